@@ -25,8 +25,10 @@
 #include <paludis/util/exception.hh>
 #include <paludis/util/set-impl.hh>
 #include <paludis/util/wrapped_value-impl.hh>
+#include <paludis/util/hashes.hh>
 #include <algorithm>
 #include <list>
+#include <unordered_map>
 
 using namespace paludis;
 
@@ -212,9 +214,9 @@ Choices::find_by_name_with_prefix(const ChoiceNameWithPrefix & f) const
         if (0 != choice->prefix().value().compare(0, choice->prefix().value().length(), f.value(), 0, choice->prefix().value().length()))
             continue;
 
-        for (const auto & value : *choice)
-            if (value->name_with_prefix() == f)
-                return value;
+        auto value(choice->find_by_name_with_prefix(f));
+        if (value)
+            return value;
     }
 
     return nullptr;
@@ -241,6 +243,7 @@ namespace paludis
     struct Imp<Choice>
     {
         ChoiceList values;
+        std::unordered_map<ChoiceNameWithPrefix, std::shared_ptr<const ChoiceValue>, Hash<ChoiceNameWithPrefix> > values_by_name;
         const ChoiceParams params;
 
         Imp(const ChoiceParams & p) :
@@ -261,6 +264,16 @@ void
 Choice::add(const std::shared_ptr<const ChoiceValue> & v)
 {
     _imp->values.push_back(v);
+    _imp->values_by_name.emplace(v->name_with_prefix(), v);
+}
+
+const std::shared_ptr<const ChoiceValue>
+Choice::find_by_name_with_prefix(const ChoiceNameWithPrefix & f) const
+{
+    auto i(_imp->values_by_name.find(f));
+    if (i == _imp->values_by_name.end())
+        return nullptr;
+    return i->second;
 }
 
 const std::string
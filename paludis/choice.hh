@@ -250,6 +250,17 @@ namespace paludis
              */
             void add(const std::shared_ptr<const ChoiceValue> &);
 
+            /**
+             * Find one of our ChoiceValue children by its name with prefix.
+             *
+             * Returns a zero pointer for no match. Uses an index, so unlike
+             * iterating over our children, this does not depend upon how
+             * many values we have. If two values have the same name, the
+             * one added first is returned.
+             */
+            const std::shared_ptr<const ChoiceValue> find_by_name_with_prefix(
+                    const ChoiceNameWithPrefix &) const PALUDIS_ATTRIBUTE((warn_unused_result));
+
             ///\name Properties
             ///\{
 
@@ -0,0 +1,153 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/choice.hh>
+
+#include <paludis/util/make_named_values.hh>
+#include <paludis/util/wrapped_forward_iterator.hh>
+
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+namespace
+{
+    struct TestChoiceValue :
+        ChoiceValue
+    {
+        const std::string prefix;
+        const std::string name;
+        const std::string desc;
+
+        TestChoiceValue(const std::string & p, const std::string & n, const std::string & d) :
+            prefix(p),
+            name(n),
+            desc(d)
+        {
+        }
+
+        const UnprefixedChoiceName unprefixed_name() const override
+        {
+            return UnprefixedChoiceName(name);
+        }
+
+        const ChoiceNameWithPrefix name_with_prefix() const override
+        {
+            return ChoiceNameWithPrefix((prefix.empty() ? "" : prefix + ":") + name);
+        }
+
+        bool enabled() const override
+        {
+            return true;
+        }
+
+        bool enabled_by_default() const override
+        {
+            return true;
+        }
+
+        bool presumed() const override
+        {
+            return false;
+        }
+
+        bool locked() const override
+        {
+            return false;
+        }
+
+        const std::string description() const override
+        {
+            return desc;
+        }
+
+        ChoiceOrigin origin() const override
+        {
+            return co_explicit;
+        }
+
+        const std::string parameter() const override
+        {
+            return "";
+        }
+
+        const std::shared_ptr<const PermittedChoiceValueParameterValues> permitted_parameter_values() const override
+        {
+            return nullptr;
+        }
+    };
+
+    std::shared_ptr<Choice> make_choice(const std::string & prefix)
+    {
+        return std::make_shared<Choice>(make_named_values<ChoiceParams>(
+                    n::consider_added_or_changed() = false,
+                    n::contains_every_value() = false,
+                    n::hidden() = false,
+                    n::hide_description() = false,
+                    n::human_name() = prefix,
+                    n::prefix() = ChoicePrefixName(prefix),
+                    n::raw_name() = prefix,
+                    n::show_with_no_prefix() = false
+                    ));
+    }
+}
+
+TEST(Choice, FindByNameWithPrefix)
+{
+    auto c(make_choice("linguas"));
+    c->add(std::make_shared<TestChoiceValue>("linguas", "en", "English"));
+    c->add(std::make_shared<TestChoiceValue>("linguas", "fr", "French"));
+
+    auto en(c->find_by_name_with_prefix(ChoiceNameWithPrefix("linguas:en")));
+    ASSERT_TRUE(bool(en));
+    EXPECT_EQ("English", en->description());
+
+    auto fr(c->find_by_name_with_prefix(ChoiceNameWithPrefix("linguas:fr")));
+    ASSERT_TRUE(bool(fr));
+    EXPECT_EQ("French", fr->description());
+}
+
+TEST(Choice, FindByNameWithPrefixMissing)
+{
+    auto c(make_choice("linguas"));
+    c->add(std::make_shared<TestChoiceValue>("linguas", "en", "English"));
+
+    EXPECT_FALSE(c->find_by_name_with_prefix(ChoiceNameWithPrefix("linguas:de")));
+    EXPECT_FALSE(c->find_by_name_with_prefix(ChoiceNameWithPrefix("en")));
+    EXPECT_FALSE(make_choice("linguas")->find_by_name_with_prefix(ChoiceNameWithPrefix("linguas:en")));
+}
+
+TEST(Choice, FindByNameWithPrefixDuplicate)
+{
+    auto c(make_choice("linguas"));
+    c->add(std::make_shared<TestChoiceValue>("linguas", "en", "first"));
+    c->add(std::make_shared<TestChoiceValue>("linguas", "en", "second"));
+
+    auto en(c->find_by_name_with_prefix(ChoiceNameWithPrefix("linguas:en")));
+    ASSERT_TRUE(bool(en));
+    EXPECT_EQ("first", en->description());
+
+    /* both are still there for anyone iterating */
+    EXPECT_EQ(2, std::distance(c->begin(), c->end()));
+}
@@ -32,7 +32,7 @@ using namespace paludis;
 std::shared_ptr<const DependencySpecTree>
 CommaSeparatedDepParser::parse(const Environment * const env, const std::string & s)
 {
-    Context context("When parsing '" + s + "':");
+    Context context([&] { return "When parsing '" + s + "':"; });
 
     std::shared_ptr<DependencySpecTree> result(std::make_shared<DependencySpecTree>(std::make_shared<AllDepSpec>()));
 
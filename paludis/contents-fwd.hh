@@ -21,6 +21,9 @@
 #define PALUDIS_GUARD_PALUDIS_CONTENTS_FWD_HH 1
 
 #include <iosfwd>
+#include <functional>
+#include <memory>
+#include <string_view>
 #include <paludis/util/attributes.hh>
 
 /** \file
@@ -38,6 +41,36 @@ namespace paludis
     class ContentsOtherEntry;
 
     class Contents;
+
+    struct ContentsEntryView;
+
+    /**
+     * Turns a single line of a contents file into an entry, or returns a null
+     * pointer if the line is to be skipped.
+     *
+     * \ingroup g_contents
+     */
+    typedef std::function<std::shared_ptr<const ContentsEntry> (const std::string_view &)> ContentsLineDecoder;
+
+    /**
+     * Called for every line of a contents file, with its line number, when a
+     * lazy Contents is created. Warns about, and returns false for, any line
+     * that is to be skipped, and throws if the file is unusable, so that
+     * problems show up when the contents is loaded rather than when it is
+     * iterated.
+     *
+     * \ingroup g_contents
+     */
+    typedef std::function<bool (const std::string_view &, unsigned)> ContentsLineChecker;
+
+    /**
+     * Makes a view of a single line of a contents file, pointing into the
+     * line, without decoding it into an entry. Only called for lines the
+     * checker accepted.
+     *
+     * \ingroup g_contents
+     */
+    typedef std::function<ContentsEntryView (const std::string_view &)> ContentsLineViewer;
 }
 
 #endif
@@ -20,12 +20,24 @@
 #include <paludis/contents.hh>
 #include <paludis/util/pimp-impl.hh>
 #include <paludis/util/wrapped_forward_iterator-impl.hh>
+#include <paludis/util/mapped_file.hh>
+#include <paludis/util/make_named_values.hh>
+#include <paludis/util/visitor_cast.hh>
+#include <paludis/util/destringify.hh>
+#include <paludis/util/stringify.hh>
+#include <paludis/util/timestamp.hh>
+#include <paludis/util/fs_path.hh>
 #include <paludis/literal_metadata_key.hh>
-#include <list>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <vector>
 
 using namespace paludis;
 
-typedef std::list<std::shared_ptr<const ContentsEntry> > Entries;
+typedef std::vector<std::shared_ptr<const ContentsEntry> > Entries;
 
 namespace paludis
 {
@@ -144,18 +156,202 @@ ContentsSymEntry::part_key() const
     return _imp->part_key;
 }
 
+time_t
+paludis::parse_contents_mtime(const std::string_view & s)
+{
+    if (s.empty())
+        throw DestringifyError("is empty");
+
+    time_t result;
+    auto r(std::from_chars(s.data(), s.data() + s.length(), result));
+    if (r.ec != std::errc() || r.ptr != s.data() + s.length())
+        throw DestringifyError(std::string(s));
+
+    return result;
+}
+
+namespace
+{
+    template <typename T_>
+    const T_ * find_key(const ContentsEntry & e, const std::string & r)
+    {
+        auto k(e.find_metadata(r));
+        return e.end_metadata() == k ? nullptr : visitor_cast<const T_>(**k);
+    }
+}
+
+void
+paludis::view_contents_entry(const ContentsEntry & e, const std::function<void (const ContentsEntryView &)> & f)
+{
+    const std::string path(stringify(e.location_key()->parse_value()));
+
+    std::string md5;
+    if (auto k = find_key<MetadataValueKey<std::string> >(e, "md5"))
+        md5 = k->parse_value();
+
+    std::string mtime;
+    if (auto k = find_key<MetadataTimeKey>(e, "mtime"))
+        mtime = stringify(k->parse_value().seconds());
+
+    std::string target;
+    if (auto k = find_key<MetadataValueKey<std::string> >(e, "target"))
+        target = k->parse_value();
+
+    bool is_volatile(false);
+    if (auto k = find_key<MetadataValueKey<bool> >(e, "volatile"))
+        is_volatile = k->parse_value();
+
+    f(make_named_values<ContentsEntryView>(
+                n::is_volatile() = is_volatile,
+                n::md5() = std::string_view(md5),
+                n::mtime() = std::string_view(mtime),
+                n::path() = std::string_view(path),
+                n::target() = std::string_view(target),
+                n::type() = e.make_accept_returning(
+                    [&] (const ContentsFileEntry &)  { return et_file; },
+                    [&] (const ContentsDirEntry &)   { return et_dir; },
+                    [&] (const ContentsSymEntry &)   { return et_sym; },
+                    [&] (const ContentsOtherEntry &) { return et_misc; }
+                    )
+                ));
+}
+
 namespace paludis
 {
     template<>
     struct Imp<Contents>
     {
-        Entries c;
+        std::shared_ptr<const MappedFile> file;
+        ContentsLineDecoder decoder;
+        ContentsLineViewer viewer;
+
+        /* for a lazy contents, the offset of every line the checker
+         * accepted */
+        std::vector<std::size_t> line_offsets;
+
+        /* set, with release ordering, once c[n] is safe to read without
+         * holding the mutex */
+        std::unique_ptr<std::atomic<bool> []> decoded;
+
+        mutable std::mutex mutex;
+        mutable Entries c;
+
+        Imp() = default;
+
+        Imp(const std::shared_ptr<const MappedFile> & f, const ContentsLineChecker & check, const ContentsLineDecoder & d,
+                const ContentsLineViewer & v) :
+            file(f),
+            decoder(d),
+            viewer(v)
+        {
+            const char * const data(file->data());
+            const std::size_t size(file->size());
+
+            unsigned line_number(0);
+            for (std::size_t p(0) ; p < size ; )
+            {
+                const void * nl(std::memchr(data + p, '\n', size - p));
+                std::size_t e(nl ? static_cast<const char *>(nl) - data : size);
+                if (check(std::string_view(data + p, e - p), ++line_number))
+                    line_offsets.push_back(p);
+                p = e + 1;
+            }
+
+            decoded.reset(new std::atomic<bool>[line_offsets.size()]());
+            c.resize(line_offsets.size());
+        }
+
+        std::string_view line(std::size_t n) const
+        {
+            std::string_view rest(file->view().substr(line_offsets[n]));
+            return rest.substr(0, rest.find('\n'));
+        }
+
+        std::size_t size() const
+        {
+            return c.size();
+        }
+
+        const std::shared_ptr<const ContentsEntry> & entry(std::size_t n) const
+        {
+            if ((! file) || decoded[n].load(std::memory_order_acquire))
+                return c[n];
+
+            std::unique_lock<std::mutex> lock(mutex);
+            if (! decoded[n].load(std::memory_order_relaxed))
+            {
+                c[n] = decoder(line(n));
+                decoded[n].store(true, std::memory_order_release);
+            }
+
+            return c[n];
+        }
+    };
+
+    /* walks over entries by index, decoding them as it goes, and stepping
+     * over any lines the decoder chose to skip */
+    struct ContentsUnderlyingIterator
+    {
+        typedef std::forward_iterator_tag iterator_category;
+        typedef const std::shared_ptr<const ContentsEntry> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const std::shared_ptr<const ContentsEntry> * pointer;
+        typedef const std::shared_ptr<const ContentsEntry> & reference;
+
+        const Imp<Contents> * imp;
+        std::size_t n;
+
+        ContentsUnderlyingIterator() :
+            imp(nullptr),
+            n(0)
+        {
+        }
+
+        ContentsUnderlyingIterator(const Imp<Contents> * const i, const std::size_t nn) :
+            imp(i),
+            n(nn)
+        {
+            skip_empty();
+        }
+
+        void skip_empty()
+        {
+            while (n < imp->size() && ! imp->entry(n))
+                ++n;
+        }
+
+        reference operator* () const
+        {
+            return imp->entry(n);
+        }
+
+        pointer operator-> () const
+        {
+            return &imp->entry(n);
+        }
+
+        ContentsUnderlyingIterator & operator++ ()
+        {
+            ++n;
+            skip_empty();
+            return *this;
+        }
+
+        bool operator== (const ContentsUnderlyingIterator & other) const
+        {
+            return n == other.n;
+        }
+
+        bool operator!= (const ContentsUnderlyingIterator & other) const
+        {
+            return ! operator== (other);
+        }
     };
 
     template <>
     struct WrappedForwardIteratorTraits<Contents::ConstIteratorTag>
     {
-        typedef Entries::const_iterator UnderlyingIterator;
+        typedef ContentsUnderlyingIterator UnderlyingIterator;
     };
 }
 
@@ -164,24 +360,67 @@ Contents::Contents() :
 {
 }
 
+Contents::Contents(const std::shared_ptr<const MappedFile> & f, const ContentsLineChecker & c,
+        const ContentsLineDecoder & d) :
+    _imp(f, c, d, nullptr)
+{
+}
+
+Contents::Contents(const std::shared_ptr<const MappedFile> & f, const ContentsLineChecker & c,
+        const ContentsLineDecoder & d, const ContentsLineViewer & v) :
+    _imp(f, c, d, v)
+{
+}
+
 Contents::~Contents() = default;
 
 void
 Contents::add(const std::shared_ptr<const ContentsEntry> & c)
 {
+    if (_imp->file)
+    {
+        /* stop being lazy, rather than growing the decoded flags */
+        for (std::size_t n(0), n_end(_imp->size()) ; n != n_end ; ++n)
+            _imp->entry(n);
+        _imp->file.reset();
+        _imp->decoded.reset();
+        std::vector<std::size_t>().swap(_imp->line_offsets);
+    }
+
     _imp->c.push_back(c);
 }
 
 Contents::ConstIterator
 Contents::begin() const
 {
-    return ConstIterator(_imp->c.begin());
+    return ConstIterator(ContentsUnderlyingIterator(_imp.get(), 0));
 }
 
 Contents::ConstIterator
 Contents::end() const
 {
-    return ConstIterator(_imp->c.end());
+    return ConstIterator(ContentsUnderlyingIterator(_imp.get(), _imp->size()));
+}
+
+void
+Contents::for_each_view(const std::function<bool (const ContentsEntryView &)> & f) const
+{
+    if (_imp->file && _imp->viewer)
+    {
+        for (std::size_t n(0), n_end(_imp->size()) ; n != n_end ; ++n)
+            if (! f(_imp->viewer(_imp->line(n))))
+                return;
+    }
+    else
+    {
+        for (const auto & e : *this)
+        {
+            bool more(true);
+            view_contents_entry(*e, [&] (const ContentsEntryView & v) { more = f(v); });
+            if (! more)
+                return;
+        }
+    }
 }
 
 namespace paludis
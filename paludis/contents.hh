@@ -26,9 +26,15 @@
 #include <paludis/util/type_list.hh>
 #include <paludis/util/wrapped_forward_iterator.hh>
 #include <paludis/util/fs_path-fwd.hh>
+#include <paludis/util/mapped_file-fwd.hh>
+#include <paludis/util/named_value.hh>
 #include <paludis/metadata_key_holder.hh>
+#include <paludis/merger_entry_type.hh>
+#include <ctime>
+#include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
 
 /** \file
  * Declarations for the Contents classes.
@@ -42,6 +48,63 @@
 
 namespace paludis
 {
+    namespace n
+    {
+        typedef Name<struct name_is_volatile> is_volatile;
+        typedef Name<struct name_md5> md5;
+        typedef Name<struct name_mtime> mtime;
+        typedef Name<struct name_path> path;
+        typedef Name<struct name_target> target;
+        typedef Name<struct name_type> type;
+    }
+
+    /**
+     * A view of a single contents entry, for callers that only want to look
+     * at each entry once and so have no need for a ContentsEntry.
+     *
+     * The views only stay valid for the duration of the call they are passed
+     * to.
+     *
+     * \see Contents::for_each_view
+     * \ingroup g_contents
+     * \nosubgrouping
+     */
+    struct ContentsEntryView
+    {
+        /// Whether the entry may be changed after it has been merged.
+        NamedValue<n::is_volatile, bool> is_volatile;
+
+        /// The md5 of a file, or empty.
+        NamedValue<n::md5, std::string_view> md5;
+
+        /// The modification time in seconds of a file or a sym, or empty.
+        NamedValue<n::mtime, std::string_view> mtime;
+
+        NamedValue<n::path, std::string_view> path;
+
+        /// The target of a sym, or empty.
+        NamedValue<n::target, std::string_view> target;
+
+        /// One of et_file, et_dir, et_sym or et_misc.
+        NamedValue<n::type, EntryType> type;
+    };
+
+    /**
+     * Parse the mtime of a ContentsEntryView.
+     *
+     * \throw DestringifyError if it is empty or not a number.
+     * \ingroup g_contents
+     */
+    time_t parse_contents_mtime(const std::string_view &) PALUDIS_VISIBLE;
+
+    /**
+     * Call the function with a view of a ContentsEntry.
+     *
+     * \ingroup g_contents
+     */
+    void view_contents_entry(const ContentsEntry &,
+            const std::function<void (const ContentsEntryView &)> &) PALUDIS_VISIBLE;
+
     /**
      * Base class for a contents entry.
      *
@@ -207,6 +270,12 @@ namespace paludis
     /**
      * A package's contents, obtainable by PackageID::contents.
      *
+     * A Contents can either be filled in using add(), or be backed by a
+     * mapped contents file, in which case only the offset of each line is
+     * held, and entries are decoded the first time they are reached. If it
+     * also has a viewer, for_each_view() looks at lines without decoding
+     * them at all.
+     *
      * \ingroup g_contents
      * \nosubgrouping
      */
@@ -220,6 +289,20 @@ namespace paludis
             ///\{
 
             Contents();
+
+            /**
+             * Lazily decode entries, one per line of the file that the
+             * checker accepts, using the supplied decoder.
+             */
+            Contents(const std::shared_ptr<const MappedFile> &, const ContentsLineChecker &,
+                    const ContentsLineDecoder &);
+
+            /**
+             * As above, using the viewer for for_each_view().
+             */
+            Contents(const std::shared_ptr<const MappedFile> &, const ContentsLineChecker &,
+                    const ContentsLineDecoder &, const ContentsLineViewer &);
+
             ~Contents();
 
             Contents(const Contents &) = delete;
@@ -243,6 +326,12 @@ namespace paludis
                 PALUDIS_ATTRIBUTE((warn_unused_result));
 
             ///\}
+
+            /**
+             * Call the function with a view of each entry in turn, until it
+             * returns false. Entries are only decoded if we have no viewer.
+             */
+            void for_each_view(const std::function<bool (const ContentsEntryView &)> &) const;
     };
 
     extern template class Pimp<Contents>;
@@ -20,6 +20,9 @@
 #include <paludis/dep_spec.hh>
 #include <paludis/user_dep_spec.hh>
 #include <paludis/version_requirements.hh>
+#include <paludis/version_operator.hh>
+#include <paludis/version_spec.hh>
+#include <paludis/partially_made_package_dep_spec.hh>
 #include <paludis/environments/test/test_environment.hh>
 
 #include <paludis/util/clone-impl.hh>
@@ -28,6 +31,7 @@
 #include <paludis/util/iterator_funcs.hh>
 #include <paludis/util/options.hh>
 #include <paludis/util/stringify.hh>
+#include <paludis/util/make_named_values.hh>
 
 #include <gtest/gtest.h>
 
@@ -66,3 +70,24 @@ TEST(DepSpec, Clone)
     EXPECT_EQ(stringify(d.blocking()), stringify(e->blocking()));
 }
 
+
+TEST(PartiallyMadePackageDepSpec, CopyOnWrite)
+{
+    TestEnvironment env;
+    PackageDepSpec a(parse_user_package_dep_spec(">=cat/pkg-1::repo", &env, { }));
+    std::shared_ptr<const QualifiedPackageName> a_package(a.package_ptr());
+
+    PackageDepSpec b(PartiallyMadePackageDepSpec(a)
+            .package(QualifiedPackageName("cat/other"))
+            .version_requirement(make_named_values<VersionRequirement>(
+                    n::version_operator() = VersionOperator("<"),
+                    n::version_spec() = VersionSpec("2", { })))
+            .clear_in_repository());
+
+    EXPECT_EQ(">=cat/pkg-1::repo", stringify(a));
+    EXPECT_EQ("cat/pkg", stringify(*a_package));
+    EXPECT_EQ(1, std::distance(a.version_requirements_ptr()->begin(), a.version_requirements_ptr()->end()));
+    EXPECT_EQ("cat/other[>=1&<2]", stringify(b));
+    EXPECT_EQ(2, std::distance(b.version_requirements_ptr()->begin(), b.version_requirements_ptr()->end()));
+    EXPECT_FALSE(bool(b.in_repository_ptr()));
+}
@@ -34,7 +34,7 @@
 #include <paludis/util/member_iterator-impl.hh>
 #include <paludis/util/visitor_cast.hh>
 #include <paludis/util/wrapped_forward_iterator.hh>
-#include <paludis/util/safe_ifstream.hh>
+#include <paludis/util/mapped_file.hh>
 #include <paludis/util/fs_path.hh>
 #include <paludis/util/fs_stat.hh>
 
@@ -107,7 +107,7 @@ namespace paludis
     struct Imp<ElfLinkageChecker>
     {
         FSPath root;
-        std::set<std::string> check_libraries;
+        std::set<std::string, std::less<> > check_libraries;
 
         std::mutex mutex;
 
@@ -119,9 +119,9 @@ namespace paludis
 
         std::vector<FSPath> extra_lib_dirs;
 
-        template <typename> bool check_elf(const FSPath &, std::istream &);
+        template <typename> bool check_elf(const FSPath &, const MappedFile &);
         void handle_library(const FSPath &, const ElfArchitecture &);
-        template <typename> bool check_extra_elf(const FSPath &, std::istream &, std::set<ElfArchitecture> &);
+        template <typename> bool check_extra_elf(const FSPath &, const MappedFile &, std::set<ElfArchitecture> &);
 
         Imp(const FSPath & the_root, const std::shared_ptr<const Sequence<std::string>> & the_libraries) :
             root(the_root)
@@ -148,22 +148,22 @@ ElfLinkageChecker::check_file(const FSPath & file)
            (0 != (file.stat().permissions() & S_IXUSR))))
         return false;
 
-    SafeIFStream stream(file);
-    return _imp->check_elf<Elf32Type>(file, stream) || _imp->check_elf<Elf64Type>(file, stream);
+    MappedFile data(file);
+    return _imp->check_elf<Elf32Type>(file, data) || _imp->check_elf<Elf64Type>(file, data);
 }
 
 template <typename ElfType_>
 bool
-Imp<ElfLinkageChecker>::check_elf(const FSPath & file, std::istream & stream)
+Imp<ElfLinkageChecker>::check_elf(const FSPath & file, const MappedFile & data)
 {
-    if (! ElfObject<ElfType_>::is_valid_elf(stream))
+    if (! ElfObject<ElfType_>::is_valid_elf(data))
         return false;
 
     try
     {
         Context ctx("When checking '" + stringify(file) + "' as a " +
                     stringify<int>(ElfType_::elf_class * 32) + "-bit ELF file:");
-        ElfObject<ElfType_> elf(stream);
+        ElfObject<ElfType_> elf(data);
         if (ET_EXEC != elf.get_type() && ET_DYN != elf.get_type())
         {
             Log::get_instance()->message("broken_linkage_finder.not_interesting", ll_debug, lc_context)
@@ -190,12 +190,12 @@ Imp<ElfLinkageChecker>::check_elf(const FSPath & file, std::istream & stream)
                         if (ent_str->tag_name() != "NEEDED")
                             continue;
 
-                        const std::string & req((*ent_str)());
+                        const std::string_view req((*ent_str)());
                         if (check_libraries.empty() || check_libraries.end() != check_libraries.find(req))
                         {
                             Log::get_instance()->message("broken_linkage_finder.depends", ll_debug, lc_context)
                                 << "File depends on " << req;
-                            needed[arch][req].push_back(file);
+                            needed[arch][std::string(req)].push_back(file);
                         }
                     }
                 }
@@ -305,14 +305,14 @@ ElfLinkageChecker::need_breakage_added(
 
             try
             {
-                SafeIFStream stream(file);
+                MappedFile data(file);
 
-                if (! (_imp->check_extra_elf<Elf32Type>(file, stream, missing.second) ||
-                       _imp->check_extra_elf<Elf64Type>(file, stream, missing.second)))
+                if (! (_imp->check_extra_elf<Elf32Type>(file, data, missing.second) ||
+                       _imp->check_extra_elf<Elf64Type>(file, data, missing.second)))
                     Log::get_instance()->message("broken_linkage_finder.not_an_elf", ll_debug, lc_no_context)
                         << "'" << file << "' is not an ELF file";
             }
-            catch (const SafeIFStreamError & e)
+            catch (const MappedFileError & e)
             {
                 Log::get_instance()->message("broken_linkage_finder.failure", ll_warning, lc_no_context)
                     << "Error opening '" << file << "': '" << e.message() << "' (" << e.what() << ")";
@@ -331,16 +331,16 @@ ElfLinkageChecker::need_breakage_added(
 
 template <typename ElfType_>
 bool
-Imp<ElfLinkageChecker>::check_extra_elf(const FSPath & file, std::istream & stream, std::set<ElfArchitecture> & arches)
+Imp<ElfLinkageChecker>::check_extra_elf(const FSPath & file, const MappedFile & data, std::set<ElfArchitecture> & arches)
 {
-    if (! ElfObject<ElfType_>::is_valid_elf(stream))
+    if (! ElfObject<ElfType_>::is_valid_elf(data))
         return false;
 
     Context ctx("When checking '" + stringify(file) + "' as a " + stringify<int>(ElfType_::elf_class * 32) + "-bit ELF file");
 
     try
     {
-        ElfObject<ElfType_> elf(stream);
+        ElfObject<ElfType_> elf(data);
         if (ET_DYN == elf.get_type())
         {
             Log::get_instance()->message("broken_linkage_finder.is_library", ll_debug, lc_context)
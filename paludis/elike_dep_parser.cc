@@ -281,7 +281,7 @@ namespace
 void
 paludis::parse_elike_dependencies(const std::string & s, const ELikeDepParserCallbacks & callbacks, const ELikeDepParserOptions & options)
 {
-    Context context("When parsing '" + s + "':");
+    Context context([&] { return "When parsing '" + s + "':"; });
 
     SimpleParser parser(s);
     parse(parser, callbacks, options, false, false);
@@ -38,7 +38,7 @@ using namespace paludis;
 PartiallyMadePackageDepSpec
 paludis::partial_parse_generic_elike_package_dep_spec(const std::string & ss, const GenericELikePackageDepSpecParseFunctions & fns)
 {
-    Context context("When parsing generic package dep spec '" + ss + "':");
+    Context context([&] { return "When parsing generic package dep spec '" + ss + "':"; });
 
     /* Check that it's not, e.g. a set with updso_throw_if_set, or empty. */
     fns.check_sanity()(ss);
@@ -574,7 +574,7 @@ paludis::partial_parse_elike_package_dep_spec(
 {
     using namespace std::placeholders;
 
-    Context context("When parsing elike package dep spec '" + ss + "':");
+    Context context([&] { return "When parsing elike package dep spec '" + ss + "':"; });
 
     bool had_bracket_version_requirements(false);
     bool had_use_requirements(false);
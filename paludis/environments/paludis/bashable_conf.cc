@@ -18,6 +18,7 @@
  */
 
 #include <paludis/environments/paludis/bashable_conf.hh>
+#include <paludis/environments/paludis/config_snapshot.hh>
 
 #include <paludis/util/config_file.hh>
 #include <paludis/util/is_file_with_extension.hh>
@@ -30,8 +31,10 @@
 #include <paludis/util/options.hh>
 #include <paludis/util/fs_path.hh>
 #include <paludis/util/env_var_names.hh>
+#include <paludis/util/sequence.hh>
 
 #include <functional>
+#include <memory>
 
 using namespace paludis;
 using namespace paludis::paludis_environment;
@@ -49,6 +52,78 @@ namespace
 
         return "";
     }
+
+    ConfigSnapshot * config_snapshot()
+    {
+        static const std::unique_ptr<ConfigSnapshot> result([] () -> std::unique_ptr<ConfigSnapshot> {
+                    const std::string location(getenv_with_default(env_vars::config_snapshot, ""));
+                    if (location.empty())
+                        return nullptr;
+                    return std::make_unique<ConfigSnapshot>(FSPath(location));
+                }());
+
+        return result.get();
+    }
+}
+
+int
+paludis::paludis_environment::run_bashable_script(
+        const FSPath & f,
+        const std::string & stderr_prefix,
+        const std::shared_ptr<const Map<std::string, std::string> > & extra_variables,
+        std::stringstream & output)
+{
+    const std::string log_level(stringify(Log::get_instance()->log_level()));
+    const std::string ebuild_dir(getenv_with_default(env_vars::ebuild_dir, LIBEXECDIR "/paludis"));
+
+    /* the script's output can depend upon the variables we give it, as well
+     * as upon its own text */
+    ConfigSnapshot * const snapshot(config_snapshot());
+    std::string key;
+    if (snapshot)
+    {
+        key = "bash\n" + stringify(f) + "\n" + log_level + "\n" + ebuild_dir;
+        if (extra_variables)
+            for (const auto & var : *extra_variables)
+                key.append("\n" + var.first + "=" + var.second);
+
+        auto cached(snapshot->find(key));
+        if (cached)
+        {
+            output << *cached;
+            return 0;
+        }
+    }
+
+    std::stringstream s;
+    Process process(ProcessCommand({ "bash", stringify(f) }));
+    process
+        .setenv("PALUDIS_LOG_LEVEL", log_level)
+        .setenv("PALUDIS_EBUILD_DIR", ebuild_dir)
+        .prefix_stderr(stderr_prefix)
+        .capture_stdout(s);
+    if (extra_variables)
+        for (const auto & var : *extra_variables)
+            process.setenv(var.first, var.second);
+    int exit_status(process.run().wait());
+
+    if (snapshot && 0 == exit_status)
+    {
+        auto depends_upon(std::make_shared<FSPathSequence>());
+        depends_upon->push_back(f);
+        snapshot->store(key, depends_upon, s.str());
+    }
+
+    output << s.str();
+    return exit_status;
+}
+
+void
+paludis::paludis_environment::save_config_snapshot()
+{
+    ConfigSnapshot * const snapshot(config_snapshot());
+    if (snapshot)
+        snapshot->save();
 }
 
 std::shared_ptr<LineConfigFile>
@@ -61,14 +136,7 @@ paludis::paludis_environment::make_bashable_conf(const FSPath & f, const LineCon
     if (is_file_with_extension(f, ".bash", { }))
     {
         std::stringstream s;
-
-        Process process(ProcessCommand({ "bash", stringify(f) }));
-        process
-            .setenv("PALUDIS_LOG_LEVEL", stringify(Log::get_instance()->log_level()))
-            .setenv("PALUDIS_EBUILD_DIR", getenv_with_default(env_vars::ebuild_dir, LIBEXECDIR "/paludis"))
-            .prefix_stderr(f.basename() + "> ")
-            .capture_stdout(s);
-        int exit_status(process.run().wait());
+        int exit_status(run_bashable_script(f, f.basename() + "> ", nullptr, s));
         result = std::make_shared<LineConfigFile>(s, o);
 
         if (exit_status != 0)
@@ -96,15 +164,7 @@ paludis::paludis_environment::make_bashable_kv_conf(const FSPath & f,
     if (is_file_with_extension(f, ".bash", { }))
     {
         std::stringstream s;
-        Process process(ProcessCommand({ "bash", stringify(f) }));
-        process
-            .setenv("PALUDIS_LOG_LEVEL", stringify(Log::get_instance()->log_level()))
-            .setenv("PALUDIS_EBUILD_DIR", getenv_with_default(env_vars::ebuild_dir, LIBEXECDIR "/paludis"))
-            .prefix_stderr(f.basename() + "> ")
-            .capture_stdout(s);
-        for (const auto & var : *predefined_variables)
-            process.setenv(var.first, var.second);
-        int exit_status(process.run().wait());
+        int exit_status(run_bashable_script(f, f.basename() + "> ", predefined_variables, s));
         result = std::make_shared<KeyValueConfigFile>(s, o, &KeyValueConfigFile::no_defaults, &KeyValueConfigFile::no_transformation);
 
         if (exit_status != 0)
@@ -24,12 +24,33 @@
 #include <paludis/util/config_file-fwd.hh>
 #include <paludis/util/map-fwd.hh>
 #include <memory>
+#include <sstream>
 #include <string>
 
 namespace paludis
 {
     namespace paludis_environment
     {
+        /**
+         * Run a .bash configuration file, capturing its output, and return its
+         * exit status.
+         *
+         * If PALUDIS_CONFIG_SNAPSHOT names a snapshot file, the output of a
+         * successful run is stored there, and reused by later runs for as long
+         * as the script itself is unchanged.
+         */
+        int run_bashable_script(
+                const FSPath &,
+                const std::string & stderr_prefix,
+                const std::shared_ptr<const Map<std::string, std::string> > & extra_variables,
+                std::stringstream & output);
+
+        /**
+         * Write out the snapshot used by run_bashable_script, if there is
+         * one and anything new has been stored in it.
+         */
+        void save_config_snapshot();
+
         std::shared_ptr<LineConfigFile> make_bashable_conf(
                 const FSPath &,
                 const LineConfigFileOptions &);
@@ -0,0 +1,314 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/environments/paludis/config_snapshot.hh>
+#include <paludis/util/pimp-impl.hh>
+#include <paludis/util/mapped_file.hh>
+#include <paludis/util/fs_stat.hh>
+#include <paludis/util/fs_error.hh>
+#include <paludis/util/timestamp.hh>
+#include <paludis/util/safe_ofstream.hh>
+#include <paludis/util/sequence.hh>
+#include <paludis/util/wrapped_forward_iterator.hh>
+#include <paludis/util/stringify.hh>
+#include <paludis/util/log.hh>
+#include <paludis/util/hashes.hh>
+
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace paludis;
+using namespace paludis::paludis_environment;
+
+namespace
+{
+    const std::string_view magic("paludis config snapshot 1\n");
+
+    struct Dependency
+    {
+        std::string path;
+        std::int64_t mtime_seconds;
+        std::int64_t mtime_nanoseconds;
+        std::int64_t size;
+    };
+
+    struct Entry
+    {
+        std::vector<Dependency> dependencies;
+        std::string_view value;
+        std::shared_ptr<const std::string> owned_value;
+    };
+
+    typedef std::unordered_map<std::string, Entry, Hash<std::string> > Entries;
+
+    struct Reader
+    {
+        std::string_view data;
+
+        bool read_u64(std::uint64_t & result)
+        {
+            if (data.size() < sizeof(result))
+                return false;
+            std::memcpy(&result, data.data(), sizeof(result));
+            data.remove_prefix(sizeof(result));
+            return true;
+        }
+
+        bool read_i64(std::int64_t & result)
+        {
+            std::uint64_t u;
+            if (! read_u64(u))
+                return false;
+            result = static_cast<std::int64_t>(u);
+            return true;
+        }
+
+        bool read_string(std::string_view & result)
+        {
+            std::uint64_t length;
+            if ((! read_u64(length)) || data.size() < length)
+                return false;
+            result = data.substr(0, length);
+            data.remove_prefix(length);
+            return true;
+        }
+    };
+
+    void write_u64(std::string & out, const std::uint64_t v)
+    {
+        out.append(reinterpret_cast<const char *>(&v), sizeof(v));
+    }
+
+    void write_string(std::string & out, const std::string_view & s)
+    {
+        write_u64(out, s.size());
+        out.append(s.data(), s.size());
+    }
+
+    Dependency make_dependency(const FSPath & f)
+    {
+        FSStat f_stat(f);
+        if (! f_stat.exists())
+            return Dependency{ stringify(f), -1, -1, -1 };
+
+        Timestamp mtim(f_stat.mtim());
+        return Dependency{ stringify(f), static_cast<std::int64_t>(mtim.seconds()),
+            static_cast<std::int64_t>(mtim.nanoseconds()), static_cast<std::int64_t>(f_stat.file_size()) };
+    }
+
+    bool unchanged(const Dependency & d)
+    {
+        Dependency now(make_dependency(FSPath(d.path)));
+        return now.mtime_seconds == d.mtime_seconds && now.mtime_nanoseconds == d.mtime_nanoseconds && now.size == d.size;
+    }
+}
+
+namespace paludis
+{
+    template <>
+    struct Imp<ConfigSnapshot>
+    {
+        const FSPath location;
+        std::unique_ptr<MappedFile> mapped;
+
+        mutable std::mutex mutex;
+        Entries entries;
+        bool dirty;
+
+        Imp(const FSPath & l) :
+            location(l),
+            dirty(false)
+        {
+        }
+
+        bool load();
+        void save() const;
+    };
+}
+
+bool
+Imp<ConfigSnapshot>::load()
+{
+    if (! location.stat().is_regular_file())
+        return false;
+
+    mapped = std::make_unique<MappedFile>(location);
+    Reader reader{ mapped->view() };
+
+    if (0 != reader.data.compare(0, magic.size(), magic))
+        return false;
+    reader.data.remove_prefix(magic.size());
+
+    std::uint64_t entry_count;
+    if (! reader.read_u64(entry_count))
+        return false;
+
+    for ( ; entry_count > 0 ; --entry_count)
+    {
+        std::string_view key;
+        std::uint64_t dependency_count;
+        if ((! reader.read_string(key)) || (! reader.read_u64(dependency_count)))
+            return false;
+
+        Entry entry;
+        for ( ; dependency_count > 0 ; --dependency_count)
+        {
+            std::string_view path;
+            Dependency d;
+            if ((! reader.read_string(path)) || (! reader.read_i64(d.mtime_seconds))
+                    || (! reader.read_i64(d.mtime_nanoseconds)) || (! reader.read_i64(d.size)))
+                return false;
+            d.path = std::string(path);
+            entry.dependencies.push_back(std::move(d));
+        }
+
+        if (! reader.read_string(entry.value))
+            return false;
+
+        entries[std::string(key)] = std::move(entry);
+    }
+
+    return reader.data.empty();
+}
+
+void
+Imp<ConfigSnapshot>::save() const
+{
+    std::string out(magic);
+    write_u64(out, entries.size());
+    for (const auto & entry : entries)
+    {
+        write_string(out, entry.first);
+        write_u64(out, entry.second.dependencies.size());
+        for (const auto & d : entry.second.dependencies)
+        {
+            write_string(out, d.path);
+            write_u64(out, d.mtime_seconds);
+            write_u64(out, d.mtime_nanoseconds);
+            write_u64(out, d.size);
+        }
+        write_string(out, entry.second.value);
+    }
+
+    /* write to a temporary file and rename it into place, so that other
+     * processes never see a partial snapshot */
+    FSPath temporary(location.dirname() / ("." + location.basename() + "." + stringify(::getpid())));
+    {
+        SafeOFStream f(temporary, O_CREAT | O_TRUNC | O_WRONLY, true);
+        f << out;
+    }
+    temporary.rename(location);
+}
+
+ConfigSnapshot::ConfigSnapshot(const FSPath & l) :
+    _imp(l)
+{
+    Context context("When loading configuration snapshot '" + stringify(l) + "':");
+
+    try
+    {
+        if (! _imp->load())
+        {
+            Log::get_instance()->message("paludis_environment.config_snapshot.invalid", ll_debug, lc_context)
+                << "Ignoring missing or invalid configuration snapshot";
+            _imp->entries.clear();
+        }
+    }
+    catch (const FSError & e)
+    {
+        Log::get_instance()->message("paludis_environment.config_snapshot.unreadable", ll_warning, lc_context)
+            << "Cannot read configuration snapshot: '" << e.message() << "' (" << e.what() << ")";
+        _imp->entries.clear();
+    }
+}
+
+ConfigSnapshot::~ConfigSnapshot() = default;
+
+const std::shared_ptr<const std::string>
+ConfigSnapshot::find(const std::string & key) const
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+
+    auto e(_imp->entries.find(key));
+    if (_imp->entries.end() == e)
+        return nullptr;
+
+    for (const auto & d : e->second.dependencies)
+        if (! unchanged(d))
+            return nullptr;
+
+    return std::make_shared<const std::string>(e->second.value);
+}
+
+void
+ConfigSnapshot::store(const std::string & key, const std::shared_ptr<const FSPathSequence> & depends_upon,
+        const std::string & value)
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+
+    Entry entry;
+    for (const auto & f : *depends_upon)
+        entry.dependencies.push_back(make_dependency(f));
+
+    entry.owned_value = std::make_shared<const std::string>(value);
+    entry.value = *entry.owned_value;
+    _imp->entries[key] = std::move(entry);
+    _imp->dirty = true;
+}
+
+void
+ConfigSnapshot::save()
+{
+    Context context("When saving configuration snapshot '" + stringify(_imp->location) + "':");
+
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    if (! _imp->dirty)
+        return;
+
+    /* whatever happens, don't keep trying */
+    _imp->dirty = false;
+
+    try
+    {
+        _imp->save();
+    }
+    catch (const FSError & e)
+    {
+        Log::get_instance()->message("paludis_environment.config_snapshot.unwritable", ll_warning, lc_context)
+            << "Cannot write configuration snapshot: '" << e.message() << "' (" << e.what() << ")";
+    }
+    catch (const SafeOFStreamError & e)
+    {
+        Log::get_instance()->message("paludis_environment.config_snapshot.unwritable", ll_warning, lc_context)
+            << "Cannot write configuration snapshot: '" << e.message() << "' (" << e.what() << ")";
+    }
+}
+
+namespace paludis
+{
+    template class Pimp<ConfigSnapshot>;
+}
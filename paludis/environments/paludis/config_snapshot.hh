@@ -0,0 +1,91 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef PALUDIS_GUARD_PALUDIS_ENVIRONMENTS_PALUDIS_CONFIG_SNAPSHOT_HH
+#define PALUDIS_GUARD_PALUDIS_ENVIRONMENTS_PALUDIS_CONFIG_SNAPSHOT_HH 1
+
+#include <paludis/util/pimp.hh>
+#include <paludis/util/attributes.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/sequence-fwd.hh>
+#include <memory>
+#include <string>
+
+namespace paludis
+{
+    namespace paludis_environment
+    {
+        /**
+         * A snapshot of expensive-to-generate configuration text, such as
+         * the output of a .bash config file, kept on disk between runs.
+         *
+         * Each value is stored along with the size and mtime of the files it
+         * was generated from, and is only returned if none of them has
+         * changed. The snapshot file is read using mmap, and an invalid or
+         * out of date file is ignored.
+         *
+         * \ingroup grppaludisenvironment
+         * \nosubgrouping
+         */
+        class PALUDIS_VISIBLE ConfigSnapshot
+        {
+            private:
+                Pimp<ConfigSnapshot> _imp;
+
+            public:
+                ///\name Basic operations
+                ///\{
+
+                explicit ConfigSnapshot(const FSPath &);
+                ~ConfigSnapshot();
+
+                ConfigSnapshot(const ConfigSnapshot &) = delete;
+                ConfigSnapshot & operator= (const ConfigSnapshot &) = delete;
+
+                ///\}
+
+                /**
+                 * The value stored for this key, or null if there is none or
+                 * if any of the files it depends upon has changed.
+                 */
+                const std::shared_ptr<const std::string> find(const std::string & key) const
+                    PALUDIS_ATTRIBUTE((warn_unused_result));
+
+                /**
+                 * Store a value. It is not written out until save() is
+                 * called.
+                 */
+                void store(const std::string & key, const std::shared_ptr<const FSPathSequence> & depends_upon,
+                        const std::string & value);
+
+                /**
+                 * Write the snapshot out, if anything different has been
+                 * stored since it was loaded or last saved.
+                 *
+                 * Failure to write the snapshot is logged, not thrown.
+                 */
+                void save();
+        };
+    }
+
+    extern template class Pimp<paludis_environment::ConfigSnapshot>;
+}
+
+#endif
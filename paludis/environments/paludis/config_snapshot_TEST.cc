@@ -0,0 +1,106 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/environments/paludis/config_snapshot.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/fs_stat.hh>
+#include <paludis/util/safe_ofstream.hh>
+#include <paludis/util/sequence.hh>
+
+#include <fcntl.h>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+using namespace paludis::paludis_environment;
+
+namespace
+{
+    std::shared_ptr<FSPathSequence> depends_upon(const std::string & name)
+    {
+        auto result(std::make_shared<FSPathSequence>());
+        result->push_back(FSPath::cwd() / "config_snapshot_TEST_dir" / name);
+        return result;
+    }
+}
+
+TEST(ConfigSnapshot, Works)
+{
+    FSPath location(FSPath::cwd() / "config_snapshot_TEST_dir" / "snapshot");
+
+    {
+        ConfigSnapshot snapshot(location);
+        EXPECT_FALSE(snapshot.find("one"));
+
+        snapshot.store("one", depends_upon("one"), "value for one");
+        snapshot.store("two", depends_upon("two"), std::string("value\0for two", 13));
+        ASSERT_TRUE(snapshot.find("one"));
+        EXPECT_EQ("value for one", *snapshot.find("one"));
+
+        EXPECT_FALSE(location.stat().exists());
+        snapshot.save();
+        EXPECT_TRUE(location.stat().exists());
+    }
+
+    {
+        ConfigSnapshot snapshot(location);
+        ASSERT_TRUE(snapshot.find("one"));
+        EXPECT_EQ("value for one", *snapshot.find("one"));
+        ASSERT_TRUE(snapshot.find("two"));
+        EXPECT_EQ(std::string("value\0for two", 13), *snapshot.find("two"));
+        EXPECT_FALSE(snapshot.find("three"));
+
+        {
+            SafeOFStream f(FSPath::cwd() / "config_snapshot_TEST_dir" / "two", O_WRONLY | O_APPEND, true);
+            f << "changed" << std::endl;
+        }
+
+        EXPECT_TRUE(snapshot.find("one"));
+        EXPECT_FALSE(snapshot.find("two"));
+    }
+}
+
+TEST(ConfigSnapshot, SavesOnlyWhenDirty)
+{
+    FSPath location(FSPath::cwd() / "config_snapshot_TEST_dir" / "dirty");
+
+    {
+        ConfigSnapshot snapshot(location);
+        snapshot.save();
+        EXPECT_FALSE(location.stat().exists());
+
+        snapshot.store("one", depends_upon("one"), "value for one");
+        snapshot.save();
+        EXPECT_TRUE(location.stat().exists());
+
+        location.unlink();
+        snapshot.save();
+        EXPECT_FALSE(location.stat().exists());
+    }
+}
+
+TEST(ConfigSnapshot, Invalid)
+{
+    ConfigSnapshot snapshot(FSPath::cwd() / "config_snapshot_TEST_dir" / "garbage");
+    EXPECT_FALSE(snapshot.find("one"));
+
+    ConfigSnapshot missing(FSPath::cwd() / "config_snapshot_TEST_dir" / "missing");
+    EXPECT_FALSE(missing.find("one"));
+}
@@ -0,0 +1,9 @@
+#!/usr/bin/env bash
+# vim: set ft=sh sw=4 sts=4 et :
+
+mkdir config_snapshot_TEST_dir || exit 2
+cd config_snapshot_TEST_dir || exit 3
+
+echo one > one
+echo two > two
+echo "not a snapshot" > garbage
@@ -24,6 +24,7 @@
 #include <paludis/spec_tree.hh>
 #include <paludis/user_dep_spec.hh>
 #include <paludis/match_package.hh>
+#include <paludis/package_dep_spec_index.hh>
 #include <paludis/util/config_file.hh>
 #include <paludis/package_id.hh>
 #include <paludis/environments/paludis/paludis_environment.hh>
@@ -54,13 +55,15 @@ namespace paludis
     {
         const PaludisEnvironment * const env;
         const bool allow_reasons;
-        std::list<std::pair<std::shared_ptr<const PackageDepSpec>, std::set<std::string> > > masks;
+        PackageDepSpecIndex masks;
+        std::vector<std::set<std::string> > masks_reasons;
         mutable Sets sets;
         mutable std::mutex set_mutex;
 
         Imp(const PaludisEnvironment * const e, const bool a) :
             env(e),
-            allow_reasons(a)
+            allow_reasons(a),
+            masks(e)
         {
         }
     };
@@ -99,14 +102,13 @@ PackageMaskConf::add(const FSPath & filename)
 
         try
         {
-            _imp->masks.push_back(std::make_pair(
-                    std::make_shared<PackageDepSpec>(parse_user_package_dep_spec(
-                            spec,
-                            _imp->env,
-                            { updso_allow_wildcards,
-                              updso_no_disambiguation,
-                              updso_throw_if_set })),
-                    reasons));
+            _imp->masks.insert(parse_user_package_dep_spec(
+                        spec,
+                        _imp->env,
+                        { updso_allow_wildcards,
+                          updso_no_disambiguation,
+                          updso_throw_if_set }));
+            _imp->masks_reasons.push_back(reasons);
         }
         catch (const GotASetNotAPackageDepSpec &)
         {
@@ -120,20 +122,20 @@ PackageMaskConf::query(const std::shared_ptr<const PackageID> & e, const std::st
 {
     using namespace std::placeholders;
 
-    for (const auto & mask : _imp->masks)
-        if (match_package(*_imp->env, *mask.first, e, nullptr, MatchPackageOptions()))
+    for (const auto & p : *_imp->masks.matching_positions(e))
+    {
+        const auto & reasons(_imp->masks_reasons[p]);
+        if (r.empty())
         {
-            if (r.empty())
-            {
-                if (mask.second.empty())
-                    return true;
-            }
-            else
-            {
-                if (mask.second.empty() || (mask.second.end() != mask.second.find(r)))
-                    return true;
-            }
+            if (reasons.empty())
+                return true;
+        }
+        else
+        {
+            if (reasons.empty() || (reasons.end() != reasons.find(r)))
+                return true;
         }
+    }
 
     {
         std::unique_lock<std::mutex> lock(_imp->set_mutex);
@@ -28,6 +28,7 @@
 #include <paludis/environments/paludis/world.hh>
 #include <paludis/environments/paludis/extra_distribution_data.hh>
 #include <paludis/environments/paludis/suggestions_conf.hh>
+#include <paludis/environments/paludis/bashable_conf.hh>
 
 #include <paludis/util/config_file.hh>
 #include <paludis/util/destringify.hh>
@@ -256,13 +257,7 @@ namespace paludis
         else if ((FSPath(config_dir) / "general.bash").stat().exists())
         {
             std::stringstream s;
-            Process process(ProcessCommand({ "bash", stringify(FSPath(config_dir) / "general.bash") }));
-            process
-                .setenv("PALUDIS_LOG_LEVEL", stringify(Log::get_instance()->log_level()))
-                .setenv("PALUDIS_EBUILD_DIR", getenv_with_default(env_vars::ebuild_dir, LIBEXECDIR "/paludis"))
-                .prefix_stderr("general.bash> ")
-                .capture_stdout(s);
-            int exit_status(process.run().wait());
+            int exit_status(run_bashable_script(FSPath(config_dir) / "general.bash", "general.bash> ", nullptr, s));
             kv = std::make_shared<KeyValueConfigFile>(
                 s,
                 KeyValueConfigFileOptions() + kvcfo_allow_env,
@@ -296,13 +291,7 @@ namespace paludis
                 << (FSPath(config_dir) / "general.bash") << "'.";
 
             std::stringstream s;
-            Process process(ProcessCommand({ "bash", stringify(FSPath(config_dir) / "environment.bash") }));
-            process
-                .setenv("PALUDIS_LOG_LEVEL", stringify(Log::get_instance()->log_level()))
-                .setenv("PALUDIS_EBUILD_DIR", getenv_with_default(env_vars::ebuild_dir, LIBEXECDIR "/paludis"))
-                .prefix_stderr("general.bash> ")
-                .capture_stdout(s);
-            int exit_status(process.run().wait());
+            int exit_status(run_bashable_script(FSPath(config_dir) / "environment.bash", "general.bash> ", nullptr, s));
             kv = std::make_shared<KeyValueConfigFile>(
                 s,
                 KeyValueConfigFileOptions() + kvcfo_allow_env,
@@ -834,9 +823,15 @@ PaludisConfig::PaludisConfig(PaludisEnvironment * const e, const std::string & s
 
 
     _imp->bashrc_files->push_back(_imp->local_config_dir / dist->bashrc_filename());
+
+    save_config_snapshot();
 }
 
-PaludisConfig::~PaludisConfig() = default;
+PaludisConfig::~PaludisConfig()
+{
+    /* for anything loaded lazily, such as general.bash */
+    save_config_snapshot();
+}
 
 namespace
 {
@@ -877,13 +872,8 @@ PaludisConfig::repo_func_from_file(const FSPath & repo_file)
     else if ((_imp->local_config_dir / (dist->repository_defaults_filename_part() + ".bash")).stat().exists())
     {
         std::stringstream s;
-        Process process(ProcessCommand({ "bash", stringify(_imp->local_config_dir / (dist->repository_defaults_filename_part() + ".bash")) + "'" }));
-        process
-            .setenv("PALUDIS_LOG_LEVEL", stringify(Log::get_instance()->log_level()))
-            .setenv("PALUDIS_EBUILD_DIR", getenv_with_default(env_vars::ebuild_dir, LIBEXECDIR "/paludis"))
-            .prefix_stderr(dist->repository_defaults_filename_part() + ".bash> ")
-            .capture_stdout(s);
-        int exit_status(process.run().wait());
+        int exit_status(run_bashable_script(_imp->local_config_dir / (dist->repository_defaults_filename_part() + ".bash"),
+                    dist->repository_defaults_filename_part() + ".bash> ", nullptr, s));
         predefined_conf_vars_func = std::bind(&from_kv, std::make_shared<KeyValueConfigFile>(
                     s, KeyValueConfigFileOptions() + kvcfo_allow_env,
                     std::bind(&to_kv_func, predefined_conf_vars_func, std::placeholders::_1, std::placeholders::_2),
@@ -899,13 +889,7 @@ PaludisConfig::repo_func_from_file(const FSPath & repo_file)
     if (is_file_with_extension(repo_file, ".bash", { }))
     {
         std::stringstream s;
-        Process process(ProcessCommand({ "bash", stringify(repo_file) }));
-        process
-            .setenv("PALUDIS_LOG_LEVEL", stringify(Log::get_instance()->log_level()))
-            .setenv("PALUDIS_EBUILD_DIR", getenv_with_default(env_vars::ebuild_dir, LIBEXECDIR "/paludis"))
-            .prefix_stderr(repo_file.basename() + "> ")
-            .capture_stdout(s);
-        int exit_status(process.run().wait());
+        int exit_status(run_bashable_script(repo_file, repo_file.basename() + "> ", nullptr, s));
         kv = std::make_shared<KeyValueConfigFile>(s, KeyValueConfigFileOptions() + kvcfo_allow_env,
                     std::bind(&to_kv_func, predefined_conf_vars_func, std::placeholders::_1, std::placeholders::_2),
                     &KeyValueConfigFile::no_transformation);
@@ -157,6 +157,28 @@ TEST(PaludisEnvironment, UseMinusPartialStar)
     EXPECT_TRUE(get_use("third_exp_two", three));
 }
 
+TEST(PaludisEnvironment, UseWildcardOrder)
+{
+    setenv("PALUDIS_HOME", stringify(FSPath::cwd() / "paludis_environment_TEST_dir" / "home6").c_str(), 1);
+    unsetenv("PALUDIS_SKIP_CONFIG");
+
+    std::shared_ptr<Environment> env(std::make_shared<PaludisEnvironment>(""));
+
+    const std::shared_ptr<const PackageID> one(*(*env)[selection::RequireExactlyOne(
+                generator::Matches(PackageDepSpec(parse_user_package_dep_spec("=cat-one/pkg-one-1",
+                            env.get(), { })), nullptr, { }))]->begin());
+    const std::shared_ptr<const PackageID> three(*(*env)[selection::RequireExactlyOne(
+                generator::Matches(PackageDepSpec(parse_user_package_dep_spec("=cat-one/pkg-two-3",
+                            env.get(), { })), nullptr, { }))]->begin());
+
+    EXPECT_TRUE(! get_use("foofoo", one));
+    EXPECT_TRUE(get_use("foofoo", three));
+    EXPECT_TRUE(! get_use("moo", one));
+    EXPECT_TRUE(! get_use("moo", three));
+    EXPECT_TRUE(! get_use("quoted-name", one));
+    EXPECT_TRUE(! get_use("quoted-name", three));
+}
+
 TEST(PaludisEnvironment, Repositories)
 {
     setenv("PALUDIS_HOME", stringify(FSPath::cwd() / "paludis_environment_TEST_dir" / "home4").c_str(), 1);
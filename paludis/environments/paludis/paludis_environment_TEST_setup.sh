@@ -228,3 +228,25 @@ profiles = `pwd`/sixthrepo/profile
 cache = /var/empty
 END
 
+
+mkdir -p home6/.paludis/repositories
+cat <<END > home6/.paludis/use.conf
+*/* foofoo
+cat-one/* -foofoo -moo
+*/pkg-two foofoo
+*/pkg-one quoted-name
+cat-one/* -quoted-name
+END
+cat <<END > home6/.paludis/keywords.conf
+*/* keyword
+END
+cat <<END > home6/.paludis/licenses.conf
+*/* *
+END
+cat <<END > home6/.paludis/repositories/foo.conf
+format = e
+names_cache = /var/empty
+location = `pwd`/repo
+profiles = `pwd`/repo/profile
+cache = /var/empty
+END
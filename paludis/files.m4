@@ -19,7 +19,7 @@ add(`broken_linkage_finder',                       `hh', `cc')
 add(`buffer_output_manager',                       `hh', `cc', `fwd')
 add(`call_pretty_printer',                         `hh', `cc', `fwd')
 add(`changed_choices',                             `hh', `cc', `fwd')
-add(`choice',                                      `hh', `cc', `se', `fwd')
+add(`choice',                                      `hh', `cc', `se', `fwd', `gtest')
 add(`comma_separated_dep_parser',                  `hh', `cc', `gtest')
 add(`comma_separated_dep_pretty_printer',          `hh', `cc', `fwd')
 add(`command_output_manager',                      `hh', `cc', `fwd')
@@ -63,7 +63,7 @@ add(`literal_metadata_key',                        `hh', `cc')
 add(`maintainer',                                  `hh', `cc', `fwd')
 add(`mask',                                        `hh', `cc', `fwd', `se')
 add(`mask_utils',                                  `hh', `cc', `fwd')
-add(`match_package',                               `hh', `cc', `se', `fwd')
+add(`match_package',                               `hh', `cc', `se', `fwd', `gtest')
 add(`merger',                                      `hh', `cc', `se', `fwd')
 add(`merger_entry_type',                           `hh', `cc', `se')
 add(`metadata_key',                                `hh', `cc', `se', `fwd')
@@ -77,6 +77,7 @@ add(`output_manager',                              `hh', `fwd', `cc', `se')
 add(`output_manager_factory',                      `hh', `fwd', `cc')
 add(`output_manager_from_environment',             `hh', `fwd', `cc')
 add(`package_dep_spec_collection',                 `hh', `cc', `fwd')
+add(`package_dep_spec_index',                      `hh', `cc', `fwd', `gtest')
 add(`package_dep_spec_properties',                 `hh', `cc', `fwd')
 add(`package_id',                                  `hh', `cc', `fwd', `se')
 add(`paludis',                                     `hh')
@@ -465,10 +465,12 @@ namespace
                 const std::shared_ptr<const PackageIDSet> & ids) const override
         {
             std::shared_ptr<PackageIDSet> result(std::make_shared<PackageIDSet>());
+            auto matches(match_package_batch(*env, spec, *ids, from_id, options));
+            auto m(matches.begin());
 
             for (const auto & id : *ids)
             {
-                if (match_package(*env, spec, id, from_id, options))
+                if (*m++)
                     result->insert(id);
             }
 
@@ -437,14 +437,17 @@ namespace
                 const RepositoryContentMayExcludes & x) const override
         {
             std::shared_ptr<PackageIDSet> result(std::make_shared<PackageIDSet>());
+            const CompiledPackageDepSpecMatcher matcher(env, spec);
 
             for (const auto & repository_name : *repos)
             {
                 for (const auto & qpn : *qpns)
                 {
                     std::shared_ptr<const PackageIDSequence> ids(env->fetch_repository(repository_name)->package_ids(qpn, x));
+                    auto matches(matcher.match_batch(*ids, from_id, options));
+                    auto m(matches.begin());
                     for (const auto & id : *ids)
-                        if (match_package(*env, spec, id, from_id, options))
+                        if (*m++)
                             result->insert(id);
                 }
             }
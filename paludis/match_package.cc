@@ -33,13 +33,20 @@
 
 #include <paludis/util/set.hh>
 #include <paludis/util/options.hh>
+#include <paludis/util/instrumentation.hh>
 #include <paludis/util/wrapped_forward_iterator.hh>
 #include <paludis/util/sequence.hh>
 #include <paludis/util/indirect_iterator-impl.hh>
 #include <paludis/util/stringify.hh>
+#include <paludis/util/pimp-impl.hh>
 
 #include <functional>
 #include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <vector>
 #include <istream>
 #include <ostream>
 
@@ -92,25 +99,149 @@ namespace
     };
 }
 
+namespace
+{
+    /* does the matching for both match_package and a
+     * CompiledPackageDepSpecMatcher, which owns the spec */
+    struct SpecMatcher
+    {
+        const Environment * const env;
+        const PackageDepSpec & spec;
+        const bool no_self_match;
+
+        /* anything which doesn't depend upon the ID is only worked out the
+         * first time we need it, so that matching once costs no more than
+         * it must */
+        mutable std::once_flag from_repository_once;
+        mutable std::string from_repository;
+
+        mutable std::once_flag repositories_installed_at_path_once;
+        mutable std::set<RepositoryName> repositories_installed_at_path;
+
+        mutable std::once_flag installable_to_repository_once;
+        mutable std::shared_ptr<const Repository> installable_to_repository;
+
+        mutable std::once_flag installable_to_path_repositories_once;
+        mutable std::vector<std::shared_ptr<const Repository> > installable_to_path_repositories;
+
+        SpecMatcher(const Environment * const e, const PackageDepSpec & s) :
+            env(e),
+            spec(s),
+            no_self_match(s.maybe_annotations() && s.maybe_annotations()->end() != s.maybe_annotations()->find(dsar_no_self_match))
+        {
+        }
+
+        bool name_matches(const QualifiedPackageName &) const;
+        bool repository_matches(const RepositoryName &) const;
+
+        bool rest_matches(
+                const ChangedChoices * const maybe_changes_to_owner,
+                const std::shared_ptr<const PackageID> & id,
+                const std::shared_ptr<const PackageID> & from_id,
+                const ChangedChoices * const maybe_changes_to_target,
+                const MatchPackageOptions & options) const;
+
+        bool matches(
+                const ChangedChoices * const maybe_changes_to_owner,
+                const std::shared_ptr<const PackageID> & id,
+                const std::shared_ptr<const PackageID> & from_id,
+                const ChangedChoices * const maybe_changes_to_target,
+                const MatchPackageOptions & options) const
+        {
+            return name_matches(id->name()) && repository_matches(id->repository_name())
+                && rest_matches(maybe_changes_to_owner, id, from_id, maybe_changes_to_target, options);
+        }
+    };
+}
+
+namespace paludis
+{
+    template <>
+    struct Imp<CompiledPackageDepSpecMatcher>
+    {
+        const PackageDepSpec spec;
+        const SpecMatcher matcher;
+
+        Imp(const Environment * const e, const PackageDepSpec & s) :
+            spec(s),
+            matcher(e, spec)
+        {
+        }
+    };
+}
+
+CompiledPackageDepSpecMatcher::CompiledPackageDepSpecMatcher(const Environment * const env, const PackageDepSpec & spec) :
+    _imp(env, spec)
+{
+}
+
+CompiledPackageDepSpecMatcher::~CompiledPackageDepSpecMatcher() = default;
+
+const PackageDepSpec
+CompiledPackageDepSpecMatcher::spec() const
+{
+    return _imp->spec;
+}
+
 bool
-paludis::match_package_with_maybe_changes(
-        const Environment & env,
-        const PackageDepSpec & spec,
-        const ChangedChoices * const maybe_changes_to_owner,
+CompiledPackageDepSpecMatcher::match(
         const std::shared_ptr<const PackageID> & id,
         const std::shared_ptr<const PackageID> & from_id,
-        const ChangedChoices * const maybe_changes_to_target,
-        const MatchPackageOptions & options)
+        const MatchPackageOptions & options) const
 {
-    if (spec.package_ptr() && *spec.package_ptr() != id->name())
+    return match_with_maybe_changes(nullptr, id, from_id, nullptr, options);
+}
+
+bool
+SpecMatcher::name_matches(const QualifiedPackageName & name) const
+{
+    if (spec.package_ptr() && *spec.package_ptr() != name)
         return false;
 
-    if (spec.package_name_part_ptr() && *spec.package_name_part_ptr() != id->name().package())
+    if (spec.package_name_part_ptr() && *spec.package_name_part_ptr() != name.package())
         return false;
 
-    if (spec.category_name_part_ptr() && *spec.category_name_part_ptr() != id->name().category())
+    if (spec.category_name_part_ptr() && *spec.category_name_part_ptr() != name.category())
         return false;
 
+    return true;
+}
+
+bool
+SpecMatcher::repository_matches(const RepositoryName & repository) const
+{
+    if (spec.in_repository_ptr())
+        if (*spec.in_repository_ptr() != repository)
+            return false;
+
+    if (spec.installed_at_path_ptr())
+    {
+        std::call_once(repositories_installed_at_path_once, [&] () {
+                for (const auto & r : env->repositories())
+                    if (r->installed_root_key() && r->installed_root_key()->parse_value() == *spec.installed_at_path_ptr())
+                        repositories_installed_at_path.insert(r->name());
+                });
+
+        if (repositories_installed_at_path.end() == repositories_installed_at_path.find(repository))
+        {
+            /* complain about an ID from a repository we don't know about */
+            if (! env->has_repository_named(repository))
+                throw NoSuchRepositoryError(repository);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+SpecMatcher::rest_matches(
+        const ChangedChoices * const maybe_changes_to_owner,
+        const std::shared_ptr<const PackageID> & id,
+        const std::shared_ptr<const PackageID> & from_id,
+        const ChangedChoices * const maybe_changes_to_target,
+        const MatchPackageOptions & options) const
+{
     if (spec.version_requirements_ptr())
         switch (spec.version_requirements_mode())
         {
@@ -123,8 +254,8 @@ paludis::match_package_with_maybe_changes(
             case vr_or:
                 {
                     bool matched(false);
-                    for (const auto & r : *spec.version_requirements_ptr())
-                        if (r.version_operator().as_version_spec_comparator()(id->version(), r.version_spec()))
+                    for (const auto & requirement : *spec.version_requirements_ptr())
+                        if (requirement.version_operator().as_version_spec_comparator()(id->version(), requirement.version_spec()))
                         {
                             matched = true;
                             break;
@@ -139,26 +270,25 @@ paludis::match_package_with_maybe_changes(
                 ;
         }
 
-    if (spec.in_repository_ptr())
-        if (*spec.in_repository_ptr() != id->repository_name())
+    if (no_self_match && from_id && *id == *from_id)
+        return false;
+
+    if (spec.slot_requirement_ptr())
+    {
+        SlotRequirementChecker v(id);
+        spec.slot_requirement_ptr()->accept(v);
+        if (! v.result)
             return false;
+    }
 
     if (spec.from_repository_ptr())
     {
         if (! id->from_repositories_key())
             return false;
 
+        std::call_once(from_repository_once, [&] () { from_repository = stringify(*spec.from_repository_ptr()); });
         auto v(id->from_repositories_key()->parse_value());
-        if (v->end() == v->find(stringify(*spec.from_repository_ptr())))
-            return false;
-    }
-
-    if (spec.installed_at_path_ptr())
-    {
-        auto repo(env.fetch_repository(id->repository_name()));
-        if (! repo->installed_root_key())
-            return false;
-        if (repo->installed_root_key()->parse_value() != *spec.installed_at_path_ptr())
+        if (v->end() == v->find(from_repository))
             return false;
     }
 
@@ -170,11 +300,12 @@ paludis::match_package_with_maybe_changes(
             if (id->masked())
                 return false;
 
-        const std::shared_ptr<const Repository> dest(env.fetch_repository(
-                    spec.installable_to_repository_ptr()->repository()));
-        if (! dest->destination_interface())
+        std::call_once(installable_to_repository_once, [&] () {
+                installable_to_repository = env->fetch_repository(spec.installable_to_repository_ptr()->repository());
+                });
+        if (! installable_to_repository->destination_interface())
             return false;
-        if (! dest->destination_interface()->is_suitable_destination_for(id))
+        if (! installable_to_repository->destination_interface()->is_suitable_destination_for(id))
             return false;
     }
 
@@ -186,50 +317,150 @@ paludis::match_package_with_maybe_changes(
             if (id->masked())
                 return false;
 
+        std::call_once(installable_to_path_repositories_once, [&] () {
+                for (const auto & repository : env->repositories())
+                    if (repository->destination_interface() && repository->installed_root_key()
+                            && repository->installed_root_key()->parse_value() == spec.installable_to_path_ptr()->path())
+                        installable_to_path_repositories.push_back(repository);
+                });
+
         bool ok(false);
-        for (const auto & repository : env.repositories())
-        {
-            if (! repository->destination_interface())
-                continue;
-            if (! repository->installed_root_key())
-                continue;
-            if (repository->installed_root_key()->parse_value() != spec.installable_to_path_ptr()->path())
-                continue;
-            if (! repository->destination_interface()->is_suitable_destination_for(id))
-                continue;
-
-            ok = true;
-            break;
-        }
+        for (const auto & repository : installable_to_path_repositories)
+            if (repository->destination_interface()->is_suitable_destination_for(id))
+            {
+                ok = true;
+                break;
+            }
 
         if (! ok)
             return false;
     }
 
-    if (spec.slot_requirement_ptr())
-    {
-        SlotRequirementChecker v(id);
-        spec.slot_requirement_ptr()->accept(v);
-        if (! v.result)
-            return false;
-    }
-
     if (! options[mpo_ignore_additional_requirements])
     {
         if (spec.additional_requirements_ptr())
         {
             for (const auto & u : *spec.additional_requirements_ptr())
-                if (! u->requirement_met(&env, maybe_changes_to_owner, id, from_id, maybe_changes_to_target).first)
+                if (! u->requirement_met(env, maybe_changes_to_owner, id, from_id, maybe_changes_to_target).first)
                     return false;
         }
     }
 
-    if (from_id && *id == *from_id && spec.maybe_annotations() && spec.maybe_annotations()->end() != spec.maybe_annotations()->find(dsar_no_self_match))
-        return false;
-
     return true;
 }
 
+bool
+CompiledPackageDepSpecMatcher::match_with_maybe_changes(
+        const ChangedChoices * const maybe_changes_to_owner,
+        const std::shared_ptr<const PackageID> & id,
+        const std::shared_ptr<const PackageID> & from_id,
+        const ChangedChoices * const maybe_changes_to_target,
+        const MatchPackageOptions & options) const
+{
+    return _imp->matcher.matches(maybe_changes_to_owner, id, from_id, maybe_changes_to_target, options);
+}
+
+namespace
+{
+    template <typename IDs_>
+    std::vector<bool> match_batch_of(
+            const SpecMatcher & imp,
+            const IDs_ & ids,
+            const std::shared_ptr<const PackageID> & from_id,
+            const MatchPackageOptions & options)
+    {
+        std::vector<bool> result;
+        result.reserve(std::distance(ids.begin(), ids.end()));
+
+        /* IDs usually come in runs sharing a name and repository, so only
+         * recheck those when they change */
+        std::optional<QualifiedPackageName> last_name;
+        std::optional<RepositoryName> last_repository;
+        bool name_ok(false), repository_ok(false);
+
+        for (const auto & id : ids)
+        {
+            const QualifiedPackageName name(id->name());
+            if ((! last_name) || *last_name != name)
+            {
+                name_ok = imp.name_matches(name);
+                last_name = name;
+            }
+
+            const RepositoryName repository(id->repository_name());
+            if ((! last_repository) || *last_repository != repository)
+            {
+                repository_ok = imp.repository_matches(repository);
+                last_repository = repository;
+            }
+
+            result.push_back(name_ok && repository_ok && imp.rest_matches(nullptr, id, from_id, nullptr, options));
+        }
+
+        return result;
+    }
+}
+
+std::vector<bool>
+CompiledPackageDepSpecMatcher::match_batch(
+        const PackageIDSequence & ids,
+        const std::shared_ptr<const PackageID> & from_id,
+        const MatchPackageOptions & options) const
+{
+    return match_batch_of(_imp->matcher, ids, from_id, options);
+}
+
+std::vector<bool>
+CompiledPackageDepSpecMatcher::match_batch(
+        const PackageIDSet & ids,
+        const std::shared_ptr<const PackageID> & from_id,
+        const MatchPackageOptions & options) const
+{
+    return match_batch_of(_imp->matcher, ids, from_id, options);
+}
+
+bool
+paludis::match_package_with_maybe_changes(
+        const Environment & env,
+        const PackageDepSpec & spec,
+        const ChangedChoices * const maybe_changes_to_owner,
+        const std::shared_ptr<const PackageID> & id,
+        const std::shared_ptr<const PackageID> & from_id,
+        const ChangedChoices * const maybe_changes_to_target,
+        const MatchPackageOptions & options)
+{
+    /* far too many calls to time individually */
+    static InstrumentationPoint point("match_package");
+    point.count();
+
+    /* matching just once, so don't pay for copying the spec into a
+     * CompiledPackageDepSpecMatcher */
+    return SpecMatcher(&env, spec).matches(maybe_changes_to_owner, id, from_id,
+            maybe_changes_to_target, options);
+}
+
+std::vector<bool>
+paludis::match_package_batch(
+        const Environment & env,
+        const PackageDepSpec & spec,
+        const PackageIDSequence & ids,
+        const std::shared_ptr<const PackageID> & from_id,
+        const MatchPackageOptions & options)
+{
+    return CompiledPackageDepSpecMatcher(&env, spec).match_batch(ids, from_id, options);
+}
+
+std::vector<bool>
+paludis::match_package_batch(
+        const Environment & env,
+        const PackageDepSpec & spec,
+        const PackageIDSet & ids,
+        const std::shared_ptr<const PackageID> & from_id,
+        const MatchPackageOptions & options)
+{
+    return CompiledPackageDepSpecMatcher(&env, spec).match_batch(ids, from_id, options);
+}
+
 bool
 paludis::match_package(
         const Environment & env,
@@ -257,3 +488,7 @@ paludis::match_package_in_set(
             std::bind(&match_package, std::cref(env), _1, std::cref(id), nullptr, std::cref(options)));
 }
 
+namespace paludis
+{
+    template class Pimp<CompiledPackageDepSpecMatcher>;
+}
@@ -21,7 +21,8 @@
 #define PALUDIS_GUARD_PALUDIS_MATCH_PACKAGE_HH 1
 
 /** \file
- * Declarations for match_package and match_package_in_set.
+ * Declarations for match_package, match_package_batch, match_package_in_set
+ * and CompiledPackageDepSpecMatcher.
  *
  * \ingroup g_query
  *
@@ -32,11 +33,13 @@
 
 #include <paludis/match_package-fwd.hh>
 #include <paludis/util/attributes.hh>
+#include <paludis/util/pimp.hh>
 #include <paludis/dep_spec-fwd.hh>
 #include <paludis/spec_tree-fwd.hh>
 #include <paludis/environment-fwd.hh>
 #include <paludis/package_id-fwd.hh>
 #include <paludis/changed_choices-fwd.hh>
+#include <vector>
 
 namespace paludis
 {
@@ -82,6 +85,38 @@ namespace paludis
             const MatchPackageOptions & options)
         PALUDIS_ATTRIBUTE((warn_unused_result)) PALUDIS_VISIBLE;
 
+    /**
+     * Return which of the specified PackageID instances match the specified
+     * PackageDepSpec, in iteration order.
+     *
+     * Checks which only depend upon the name or repository are made once for
+     * each run of IDs sharing that name or repository, as is the case for
+     * the results of Repository::package_ids.
+     *
+     * \ingroup g_query
+     */
+    std::vector<bool> match_package_batch(
+            const Environment & env,
+            const PackageDepSpec & spec,
+            const PackageIDSequence & ids,
+            const std::shared_ptr<const PackageID> & spec_id,
+            const MatchPackageOptions & options)
+        PALUDIS_ATTRIBUTE((warn_unused_result)) PALUDIS_VISIBLE;
+
+    /**
+     * Return which of the specified PackageID instances match the specified
+     * PackageDepSpec, in iteration order.
+     *
+     * \ingroup g_query
+     */
+    std::vector<bool> match_package_batch(
+            const Environment & env,
+            const PackageDepSpec & spec,
+            const PackageIDSet & ids,
+            const std::shared_ptr<const PackageID> & spec_id,
+            const MatchPackageOptions & options)
+        PALUDIS_ATTRIBUTE((warn_unused_result)) PALUDIS_VISIBLE;
+
     /**
      * Return whether the specified PackageID matches any of the items in the
      * specified set.
@@ -96,6 +131,81 @@ namespace paludis
             const std::shared_ptr<const PackageID> & id,
             const MatchPackageOptions & options)
         PALUDIS_ATTRIBUTE((warn_unused_result)) PALUDIS_VISIBLE;
+
+    /**
+     * A PackageDepSpec prepared for matching against many PackageID
+     * instances.
+     *
+     * Anything which does not depend upon the PackageID being matched, such
+     * as looking up repositories, is done once, the first time it is needed,
+     * and the checks are made in order of increasing cost. Repositories added
+     * to the Environment after that are not considered.
+     *
+     * \see match_package
+     * \ingroup g_query
+     */
+    class PALUDIS_VISIBLE CompiledPackageDepSpecMatcher
+    {
+        private:
+            Pimp<CompiledPackageDepSpecMatcher> _imp;
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            CompiledPackageDepSpecMatcher(const Environment * const, const PackageDepSpec &);
+            ~CompiledPackageDepSpecMatcher();
+
+            CompiledPackageDepSpecMatcher(const CompiledPackageDepSpecMatcher &) = delete;
+            CompiledPackageDepSpecMatcher & operator= (const CompiledPackageDepSpecMatcher &) = delete;
+
+            ///\}
+
+            /**
+             * The spec we match.
+             */
+            const PackageDepSpec spec() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * As for match_package.
+             */
+            bool match(
+                    const std::shared_ptr<const PackageID> & id,
+                    const std::shared_ptr<const PackageID> & spec_id,
+                    const MatchPackageOptions & options) const
+                PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * As for match_package_with_maybe_changes.
+             */
+            bool match_with_maybe_changes(
+                    const ChangedChoices * const maybe_changes_to_owner,
+                    const std::shared_ptr<const PackageID> & id,
+                    const std::shared_ptr<const PackageID> & spec_id,
+                    const ChangedChoices * const maybe_changes_to_target,
+                    const MatchPackageOptions & options) const
+                PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * As for match_package_batch.
+             */
+            std::vector<bool> match_batch(
+                    const PackageIDSequence & ids,
+                    const std::shared_ptr<const PackageID> & spec_id,
+                    const MatchPackageOptions & options) const
+                PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * As for match_package_batch.
+             */
+            std::vector<bool> match_batch(
+                    const PackageIDSet & ids,
+                    const std::shared_ptr<const PackageID> & spec_id,
+                    const MatchPackageOptions & options) const
+                PALUDIS_ATTRIBUTE((warn_unused_result));
+    };
+
+    extern template class Pimp<CompiledPackageDepSpecMatcher>;
 }
 
 #endif
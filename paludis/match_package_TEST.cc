@@ -0,0 +1,151 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/match_package.hh>
+#include <paludis/generator.hh>
+#include <paludis/filtered_generator.hh>
+#include <paludis/selection.hh>
+#include <paludis/user_dep_spec.hh>
+#include <paludis/dep_spec.hh>
+#include <paludis/environment.hh>
+
+#include <paludis/environments/test/test_environment.hh>
+
+#include <paludis/repositories/fake/fake_package_id.hh>
+#include <paludis/repositories/fake/fake_repository.hh>
+#include <paludis/repositories/fake/fake_installed_repository.hh>
+
+#include <paludis/util/sequence.hh>
+#include <paludis/util/wrapped_forward_iterator.hh>
+#include <paludis/util/make_named_values.hh>
+#include <paludis/util/stringify.hh>
+
+#include <iterator>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+TEST(CompiledPackageDepSpecMatcher, Works)
+{
+    TestEnvironment env;
+
+    auto repo1(std::make_shared<FakeRepository>(make_named_values<FakeRepositoryParams>(
+                    n::environment() = &env,
+                    n::name() = RepositoryName("repo1")
+                    )));
+    auto repo2(std::make_shared<FakeRepository>(make_named_values<FakeRepositoryParams>(
+                    n::environment() = &env,
+                    n::name() = RepositoryName("repo2")
+                    )));
+    auto inst_repo1(std::make_shared<FakeInstalledRepository>(
+                make_named_values<FakeInstalledRepositoryParams>(
+                    n::environment() = &env,
+                    n::name() = RepositoryName("inst_repo1"),
+                    n::suitable_destination() = true,
+                    n::supports_uninstall() = true
+                    )));
+
+    env.add_repository(1, repo1);
+    env.add_repository(10, repo2);
+    env.add_repository(0, inst_repo1);
+
+    repo1->add_version("cat", "a", "1");
+    repo1->add_version("cat", "a", "2")->set_slot(SlotName("2"));
+    repo1->add_version("cat", "b", "1");
+    repo2->add_version("cat", "a", "3")->keywords_key()->set_from_string("");
+    repo2->add_version("dog", "b", "1");
+    inst_repo1->add_version("cat", "a", "1");
+
+    const std::pair<std::string, std::string> specs_and_expected[] = {
+        { "cat/a", "cat/a-1:0::inst_repo1 cat/a-1:0::repo1 cat/a-2:2::repo1 cat/a-3:0::repo2 " },
+        { "*/b", "cat/b-1:0::repo1 dog/b-1:0::repo2 " },
+        { "cat/*", "cat/a-1:0::inst_repo1 cat/a-1:0::repo1 cat/a-2:2::repo1 cat/a-3:0::repo2 cat/b-1:0::repo1 " },
+        { ">=cat/a-2", "cat/a-2:2::repo1 cat/a-3:0::repo2 " },
+        { "cat/a[=1|=3]", "cat/a-1:0::inst_repo1 cat/a-1:0::repo1 cat/a-3:0::repo2 " },
+        { "cat/a[>1&<3]", "cat/a-2:2::repo1 " },
+        { "cat/a:0", "cat/a-1:0::inst_repo1 cat/a-1:0::repo1 cat/a-3:0::repo2 " },
+        { "cat/a:1", "" },
+        { "cat/a::repo1", "cat/a-1:0::repo1 cat/a-2:2::repo1 " },
+        { "cat/a::/", "cat/a-1:0::inst_repo1 " },
+        { "cat/a::/?", "cat/a-1:0::repo1 cat/a-2:2::repo1 " },
+        { "cat/a::/??", "cat/a-1:0::repo1 cat/a-2:2::repo1 cat/a-3:0::repo2 " },
+        { "cat/a::inst_repo1?", "cat/a-1:0::repo1 cat/a-2:2::repo1 " },
+        { "cat/a::repo1?", "" }
+    };
+
+    std::shared_ptr<const PackageIDSequence> ids(env[selection::AllVersionsSorted(generator::All())]);
+
+    for (const auto & spec_and_expected : specs_and_expected)
+    {
+        PackageDepSpec spec(parse_user_package_dep_spec(spec_and_expected.first, &env, { updso_allow_wildcards }));
+        const CompiledPackageDepSpecMatcher matcher(&env, spec);
+
+        std::string got;
+        for (const auto & id : *ids)
+        {
+            bool m(matcher.match(id, nullptr, { }));
+            EXPECT_EQ(m, match_package(env, spec, id, nullptr, { })) << spec_and_expected.first << " " << *id;
+            if (m)
+                got.append(stringify(*id) + " ");
+        }
+
+        EXPECT_EQ(spec_and_expected.second, got) << spec_and_expected.first;
+
+        std::string got_batch;
+        auto matches(match_package_batch(env, spec, *ids, nullptr, { }));
+        ASSERT_EQ(std::size_t(std::distance(ids->begin(), ids->end())), matches.size());
+        auto m(matches.begin());
+        for (const auto & id : *ids)
+            if (*m++)
+                got_batch.append(stringify(*id) + " ");
+
+        EXPECT_EQ(spec_and_expected.second, got_batch) << spec_and_expected.first;
+    }
+}
+
+
+TEST(CompiledPackageDepSpecMatcher, UnknownRepository)
+{
+    TestEnvironment env;
+
+    auto inst_repo1(std::make_shared<FakeInstalledRepository>(
+                make_named_values<FakeInstalledRepositoryParams>(
+                    n::environment() = &env,
+                    n::name() = RepositoryName("inst_repo1"),
+                    n::suitable_destination() = true,
+                    n::supports_uninstall() = true
+                    )));
+    auto unknown(std::make_shared<FakeRepository>(make_named_values<FakeRepositoryParams>(
+                    n::environment() = &env,
+                    n::name() = RepositoryName("unknown")
+                    )));
+
+    env.add_repository(0, inst_repo1);
+    auto id(unknown->add_version("cat", "a", "1"));
+
+    PackageDepSpec installed_at_path(parse_user_package_dep_spec("cat/a::/", &env, { }));
+    EXPECT_THROW(bool PALUDIS_ATTRIBUTE((unused)) m = match_package(env, installed_at_path, id, nullptr, { }), NoSuchRepositoryError);
+    EXPECT_THROW(bool PALUDIS_ATTRIBUTE((unused)) m = CompiledPackageDepSpecMatcher(&env, installed_at_path).match(id, nullptr, { }), NoSuchRepositoryError);
+
+    PackageDepSpec installable_to(parse_user_package_dep_spec("cat/a::nonexistent?", &env, { }));
+    EXPECT_THROW(bool PALUDIS_ATTRIBUTE((unused)) m = match_package(env, installable_to, id, nullptr, { }), NoSuchRepositoryError);
+    EXPECT_THROW(bool PALUDIS_ATTRIBUTE((unused)) m = CompiledPackageDepSpecMatcher(&env, installable_to).match(id, nullptr, { }), NoSuchRepositoryError);
+}
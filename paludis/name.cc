@@ -28,8 +28,12 @@
 #include <paludis/util/options.hh>
 #include <paludis/util/hashes.hh>
 #include <paludis/util/wrapped_value-impl.hh>
+#include <paludis/util/character_class.hh>
 #include <ostream>
 #include <utility>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
 
 using namespace paludis;
 
@@ -97,7 +101,7 @@ SlotNameError::SlotNameError(const std::string & name) noexcept :
 bool
 WrappedValueTraits<SlotNameTag>::validate(const std::string & s)
 {
-    static const std::string allowed_chars(
+    static const CharacterClass allowed_chars(
             "abcdefghijklmnopqrstuvwxyz"
             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
             "0123456789-+_.");
@@ -108,7 +112,7 @@ WrappedValueTraits<SlotNameTag>::validate(const std::string & s)
     if ('-' == s[0] || '.' == s[0])
         return false;
 
-    if (std::string::npos != s.find_first_not_of(allowed_chars))
+    if (std::string::npos != allowed_chars.find_first_not_in(s))
         return false;
 
     return true;
@@ -122,27 +126,24 @@ PackageNamePartError::PackageNamePartError(const std::string & name) noexcept :
 bool
 WrappedValueTraits<PackageNamePartTag>::validate(const std::string & s)
 {
-    static const std::string allowed_chars(
+    static const CharacterClass allowed_chars(
             "abcdefghijklmnopqrstuvwxyz"
             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
             "0123456789-+_");
 
-    static const std::string number_chars(
+    static const CharacterClass number_chars(
             "0123456789");
 
     if (s.empty() || '-' == s[0])
         return false;
 
-    for (std::string::size_type p(0) ; p < s.length() ; ++p)
-    {
-        if (std::string::npos == allowed_chars.find(s[p]))
-            return false;
+    if (std::string::npos != allowed_chars.find_first_not_in(s))
+        return false;
 
-        if ((p + 1 < s.length()) && (s[p] == '-') &&
-                (std::string::npos != number_chars.find(s[p + 1])))
-            if (std::string::npos == s.find_first_not_of(number_chars, p + 1))
+    for (std::string::size_type p(s.find('-')) ; std::string::npos != p ; p = s.find('-', p + 1))
+        if ((p + 1 < s.length()) && number_chars.contains(s[p + 1]))
+            if (std::string::npos == number_chars.find_first_not_in(s, p + 1))
                 return false;
-    }
 
     return true;
 }
@@ -152,7 +153,7 @@ WrappedValueTraits<CategoryNamePartTag>::validate(const std::string & s)
 {
     // Allow . because crossdev can create, for example,
     // cross-i686-unknown-freebsd6.0   --spb
-    static const std::string allowed_chars(
+    static const CharacterClass allowed_chars(
             "abcdefghijklmnopqrstuvwxyz"
             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
             "0123456789-+_.");
@@ -163,7 +164,7 @@ WrappedValueTraits<CategoryNamePartTag>::validate(const std::string & s)
     if ('-' == s[0] || '.' == s[0])
         return false;
 
-    if (std::string::npos != s.find_first_not_of(allowed_chars))
+    if (std::string::npos != allowed_chars.find_first_not_in(s))
         return false;
 
     return true;
@@ -177,7 +178,7 @@ CategoryNamePartError::CategoryNamePartError(const std::string & name) noexcept
 bool
 WrappedValueTraits<RepositoryNameTag>::validate(const std::string & s)
 {
-    static const std::string allowed_chars(
+    static const CharacterClass allowed_chars(
             "abcdefghijklmnopqrstuvwxyz"
             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
             "0123456789-_");
@@ -188,7 +189,7 @@ WrappedValueTraits<RepositoryNameTag>::validate(const std::string & s)
     if ('-' == s[0])
         return false;
 
-    if (std::string::npos != s.find_first_not_of(allowed_chars))
+    if (std::string::npos != allowed_chars.find_first_not_in(s))
         return false;
 
     return true;
@@ -207,7 +208,7 @@ KeywordNameError::KeywordNameError(const std::string & name) noexcept :
 bool
 WrappedValueTraits<KeywordNameTag>::validate(const std::string & s)
 {
-    static const std::string allowed_chars(
+    static const CharacterClass allowed_chars(
             "abcdefghijklmnopqrstuvwxyz"
             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
             "0123456789-_");
@@ -228,7 +229,7 @@ WrappedValueTraits<KeywordNameTag>::validate(const std::string & s)
 
             /* fall through */
         default:
-            if (std::string::npos != s.find_first_not_of(allowed_chars,
+            if (std::string::npos != allowed_chars.find_first_not_in(s,
                         ('~' == s[0] ? 1 : 0)))
                 return false;
     }
@@ -236,6 +237,51 @@ WrappedValueTraits<KeywordNameTag>::validate(const std::string & s)
     return true;
 }
 
+namespace
+{
+    template <typename Tag_>
+    struct InternTable
+    {
+        std::shared_mutex mutex;
+        std::unordered_map<std::string, std::size_t, Hash<std::string> > values;
+    };
+
+    template <typename Tag_>
+    const std::pair<const std::string, std::size_t> *
+    intern_name(const std::string & s)
+    {
+        /* deliberately never destroyed, since names can outlive any static
+         * table we could make, and the pointers must stay valid until exit */
+        static InternTable<Tag_> * const table(new InternTable<Tag_>);
+
+        {
+            std::shared_lock<std::shared_mutex> lock(table->mutex);
+            auto i(table->values.find(s));
+            if (i != table->values.end())
+                return &*i;
+        }
+
+        /* only new names need validating */
+        if (! WrappedValueTraits<Tag_>::validate(s))
+            throw typename WrappedValueTraits<Tag_>::ExceptionType(s);
+
+        std::unique_lock<std::shared_mutex> lock(table->mutex);
+        return &*table->values.insert(std::make_pair(s, Hash<std::string>()(s))).first;
+    }
+}
+
+const std::pair<const std::string, std::size_t> *
+WrappedValueInterning<PackageNamePartTag>::intern(const std::string & s)
+{
+    return intern_name<PackageNamePartTag>(s);
+}
+
+const std::pair<const std::string, std::size_t> *
+WrappedValueInterning<CategoryNamePartTag>::intern(const std::string & s)
+{
+    return intern_name<CategoryNamePartTag>(s);
+}
+
 namespace
 {
     CategoryNamePart
@@ -280,24 +326,22 @@ QualifiedPackageName::QualifiedPackageName(const CategoryNamePart & c, const Pac
 bool
 QualifiedPackageName::operator< (const QualifiedPackageName & other) const
 {
-    if (category() < other.category())
-        return true;
-    if (category() > other.category())
-        return false;
+    if (_cat != other._cat)
+        return _cat < other._cat;
 
-    return package() < other.package();
+    return _pkg < other._pkg;
 }
 
 bool
 QualifiedPackageName::operator== (const QualifiedPackageName & other) const
 {
-    return category() == other.category() && package() == other.package();
+    return _cat == other._cat && _pkg == other._pkg;
 }
 
 bool
 WrappedValueTraits<SetNameTag>::validate(const std::string & s)
 {
-    static const std::string allowed_chars(
+    static const CharacterClass allowed_chars(
             "abcdefghijklmnopqrstuvwxyz"
             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
             "0123456789-+_:");
@@ -314,7 +358,7 @@ WrappedValueTraits<SetNameTag>::validate(const std::string & s)
     if ('-' == s[0] || '.' == s[0])
         return false;
 
-    if (std::string::npos != s.find_first_not_of(allowed_chars))
+    if (std::string::npos != allowed_chars.find_first_not_in(s))
         return false;
 
     std::string::size_type p(s.find(':'));
@@ -347,17 +391,17 @@ PartNameError::PartNameError(const std::string & name) noexcept :
 bool
 WrappedValueTraits<PartNameTag>::validate(const std::string & name)
 {
-    static const std::string allowed_chars(
+    static const CharacterClass allowed_chars(
             "abcdefghijklmnopqrstuvwxyz"
             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
             "0123456789-+_");
 
-    return name.find_first_not_of(allowed_chars) == std::string::npos;
+    return allowed_chars.find_first_not_in(name) == std::string::npos;
 }
 
 std::size_t
 QualifiedPackageName::hash() const
 {
-    return Hash<std::string>()(stringify(*this));
+    return (_cat.hash() << 8) ^ _pkg.hash();
 }
 
@@ -29,6 +29,8 @@
 #include <paludis/util/wrapped_output_iterator.hh>
 
 #include <string>
+#include <utility>
+#include <cstddef>
 #include <iosfwd>
 
 /** \file
@@ -70,6 +72,15 @@ namespace paludis
         static bool validate(const std::string &) PALUDIS_ATTRIBUTE((warn_unused_result));
     };
 
+    template <>
+    struct PALUDIS_VISIBLE WrappedValueInterning<PackageNamePartTag>
+    {
+        static const bool enabled = true;
+
+        static const std::pair<const std::string, std::size_t> * intern(const std::string &)
+            PALUDIS_ATTRIBUTE((warn_unused_result));
+    };
+
     extern template class PALUDIS_VISIBLE WrappedValue<PackageNamePartTag>;
 
     /**
@@ -99,6 +110,15 @@ namespace paludis
         static bool validate(const std::string &) PALUDIS_ATTRIBUTE((warn_unused_result));
     };
 
+    template <>
+    struct PALUDIS_VISIBLE WrappedValueInterning<CategoryNamePartTag>
+    {
+        static const bool enabled = true;
+
+        static const std::pair<const std::string, std::size_t> * intern(const std::string &)
+            PALUDIS_ATTRIBUTE((warn_unused_result));
+    };
+
     extern template class PALUDIS_VISIBLE WrappedValue<CategoryNamePartTag>;
 
     /**
@@ -118,6 +138,12 @@ namespace paludis
             QualifiedPackageName(const CategoryNamePart &, const PackageNamePart &);
             explicit QualifiedPackageName(const std::string &);
 
+            /**
+             * Combines the hashes of our category and package parts, so it
+             * is not the hash of our string form. It is only for in-memory
+             * hashed containers, and is not to be stored or compared between
+             * runs.
+             */
             std::size_t hash() const PALUDIS_ATTRIBUTE((warn_unused_result));
 
             bool operator< (const QualifiedPackageName &) const PALUDIS_ATTRIBUTE((warn_unused_result));
@@ -20,6 +20,7 @@
 #include <paludis/name.hh>
 
 #include <paludis/util/exception.hh>
+#include <paludis/util/stringify.hh>
 
 #include <gtest/gtest.h>
 
@@ -59,6 +60,20 @@ TEST(QualifiedPackageName, Compare)
     EXPECT_TRUE( (foo2_bar1 >  foo1_bar2));
 }
 
+TEST(QualifiedPackageName, Interned)
+{
+    QualifiedPackageName a("foo/bar"), b(std::string("foo") + "/" + "bar"), c("foo/baz");
+    EXPECT_EQ(&a.category().value(), &b.category().value());
+    EXPECT_EQ(&a.package().value(), &b.package().value());
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.hash(), b.hash());
+    EXPECT_NE(a, c);
+    EXPECT_EQ("foo/bar", stringify(b));
+
+    EXPECT_THROW(PackageNamePart("-bad"), NameError);
+    EXPECT_THROW(PackageNamePart("-bad"), NameError);
+}
+
 TEST(CategoryNamePart, Create)
 {
     CategoryNamePart p("foo");
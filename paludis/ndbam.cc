@@ -32,6 +32,7 @@
 #include <paludis/util/fs_stat.hh>
 #include <paludis/util/fs_iterator.hh>
 #include <paludis/util/fs_error.hh>
+#include <paludis/util/mapped_file.hh>
 #include <paludis/ndbam.hh>
 #include <paludis/package_id.hh>
 #include <paludis/metadata_key.hh>
@@ -43,6 +44,7 @@
 #include <functional>
 #include <vector>
 #include <map>
+#include <string_view>
 
 using namespace paludis;
 
@@ -430,182 +432,309 @@ NDBAM::remove_entry(const QualifiedPackageName & q, const FSPath & d)
     }
 }
 
-void
-NDBAM::parse_contents(const PackageID & id,
-        const std::function<void (const std::shared_ptr<const ContentsEntry> &)> & on_file,
-        const std::function<void (const std::shared_ptr<const ContentsEntry> &)> & on_dir,
-        const std::function<void (const std::shared_ptr<const ContentsEntry> &)> & on_sym
-        ) const
+namespace
 {
-    Context c("When fetching contents for '" + stringify(id) + "':");
+    /* a key, and its value with any escapes still in place */
+    typedef std::pair<std::string_view, std::string_view> ContentsToken;
 
-    if (! id.fs_location_key())
-        throw InternalError(PALUDIS_HERE, "No id.fs_location_key");
-
-    FSPath ff(id.fs_location_key()->parse_value() / "contents");
-    if (! ff.stat().is_regular_file_or_symlink_to_regular_file())
+    bool split_contents_line(const std::string_view & line, const FSPath & ff, const bool warn_duplicates,
+            std::vector<ContentsToken> & tokens)
     {
-        Log::get_instance()->message("ndbam.contents.skipping", ll_warning, lc_context)
-            << "Contents file '" << ff << "' not a regular file, skipping";
-        return;
-    }
+        tokens.clear();
 
-    LineConfigFile f(ff, { });
-    for (const auto & line : f)
-    {
-        std::map<std::string, std::string> tokens;
-        std::string::size_type p(0);
-        bool error(false);
-        while ((! error) && (p < line.length()) && (std::string::npos != p))
+        std::string_view::size_type p(0);
+        while (p < line.length())
         {
-            std::string::size_type q(line.find('=', p));
-            if (std::string::npos == q)
+            std::string_view::size_type q(line.find('=', p));
+            if (std::string_view::npos == q)
             {
                 Log::get_instance()->message("ndbam.contents.invalid", ll_warning, lc_context)
                     << "Malformed line '" << line << "' in '" << ff << "'";
-                error = true;
-                continue;
+                return false;
             }
 
-            std::string key(line.substr(p, q - p));
-            std::string value;
+            std::string_view key(line.substr(p, q - p));
             p = q + 1;
-            while (p < line.length() && std::string::npos != p)
+            while (p < line.length() && ' ' != line[p])
             {
                 if ('\\' == line[p])
                 {
                     ++p;
-                    if (p >= line.length() || std::string::npos == p)
+                    if (p >= line.length())
                     {
                         Log::get_instance()->message("ndbam.contents.invalid", ll_warning, lc_context)
                             << "Malformed line '" << line << "' in '" << ff << "'";
-                        error = true;
-                        break;
+                        return false;
                     }
-                    if ('n' == line[p])
-                        value.append("\n");
-                    else
-                        value.append(1, line[p]);
-                    ++p;
-                }
-                else if (' ' == line[p])
-                {
-                    if (! tokens.insert(std::make_pair(key, value)).second)
-                        Log::get_instance()->message("ndbam.contents.duplicate", ll_warning, lc_context)
-                            << "Duplicate token '" << key << "' on line '" << line << "' in '" << ff << "'";
-                    key.clear();
-                    value.clear();
-                    ++p;
-                    break;
-                }
-                else
-                {
-                    value.append(1, line[p]);
-                    ++p;
                 }
+                ++p;
             }
 
-            if ((! error) && (! key.empty()))
+            std::string_view value(line.substr(q + 1, p - (q + 1)));
+            if (p < line.length())
+                ++p;
+            else if (key.empty())
+                continue;
+
+            if (tokens.end() == std::find_if(tokens.begin(), tokens.end(),
+                        [&] (const ContentsToken & t) { return t.first == key; }))
+                tokens.emplace_back(key, value);
+            else if (warn_duplicates)
+                Log::get_instance()->message("ndbam.contents.duplicate", ll_warning, lc_context)
+                    << "Duplicate token '" << key << "' on line '" << line << "' in '" << ff << "'";
+        }
+
+        return true;
+    }
+
+    const ContentsToken * find_contents_token(const std::vector<ContentsToken> & tokens, const std::string_view & key)
+    {
+        auto i(std::find_if(tokens.begin(), tokens.end(), [&] (const ContentsToken & t) { return t.first == key; }));
+        return tokens.end() == i ? nullptr : &*i;
+    }
+
+    std::string unescape_contents_value(const std::string_view & v)
+    {
+        std::string result;
+        result.reserve(v.length());
+        for (std::string_view::size_type p(0) ; p < v.length() ; ++p)
+        {
+            if ('\\' == v[p])
             {
-                if (! tokens.insert(std::make_pair(key, value)).second)
-                    Log::get_instance()->message("ndbam.contents.duplicate", ll_warning, lc_context)
-                        << "Duplicate token '" << key << "' on line '" << line << "' in '" << ff << "'";
+                ++p;
+                result.append(1, 'n' == v[p] ? '\n' : v[p]);
             }
+            else
+                result.append(1, v[p]);
         }
+        return result;
+    }
 
-        if (error)
-            continue;
+    /* warns about and returns false for a bad line. If the line is good and
+     * result is not null, makes its entry. */
+    bool decode_contents_line(const std::string_view & line, const FSPath & ff, const bool warn_duplicates,
+            std::vector<ContentsToken> & tokens, std::shared_ptr<const ContentsEntry> * const result)
+    {
+        if (! split_contents_line(line, ff, warn_duplicates, tokens))
+            return false;
 
-        if (! tokens.count("type"))
+        const ContentsToken * const type_token(find_contents_token(tokens, "type"));
+        if (! type_token)
         {
             Log::get_instance()->message("ndbam.contents.no_key.type", ll_warning, lc_context) <<
                 "No key 'type' found on line '" << line << "' in '" << ff << "'";
-            continue;
+            return false;
         }
-        std::string type(tokens.find("type")->second);
+        std::string type(unescape_contents_value(type_token->second));
 
-        if (! tokens.count("path"))
+        const ContentsToken * const path_token(find_contents_token(tokens, "path"));
+        if (! path_token)
         {
             Log::get_instance()->message("ndbam.contents.no_key.path", ll_warning, lc_context) <<
                 "No key 'path' found on line '" << line << "' in '" << ff << "'";
-            continue;
+            return false;
         }
-        std::string path(tokens.find("path")->second);
+
+        const ContentsToken * const part_token(find_contents_token(tokens, "part"));
+        const ContentsToken * const volatile_token(find_contents_token(tokens, "volatile"));
 
         if ("file" == type)
         {
-            if (! tokens.count("md5"))
+            const ContentsToken * const md5_token(find_contents_token(tokens, "md5"));
+            if (! md5_token)
             {
                 Log::get_instance()->message("ndbam.contents.no_key.md5", ll_warning, lc_context) <<
                     "No key 'md5' found on sym line '" << line << "' in '" << ff << "'";
-                continue;
+                return false;
             }
-            std::string md5(tokens.find("md5")->second);
-
-            std::string part;
-            if (tokens.count("part"))
-                part = tokens.find("part")->second;
 
             bool isvolatile = false;
-            if (tokens.count("volatile"))
-                isvolatile = destringify<bool>(tokens.find("volatile")->second);
+            if (volatile_token)
+                isvolatile = destringify<bool>(unescape_contents_value(volatile_token->second));
 
-            if (! tokens.count("mtime"))
+            const ContentsToken * const mtime_token(find_contents_token(tokens, "mtime"));
+            if (! mtime_token)
             {
                 Log::get_instance()->message("ndbam.contents.no_key.mtime", ll_warning, lc_context) <<
                     "No key 'mtime' found on sym line '" << line << "' in '" << ff << "'";
-                continue;
+                return false;
             }
-            time_t mtime(destringify<time_t>(tokens.find("mtime")->second));
+            time_t mtime(destringify<time_t>(unescape_contents_value(mtime_token->second)));
 
-            std::shared_ptr<ContentsFileEntry> entry(std::make_shared<ContentsFileEntry>(FSPath(path), part));
-            entry->add_metadata_key(std::make_shared<LiteralMetadataValueKey<std::string>>("md5", "md5", mkt_normal, md5));
-            entry->add_metadata_key(std::make_shared<LiteralMetadataTimeKey>("mtime", "mtime", mkt_normal, Timestamp(mtime, 0)));
-            if (isvolatile)
-                entry->add_metadata_key(std::make_shared<LiteralMetadataValueKey<bool> >("volatile", "volatile", mkt_normal, isvolatile));
-            on_file(entry);
+            if (result)
+            {
+                std::shared_ptr<ContentsFileEntry> entry(std::make_shared<ContentsFileEntry>(
+                            FSPath(unescape_contents_value(path_token->second)),
+                            part_token ? unescape_contents_value(part_token->second) : ""));
+                entry->add_metadata_key(std::make_shared<LiteralMetadataValueKey<std::string>>("md5", "md5", mkt_normal,
+                            unescape_contents_value(md5_token->second)));
+                entry->add_metadata_key(std::make_shared<LiteralMetadataTimeKey>("mtime", "mtime", mkt_normal, Timestamp(mtime, 0)));
+                if (isvolatile)
+                    entry->add_metadata_key(std::make_shared<LiteralMetadataValueKey<bool> >("volatile", "volatile", mkt_normal, isvolatile));
+                *result = entry;
+            }
         }
         else if ("dir" == type)
         {
-            std::shared_ptr<ContentsDirEntry> entry(std::make_shared<ContentsDirEntry>(FSPath(path)));
-            on_dir(entry);
+            if (result)
+                *result = std::make_shared<ContentsDirEntry>(FSPath(unescape_contents_value(path_token->second)));
         }
         else if ("sym" == type)
         {
-            if (! tokens.count("target"))
+            const ContentsToken * const target_token(find_contents_token(tokens, "target"));
+            if (! target_token)
             {
                 Log::get_instance()->message("ndbam.contents.no_key.target", ll_warning, lc_context) <<
                     "No key 'target' found on sym line '" << line << "' in '" << ff << "'";
-                continue;
+                return false;
             }
-            std::string target(tokens.find("target")->second);
 
-            if (! tokens.count("mtime"))
+            const ContentsToken * const mtime_token(find_contents_token(tokens, "mtime"));
+            if (! mtime_token)
             {
                 Log::get_instance()->message("ndbam.contents.no_key.mtime", ll_warning, lc_context) <<
                     "No key 'mtime' found on sym line '" << line << "' in '" << ff << "'";
-                continue;
+                return false;
             }
-            time_t mtime(destringify<time_t>(tokens.find("mtime")->second));
-
-            std::string part;
-            if (tokens.count("part"))
-                part = tokens.find("part")->second;
+            time_t mtime(destringify<time_t>(unescape_contents_value(mtime_token->second)));
 
             bool isvolatile = false;
-            if (tokens.count("volatile"))
-                isvolatile = destringify<bool>(tokens.find("volatile")->second);
+            if (volatile_token)
+                isvolatile = destringify<bool>(unescape_contents_value(volatile_token->second));
 
-            std::shared_ptr<ContentsSymEntry> entry(std::make_shared<ContentsSymEntry>(FSPath(path), target, part));
-            entry->add_metadata_key(std::make_shared<LiteralMetadataTimeKey>("mtime", "mtime", mkt_normal, Timestamp(mtime, 0)));
-            if (isvolatile)
-                entry->add_metadata_key(std::make_shared<LiteralMetadataValueKey<bool> >("volatile", "volatile", mkt_normal, isvolatile));
-            on_sym(entry);
+            if (result)
+            {
+                std::shared_ptr<ContentsSymEntry> entry(std::make_shared<ContentsSymEntry>(
+                            FSPath(unescape_contents_value(path_token->second)),
+                            unescape_contents_value(target_token->second),
+                            part_token ? unescape_contents_value(part_token->second) : ""));
+                entry->add_metadata_key(std::make_shared<LiteralMetadataTimeKey>("mtime", "mtime", mkt_normal, Timestamp(mtime, 0)));
+                if (isvolatile)
+                    entry->add_metadata_key(std::make_shared<LiteralMetadataValueKey<bool> >("volatile", "volatile", mkt_normal, isvolatile));
+                *result = entry;
+            }
         }
         else
+        {
             Log::get_instance()->message("ndbam.contents.unknown_type", ll_warning, lc_context) <<
                 "Unknown type '" << type << "' found on line '" << line << "' in '" << ff << "'";
+            return false;
+        }
+
+        return true;
+    }
+
+    struct ContentsEntryDispatcher
+    {
+        const std::shared_ptr<const ContentsEntry> & entry;
+        const std::function<void (const std::shared_ptr<const ContentsEntry> &)> & on_file;
+        const std::function<void (const std::shared_ptr<const ContentsEntry> &)> & on_dir;
+        const std::function<void (const std::shared_ptr<const ContentsEntry> &)> & on_sym;
+
+        void visit(const ContentsFileEntry &)
+        {
+            on_file(entry);
+        }
+
+        void visit(const ContentsDirEntry &)
+        {
+            on_dir(entry);
+        }
+
+        void visit(const ContentsSymEntry &)
+        {
+            on_sym(entry);
+        }
+
+        void visit(const ContentsOtherEntry &)
+        {
+        }
+    };
+
+    /* the same lines LineConfigFile would give us */
+    std::string_view contents_file_line(const std::string_view & l)
+    {
+        std::string_view::size_type e(l.find_last_not_of(" \t\r"));
+        std::string_view line(l.substr(0, std::string_view::npos == e ? 0 : e + 1));
+        line.remove_prefix(std::min(line.find_first_not_of(" \t"), line.length()));
+        return (line.empty() || '#' == line[0]) ? std::string_view() : line;
     }
+
+    bool check_mapped_contents_line(const std::string_view & l, const FSPath & ff, std::vector<ContentsToken> & tokens)
+    {
+        std::string_view line(contents_file_line(l));
+        return (! line.empty()) && decode_contents_line(line, ff, true, tokens, nullptr);
+    }
+
+    /* only called for lines check_mapped_contents_line accepted */
+    std::shared_ptr<const ContentsEntry> decode_mapped_contents_line(const std::string_view & l, const FSPath & ff,
+            const std::string & context_text)
+    {
+        Context c([&context_text] () { return context_text; });
+
+        std::vector<ContentsToken> tokens;
+        std::shared_ptr<const ContentsEntry> result;
+        decode_contents_line(contents_file_line(l), ff, false, tokens, &result);
+        return result;
+    }
+
+    FSPath contents_file_for(const PackageID & id)
+    {
+        if (! id.fs_location_key())
+            throw InternalError(PALUDIS_HERE, "No id.fs_location_key");
+
+        return id.fs_location_key()->parse_value() / "contents";
+    }
+}
+
+void
+NDBAM::parse_contents(const PackageID & id,
+        const std::function<void (const std::shared_ptr<const ContentsEntry> &)> & on_file,
+        const std::function<void (const std::shared_ptr<const ContentsEntry> &)> & on_dir,
+        const std::function<void (const std::shared_ptr<const ContentsEntry> &)> & on_sym
+        ) const
+{
+    Context c("When fetching contents for '" + stringify(id) + "':");
+
+    FSPath ff(contents_file_for(id));
+    if (! ff.stat().is_regular_file_or_symlink_to_regular_file())
+    {
+        Log::get_instance()->message("ndbam.contents.skipping", ll_warning, lc_context)
+            << "Contents file '" << ff << "' not a regular file, skipping";
+        return;
+    }
+
+    LineConfigFile f(ff, { });
+    std::vector<ContentsToken> tokens;
+    for (const auto & line : f)
+    {
+        std::shared_ptr<const ContentsEntry> entry;
+        if (decode_contents_line(line, ff, true, tokens, &entry))
+        {
+            ContentsEntryDispatcher d{ entry, on_file, on_dir, on_sym };
+            entry->accept(d);
+        }
+    }
+}
+
+const std::shared_ptr<const Contents>
+NDBAM::contents(const PackageID & id) const
+{
+    Context c("When fetching contents for '" + stringify(id) + "':");
+
+    FSPath ff(contents_file_for(id));
+    if (! ff.stat().is_regular_file_or_symlink_to_regular_file())
+    {
+        Log::get_instance()->message("ndbam.contents.skipping", ll_warning, lc_context)
+            << "Contents file '" << ff << "' not a regular file, skipping";
+        return std::make_shared<Contents>();
+    }
+
+    std::vector<ContentsToken> tokens;
+    return std::make_shared<Contents>(std::make_shared<MappedFile>(ff),
+            [&] (const std::string_view & line, unsigned) { return check_mapped_contents_line(line, ff, tokens); },
+            std::bind(&decode_mapped_contents_line, std::placeholders::_1, ff,
+                "When decoding contents from '" + stringify(ff) + "':"));
 }
 
 std::shared_ptr<const CategoryNamePartSet>
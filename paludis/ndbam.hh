@@ -124,6 +124,13 @@ namespace paludis
                     const std::function<void (const std::shared_ptr<const ContentsEntry> &)> & on_sym
                     ) const;
 
+            /**
+             * The contents for a given ID, decoded from the contents file only
+             * as entries are reached.
+             */
+            const std::shared_ptr<const Contents> contents(const PackageID &) const
+                PALUDIS_ATTRIBUTE((warn_unused_result));
+
             /**
              * Index a newly added QualifiedPackageName, using the provided data directory
              * name part.
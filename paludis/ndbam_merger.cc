@@ -58,13 +58,15 @@ namespace paludis
         NDBAMMergerParams params;
         FSPath realroot;
         std::shared_ptr<SafeOFStream> contents_file;
+        unsigned long installed_size;
 
         std::list<std::string> config_protect;
         std::list<std::string> config_protect_mask;
 
         Imp(const NDBAMMergerParams & p) :
             params(p),
-            realroot(params.root().realpath())
+            realroot(params.root().realpath()),
+            installed_size(0)
         {
             tokenise_whitespace(p.config_protect(), std::back_inserter(config_protect));
             tokenise_whitespace(p.config_protect_mask(), std::back_inserter(config_protect_mask));
@@ -189,6 +191,8 @@ NDBAMMerger::record_install_file(const FSPath & src, const FSPath & dst_dir, con
     if (_imp->params.is_volatile()(FSPath(tidy)))
         *_imp->contents_file << " volatile=true";
     *_imp->contents_file << std::endl;
+
+    _imp->installed_size += dst_dir_name_stat.file_size();
 }
 
 void
@@ -316,7 +320,11 @@ NDBAMMerger::merge()
 {
     display_override(">>> Merging to " + stringify(_imp->params.root()));
     _imp->contents_file = std::make_shared<SafeOFStream>(_imp->params.contents_file(), -1, false);
+    _imp->installed_size = 0;
     FSMerger::merge();
+
+    SafeOFStream size_file(_imp->params.size_file(), -1, false);
+    size_file << _imp->installed_size << std::endl;
 }
 
 bool
@@ -49,6 +49,7 @@ namespace paludis
         typedef Name<struct name_permit_destination> permit_destination;
         typedef Name<struct name_root> root;
         typedef Name<struct name_should_merge> should_merge;
+        typedef Name<struct name_size_file> size_file;
     }
 
     struct NDBAMMergerParams
@@ -71,6 +72,7 @@ namespace paludis
         NamedValue<n::permit_destination, PermitDestinationFn> permit_destination;
         NamedValue<n::root, FSPath> root;
         NamedValue<n::should_merge, std::function<bool(const FSPath &)>> should_merge;
+        NamedValue<n::size_file, FSPath> size_file;
     };
 
     /**
@@ -185,41 +185,10 @@ NDBAMUnmerger::populate_unmerge_set()
             );
 }
 
-namespace
-{
-    template <typename T_>
-    const T_ & require_key(const MetadataKeyHolder & h, const std::string & r)
-    {
-        MetadataKeyHolder::MetadataConstIterator m(h.find_metadata(r));
-        if (m == h.end_metadata())
-            throw InternalError(PALUDIS_HERE, "Expected key '" + r + "' not found");
-
-        const T_ * const c(visitor_cast<const T_>(**m));
-        if (! c)
-            throw InternalError(PALUDIS_HERE, "Key '" + r + "' is of wrong type");
-
-        return *c;
-    }
-
-    template <typename T_, typename V_>
-    bool has_key_with_value(const MetadataKeyHolder & h, const std::string & r, const V_ & v)
-    {
-        MetadataKeyHolder::MetadataConstIterator m(h.find_metadata(r));
-        if (m == h.end_metadata())
-            return false;
-
-        const T_ * const c(visitor_cast<const T_>(**m));
-        if (! c)
-            throw InternalError(PALUDIS_HERE, "Key '" + r + "' is of wrong type");
-
-        return c->parse_value() == v;
-    }
-}
-
 bool
-NDBAMUnmerger::check_file(const std::shared_ptr<const ContentsEntry> & e) const
+NDBAMUnmerger::check_file(const ContentsEntryView & e) const
 {
-    const FSPath f(e->location_key()->parse_value());
+    const FSPath f(std::string(e.path()));
     const FSPath root_f(_imp->options.root() / f);
     const FSStat root_f_stat(root_f);
 
@@ -227,9 +196,9 @@ NDBAMUnmerger::check_file(const std::shared_ptr<const ContentsEntry> & e) const
         display("--- [gone ] " + stringify(f));
     else if (! root_f_stat.is_regular_file())
         display("--- [!type] " + stringify(f));
-    else if (has_key_with_value<MetadataValueKey<bool> >(*e, "volatile", true) && ! config_protected(root_f))
+    else if (e.is_volatile() && ! config_protected(root_f))
         return true;
-    else if (root_f_stat.mtim().seconds() != require_key<MetadataTimeKey>(*e, "mtime").parse_value().seconds())
+    else if (root_f_stat.mtim().seconds() != parse_contents_mtime(e.mtime()))
         display("--- [!time] " + stringify(f));
     else
     {
@@ -239,7 +208,7 @@ NDBAMUnmerger::check_file(const std::shared_ptr<const ContentsEntry> & e) const
             Log::get_instance()->message("ndbam.unmerger.md5_failed", ll_warning, lc_no_context) << "Cannot get md5 for '" << root_f << "'";
             display("--- [!md5?] " + stringify(f));
         }
-        else if (MD5(md5_file).hexsum() != require_key<MetadataValueKey<std::string> >(*e, "md5").parse_value())
+        else if (MD5(md5_file).hexsum() != e.md5())
             display("--- [!md5 ] " + stringify(f));
         else if (config_protected(root_f))
             display("--- [cfgpr] " + stringify(f));
@@ -251,9 +220,9 @@ NDBAMUnmerger::check_file(const std::shared_ptr<const ContentsEntry> & e) const
 }
 
 bool
-NDBAMUnmerger::check_sym(const std::shared_ptr<const ContentsEntry> & e) const
+NDBAMUnmerger::check_sym(const ContentsEntryView & e) const
 {
-    const FSPath f(e->location_key()->parse_value());
+    const FSPath f(std::string(e.path()));
     const FSPath root_f(_imp->options.root() / f);
     const FSStat root_f_stat(root_f);
 
@@ -261,11 +230,11 @@ NDBAMUnmerger::check_sym(const std::shared_ptr<const ContentsEntry> & e) const
         display("--- [gone ] " + stringify(f));
     else if (! root_f_stat.is_symlink())
         display("--- [!type] " + stringify(f));
-    else if (has_key_with_value<MetadataValueKey<bool> >(*e, "volatile", true))
+    else if (e.is_volatile())
         return true;
-    else if (root_f_stat.mtim().seconds() != require_key<MetadataTimeKey>(*e, "mtime").parse_value().seconds())
+    else if (root_f_stat.mtim().seconds() != parse_contents_mtime(e.mtime()))
         display("--- [!time] " + stringify(f));
-    else if (root_f.readlink() != require_key<MetadataValueKey<std::string> >(*e, "target").parse_value())
+    else if (root_f.readlink() != e.target())
         display("--- [!dest] " + stringify(f));
     else
         return true;
@@ -274,15 +243,15 @@ NDBAMUnmerger::check_sym(const std::shared_ptr<const ContentsEntry> & e) const
 }
 
 bool
-NDBAMUnmerger::check_misc(const std::shared_ptr<const ContentsEntry> &) const
+NDBAMUnmerger::check_misc(const ContentsEntryView &) const
 {
     return false;
 }
 
 bool
-NDBAMUnmerger::check_dir(const std::shared_ptr<const ContentsEntry> & e) const
+NDBAMUnmerger::check_dir(const ContentsEntryView & e) const
 {
-    const FSPath f(e->location_key()->parse_value());
+    const FSPath f(std::string(e.path()));
     const FSPath root_f(_imp->options.root() / f);
     const FSStat root_f_stat(root_f);
 
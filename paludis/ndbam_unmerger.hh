@@ -89,10 +89,10 @@ namespace paludis
 
             void display(const std::string &) const override;
 
-            bool check_file(const std::shared_ptr<const ContentsEntry> &) const override;
-            bool check_dir(const std::shared_ptr<const ContentsEntry> &) const override;
-            bool check_sym(const std::shared_ptr<const ContentsEntry> &) const override;
-            bool check_misc(const std::shared_ptr<const ContentsEntry> &) const override;
+            bool check_file(const ContentsEntryView &) const override;
+            bool check_dir(const ContentsEntryView &) const override;
+            bool check_sym(const ContentsEntryView &) const override;
+            bool check_misc(const ContentsEntryView &) const override;
 
         public:
             ///\name Basic operations
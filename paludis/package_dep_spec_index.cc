@@ -0,0 +1,259 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/package_dep_spec_index.hh>
+#include <paludis/util/pimp-impl.hh>
+#include <paludis/util/hashes.hh>
+#include <paludis/util/options.hh>
+#include <paludis/util/sequence.hh>
+#include <paludis/util/wrapped_forward_iterator.hh>
+#include <paludis/package_id.hh>
+#include <paludis/dep_spec.hh>
+#include <paludis/match_package.hh>
+#include <paludis/version_requirements.hh>
+#include <paludis/version_operator.hh>
+#include <paludis/version_spec.hh>
+#include <paludis/name.hh>
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+using namespace paludis;
+
+namespace
+{
+    typedef std::vector<std::pair<VersionSpec, std::size_t> > SortedVersions;
+
+    struct NameEntries
+    {
+        std::vector<std::size_t> any_version;
+        SortedVersions less, less_equal, equal, greater_equal, greater;
+        std::vector<std::size_t> general;
+    };
+
+    typedef std::unordered_map<QualifiedPackageName, NameEntries, Hash<QualifiedPackageName> > ByName;
+
+    typedef std::unordered_map<const PackageID *, std::pair<std::weak_ptr<const PackageID>,
+            std::shared_ptr<const std::vector<std::size_t> > > > Cache;
+
+    const std::size_t min_cache_prune_size(256);
+
+    bool version_less_than_entry(const VersionSpec & v, const std::pair<VersionSpec, std::size_t> & e)
+    {
+        return v < e.first;
+    }
+
+    bool entry_less_than_version(const std::pair<VersionSpec, std::size_t> & e, const VersionSpec & v)
+    {
+        return e.first < v;
+    }
+
+    bool restricts_only_name_and_version(const PackageDepSpec & spec)
+    {
+        return spec.package_ptr()
+            && ! spec.package_name_part_ptr()
+            && ! spec.category_name_part_ptr()
+            && ! spec.slot_requirement_ptr()
+            && ! spec.in_repository_ptr()
+            && ! spec.installable_to_repository_ptr()
+            && ! spec.from_repository_ptr()
+            && ! spec.installed_at_path_ptr()
+            && ! spec.installable_to_path_ptr()
+            && ((! spec.additional_requirements_ptr()) || spec.additional_requirements_ptr()->empty());
+    }
+
+    SortedVersions * sorted_versions_for(NameEntries & entries, const VersionOperator & op)
+    {
+        switch (op.value())
+        {
+            case vo_less:
+                return &entries.less;
+            case vo_less_equal:
+                return &entries.less_equal;
+            case vo_equal:
+                return &entries.equal;
+            case vo_greater_equal:
+                return &entries.greater_equal;
+            case vo_greater:
+                return &entries.greater;
+
+            case vo_tilde:
+            case vo_equal_star:
+            case vo_tilde_greater:
+            case last_vo:
+                break;
+        }
+
+        return nullptr;
+    }
+
+    void add_range(std::vector<std::size_t> & result, SortedVersions::const_iterator b, SortedVersions::const_iterator e)
+    {
+        for ( ; b != e ; ++b)
+            result.push_back(b->second);
+    }
+}
+
+namespace paludis
+{
+    template <>
+    struct Imp<PackageDepSpecIndex>
+    {
+        const Environment * const env;
+        std::vector<PackageDepSpec> specs;
+
+        ByName by_name;
+        std::vector<std::size_t> unnamed;
+
+        mutable std::mutex cache_mutex;
+        mutable Cache cache;
+
+        /* IDs come and go, for example in a long running cave serve, so
+         * entries for dead IDs are dropped whenever the cache reaches this
+         * size, which is then set to twice what is left */
+        mutable std::size_t cache_prune_size;
+
+        Imp(const Environment * const e) :
+            env(e),
+            cache_prune_size(min_cache_prune_size)
+        {
+        }
+    };
+}
+
+PackageDepSpecIndex::PackageDepSpecIndex(const Environment * const e) :
+    _imp(e)
+{
+}
+
+PackageDepSpecIndex::~PackageDepSpecIndex() = default;
+
+std::size_t
+PackageDepSpecIndex::insert(const PackageDepSpec & spec)
+{
+    std::size_t position(_imp->specs.size());
+    _imp->specs.push_back(spec);
+
+    {
+        std::unique_lock<std::mutex> lock(_imp->cache_mutex);
+        _imp->cache.clear();
+    }
+
+    if (! spec.package_ptr())
+    {
+        _imp->unnamed.push_back(position);
+        return position;
+    }
+
+    NameEntries & entries(_imp->by_name[*spec.package_ptr()]);
+
+    if (! restricts_only_name_and_version(spec))
+        entries.general.push_back(position);
+    else if ((! spec.version_requirements_ptr()) || spec.version_requirements_ptr()->empty())
+        entries.any_version.push_back(position);
+    else
+    {
+        SortedVersions * sorted(nullptr);
+        if (1 == std::distance(spec.version_requirements_ptr()->begin(), spec.version_requirements_ptr()->end()))
+            sorted = sorted_versions_for(entries, spec.version_requirements_ptr()->begin()->version_operator());
+
+        if (sorted)
+        {
+            const VersionSpec & v(spec.version_requirements_ptr()->begin()->version_spec());
+            sorted->insert(std::upper_bound(sorted->begin(), sorted->end(), v, &version_less_than_entry), std::make_pair(v, position));
+        }
+        else
+            entries.general.push_back(position);
+    }
+
+    return position;
+}
+
+std::size_t
+PackageDepSpecIndex::size() const
+{
+    return _imp->specs.size();
+}
+
+const std::shared_ptr<const std::vector<std::size_t> >
+PackageDepSpecIndex::matching_positions(const std::shared_ptr<const PackageID> & id) const
+{
+    {
+        std::unique_lock<std::mutex> lock(_imp->cache_mutex);
+        /* the address could belong to a dead ID, so check it's still ours */
+        auto c(_imp->cache.find(id.get()));
+        if (_imp->cache.end() != c && c->second.first.lock() == id)
+            return c->second.second;
+    }
+
+    auto result(std::make_shared<std::vector<std::size_t> >());
+
+    auto n(_imp->by_name.find(id->name()));
+    if (_imp->by_name.end() != n)
+    {
+        const NameEntries & entries(n->second);
+        const VersionSpec v(id->version());
+
+        result->insert(result->end(), entries.any_version.begin(), entries.any_version.end());
+
+        /* for <V and <=V, every entry whose V is above (or not below) ours
+         * matches, and similarly the other way for >V and >=V */
+        add_range(*result, std::upper_bound(entries.less.begin(), entries.less.end(), v, &version_less_than_entry),
+                entries.less.end());
+        add_range(*result, std::lower_bound(entries.less_equal.begin(), entries.less_equal.end(), v, &entry_less_than_version),
+                entries.less_equal.end());
+        add_range(*result, std::lower_bound(entries.equal.begin(), entries.equal.end(), v, &entry_less_than_version),
+                std::upper_bound(entries.equal.begin(), entries.equal.end(), v, &version_less_than_entry));
+        add_range(*result, entries.greater_equal.begin(),
+                std::upper_bound(entries.greater_equal.begin(), entries.greater_equal.end(), v, &version_less_than_entry));
+        add_range(*result, entries.greater.begin(),
+                std::lower_bound(entries.greater.begin(), entries.greater.end(), v, &entry_less_than_version));
+
+        for (const auto & p : entries.general)
+            if (match_package(*_imp->env, _imp->specs[p], id, nullptr, { }))
+                result->push_back(p);
+    }
+
+    for (const auto & p : _imp->unnamed)
+        if (match_package(*_imp->env, _imp->specs[p], id, nullptr, { }))
+            result->push_back(p);
+
+    std::sort(result->begin(), result->end());
+
+    std::unique_lock<std::mutex> lock(_imp->cache_mutex);
+    if (_imp->cache.size() >= _imp->cache_prune_size)
+    {
+        for (auto c(_imp->cache.begin()), c_end(_imp->cache.end()) ; c != c_end ; )
+            if (c->second.first.expired())
+                c = _imp->cache.erase(c);
+            else
+                ++c;
+
+        _imp->cache_prune_size = std::max(min_cache_prune_size, 2 * _imp->cache.size());
+    }
+
+    _imp->cache[id.get()] = std::make_pair(std::weak_ptr<const PackageID>(id), result);
+    return result;
+}
+
+namespace paludis
+{
+    template class Pimp<PackageDepSpecIndex>;
+}
@@ -0,0 +1,88 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef PALUDIS_GUARD_PALUDIS_PACKAGE_DEP_SPEC_INDEX_HH
+#define PALUDIS_GUARD_PALUDIS_PACKAGE_DEP_SPEC_INDEX_HH 1
+
+#include <paludis/package_dep_spec_index-fwd.hh>
+#include <paludis/util/pimp.hh>
+#include <paludis/util/attributes.hh>
+#include <paludis/dep_spec-fwd.hh>
+#include <paludis/environment-fwd.hh>
+#include <paludis/package_id-fwd.hh>
+#include <memory>
+#include <vector>
+
+namespace paludis
+{
+    /**
+     * An ordered list of PackageDepSpec instances, such as the lines of a
+     * mask file, indexed so that finding every entry which matches a given
+     * PackageID does not require calling match_package on all of them.
+     *
+     * Specs are grouped by package name. Specs whose only restriction beyond
+     * the name is a single <, <=, =, >= or > version requirement are kept
+     * sorted by version and found by binary search. Results are cached per
+     * PackageID.
+     *
+     * Matching is done as for match_package with no spec_id and default
+     * options.
+     *
+     * \ingroup g_query
+     */
+    class PALUDIS_VISIBLE PackageDepSpecIndex
+    {
+        private:
+            Pimp<PackageDepSpecIndex> _imp;
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            explicit PackageDepSpecIndex(const Environment * const);
+            ~PackageDepSpecIndex();
+
+            PackageDepSpecIndex(const PackageDepSpecIndex &) = delete;
+            PackageDepSpecIndex & operator= (const PackageDepSpecIndex &) = delete;
+
+            ///\}
+
+            /**
+             * Add a spec, returning its position, which counts up from zero.
+             */
+            std::size_t insert(const PackageDepSpec &);
+
+            /**
+             * How many specs have been inserted?
+             */
+            std::size_t size() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * The positions of every spec which matches the ID, in insertion
+             * order.
+             */
+            const std::shared_ptr<const std::vector<std::size_t> > matching_positions(
+                    const std::shared_ptr<const PackageID> &) const PALUDIS_ATTRIBUTE((warn_unused_result));
+    };
+
+    extern template class Pimp<PackageDepSpecIndex>;
+}
+
+#endif
@@ -0,0 +1,123 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/package_dep_spec_index.hh>
+#include <paludis/match_package.hh>
+#include <paludis/generator.hh>
+#include <paludis/filtered_generator.hh>
+#include <paludis/selection.hh>
+#include <paludis/user_dep_spec.hh>
+#include <paludis/dep_spec.hh>
+
+#include <paludis/environments/test/test_environment.hh>
+
+#include <paludis/repositories/fake/fake_package_id.hh>
+#include <paludis/repositories/fake/fake_repository.hh>
+
+#include <paludis/util/sequence.hh>
+#include <paludis/util/wrapped_forward_iterator.hh>
+#include <paludis/util/make_named_values.hh>
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+TEST(PackageDepSpecIndex, Works)
+{
+    TestEnvironment env;
+
+    auto repo(std::make_shared<FakeRepository>(make_named_values<FakeRepositoryParams>(
+                    n::environment() = &env,
+                    n::name() = RepositoryName("repo")
+                    )));
+    env.add_repository(1, repo);
+
+    for (const auto & v : { "1", "2", "2-r1", "2.0", "3", "10" })
+        repo->add_version("cat", "a", v);
+    repo->add_version("cat", "a", "4")->set_slot(SlotName("4"));
+    repo->add_version("cat", "b", "2");
+    repo->add_version("dog", "b", "2");
+
+    const std::string specs[] = {
+        "cat/a", "<cat/a-2", "<=cat/a-2", "=cat/a-2", "=cat/a-2.0", ">=cat/a-2", ">cat/a-2",
+        ">cat/a-10", "<cat/a-1", "=cat/a-2-r1", "~cat/a-2", "=cat/a-1*", "cat/a:4", "<=cat/a-3",
+        "cat/*", "*/b", "<cat/b-3", "cat/a::repo", ">=cat/a-3", "=cat/a-2", "cat/c"
+    };
+
+    PackageDepSpecIndex index(&env);
+    std::vector<PackageDepSpec> parsed;
+    for (const auto & s : specs)
+    {
+        parsed.push_back(parse_user_package_dep_spec(s, &env, { updso_allow_wildcards }));
+        EXPECT_EQ(parsed.size() - 1, index.insert(parsed.back()));
+    }
+    EXPECT_EQ(parsed.size(), index.size());
+
+    auto ids(env[selection::AllVersionsSorted(generator::All())]);
+    ASSERT_EQ(9, std::distance(ids->begin(), ids->end()));
+
+    for (const auto & id : *ids)
+    {
+        std::vector<std::size_t> expected;
+        for (std::size_t p(0) ; p != parsed.size() ; ++p)
+            if (match_package(env, parsed[p], id, nullptr, { }))
+                expected.push_back(p);
+
+        auto got(index.matching_positions(id));
+        EXPECT_EQ(expected, *got) << id->canonical_form(idcf_full);
+        EXPECT_EQ(got, index.matching_positions(id));
+    }
+}
+
+TEST(PackageDepSpecIndex, CacheDoesNotGrowWithChurn)
+{
+    TestEnvironment env;
+
+    PackageDepSpecIndex index(&env);
+    index.insert(parse_user_package_dep_spec("cat/a", &env, { }));
+
+    /* each ID dies straight after we look it up, so its cached result
+     * should eventually go too */
+    std::vector<std::weak_ptr<const std::vector<std::size_t> > > results;
+    for (int n(0) ; n < 4096 ; ++n)
+    {
+        auto repo(std::make_shared<FakeRepository>(make_named_values<FakeRepositoryParams>(
+                        n::environment() = &env,
+                        n::name() = RepositoryName("repo")
+                        )));
+        std::shared_ptr<const PackageID> id(repo->add_version("cat", "a", "1"));
+        std::weak_ptr<const PackageID> weak_id(id);
+
+        auto positions(index.matching_positions(id));
+        EXPECT_EQ(std::vector<std::size_t>{ 0 }, *positions);
+        results.push_back(positions);
+
+        positions.reset();
+        id.reset();
+        repo.reset();
+        ASSERT_TRUE(weak_id.expired());
+    }
+
+    auto alive(std::count_if(results.begin(), results.end(), [] (const auto & r) { return ! r.expired(); }));
+    EXPECT_LT(alive, 1024);
+}
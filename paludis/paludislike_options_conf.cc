@@ -41,11 +41,16 @@
 #include <paludis/environment.hh>
 #include <paludis/spec_tree.hh>
 #include <paludis/package_dep_spec_properties.hh>
+#include <paludis/package_dep_spec_collection.hh>
+#include <paludis/dep_spec_flattener.hh>
 #include <unordered_map>
 #include <unordered_set>
 #include <list>
 #include <vector>
 #include <algorithm>
+#include <iterator>
+#include <atomic>
+#include <mutex>
 
 using namespace paludis;
 
@@ -115,14 +120,22 @@ namespace
     {
         NamedValue<n::spec, PackageDepSpec> spec;
         NamedValue<n::values_groups, ValuesGroups> values_groups;
+
+        /* filled in on first use, since not every repository need exist
+         * when we're loaded */
+        mutable std::shared_ptr<const CompiledPackageDepSpecMatcher> matcher = nullptr;
     };
 
     typedef std::list<SpecWithValuesGroups> SpecsWithValuesGroups;
 
+    /* wildcard specs, along with their position in the file, since later
+     * lines override earlier ones */
+    typedef std::vector<std::pair<std::size_t, const SpecWithValuesGroups *> > WildcardSpecsBucket;
+
     struct SetNameWithValuesGroups
     {
         NamedValue<n::set_name, SetName> set_name;
-        NamedValue<n::set_value, ActiveObjectPtr<DeferredConstructionPtr<std::shared_ptr<const SetSpecTree> > > > set_value;
+        NamedValue<n::set_value, ActiveObjectPtr<DeferredConstructionPtr<std::shared_ptr<const PackageDepSpecCollection> > > > set_value;
         NamedValue<n::values_groups, ValuesGroups> values_groups;
     };
 
@@ -130,19 +143,26 @@ namespace
 
     typedef std::unordered_map<QualifiedPackageName, SpecsWithValuesGroups, Hash<QualifiedPackageName> > SpecificSpecs;
 
-    const std::shared_ptr<const SetSpecTree> make_set_value(
+    const std::shared_ptr<const PackageDepSpecCollection> make_set_value(
             const Environment * const env,
             const FSPath & from,
             const SetName name)
     {
-        std::shared_ptr<const SetSpecTree> result(env->set(name));
-        if (! result)
+        std::shared_ptr<const SetSpecTree> set(env->set(name));
+        if (! set)
         {
             Log::get_instance()->message("paludislike_options_conf.bad_set", ll_warning, lc_context)
                 << "Set '" << name << "' in '" << from << "' does not exist";
-            result = std::make_shared<SetSpecTree>(std::make_shared<AllDepSpec>());
+            set = std::make_shared<SetSpecTree>(std::make_shared<AllDepSpec>());
         }
 
+        DepSpecFlattener<SetSpecTree, PackageDepSpec> f(env, nullptr);
+        set->top()->accept(f);
+
+        auto result(std::make_shared<PackageDepSpecCollection>(nullptr));
+        for (const auto & spec : f)
+            result->insert(*spec);
+
         return result;
     }
 }
@@ -158,9 +178,75 @@ namespace paludis
         SetNamesWithValuesGroups set_specs;
         SpecsWithValuesGroups wildcard_specs;
 
+        std::unordered_map<CategoryNamePart, WildcardSpecsBucket, Hash<CategoryNamePart> > wildcard_specs_by_category;
+        std::unordered_map<PackageNamePart, WildcardSpecsBucket, Hash<PackageNamePart> > wildcard_specs_by_package_name_part;
+        WildcardSpecsBucket other_wildcard_specs;
+
+        /* each category's bucket merged with other_wildcard_specs, made along
+         * with the matchers */
+        mutable std::unordered_map<CategoryNamePart, WildcardSpecsBucket, Hash<CategoryNamePart> > wildcard_specs_by_category_and_other;
+
+        mutable std::mutex matchers_mutex;
+        mutable std::atomic<bool> matchers_made;
+
         Imp(const PaludisLikeOptionsConfParams & p) :
-            params(p)
+            params(p),
+            matchers_made(false)
+        {
+        }
+
+        void make_matcher(const SpecWithValuesGroups & spec) const
+        {
+            if (! spec.matcher)
+                spec.matcher = std::make_shared<const CompiledPackageDepSpecMatcher>(params.environment(), spec.spec());
+        }
+
+        void make_matchers() const
+        {
+            if (matchers_made.load(std::memory_order_acquire))
+                return;
+
+            std::unique_lock<std::mutex> lock(matchers_mutex);
+            if (matchers_made.load(std::memory_order_relaxed))
+                return;
+
+            for (const auto & specs : specific_specs)
+                for (const auto & spec : specs.second)
+                    make_matcher(spec);
+
+            for (const auto & spec : wildcard_specs)
+                make_matcher(spec);
+
+            /* every bucket is already in file order, so merging keeps it so */
+            wildcard_specs_by_category_and_other.clear();
+            for (const auto & bucket : wildcard_specs_by_category)
+            {
+                WildcardSpecsBucket & merged(wildcard_specs_by_category_and_other[bucket.first]);
+                std::merge(other_wildcard_specs.begin(), other_wildcard_specs.end(),
+                        bucket.second.begin(), bucket.second.end(), std::back_inserter(merged));
+            }
+
+            matchers_made.store(true, std::memory_order_release);
+        }
+
+        /* the wildcard specs which could match something named q, in file
+         * order. only uses storage if there are package name wildcards for q,
+         * which is rare. */
+        const WildcardSpecsBucket & wildcard_specs_for(const QualifiedPackageName & q, WildcardSpecsBucket & storage) const
         {
+            const WildcardSpecsBucket * result(&other_wildcard_specs);
+
+            auto c(wildcard_specs_by_category_and_other.find(q.category()));
+            if (c != wildcard_specs_by_category_and_other.end())
+                result = &c->second;
+
+            auto p(wildcard_specs_by_package_name_part.find(q.package()));
+            if (p == wildcard_specs_by_package_name_part.end())
+                return *result;
+
+            storage.clear();
+            std::merge(result->begin(), result->end(), p->second.begin(), p->second.end(), std::back_inserter(storage));
+            return storage;
         }
     };
 }
@@ -181,6 +267,8 @@ PaludisLikeOptionsConf::add_file(const FSPath & f)
     if (! file)
         return;
 
+    _imp->matchers_made.store(false);
+
     for (const auto & line : *file)
     {
         std::vector<std::string> tokens;
@@ -217,11 +305,20 @@ PaludisLikeOptionsConf::add_file(const FSPath & f)
             }
             else
             {
-                values_groups = &_imp->wildcard_specs.insert(_imp->wildcard_specs.end(),
+                SpecWithValuesGroups & w(*_imp->wildcard_specs.insert(_imp->wildcard_specs.end(),
                         make_named_values<SpecWithValuesGroups>(
                             n::spec() = *d,
                             n::values_groups() = ValuesGroups()
-                            ))->values_groups();
+                            )));
+
+                WildcardSpecsBucket * bucket(&_imp->other_wildcard_specs);
+                if (d->category_name_part_ptr())
+                    bucket = &_imp->wildcard_specs_by_category[*d->category_name_part_ptr()];
+                else if (d->package_name_part_ptr())
+                    bucket = &_imp->wildcard_specs_by_package_name_part[*d->package_name_part_ptr()];
+                bucket->push_back(std::make_pair(_imp->wildcard_specs.size(), &w));
+
+                values_groups = &w.values_groups();
             }
         }
         catch (const GotASetNotAPackageDepSpec &)
@@ -231,7 +328,7 @@ PaludisLikeOptionsConf::add_file(const FSPath & f)
             values_groups = &_imp->set_specs.insert(_imp->set_specs.end(),
                     make_named_values<SetNameWithValuesGroups>(
                         n::set_name() = n,
-                        n::set_value() = DeferredConstructionPtr<std::shared_ptr<const SetSpecTree> >(
+                        n::set_value() = DeferredConstructionPtr<std::shared_ptr<const PackageDepSpecCollection> >(
                                 std::bind(&make_set_value, _imp->params.environment(), f, n)),
                         n::values_groups() = ValuesGroups()
                         ))->values_groups();
@@ -404,53 +501,61 @@ namespace
         }
     }
 
+    bool applies_to(
+            const SpecWithValuesGroups & specs_with_values_group,
+            const std::shared_ptr<const PackageID> & maybe_id)
+    {
+        if (maybe_id)
+            return specs_with_values_group.matcher->match(maybe_id, nullptr, { });
+        else
+            return match_anything(specs_with_values_group.spec());
+    }
+
+    const SpecWithValuesGroups & deref(const SpecWithValuesGroups & s)
+    {
+        return s;
+    }
+
+    const SpecWithValuesGroups & deref(const std::pair<std::size_t, const SpecWithValuesGroups *> & s)
+    {
+        return *s.second;
+    }
+
+    template <typename SpecsWithValuesGroups_>
     void check_specs_with_values_groups(
             const Environment * const env,
             const std::shared_ptr<const PackageID> & maybe_id,
             const ChoicePrefixName & prefix,
             const UnprefixedChoiceName & unprefixed_name,
-            const SpecsWithValuesGroups & specs_with_values_groups,
+            const SpecsWithValuesGroups_ & specs_with_values_groups,
             bool & seen_minus_star,
             std::pair<Tribool, bool> & result_state,
             std::string & result_value)
     {
-        for (const auto & specs_with_values_group : specs_with_values_groups)
+        for (const auto & s : specs_with_values_groups)
         {
-            if (maybe_id)
-            {
-                if (! match_package(*env, specs_with_values_group.spec(), maybe_id, nullptr, { }))
-                    continue;
-            }
-            else
-            {
-                if (! match_anything(specs_with_values_group.spec()))
-                    continue;
-            }
+            const SpecWithValuesGroups & specs_with_values_group(deref(s));
+            if (! applies_to(specs_with_values_group, maybe_id))
+                continue;
 
             check_values_groups(env, maybe_id, prefix, unprefixed_name, specs_with_values_group.values_groups(),
                     seen_minus_star, result_state, result_value);
         }
     }
 
+    template <typename SpecsWithValuesGroups_>
     void collect_known_from_specs_with_values_groups(
             const Environment * const env,
             const std::shared_ptr<const PackageID> & maybe_id,
             const ChoicePrefixName & prefix,
-            const SpecsWithValuesGroups & specs_with_values_groups,
+            const SpecsWithValuesGroups_ & specs_with_values_groups,
             const std::shared_ptr<Set<UnprefixedChoiceName> > & known)
     {
-        for (const auto & specs_with_values_group : specs_with_values_groups)
+        for (const auto & s : specs_with_values_groups)
         {
-            if (maybe_id)
-            {
-                if (! match_package(*env, specs_with_values_group.spec(), maybe_id, nullptr, { }))
-                    continue;
-            }
-            else
-            {
-                if (! match_anything(specs_with_values_group.spec()))
-                    continue;
-            }
+            const SpecWithValuesGroups & specs_with_values_group(deref(s));
+            if (! applies_to(specs_with_values_group, maybe_id))
+                continue;
 
             collect_known_from_values_groups(env, maybe_id, prefix, specs_with_values_group.values_groups(), known);
         }
@@ -464,9 +569,11 @@ PaludisLikeOptionsConf::want_choice_enabled_locked(
         const UnprefixedChoiceName & unprefixed_name
         ) const
 {
-    Context context("When checking state of flag prefix '" + stringify(prefix) +
+    Context context([&] { return "When checking state of flag prefix '" + stringify(prefix) +
             "' name '" + stringify(unprefixed_name) + "' for '" +
-            (maybe_id ? stringify(*maybe_id) : "*/*") + "':");
+            (maybe_id ? stringify(*maybe_id) : "*/*") + "':"; });
+
+    _imp->make_matchers();
 
     bool seen_minus_star(false);
     std::pair<Tribool, bool> result(indeterminate, false);
@@ -490,8 +597,7 @@ PaludisLikeOptionsConf::want_choice_enabled_locked(
     {
         for (const auto & set_spec : _imp->set_specs)
         {
-            if (! match_package_in_set(*_imp->params.environment(), *set_spec.set_value().value().value(),
-                        maybe_id, { }))
+            if (! set_spec.set_value().value().value()->match_any(_imp->params.environment(), maybe_id, { }))
                 continue;
 
             check_values_groups(_imp->params.environment(), maybe_id, prefix, unprefixed_name, set_spec.values_groups(),
@@ -505,8 +611,13 @@ PaludisLikeOptionsConf::want_choice_enabled_locked(
     /* Wildcards? */
     if (! seen_minus_star)
     {
-        check_specs_with_values_groups(_imp->params.environment(), maybe_id, prefix, unprefixed_name,
-                _imp->wildcard_specs, seen_minus_star, result, dummy);
+        WildcardSpecsBucket storage;
+        if (maybe_id)
+            check_specs_with_values_groups(_imp->params.environment(), maybe_id, prefix, unprefixed_name,
+                    _imp->wildcard_specs_for(maybe_id->name(), storage), seen_minus_star, result, dummy);
+        else
+            check_specs_with_values_groups(_imp->params.environment(), maybe_id, prefix, unprefixed_name,
+                    _imp->wildcard_specs, seen_minus_star, result, dummy);
 
         if (! result.first.is_indeterminate())
             return result;
@@ -525,8 +636,10 @@ PaludisLikeOptionsConf::value_for_choice_parameter(
         const UnprefixedChoiceName & unprefixed_name
         ) const
 {
-    Context context("When checking value for flag prefix '" + stringify(prefix) +
-            "' name '" + stringify(unprefixed_name) + "' for '" + stringify(*id) + "':");
+    Context context([&] { return "When checking value for flag prefix '" + stringify(prefix) +
+            "' name '" + stringify(unprefixed_name) + "' for '" + stringify(*id) + "':"; });
+
+    _imp->make_matchers();
 
     bool dummy_seen_minus_star(false);
     std::pair<Tribool, bool> dummy_result;
@@ -549,7 +662,7 @@ PaludisLikeOptionsConf::value_for_choice_parameter(
     {
         for (const auto & set_spec : _imp->set_specs)
         {
-            if (! match_package_in_set(*_imp->params.environment(), *set_spec.set_value().value().value(), id, { }))
+            if (! set_spec.set_value().value().value()->match_any(_imp->params.environment(), id, { }))
                 continue;
 
             check_values_groups(_imp->params.environment(), id, prefix, unprefixed_name, set_spec.values_groups(),
@@ -562,7 +675,8 @@ PaludisLikeOptionsConf::value_for_choice_parameter(
 
     /* Wildcards? */
     {
-        check_specs_with_values_groups(_imp->params.environment(), id, prefix, unprefixed_name, _imp->wildcard_specs,
+        WildcardSpecsBucket storage;
+        check_specs_with_values_groups(_imp->params.environment(), id, prefix, unprefixed_name, _imp->wildcard_specs_for(id->name(), storage),
                 dummy_seen_minus_star, dummy_result, equals_value);
 
         if (! equals_value.empty())
@@ -578,6 +692,8 @@ PaludisLikeOptionsConf::known_choice_value_names(
         const ChoicePrefixName & prefix
         ) const
 {
+    _imp->make_matchers();
+
     const std::shared_ptr<Set<UnprefixedChoiceName> > result(std::make_shared<Set<UnprefixedChoiceName>>());
 
     /* Any specific matches? */
@@ -593,8 +709,7 @@ PaludisLikeOptionsConf::known_choice_value_names(
     {
         for (const auto & set_spec : _imp->set_specs)
         {
-            if (! match_package_in_set(*_imp->params.environment(), *set_spec.set_value().value().value(),
-                        maybe_id, { }))
+            if (! set_spec.set_value().value().value()->match_any(_imp->params.environment(), maybe_id, { }))
                 continue;
 
             collect_known_from_values_groups(_imp->params.environment(), maybe_id, prefix, set_spec.values_groups(), result);
@@ -603,8 +718,13 @@ PaludisLikeOptionsConf::known_choice_value_names(
 
     /* Wildcards? */
     {
-        collect_known_from_specs_with_values_groups(_imp->params.environment(), maybe_id, prefix,
-                _imp->wildcard_specs, result);
+        WildcardSpecsBucket storage;
+        if (maybe_id)
+            collect_known_from_specs_with_values_groups(_imp->params.environment(), maybe_id, prefix,
+                    _imp->wildcard_specs_for(maybe_id->name(), storage), result);
+        else
+            collect_known_from_specs_with_values_groups(_imp->params.environment(), maybe_id, prefix,
+                    _imp->wildcard_specs, result);
     }
 
     return result;
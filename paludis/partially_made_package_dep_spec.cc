@@ -28,7 +28,9 @@
 #include <paludis/version_requirements.hh>
 #include <paludis/additional_package_dep_spec_requirement.hh>
 #include <paludis/dep_spec_data.hh>
+#include <paludis/util/fs_path.hh>
 #include <iterator>
+#include <optional>
 #include <algorithm>
 #include <ostream>
 
@@ -44,23 +46,49 @@ paludis::make_package_dep_spec(const PartiallyMadePackageDepSpecOptions & o)
 
 namespace
 {
+    /**
+     * Everything is stored inline, and the shared pointers handed out by the
+     * accessors alias this object rather than owning separate copies, so
+     * making and copying a spec costs a handful of allocations rather than
+     * one per field. The requirement sequences are shared between copies and
+     * only duplicated when a copy is modified.
+     */
     struct PartiallyMadePackageDepSpecData :
-        PackageDepSpecData
+        PackageDepSpecData,
+        std::enable_shared_from_this<PartiallyMadePackageDepSpecData>
     {
-        std::shared_ptr<const QualifiedPackageName> package;
-        std::shared_ptr<const PackageNamePart> package_name_part;
-        std::shared_ptr<const CategoryNamePart> category_name_part;
+        std::optional<QualifiedPackageName> package;
+        std::optional<PackageNamePart> package_name_part;
+        std::optional<CategoryNamePart> category_name_part;
         std::shared_ptr<VersionRequirements> version_requirements;
         VersionRequirementsMode version_requirements_mode_v;
         std::shared_ptr<const SlotRequirement> slot;
-        std::shared_ptr<const RepositoryName> in_repository;
-        std::shared_ptr<const RepositoryName> from_repository;
-        std::shared_ptr<const InstallableToRepository> installable_to_repository;
-        std::shared_ptr<const FSPath> installed_at_path;
-        std::shared_ptr<const InstallableToPath> installable_to_path;
+        std::optional<RepositoryName> in_repository;
+        std::optional<RepositoryName> from_repository;
+        std::optional<InstallableToRepository> installable_to_repository;
+        std::optional<FSPath> installed_at_path;
+        std::optional<InstallableToPath> installable_to_path;
         std::shared_ptr<AdditionalPackageDepSpecRequirements> additional_requirements;
         PartiallyMadePackageDepSpecOptions options_for_partially_made_package_dep_spec_v;
 
+        template <typename T_>
+        static std::optional<T_> copy_of(const std::shared_ptr<const T_> & t)
+        {
+            if (t)
+                return *t;
+            else
+                return std::nullopt;
+        }
+
+        template <typename T_>
+        std::shared_ptr<const T_> alias(const std::optional<T_> & t) const
+        {
+            if (t)
+                return std::shared_ptr<const T_>(shared_from_this(), &*t);
+            else
+                return nullptr;
+        }
+
         PartiallyMadePackageDepSpecData(const PartiallyMadePackageDepSpecOptions & o) :
             PackageDepSpecData(),
             version_requirements_mode_v(vr_and),
@@ -70,17 +98,17 @@ namespace
 
         PartiallyMadePackageDepSpecData(const PackageDepSpecData & other) :
             PackageDepSpecData(other),
-            package(other.package_ptr()),
-            package_name_part(other.package_name_part_ptr()),
-            category_name_part(other.category_name_part_ptr()),
+            package(copy_of(other.package_ptr())),
+            package_name_part(copy_of(other.package_name_part_ptr())),
+            category_name_part(copy_of(other.category_name_part_ptr())),
             version_requirements(other.version_requirements_ptr() ? new VersionRequirements : nullptr),
             version_requirements_mode_v(other.version_requirements_mode()),
             slot(other.slot_requirement_ptr()),
-            in_repository(other.in_repository_ptr()),
-            from_repository(other.from_repository_ptr()),
-            installable_to_repository(other.installable_to_repository_ptr()),
-            installed_at_path(other.installed_at_path_ptr()),
-            installable_to_path(other.installable_to_path_ptr()),
+            in_repository(copy_of(other.in_repository_ptr())),
+            from_repository(copy_of(other.from_repository_ptr())),
+            installable_to_repository(copy_of(other.installable_to_repository_ptr())),
+            installed_at_path(copy_of(other.installed_at_path_ptr())),
+            installable_to_path(copy_of(other.installable_to_path_ptr())),
             additional_requirements(other.additional_requirements_ptr() ? new AdditionalPackageDepSpecRequirements : nullptr),
             options_for_partially_made_package_dep_spec_v(other.options_for_partially_made_package_dep_spec())
         {
@@ -93,7 +121,48 @@ namespace
                         additional_requirements->back_inserter());
         }
 
-        PartiallyMadePackageDepSpecData(const PartiallyMadePackageDepSpecData & other) = default;
+        PartiallyMadePackageDepSpecData(const PartiallyMadePackageDepSpecData & other) :
+            PackageDepSpecData(other),
+            std::enable_shared_from_this<PartiallyMadePackageDepSpecData>(),
+            package(other.package),
+            package_name_part(other.package_name_part),
+            category_name_part(other.category_name_part),
+            version_requirements(other.version_requirements),
+            version_requirements_mode_v(other.version_requirements_mode_v),
+            slot(other.slot),
+            in_repository(other.in_repository),
+            from_repository(other.from_repository),
+            installable_to_repository(other.installable_to_repository),
+            installed_at_path(other.installed_at_path),
+            installable_to_path(other.installable_to_path),
+            additional_requirements(other.additional_requirements),
+            options_for_partially_made_package_dep_spec_v(other.options_for_partially_made_package_dep_spec_v)
+        {
+        }
+
+        /**
+         * Called before modifying the requirement sequences, which may still
+         * be shared with the spec we were copied from.
+         */
+        void unshare_version_requirements()
+        {
+            if (version_requirements && 1 != version_requirements.use_count())
+            {
+                auto v(std::make_shared<VersionRequirements>());
+                std::copy(version_requirements->begin(), version_requirements->end(), v->back_inserter());
+                version_requirements = v;
+            }
+        }
+
+        void unshare_additional_requirements()
+        {
+            if (additional_requirements && 1 != additional_requirements.use_count())
+            {
+                auto v(std::make_shared<AdditionalPackageDepSpecRequirements>());
+                std::copy(additional_requirements->begin(), additional_requirements->end(), v->back_inserter());
+                additional_requirements = v;
+            }
+        }
 
         std::string as_string() const override
         {
@@ -262,17 +331,17 @@ namespace
 
         std::shared_ptr<const QualifiedPackageName> package_ptr() const override
         {
-            return package;
+            return alias(package);
         }
 
         std::shared_ptr<const PackageNamePart> package_name_part_ptr() const override
         {
-            return package_name_part;
+            return alias(package_name_part);
         }
 
         std::shared_ptr<const CategoryNamePart> category_name_part_ptr() const override
         {
-            return category_name_part;
+            return alias(category_name_part);
         }
 
         std::shared_ptr<const VersionRequirements> version_requirements_ptr() const override
@@ -292,27 +361,27 @@ namespace
 
         std::shared_ptr<const RepositoryName> in_repository_ptr() const override
         {
-            return in_repository;
+            return alias(in_repository);
         }
 
         std::shared_ptr<const InstallableToRepository> installable_to_repository_ptr() const override
         {
-            return installable_to_repository;
+            return alias(installable_to_repository);
         }
 
         std::shared_ptr<const RepositoryName> from_repository_ptr() const override
         {
-            return from_repository;
+            return alias(from_repository);
         }
 
         std::shared_ptr<const FSPath> installed_at_path_ptr() const override
         {
-            return installed_at_path;
+            return alias(installed_at_path);
         }
 
         std::shared_ptr<const InstallableToPath> installable_to_path_ptr() const override
         {
-            return installable_to_path;
+            return alias(installable_to_path);
         }
 
         std::shared_ptr<const AdditionalPackageDepSpecRequirements> additional_requirements_ptr() const override
@@ -332,21 +401,39 @@ namespace paludis
     template <>
     struct Imp<PartiallyMadePackageDepSpec>
     {
+        /* shared with copies of us and with any PackageDepSpec made from us,
+         * and copied before we make any changes */
         std::shared_ptr<PartiallyMadePackageDepSpecData> data;
 
+        static std::shared_ptr<PartiallyMadePackageDepSpecData> data_from(const PackageDepSpec & other)
+        {
+            auto d(std::dynamic_pointer_cast<const PartiallyMadePackageDepSpecData>(other.data()));
+            if (d)
+                return std::const_pointer_cast<PartiallyMadePackageDepSpecData>(d);
+            else
+                return std::make_shared<PartiallyMadePackageDepSpecData>(*other.data());
+        }
+
         Imp(const PartiallyMadePackageDepSpecOptions & o) :
             data(std::make_shared<PartiallyMadePackageDepSpecData>(o))
         {
         }
 
         Imp(const Imp & other) :
-            data(std::make_shared<PartiallyMadePackageDepSpecData>(*other.data))
+            data(other.data)
         {
         }
 
         Imp(const PackageDepSpec & other) :
-            data(std::make_shared<PartiallyMadePackageDepSpecData>(*other.data()))
+            data(data_from(other))
+        {
+        }
+
+        PartiallyMadePackageDepSpecData * writable()
         {
+            if (1 != data.use_count())
+                data = std::make_shared<PartiallyMadePackageDepSpecData>(*data);
+            return data.get();
         }
     };
 }
@@ -371,165 +458,171 @@ PartiallyMadePackageDepSpec::~PartiallyMadePackageDepSpec() = default;
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::package(const QualifiedPackageName & name)
 {
-    _imp->data->package = std::make_shared<QualifiedPackageName>(name);
+    _imp->writable()->package = name;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::clear_package()
 {
-    _imp->data->package.reset();
+    _imp->writable()->package = std::nullopt;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::slot_requirement(const std::shared_ptr<const SlotRequirement> & s)
 {
-    _imp->data->slot = s;
+    _imp->writable()->slot = s;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::clear_slot_requirement()
 {
-    _imp->data->slot.reset();
+    _imp->writable()->slot.reset();
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::in_repository(const RepositoryName & s)
 {
-    _imp->data->in_repository = std::make_shared<RepositoryName>(s);
+    _imp->writable()->in_repository = s;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::clear_in_repository()
 {
-    _imp->data->in_repository.reset();
+    _imp->writable()->in_repository = std::nullopt;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::from_repository(const RepositoryName & s)
 {
-    _imp->data->from_repository = std::make_shared<RepositoryName>(s);
+    _imp->writable()->from_repository = s;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::clear_from_repository()
 {
-    _imp->data->from_repository.reset();
+    _imp->writable()->from_repository = std::nullopt;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::installable_to_repository(const InstallableToRepository & s)
 {
-    _imp->data->installable_to_repository = std::make_shared<InstallableToRepository>(s);
+    _imp->writable()->installable_to_repository = s;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::clear_installable_to_repository()
 {
-    _imp->data->installable_to_repository.reset();
+    _imp->writable()->installable_to_repository = std::nullopt;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::installed_at_path(const FSPath & s)
 {
-    _imp->data->installed_at_path = std::make_shared<FSPath>(s);
+    _imp->writable()->installed_at_path = s;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::clear_installed_at_path()
 {
-    _imp->data->installed_at_path.reset();
+    _imp->writable()->installed_at_path = std::nullopt;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::installable_to_path(const InstallableToPath & s)
 {
-    _imp->data->installable_to_path = std::make_shared<InstallableToPath>(s);
+    _imp->writable()->installable_to_path = s;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::clear_installable_to_path()
 {
-    _imp->data->installable_to_path.reset();
+    _imp->writable()->installable_to_path = std::nullopt;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::package_name_part(const PackageNamePart & part)
 {
-    _imp->data->package_name_part = std::make_shared<PackageNamePart>(part);
+    _imp->writable()->package_name_part = part;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::clear_package_name_part()
 {
-    _imp->data->package_name_part.reset();
+    _imp->writable()->package_name_part = std::nullopt;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::category_name_part(const CategoryNamePart & part)
 {
-    _imp->data->category_name_part = std::make_shared<CategoryNamePart>(part);
+    _imp->writable()->category_name_part = part;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::clear_category_name_part()
 {
-    _imp->data->category_name_part.reset();
+    _imp->writable()->category_name_part = std::nullopt;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::version_requirement(const VersionRequirement & req)
 {
-    if (! _imp->data->version_requirements)
-        _imp->data->version_requirements = std::make_shared<VersionRequirements>();
-    _imp->data->version_requirements->push_back(req);
+    auto data(_imp->writable());
+    if (! data->version_requirements)
+        data->version_requirements = std::make_shared<VersionRequirements>();
+    else
+        data->unshare_version_requirements();
+    data->version_requirements->push_back(req);
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::clear_version_requirements()
 {
-    _imp->data->version_requirements.reset();
+    _imp->writable()->version_requirements.reset();
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::version_requirements_mode(const VersionRequirementsMode & mode)
 {
-    _imp->data->version_requirements_mode_v = mode;
+    _imp->writable()->version_requirements_mode_v = mode;
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::additional_requirement(const std::shared_ptr<const AdditionalPackageDepSpecRequirement> & req)
 {
-    if (! _imp->data->additional_requirements)
-        _imp->data->additional_requirements = std::make_shared<AdditionalPackageDepSpecRequirements>();
-    _imp->data->additional_requirements->push_back(req);
+    auto data(_imp->writable());
+    if (! data->additional_requirements)
+        data->additional_requirements = std::make_shared<AdditionalPackageDepSpecRequirements>();
+    else
+        data->unshare_additional_requirements();
+    data->additional_requirements->push_back(req);
     return *this;
 }
 
 PartiallyMadePackageDepSpec &
 PartiallyMadePackageDepSpec::clear_additional_requirements()
 {
-    _imp->data->additional_requirements.reset();
+    _imp->writable()->additional_requirements.reset();
     return *this;
 }
 
@@ -23,6 +23,7 @@
 #include <paludis/repositories/e/parse_plain_text_label.hh>
 #include <paludis/repositories/e/parse_annotations.hh>
 #include <paludis/repositories/e/eapi.hh>
+#include <paludis/util/arena.hh>
 #include <paludis/util/stringify.hh>
 #include <paludis/util/options.hh>
 #include <paludis/util/tokeniser.hh>
@@ -114,7 +115,7 @@ namespace
                     eapi.supported()->version_spec_options(), mentioned));
         if (add_explicit_choices_requirement)
             data.additional_requirement(make_elike_presumed_choices_requirement(mentioned));
-        std::shared_ptr<PackageDepSpec> spec(std::make_shared<PackageDepSpec>(data));
+        std::shared_ptr<PackageDepSpec> spec(make_shared_in<PackageDepSpec>(h.begin()->item()->arena(), data));
         h.begin()->item()->append(spec);
         h.begin()->children().push_back(spec);
         annotations_go_here(spec);
@@ -155,7 +156,7 @@ namespace
                             op = bfo_implicit_strong;
                     }
 
-                    std::shared_ptr<BlockDepSpec> spec(std::make_shared<BlockDepSpec>(
+                    std::shared_ptr<BlockDepSpec> spec(make_shared_in<BlockDepSpec>(h.begin()->item()->arena(),
                                 s,
                                 parse_elike_package_dep_spec(std::get<2>(p),
                                     eapi.supported()->package_dep_spec_parse_options(),
@@ -179,7 +180,7 @@ namespace
             const typename ParseStackTypes<T_>::AnnotationsGoHere & annotations_go_here,
             const std::string & s)
     {
-        std::shared_ptr<LicenseDepSpec> spec(std::make_shared<LicenseDepSpec>(s));
+        std::shared_ptr<LicenseDepSpec> spec(make_shared_in<LicenseDepSpec>(h.begin()->item()->arena(), s));
         h.begin()->item()->append(spec);
         h.begin()->children().push_back(spec);
         annotations_go_here(spec);
@@ -191,7 +192,7 @@ namespace
             const typename ParseStackTypes<T_>::AnnotationsGoHere & annotations_go_here,
             const std::string & s)
     {
-        std::shared_ptr<PlainTextDepSpec> spec(std::make_shared<PlainTextDepSpec>(s));
+        std::shared_ptr<PlainTextDepSpec> spec(make_shared_in<PlainTextDepSpec>(h.begin()->item()->arena(), s));
         h.begin()->item()->append(spec);
         h.begin()->children().push_back(spec);
         annotations_go_here(spec);
@@ -203,7 +204,7 @@ namespace
             const typename ParseStackTypes<T_>::AnnotationsGoHere & annotations_go_here,
             const std::string & s)
     {
-        std::shared_ptr<SimpleURIDepSpec> spec(std::make_shared<SimpleURIDepSpec>(s));
+        std::shared_ptr<SimpleURIDepSpec> spec(make_shared_in<SimpleURIDepSpec>(h.begin()->item()->arena(), s));
         h.begin()->item()->append(spec);
         h.begin()->children().push_back(spec);
         annotations_go_here(spec);
@@ -220,7 +221,7 @@ namespace
     {
         if (t.empty() || eapi.supported()->dependency_spec_tree_parse_options()[dstpo_uri_supports_arrow])
         {
-            std::shared_ptr<FetchableURIDepSpec> spec(std::make_shared<FetchableURIDepSpec>(t.empty() ? f : f + " -> " + t));
+            std::shared_ptr<FetchableURIDepSpec> spec(make_shared_in<FetchableURIDepSpec>(h.begin()->item()->arena(), t.empty() ? f : f + " -> " + t));
             h.begin()->item()->append(spec);
             h.begin()->children().push_back(spec);
             annotations_go_here(spec);
@@ -319,7 +320,7 @@ namespace
     template <typename T_, typename A_>
     void any_all_handler(typename ParseStackTypes<T_>::Stack & stack)
     {
-        std::shared_ptr<A_> spec(std::make_shared<A_>());
+        std::shared_ptr<A_> spec(make_shared_in<A_>(stack.begin()->item()->arena()));
         stack.push_front(make_named_values<typename ParseStackTypes<T_>::Item>(
                     n::block_children() = std::list<std::pair<std::shared_ptr<BlockDepSpec>, BlockFixOp> >(),
                     n::children() = std::list<std::shared_ptr<DepSpec> >(),
@@ -336,7 +337,7 @@ namespace
             const EAPI & eapi,
             bool is_installed)
     {
-        std::shared_ptr<ConditionalDepSpec> spec(std::make_shared<ConditionalDepSpec>(parse_elike_conditional_dep_spec(
+        std::shared_ptr<ConditionalDepSpec> spec(make_shared_in<ConditionalDepSpec>(stack.begin()->item()->arena(), parse_elike_conditional_dep_spec(
                         u, is_installed || ! eapi.supported()->package_dep_spec_parse_options()[epdso_missing_use_deps_is_qa])));
         stack.push_front(make_named_values<typename ParseStackTypes<T_>::Item>(
                     n::block_children() = std::list<std::pair<std::shared_ptr<BlockDepSpec>, BlockFixOp> >(),
@@ -509,10 +510,11 @@ paludis::erepository::parse_depend(const std::string & s, const Environment * co
     using namespace std::placeholders;
 
     ParseStackTypes<DependencySpecTree>::Stack stack;
-    std::shared_ptr<AllDepSpec> spec(std::make_shared<AllDepSpec>());
+    std::shared_ptr<Arena> arena(std::make_shared<Arena>());
+    std::shared_ptr<AllDepSpec> spec(make_shared_in<AllDepSpec>(arena));
     std::shared_ptr<DepSpec> thing_to_annotate(spec);
     std::list<std::shared_ptr<DepSpec> > thing_to_star_annotate;
-    std::shared_ptr<DependencySpecTree> top(std::make_shared<DependencySpecTree>(spec));
+    std::shared_ptr<DependencySpecTree> top(make_shared_in<DependencySpecTree>(arena, spec, arena));
     stack.push_front(make_named_values<ParseStackTypes<DependencySpecTree>::Item>(
                 n::block_children() = std::list<std::pair<std::shared_ptr<BlockDepSpec>, BlockFixOp> >(),
                 n::children() = std::list<std::shared_ptr<DepSpec> >(),
@@ -563,10 +565,11 @@ paludis::erepository::parse_commented_set(const std::string & s, const Environme
     using namespace std::placeholders;
 
     ParseStackTypes<SetSpecTree>::Stack stack;
-    std::shared_ptr<AllDepSpec> spec(std::make_shared<AllDepSpec>());
+    std::shared_ptr<Arena> arena(std::make_shared<Arena>());
+    std::shared_ptr<AllDepSpec> spec(make_shared_in<AllDepSpec>(arena));
     std::shared_ptr<DepSpec> thing_to_annotate(spec);
     std::list<std::shared_ptr<DepSpec> > thing_to_star_annotate;
-    std::shared_ptr<SetSpecTree> top(std::make_shared<SetSpecTree>(spec));
+    std::shared_ptr<SetSpecTree> top(make_shared_in<SetSpecTree>(arena, spec, arena));
     stack.push_front(make_named_values<ParseStackTypes<SetSpecTree>::Item>(
                 n::block_children() = std::list<std::pair<std::shared_ptr<BlockDepSpec>, BlockFixOp> >(),
                 n::children() = std::list<std::shared_ptr<DepSpec> >(),
@@ -613,10 +616,11 @@ paludis::erepository::parse_fetchable_uri(const std::string & s, const Environme
     using namespace std::placeholders;
 
     ParseStackTypes<FetchableURISpecTree>::Stack stack;
-    std::shared_ptr<AllDepSpec> spec(std::make_shared<AllDepSpec>());
+    std::shared_ptr<Arena> arena(std::make_shared<Arena>());
+    std::shared_ptr<AllDepSpec> spec(make_shared_in<AllDepSpec>(arena));
     std::shared_ptr<DepSpec> thing_to_annotate(spec);
     std::list<std::shared_ptr<DepSpec> > thing_to_star_annotate;
-    std::shared_ptr<FetchableURISpecTree> top(std::make_shared<FetchableURISpecTree>(spec));
+    std::shared_ptr<FetchableURISpecTree> top(make_shared_in<FetchableURISpecTree>(arena, spec, arena));
     stack.push_front(make_named_values<ParseStackTypes<FetchableURISpecTree>::Item>(
                 n::block_children() = std::list<std::pair<std::shared_ptr<BlockDepSpec>, BlockFixOp> >(),
                 n::children() = std::list<std::shared_ptr<DepSpec> >(),
@@ -664,10 +668,11 @@ paludis::erepository::parse_simple_uri(const std::string & s, const Environment
     using namespace std::placeholders;
 
     ParseStackTypes<SimpleURISpecTree>::Stack stack;
-    std::shared_ptr<AllDepSpec> spec(std::make_shared<AllDepSpec>());
+    std::shared_ptr<Arena> arena(std::make_shared<Arena>());
+    std::shared_ptr<AllDepSpec> spec(make_shared_in<AllDepSpec>(arena));
     std::shared_ptr<DepSpec> thing_to_annotate(spec);
     std::list<std::shared_ptr<DepSpec> > thing_to_star_annotate;
-    std::shared_ptr<SimpleURISpecTree> top(std::make_shared<SimpleURISpecTree>(spec));
+    std::shared_ptr<SimpleURISpecTree> top(make_shared_in<SimpleURISpecTree>(arena, spec, arena));
     stack.push_front(make_named_values<ParseStackTypes<SimpleURISpecTree>::Item>(
                 n::block_children() = std::list<std::pair<std::shared_ptr<BlockDepSpec>, BlockFixOp> >(),
                 n::children() = std::list<std::shared_ptr<DepSpec> >(),
@@ -711,10 +716,11 @@ paludis::erepository::parse_license(const std::string & s, const Environment * c
     using namespace std::placeholders;
 
     ParseStackTypes<LicenseSpecTree>::Stack stack;
-    std::shared_ptr<AllDepSpec> spec(std::make_shared<AllDepSpec>());
+    std::shared_ptr<Arena> arena(std::make_shared<Arena>());
+    std::shared_ptr<AllDepSpec> spec(make_shared_in<AllDepSpec>(arena));
     std::shared_ptr<DepSpec> thing_to_annotate(spec);
     std::list<std::shared_ptr<DepSpec> > thing_to_star_annotate;
-    std::shared_ptr<LicenseSpecTree> top(std::make_shared<LicenseSpecTree>(spec));
+    std::shared_ptr<LicenseSpecTree> top(make_shared_in<LicenseSpecTree>(arena, spec, arena));
     stack.push_front(make_named_values<ParseStackTypes<LicenseSpecTree>::Item>(
                 n::block_children() = std::list<std::pair<std::shared_ptr<BlockDepSpec>, BlockFixOp> >(),
                 n::children() = std::list<std::shared_ptr<DepSpec> >(),
@@ -758,10 +764,11 @@ paludis::erepository::parse_plain_text(const std::string & s, const Environment
     using namespace std::placeholders;
 
     ParseStackTypes<PlainTextSpecTree>::Stack stack;
-    std::shared_ptr<AllDepSpec> spec(std::make_shared<AllDepSpec>());
+    std::shared_ptr<Arena> arena(std::make_shared<Arena>());
+    std::shared_ptr<AllDepSpec> spec(make_shared_in<AllDepSpec>(arena));
     std::shared_ptr<DepSpec> thing_to_annotate(spec);
     std::list<std::shared_ptr<DepSpec> > thing_to_star_annotate;
-    std::shared_ptr<PlainTextSpecTree> top(std::make_shared<PlainTextSpecTree>(spec));
+    std::shared_ptr<PlainTextSpecTree> top(make_shared_in<PlainTextSpecTree>(arena, spec, arena));
     stack.push_front(make_named_values<ParseStackTypes<PlainTextSpecTree>::Item>(
                 n::block_children() = std::list<std::pair<std::shared_ptr<BlockDepSpec>, BlockFixOp> >(),
                 n::children() = std::list<std::shared_ptr<DepSpec> >(),
@@ -805,10 +812,11 @@ paludis::erepository::parse_myoptions(const std::string & s, const Environment *
     using namespace std::placeholders;
 
     ParseStackTypes<PlainTextSpecTree>::Stack stack;
-    std::shared_ptr<AllDepSpec> spec(std::make_shared<AllDepSpec>());
+    std::shared_ptr<Arena> arena(std::make_shared<Arena>());
+    std::shared_ptr<AllDepSpec> spec(make_shared_in<AllDepSpec>(arena));
     std::shared_ptr<DepSpec> thing_to_annotate(spec);
     std::list<std::shared_ptr<DepSpec> > thing_to_star_annotate;
-    std::shared_ptr<PlainTextSpecTree> top(std::make_shared<PlainTextSpecTree>(spec));
+    std::shared_ptr<PlainTextSpecTree> top(make_shared_in<PlainTextSpecTree>(arena, spec, arena));
     stack.push_front(make_named_values<ParseStackTypes<PlainTextSpecTree>::Item>(
                 n::block_children() = std::list<std::pair<std::shared_ptr<BlockDepSpec>, BlockFixOp> >(),
                 n::children() = std::list<std::shared_ptr<DepSpec> >(),
@@ -854,10 +862,11 @@ paludis::erepository::parse_required_use(const std::string & s, const Environmen
     using namespace std::placeholders;
 
     ParseStackTypes<RequiredUseSpecTree>::Stack stack;
-    std::shared_ptr<AllDepSpec> spec(std::make_shared<AllDepSpec>());
+    std::shared_ptr<Arena> arena(std::make_shared<Arena>());
+    std::shared_ptr<AllDepSpec> spec(make_shared_in<AllDepSpec>(arena));
     std::shared_ptr<DepSpec> thing_to_annotate(spec);
     std::list<std::shared_ptr<DepSpec> > thing_to_star_annotate;
-    std::shared_ptr<RequiredUseSpecTree> top(std::make_shared<RequiredUseSpecTree>(spec));
+    std::shared_ptr<RequiredUseSpecTree> top(make_shared_in<RequiredUseSpecTree>(arena, spec, arena));
     stack.push_front(make_named_values<ParseStackTypes<RequiredUseSpecTree>::Item>(
                 n::block_children() = std::list<std::pair<std::shared_ptr<BlockDepSpec>, BlockFixOp> >(),
                 n::children() = std::list<std::shared_ptr<DepSpec> >(),
@@ -30,6 +30,8 @@
 
 #include <paludis/util/make_named_values.hh>
 #include <paludis/util/stringify.hh>
+#include <paludis/util/arena.hh>
+#include <paludis/util/wrapped_forward_iterator.hh>
 
 #include <sstream>
 
@@ -175,6 +177,32 @@ TEST(DepParser, AnyUse)
     EXPECT_EQ("|| ( one/one ( foo? ( two/two ) ) )", stringify(e));
 }
 
+TEST(DepParser, Arena)
+{
+    UnformattedPrettyPrinter ff;
+    TestEnvironment env;
+
+    std::shared_ptr<const PackageDepSpec> spec;
+    {
+        auto tree(parse_depend("|| ( one/one foo? ( two/two ) ) three/three",
+                    &env, *EAPIData::get_instance()->eapi_from_string("0"), false));
+        ASSERT_TRUE(bool(tree->top()->arena()));
+        EXPECT_LT(0u, tree->top()->arena()->bytes_allocated());
+
+        SpecTreePrettyPrinter d(ff, { });
+        tree->top()->accept(d);
+        EXPECT_EQ("|| ( one/one foo? ( two/two ) ) three/three", stringify(d));
+
+        std::shared_ptr<const DependencySpecTree::BasicNode> last;
+        for (const auto & child : *tree->top())
+            last = child;
+        spec = std::static_pointer_cast<const DependencySpecTree::NodeType<PackageDepSpec>::Type>(last)->spec();
+    }
+
+    /* the arena lives on for as long as anything allocated from it */
+    EXPECT_EQ("three/three", stringify(*spec));
+}
+
 TEST(DepParser, All)
 {
     UnformattedPrettyPrinter ff;
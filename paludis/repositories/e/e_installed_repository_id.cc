@@ -38,6 +38,7 @@
 #include <paludis/util/return_literal_function.hh>
 #include <paludis/util/fs_stat.hh>
 #include <paludis/util/singleton-impl.hh>
+#include <paludis/util/destringify.hh>
 #include <paludis/util/strip.hh>
 
 #include <paludis/name.hh>
@@ -111,6 +112,7 @@ namespace
         std::shared_ptr<const MetadataValueKey<std::string> > ldflags;
         std::shared_ptr<const MetadataValueKey<std::string> > pkgmanager;
         std::shared_ptr<const MetadataValueKey<std::string> > vdb_format;
+        std::shared_ptr<const MetadataValueKey<long> > size;
     };
 
 
@@ -198,7 +200,7 @@ EInstalledRepositoryID::need_keys_added() const
         add_metadata_key(_imp->fs_location);
     }
 
-    Context context("When loading ID keys from '" + stringify(_imp->dir) + "':");
+    Context context([&] { return "When loading ID keys from '" + stringify(_imp->dir) + "':"; });
 
     add_metadata_key(std::make_shared<LiteralMetadataValueKey<std::string>>("EAPI", "EAPI", mkt_internal, eapi()->name()));
 
@@ -602,6 +604,21 @@ EInstalledRepositoryID::need_keys_added() const
                     mkt_internal, file_contents(_imp->dir / "VDB_FORMAT"));
         add_metadata_key(_imp->keys->vdb_format);
     }
+
+    if ((_imp->dir / "SIZE").stat().exists())
+    {
+        try
+        {
+            _imp->keys->size = std::make_shared<LiteralMetadataValueKey<long> >("SIZE", "Installed size",
+                        mkt_internal, destringify<long>(file_contents(_imp->dir / "SIZE")));
+            add_metadata_key(_imp->keys->size);
+        }
+        catch (const DestringifyError &)
+        {
+            Log::get_instance()->message("e.installed.size.invalid", ll_warning, lc_context)
+                << "Ignoring invalid SIZE in '" << _imp->dir << "'";
+        }
+    }
 }
 
 void
@@ -679,7 +696,7 @@ EInstalledRepositoryID::eapi() const
     if (_imp->eapi)
         return _imp->eapi;
 
-    Context context("When finding EAPI for '" + canonical_form(idcf_full) + "':");
+    Context context([&] { return "When finding EAPI for '" + canonical_form(idcf_full) + "':"; });
 
     if ((_imp->dir / "EAPI").stat().exists())
         _imp->eapi = EAPIData::get_instance()->eapi_from_string(file_contents(_imp->dir / "EAPI"));
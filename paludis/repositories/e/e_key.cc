@@ -20,6 +20,7 @@
 #include <paludis/repositories/e/e_key.hh>
 #include <paludis/repositories/e/ebuild_id.hh>
 #include <paludis/repositories/e/dep_parser.hh>
+#include <paludis/repositories/e/parsed_spec_tree_cache.hh>
 #include <paludis/repositories/e/parse_uri_label.hh>
 #include <paludis/repositories/e/eapi.hh>
 #include <paludis/repositories/e/e_repository.hh>
@@ -101,8 +102,8 @@ EDependenciesKey::~EDependenciesKey() = default;
 const std::shared_ptr<const DependencySpecTree>
 EDependenciesKey::parse_value() const
 {
-    Context context("When parsing metadata key '" + raw_name() + "' from '" + stringify(*_imp->id) + "':");
-    return parse_depend(_imp->string_value, _imp->env, *_imp->id->eapi(), _imp->id->is_installed());
+    Context context([&] { return "When parsing metadata key '" + raw_name() + "' from '" + stringify(*_imp->id) + "':"; });
+    return ParsedSpecTreeCache::get_instance()->parse_depend(_imp->string_value, _imp->env, *_imp->id->eapi(), _imp->id->is_installed());
 }
 
 const std::shared_ptr<const DependenciesLabelSequence>
@@ -184,8 +185,8 @@ ELicenseKey::~ELicenseKey() = default;
 const std::shared_ptr<const LicenseSpecTree>
 ELicenseKey::parse_value() const
 {
-    Context context("When parsing metadata key '" + raw_name() + "':");
-    return parse_license(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
+    Context context([&] { return "When parsing metadata key '" + raw_name() + "':"; });
+    return ParsedSpecTreeCache::get_instance()->parse_license(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
 }
 
 const std::string
@@ -252,8 +253,8 @@ EFetchableURIKey::~EFetchableURIKey() = default;
 const std::shared_ptr<const FetchableURISpecTree>
 EFetchableURIKey::parse_value() const
 {
-    Context context("When parsing metadata key '" + raw_name() + "' from '" + stringify(*_imp->id) + "':");
-    return parse_fetchable_uri(_imp->string_value, _imp->env, *_imp->id->eapi(), _imp->id->is_installed());
+    Context context([&] { return "When parsing metadata key '" + raw_name() + "' from '" + stringify(*_imp->id) + "':"; });
+    return ParsedSpecTreeCache::get_instance()->parse_fetchable_uri(_imp->string_value, _imp->env, *_imp->id->eapi(), _imp->id->is_installed());
 }
 
 const std::string
@@ -359,7 +360,7 @@ ESimpleURIKey::~ESimpleURIKey() = default;
 const std::shared_ptr<const SimpleURISpecTree>
 ESimpleURIKey::parse_value() const
 {
-    return parse_simple_uri(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
+    return ParsedSpecTreeCache::get_instance()->parse_simple_uri(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
 }
 
 const std::string
@@ -431,8 +432,8 @@ EPlainTextSpecKey::~EPlainTextSpecKey() = default;
 const std::shared_ptr<const PlainTextSpecTree>
 EPlainTextSpecKey::parse_value() const
 {
-    Context context("When parsing metadata key '" + raw_name() + "':");
-    return parse_plain_text(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
+    Context context([&] { return "When parsing metadata key '" + raw_name() + "':"; });
+    return ParsedSpecTreeCache::get_instance()->parse_plain_text(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
 }
 
 const std::string
@@ -507,8 +508,8 @@ EMyOptionsKey::~EMyOptionsKey() = default;
 const std::shared_ptr<const PlainTextSpecTree>
 EMyOptionsKey::parse_value() const
 {
-    Context context("When parsing metadata key '" + raw_name() + "':");
-    return parse_myoptions(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
+    Context context([&] { return "When parsing metadata key '" + raw_name() + "':"; });
+    return ParsedSpecTreeCache::get_instance()->parse_myoptions(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
 }
 
 const std::string
@@ -584,8 +585,8 @@ ERequiredUseKey::~ERequiredUseKey() = default;
 const std::shared_ptr<const RequiredUseSpecTree>
 ERequiredUseKey::parse_value() const
 {
-    Context context("When parsing metadata key '" + raw_name() + "':");
-    return parse_required_use(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
+    Context context([&] { return "When parsing metadata key '" + raw_name() + "':"; });
+    return ParsedSpecTreeCache::get_instance()->parse_required_use(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
 }
 
 const std::string
@@ -1583,7 +1583,7 @@ ERepository::eapi_for_file(const FSPath & f) const
     EAPIForFileMap::const_iterator i(_imp->eapi_for_file_map.find(dir));
     if (i == _imp->eapi_for_file_map.end())
     {
-        Context context("When finding the EAPI to use for file '" + stringify(f) + "':");
+        Context context([&] { return "When finding the EAPI to use for file '" + stringify(f) + "':"; });
         if ((dir / "eapi").stat().is_regular_file_or_symlink_to_regular_file())
         {
             LineConfigFile file(dir / "eapi", { lcfo_disallow_continuations });
@@ -1667,7 +1667,7 @@ ERepository::tool_prefix_key() const
 const std::shared_ptr<const ERepositoryID>
 ERepository::make_id(const QualifiedPackageName & q, const FSPath & f) const
 {
-    Context context("When creating ID for '" + stringify(q) + "' from '" + stringify(f) + "':");
+    Context context([&] { return "When creating ID for '" + stringify(q) + "' from '" + stringify(f) + "':"; });
 
     std::string suffix_eapi(FileSuffixes::get_instance()->guess_eapi_from_filename(q, f));
     std::string eapi(suffix_eapi.empty() ? _imp->params.eapi_when_unknown() : suffix_eapi);
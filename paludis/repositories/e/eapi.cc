@@ -45,6 +45,7 @@
 #include <map>
 #include <vector>
 #include <list>
+#include <mutex>
 
 using namespace paludis;
 using namespace paludis::erepository;
@@ -400,7 +401,13 @@ namespace paludis
     template<>
     struct Imp<EAPIData>
     {
-        std::unordered_map<std::string, std::shared_ptr<const EAPI>, Hash<std::string> > values;
+        /* each EAPI is only loaded when it is first asked for. most runs only
+         * need one or two, and the files source one another, so loading all
+         * of them would read 0.conf over and over */
+        std::unordered_map<std::string, FSPath, Hash<std::string> > files;
+
+        mutable std::mutex mutex;
+        mutable std::unordered_map<std::string, std::shared_ptr<const EAPI>, Hash<std::string> > values;
 
         Imp()
         {
@@ -412,25 +419,26 @@ namespace paludis
                 if (! is_file_with_extension(*d, ".conf", { }))
                     continue;
 
-                Context cc("When loading EAPI file '" + stringify(*d) + "':");
-                KeyValueConfigFile k(*d, { },
-                        std::bind(&predefined, stringify(d->dirname()), std::placeholders::_1, std::placeholders::_2),
-                        &KeyValueConfigFile::no_transformation);
-
-                std::shared_ptr<EAPI> eapi(std::make_shared<EAPI>(make_named_values<EAPI>(
-                                n::exported_name() = check_get(k, "exported_name"),
-                                n::name() = strip_trailing_string(d->basename(), ".conf"),
-                                n::supported() = make_supported_eapi(k)
-                                )));
-
-                values.insert(std::make_pair(strip_trailing_string(d->basename(), ".conf"), eapi));
+                files.insert(std::make_pair(strip_trailing_string(d->basename(), ".conf"), *d));
             }
 
-            std::unordered_map<std::string, std::shared_ptr<const EAPI>, Hash<std::string> >::const_iterator i(values.find("0"));
-            if (i == values.end())
+            if (files.end() == files.find("0"))
                 throw EAPIConfigurationError("No EAPI configuration found for EAPI 0");
-            else
-                values.insert(std::make_pair("", i->second));
+        }
+
+        std::shared_ptr<const EAPI> load(const std::string & name, const FSPath & f) const
+        {
+            Context c("When loading EAPI data:");
+            Context cc("When loading EAPI file '" + stringify(f) + "':");
+            KeyValueConfigFile k(f, { },
+                    std::bind(&predefined, stringify(f.dirname()), std::placeholders::_1, std::placeholders::_2),
+                    &KeyValueConfigFile::no_transformation);
+
+            return std::make_shared<EAPI>(make_named_values<EAPI>(
+                            n::exported_name() = check_get(k, "exported_name"),
+                            n::name() = name,
+                            n::supported() = make_supported_eapi(k)
+                            ));
         }
     };
 }
@@ -450,10 +458,17 @@ EAPIData::~EAPIData() = default;
 std::shared_ptr<const EAPI>
 EAPIData::eapi_from_string(const std::string & s) const
 {
-    std::unordered_map<std::string, std::shared_ptr<const EAPI>, Hash<std::string> >::const_iterator i(_imp->values.find(s));
+    const std::string name(s.empty() ? "0" : s);
+
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    auto i(_imp->values.find(name));
     if (i != _imp->values.end())
         return i->second;
 
+    auto f(_imp->files.find(name));
+    if (f != _imp->files.end())
+        return _imp->values.insert(std::make_pair(name, _imp->load(name, f->second))).first->second;
+
     return std::make_shared<EAPI>(make_named_values<EAPI>(
                     n::exported_name() = s,
                     n::name() = s,
@@ -0,0 +1,67 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/repositories/e/eapi.hh>
+
+#include <paludis/util/fs_iterator.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/is_file_with_extension.hh>
+#include <paludis/util/strip.hh>
+#include <paludis/util/system.hh>
+#include <paludis/util/env_var_names.hh>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+using namespace paludis::erepository;
+
+TEST(EAPIData, EveryEAPILoads)
+{
+    FSPath dir(getenv_with_default(env_vars::eapis_dir, ""));
+    int count(0);
+
+    for (FSIterator d(dir, { }), d_end ; d != d_end ; ++d)
+    {
+        if (! is_file_with_extension(*d, ".conf", { }))
+            continue;
+
+        std::string name(strip_trailing_string(d->basename(), ".conf"));
+        std::shared_ptr<const EAPI> eapi(EAPIData::get_instance()->eapi_from_string(name));
+        EXPECT_TRUE(bool(eapi->supported())) << name;
+        EXPECT_EQ(name, eapi->name());
+        ++count;
+    }
+
+    EXPECT_LT(5, count);
+}
+
+TEST(EAPIData, LoadedOnce)
+{
+    std::shared_ptr<const EAPI> eapi(EAPIData::get_instance()->eapi_from_string("1"));
+    EXPECT_EQ(eapi, EAPIData::get_instance()->eapi_from_string("1"));
+    EXPECT_EQ("0", EAPIData::get_instance()->eapi_from_string("")->name());
+}
+
+TEST(EAPIData, Unknown)
+{
+    EXPECT_FALSE(bool(EAPIData::get_instance()->eapi_from_string("not-an-eapi")->supported()));
+    EXPECT_FALSE(bool(EAPIData::get_instance()->eapi_from_string("../eapis/0")->supported()));
+    EXPECT_EQ("not-an-eapi", EAPIData::get_instance()->eapi_from_string("not-an-eapi")->name());
+}
@@ -25,6 +25,7 @@
 #include <paludis/repositories/e/pipe_command_handler.hh>
 
 #include <paludis/util/system.hh>
+#include <paludis/util/instrumentation.hh>
 #include <paludis/util/process.hh>
 #include <paludis/util/strip.hh>
 #include <paludis/util/log.hh>
@@ -113,6 +114,9 @@ namespace
 bool
 EbuildCommand::operator() ()
 {
+    static InstrumentationPoint point("e.ebuild.command");
+    ScopedInstrumentationTimer timer(point);
+
     Context context("When running an ebuild command on '" + stringify(*params.package_id()) + "':");
 
     const auto & package_id = params.package_id();
@@ -349,7 +353,14 @@ EbuildCommand::operator() ()
             .capture_stdout(params.maybe_output_manager()->stdout_stream())
             .use_ptys();
 
-    if (do_run_command(process))
+    const unsigned long long start(Instrumentation::now());
+    const bool ok(do_run_command(process));
+
+    if (Instrumentation::enabled())
+        Instrumentation::get_instance()->add_event(stringify(*package_id) + " " + commands() + (ok ? "" : " (failed)"),
+                "phase", start, Instrumentation::now());
+
+    if (ok)
         return success();
     else
         return failure();
@@ -427,6 +438,9 @@ EbuildMetadataCommand::in_metadata_generation() const
 bool
 EbuildMetadataCommand::do_run_command(Process & process)
 {
+    static InstrumentationPoint point("e.ebuild.metadata_command");
+    ScopedInstrumentationTimer timer(point);
+
     bool ok(false);
     keys = std::make_shared<Map<std::string, std::string>>();
 
@@ -52,6 +52,7 @@
 #include <paludis/slot.hh>
 
 #include <paludis/util/fs_error.hh>
+#include <paludis/util/instrumentation.hh>
 #include <paludis/util/stringify.hh>
 #include <paludis/util/log.hh>
 #include <paludis/util/pimp-impl.hh>
@@ -232,7 +233,7 @@ EbuildID::need_non_xml_keys_added() const
 
     _imp->has_non_xml_keys = true;
 
-    Context context("When generating metadata for ID '" + canonical_form(idcf_full) + "':");
+    Context context([&] { return "When generating metadata for ID '" + canonical_form(idcf_full) + "':"; });
 
     add_metadata_key(_imp->fs_location);
 
@@ -507,7 +508,7 @@ EbuildID::need_xml_keys_added() const
 
     _imp->has_xml_keys = true;
 
-    Context context("When generating XML-related metadata for ID '" + canonical_form(idcf_full) + "':");
+    Context context([&] { return "When generating XML-related metadata for ID '" + canonical_form(idcf_full) + "':"; });
 
     need_non_xml_keys_added();
 
@@ -531,6 +532,9 @@ EbuildID::need_xml_keys_added() const
 void
 EbuildID::need_keys_added() const
 {
+    static InstrumentationPoint point("e.ebuild_id.need_keys_added");
+    ScopedInstrumentationTimer timer(point);
+
     std::unique_lock<std::recursive_mutex> lock(_imp->mutex);
 
     need_non_xml_keys_added();
@@ -619,6 +623,9 @@ namespace
 void
 EbuildID::need_masks_added() const
 {
+    static InstrumentationPoint point("e.ebuild_id.need_masks_added");
+    ScopedInstrumentationTimer timer(point);
+
     std::unique_lock<std::recursive_mutex> lock(_imp->mutex);
 
     if (_imp->has_masks)
@@ -626,7 +633,7 @@ EbuildID::need_masks_added() const
 
     _imp->has_masks = true;
 
-    Context context("When generating masks for ID '" + canonical_form(idcf_full) + "':");
+    Context context([&] { return "When generating masks for ID '" + canonical_form(idcf_full) + "':"; });
 
     if (! eapi()->supported())
     {
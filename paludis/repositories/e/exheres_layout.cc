@@ -38,6 +38,7 @@
 #include <paludis/util/set.hh>
 #include <paludis/util/wrapped_forward_iterator.hh>
 #include <paludis/util/hashes.hh>
+#include <paludis/util/fs_directory_reader.hh>
 #include <paludis/util/fs_iterator.hh>
 #include <paludis/util/fs_stat.hh>
 
@@ -190,7 +191,7 @@ ExheresLayout::need_category_names() const
     if (_imp->has_category_names)
         return;
 
-    Context context("When loading category names for " + stringify(_imp->repository->name()) + ":");
+    Context context([&] { return "When loading category names for " + stringify(_imp->repository->name()) + ":"; });
 
     Log::get_instance()->message("e.exheres_layout.need_category_names", ll_debug, lc_context) << "need_category_names";
 
@@ -240,8 +241,8 @@ ExheresLayout::need_package_ids(const QualifiedPackageName & n) const
     if (_imp->package_names[n])
         return;
 
-    Context context("When loading versions for '" + stringify(n) + "' in "
-            + stringify(_imp->repository->name()) + ":");
+    Context context([&] { return "When loading versions for '" + stringify(n) + "' in "
+            + stringify(_imp->repository->name()) + ":"; });
 
     std::shared_ptr<PackageIDSequence> v(std::make_shared<PackageIDSequence>());
 
@@ -285,7 +286,7 @@ ExheresLayout::has_category_named(const CategoryNamePart & c) const
 {
     std::unique_lock<std::recursive_mutex> lock(_imp->big_nasty_mutex);
 
-    Context context("When checking for category '" + stringify(c) + "' in '" + stringify(_imp->repository->name()) + "':");
+    Context context([&] { return "When checking for category '" + stringify(c) + "' in '" + stringify(_imp->repository->name()) + "':"; });
 
     need_category_names();
     return _imp->category_names.end() != _imp->category_names.find(c);
@@ -296,7 +297,7 @@ ExheresLayout::has_package_named(const QualifiedPackageName & q) const
 {
     std::unique_lock<std::recursive_mutex> lock(_imp->big_nasty_mutex);
 
-    Context context("When checking for package '" + stringify(q) + "' in '" + stringify(_imp->repository->name()) + ":");
+    Context context([&] { return "When checking for package '" + stringify(q) + "' in '" + stringify(_imp->repository->name()) + ":"; });
 
     need_category_names();
 
@@ -348,7 +349,7 @@ ExheresLayout::category_names() const
 {
     std::unique_lock<std::recursive_mutex> lock(_imp->big_nasty_mutex);
 
-    Context context("When fetching category names in " + stringify(stringify(_imp->repository->name())) + ":");
+    Context context([&] { return "When fetching category names in " + stringify(stringify(_imp->repository->name())) + ":"; });
 
     need_category_names_collection();
     return _imp->category_names_collection;
@@ -365,8 +366,8 @@ ExheresLayout::package_names(const CategoryNamePart & c) const
      * changing the data structures used to make this faster at the expense of
      * slowing down single item queries. */
 
-    Context context("When fetching package names in category '" + stringify(c)
-            + "' in '" + stringify(_imp->repository->name()) + "':");
+    Context context([&] { return "When fetching package names in category '" + stringify(c)
+            + "' in '" + stringify(_imp->repository->name()) + "':"; });
 
     need_category_names();
 
@@ -374,20 +375,19 @@ ExheresLayout::package_names(const CategoryNamePart & c) const
         return std::make_shared<QualifiedPackageNameSet>();
 
     if ((_imp->tree_root / "packages" / stringify(c)).stat().is_directory_or_symlink_to_directory())
-        for (FSIterator d(_imp->tree_root / "packages" / stringify(c), { fsio_want_directories, fsio_deref_symlinks_for_wants }), d_end ;
-                d != d_end ; ++d)
+        for (FSDirectoryReader d(_imp->tree_root / "packages" / stringify(c)) ; d.next() ; )
         {
+            if ('.' == d.name()[0] || d.name() == "CVS" || ! d.is_directory_or_symlink_to_directory())
+                continue;
+
             try
             {
-                if (d->basename() == "CVS")
-                    continue;
-
-                _imp->package_names.insert(std::make_pair(c + PackageNamePart(d->basename()), false));
+                _imp->package_names.insert(std::make_pair(c + PackageNamePart(std::string(d.name())), false));
             }
             catch (const NameError & e)
             {
                 Log::get_instance()->message("e.exheres_layout.packages.failure", ll_warning, lc_context)
-                    << "Skipping entry '" << d->basename() << "' in category '" << c << "' in repository '"
+                    << "Skipping entry '" << d.name() << "' in category '" << c << "' in repository '"
                     << _imp->repository->name() << "' (" << e.message() << ")";
             }
         }
@@ -408,7 +408,7 @@ ExheresLayout::package_ids(const QualifiedPackageName & n) const
 {
     std::unique_lock<std::recursive_mutex> lock(_imp->big_nasty_mutex);
 
-    Context context("When fetching versions of '" + stringify(n) + "' in " + stringify(_imp->repository->name()) + ":");
+    Context context([&] { return "When fetching versions of '" + stringify(n) + "' in " + stringify(_imp->repository->name()) + ":"; });
 
     if (has_package_named(n))
     {
@@ -23,7 +23,6 @@
 
 #include <paludis/util/pimp-impl.hh>
 #include <paludis/util/exception.hh>
-#include <paludis/util/hashes.hh>
 #include <paludis/util/stringify.hh>
 #include <paludis/util/log.hh>
 #include <paludis/util/safe_ifstream.hh>
@@ -32,21 +31,16 @@
 
 #include <paludis/dep_spec.hh>
 #include <paludis/package_id.hh>
-#include <paludis/match_package.hh>
+#include <paludis/package_dep_spec_index.hh>
 #include <paludis/dep_spec_flattener.hh>
 #include <paludis/dep_spec_annotations.hh>
 
 #include <algorithm>
-#include <unordered_map>
-#include <list>
+#include <vector>
 
 using namespace paludis;
 using namespace paludis::erepository;
 
-typedef std::unordered_map<QualifiedPackageName,
-        std::list<std::pair<PackageDepSpec, std::shared_ptr<const MaskInfo> > >,
-        Hash<QualifiedPackageName> > RepositoryMaskMap;
-
 namespace paludis
 {
     template <>
@@ -57,13 +51,15 @@ namespace paludis
         const std::shared_ptr<const FSPathSequence> files;
         EAPIForFileFunction eapi_for_file;
 
-        RepositoryMaskMap repo_mask;
+        PackageDepSpecIndex repo_mask;
+        std::vector<std::shared_ptr<const MaskInfo> > repo_mask_infos;
 
         Imp(const Environment * const e, const RepositoryName & r, const std::shared_ptr<const FSPathSequence> & f, const EAPIForFileFunction & n) :
             env(e),
             repo_name(r),
             files(f),
-            eapi_for_file(n)
+            eapi_for_file(n),
+            repo_mask(e)
         {
         }
     };
@@ -159,7 +155,10 @@ ExheresMaskStore::_populate()
             for (const auto & spec : flat_specs)
             {
                 if (spec->package_ptr())
-                    _imp->repo_mask[*spec->package_ptr()].push_back(std::make_pair(*spec, make_mask_info(*spec, f)));
+                {
+                    _imp->repo_mask.insert(*spec);
+                    _imp->repo_mask_infos.push_back(make_mask_info(*spec, f));
+                }
                 else
                     Log::get_instance()->message("e.package_mask.bad_spec", ll_warning, lc_context)
                         << "Loading package mask spec '" << *spec << "' failed because specification does not restrict to a "
@@ -183,11 +182,8 @@ const std::shared_ptr<const MasksInfo>
 ExheresMaskStore::query(const std::shared_ptr<const PackageID> & id) const
 {
     auto result(std::make_shared<MasksInfo>());
-    auto r(_imp->repo_mask.find(id->name()));
-    if (_imp->repo_mask.end() != r)
-        for (const auto & k : r->second)
-            if (match_package(*_imp->env, k.first, id, nullptr, { }))
-                result->push_back(*k.second);
+    for (const auto & p : *_imp->repo_mask.matching_positions(id))
+        result->push_back(*_imp->repo_mask_infos[p]);
 
     return result;
 }
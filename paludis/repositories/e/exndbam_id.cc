@@ -58,12 +58,6 @@ ExndbamID::contents_filename() const
 const std::shared_ptr<const Contents>
 ExndbamID::contents() const
 {
-    auto v(std::make_shared<Contents>());
-    _ndbam->parse_contents(*this,
-            std::bind(&Contents::add, v.get(), std::placeholders::_1),
-            std::bind(&Contents::add, v.get(), std::placeholders::_1),
-            std::bind(&Contents::add, v.get(), std::placeholders::_1)
-            );
-    return v;
+    return _ndbam->contents(*this);
 }
 
@@ -526,7 +526,8 @@ ExndbamRepository::merge(const MergeParams & m)
                 n::parts() = m.parts(),
                 n::permit_destination() = m.permit_destination(),
                 n::root() = installed_root_key()->parse_value(),
-                n::should_merge() = should_merge_callback
+                n::should_merge() = should_merge_callback,
+                n::size_file() = target_ver_dir / "SIZE"
             ));
 
     (m.used_this_for_config_protect())(config_protect);
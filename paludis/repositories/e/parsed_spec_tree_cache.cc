@@ -0,0 +1,249 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/repositories/e/parsed_spec_tree_cache.hh>
+#include <paludis/repositories/e/dep_parser.hh>
+#include <paludis/repositories/e/eapi.hh>
+
+#include <paludis/util/pimp-impl.hh>
+#include <paludis/util/singleton-impl.hh>
+#include <paludis/util/make_named_values.hh>
+#include <paludis/util/hashes.hh>
+
+#include <paludis/spec_tree.hh>
+#include <paludis/dep_spec.hh>
+
+#include <list>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+
+using namespace paludis;
+using namespace paludis::erepository;
+
+namespace
+{
+    enum ParsedSpecTreeKind
+    {
+        pstk_depend,
+        pstk_plain_text,
+        pstk_myoptions,
+        pstk_required_use,
+        pstk_fetchable_uri,
+        pstk_simple_uri,
+        pstk_license
+    };
+
+    struct CacheKey
+    {
+        ParsedSpecTreeKind kind;
+        std::string eapi;
+        bool is_installed;
+        std::string value;
+
+        bool operator== (const CacheKey & other) const
+        {
+            return std::tie(kind, is_installed, eapi, value) ==
+                std::tie(other.kind, other.is_installed, other.eapi, other.value);
+        }
+    };
+
+    struct CacheKeyHash
+    {
+        std::size_t operator() (const CacheKey & k) const
+        {
+            return Hash<std::string>()(k.value) ^ (Hash<std::string>()(k.eapi) << 1) ^
+                (static_cast<std::size_t>(k.kind) << 2) ^ static_cast<std::size_t>(k.is_installed);
+        }
+    };
+
+    struct CacheEntry
+    {
+        /* the real type depends upon kind */
+        std::shared_ptr<const void> tree;
+        std::list<const CacheKey *>::iterator position;
+    };
+
+    typedef std::unordered_map<CacheKey, CacheEntry, CacheKeyHash> Trees;
+
+    const std::size_t default_capacity(8192);
+}
+
+namespace paludis
+{
+    template <>
+    struct Imp<ParsedSpecTreeCache>
+    {
+        mutable std::mutex mutex;
+        mutable Trees trees;
+
+        /* most recently used at the front */
+        mutable std::list<const CacheKey *> recently_used;
+
+        std::size_t capacity;
+        mutable unsigned long hits, misses, evictions;
+
+        Imp() :
+            capacity(default_capacity),
+            hits(0),
+            misses(0),
+            evictions(0)
+        {
+        }
+
+        void evict_excess() const
+        {
+            while (trees.size() > capacity)
+            {
+                const CacheKey * const oldest(recently_used.back());
+                recently_used.pop_back();
+                trees.erase(*oldest);
+                ++evictions;
+            }
+        }
+
+        template <typename T_>
+        const std::shared_ptr<const T_> fetch(
+                const ParsedSpecTreeKind kind,
+                std::shared_ptr<T_> (* const parse)(const std::string &, const Environment * const, const EAPI &, const bool),
+                const std::string & s, const Environment * const env, const EAPI & eapi, const bool is_installed) const
+        {
+            CacheKey key{ kind, eapi.name(), is_installed, s };
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                auto i(trees.find(key));
+                if (i != trees.end())
+                {
+                    ++hits;
+                    recently_used.splice(recently_used.begin(), recently_used, i->second.position);
+                    return std::static_pointer_cast<const T_>(i->second.tree);
+                }
+
+                ++misses;
+            }
+
+            /* parse without holding the lock. if someone else gets there
+             * first, we just use theirs. */
+            std::shared_ptr<const T_> result(parse(s, env, eapi, is_installed));
+
+            std::unique_lock<std::mutex> lock(mutex);
+            if (0 == capacity)
+                return result;
+
+            auto i(trees.insert(std::make_pair(std::move(key), CacheEntry{ result, recently_used.end() })));
+            if (! i.second)
+            {
+                recently_used.splice(recently_used.begin(), recently_used, i.first->second.position);
+                return std::static_pointer_cast<const T_>(i.first->second.tree);
+            }
+
+            recently_used.push_front(&i.first->first);
+            i.first->second.position = recently_used.begin();
+            evict_excess();
+
+            return result;
+        }
+    };
+}
+
+ParsedSpecTreeCache::ParsedSpecTreeCache() :
+    _imp()
+{
+}
+
+ParsedSpecTreeCache::~ParsedSpecTreeCache() = default;
+
+const std::shared_ptr<const DependencySpecTree>
+ParsedSpecTreeCache::parse_depend(const std::string & s, const Environment * const env, const EAPI & eapi, const bool is_installed) const
+{
+    return _imp->fetch(pstk_depend, &erepository::parse_depend, s, env, eapi, is_installed);
+}
+
+const std::shared_ptr<const PlainTextSpecTree>
+ParsedSpecTreeCache::parse_plain_text(const std::string & s, const Environment * const env, const EAPI & eapi, const bool is_installed) const
+{
+    return _imp->fetch(pstk_plain_text, &erepository::parse_plain_text, s, env, eapi, is_installed);
+}
+
+const std::shared_ptr<const PlainTextSpecTree>
+ParsedSpecTreeCache::parse_myoptions(const std::string & s, const Environment * const env, const EAPI & eapi, const bool is_installed) const
+{
+    return _imp->fetch(pstk_myoptions, &erepository::parse_myoptions, s, env, eapi, is_installed);
+}
+
+const std::shared_ptr<const RequiredUseSpecTree>
+ParsedSpecTreeCache::parse_required_use(const std::string & s, const Environment * const env, const EAPI & eapi, const bool is_installed) const
+{
+    return _imp->fetch(pstk_required_use, &erepository::parse_required_use, s, env, eapi, is_installed);
+}
+
+const std::shared_ptr<const FetchableURISpecTree>
+ParsedSpecTreeCache::parse_fetchable_uri(const std::string & s, const Environment * const env, const EAPI & eapi, const bool is_installed) const
+{
+    return _imp->fetch(pstk_fetchable_uri, &erepository::parse_fetchable_uri, s, env, eapi, is_installed);
+}
+
+const std::shared_ptr<const SimpleURISpecTree>
+ParsedSpecTreeCache::parse_simple_uri(const std::string & s, const Environment * const env, const EAPI & eapi, const bool is_installed) const
+{
+    return _imp->fetch(pstk_simple_uri, &erepository::parse_simple_uri, s, env, eapi, is_installed);
+}
+
+const std::shared_ptr<const LicenseSpecTree>
+ParsedSpecTreeCache::parse_license(const std::string & s, const Environment * const env, const EAPI & eapi, const bool is_installed) const
+{
+    return _imp->fetch(pstk_license, &erepository::parse_license, s, env, eapi, is_installed);
+}
+
+void
+ParsedSpecTreeCache::set_capacity(const std::size_t c)
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->capacity = c;
+    _imp->evict_excess();
+}
+
+void
+ParsedSpecTreeCache::clear()
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->recently_used.clear();
+    _imp->trees.clear();
+    _imp->hits = _imp->misses = _imp->evictions = 0;
+}
+
+ParsedSpecTreeCacheStatistics
+ParsedSpecTreeCache::statistics() const
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    return make_named_values<ParsedSpecTreeCacheStatistics>(
+            n::capacity() = _imp->capacity,
+            n::evictions() = _imp->evictions,
+            n::hits() = _imp->hits,
+            n::misses() = _imp->misses,
+            n::size() = _imp->trees.size()
+            );
+}
+
+namespace paludis
+{
+    template class Pimp<ParsedSpecTreeCache>;
+    template class Singleton<ParsedSpecTreeCache>;
+}
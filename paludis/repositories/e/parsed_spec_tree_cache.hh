@@ -0,0 +1,139 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PALUDIS_GUARD_PALUDIS_REPOSITORIES_E_PARSED_SPEC_TREE_CACHE_HH
+#define PALUDIS_GUARD_PALUDIS_REPOSITORIES_E_PARSED_SPEC_TREE_CACHE_HH 1
+
+#include <paludis/repositories/e/eapi-fwd.hh>
+#include <paludis/util/singleton.hh>
+#include <paludis/util/pimp.hh>
+#include <paludis/util/attributes.hh>
+#include <paludis/util/named_value.hh>
+#include <paludis/environment-fwd.hh>
+#include <paludis/spec_tree-fwd.hh>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace paludis
+{
+    namespace n
+    {
+        typedef Name<struct name_capacity> capacity;
+        typedef Name<struct name_evictions> evictions;
+        typedef Name<struct name_hits> hits;
+        typedef Name<struct name_misses> misses;
+        typedef Name<struct name_size> size;
+    }
+
+    namespace erepository
+    {
+        struct ParsedSpecTreeCacheStatistics
+        {
+            NamedValue<n::capacity, std::size_t> capacity;
+            NamedValue<n::evictions, unsigned long> evictions;
+            NamedValue<n::hits, unsigned long> hits;
+            NamedValue<n::misses, unsigned long> misses;
+            NamedValue<n::size, std::size_t> size;
+        };
+
+        /**
+         * Holds recently parsed spec trees, so that identical metadata
+         * strings (which are very common, since many IDs share exactly the
+         * same dependencies) are only parsed once, and so that asking a key
+         * for its value repeatedly doesn't reparse it each time.
+         *
+         * Trees are keyed upon the EAPI, whether the ID is installed and the
+         * string being parsed, and are shared between everyone who asks for
+         * them, so they must not be modified. Nothing in a parsed tree
+         * depends upon the environment, which is only passed through to the
+         * parser.
+         *
+         * The least recently used trees are discarded once capacity() is
+         * reached. Parse errors are not cached.
+         */
+        class PALUDIS_VISIBLE ParsedSpecTreeCache :
+            public Singleton<ParsedSpecTreeCache>
+        {
+            friend class Singleton<ParsedSpecTreeCache>;
+
+            private:
+                Pimp<ParsedSpecTreeCache> _imp;
+
+                ParsedSpecTreeCache();
+                ~ParsedSpecTreeCache();
+
+            public:
+                ///\name Parsing, via the cache
+                ///\{
+
+                const std::shared_ptr<const DependencySpecTree> parse_depend(const std::string &,
+                        const Environment * const, const EAPI &, const bool is_installed) const
+                    PALUDIS_ATTRIBUTE((warn_unused_result));
+
+                const std::shared_ptr<const PlainTextSpecTree> parse_plain_text(const std::string &,
+                        const Environment * const, const EAPI &, const bool is_installed) const
+                    PALUDIS_ATTRIBUTE((warn_unused_result));
+
+                const std::shared_ptr<const PlainTextSpecTree> parse_myoptions(const std::string &,
+                        const Environment * const, const EAPI &, const bool is_installed) const
+                    PALUDIS_ATTRIBUTE((warn_unused_result));
+
+                const std::shared_ptr<const RequiredUseSpecTree> parse_required_use(const std::string &,
+                        const Environment * const, const EAPI &, const bool is_installed) const
+                    PALUDIS_ATTRIBUTE((warn_unused_result));
+
+                const std::shared_ptr<const FetchableURISpecTree> parse_fetchable_uri(const std::string &,
+                        const Environment * const, const EAPI &, const bool is_installed) const
+                    PALUDIS_ATTRIBUTE((warn_unused_result));
+
+                const std::shared_ptr<const SimpleURISpecTree> parse_simple_uri(const std::string &,
+                        const Environment * const, const EAPI &, const bool is_installed) const
+                    PALUDIS_ATTRIBUTE((warn_unused_result));
+
+                const std::shared_ptr<const LicenseSpecTree> parse_license(const std::string &,
+                        const Environment * const, const EAPI &, const bool is_installed) const
+                    PALUDIS_ATTRIBUTE((warn_unused_result));
+
+                ///\}
+
+                ///\name Tuning and statistics
+                ///\{
+
+                /**
+                 * Change how many trees are kept, discarding any excess.
+                 */
+                void set_capacity(const std::size_t);
+
+                /**
+                 * Discard everything, and reset the statistics.
+                 */
+                void clear();
+
+                ParsedSpecTreeCacheStatistics statistics() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+                ///\}
+        };
+    }
+
+    extern template class Pimp<erepository::ParsedSpecTreeCache>;
+    extern template class Singleton<erepository::ParsedSpecTreeCache>;
+}
+
+#endif
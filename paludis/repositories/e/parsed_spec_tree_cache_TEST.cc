@@ -0,0 +1,126 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/repositories/e/parsed_spec_tree_cache.hh>
+#include <paludis/repositories/e/dep_parser.hh>
+#include <paludis/repositories/e/spec_tree_pretty_printer.hh>
+#include <paludis/repositories/e/eapi.hh>
+
+#include <paludis/environments/test/test_environment.hh>
+
+#include <paludis/unformatted_pretty_printer.hh>
+#include <paludis/spec_tree.hh>
+
+#include <paludis/util/stringify.hh>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+using namespace paludis::erepository;
+
+namespace
+{
+    template <typename T_>
+    std::string pretty(const std::shared_ptr<const T_> & tree)
+    {
+        UnformattedPrettyPrinter ff;
+        SpecTreePrettyPrinter d(ff, { });
+        tree->top()->accept(d);
+        return stringify(d);
+    }
+}
+
+TEST(ParsedSpecTreeCache, Shared)
+{
+    TestEnvironment env;
+    auto cache(ParsedSpecTreeCache::get_instance());
+    cache->clear();
+    const EAPI & eapi(*EAPIData::get_instance()->eapi_from_string("paludis-1"));
+
+    auto a(cache->parse_depend("cat/one || ( cat/two cat/three )", &env, eapi, false));
+    auto b(cache->parse_depend("cat/one || ( cat/two cat/three )", &env, eapi, false));
+    auto c(cache->parse_depend("cat/one || ( cat/two cat/three )", &env, eapi, true));
+    auto d(cache->parse_depend("cat/one", &env, eapi, false));
+
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_NE(a, d);
+    EXPECT_EQ("cat/one || ( cat/two cat/three )", pretty(a));
+    EXPECT_EQ("cat/one", pretty(d));
+
+    auto s(cache->statistics());
+    EXPECT_EQ(1u, s.hits());
+    EXPECT_EQ(3u, s.misses());
+    EXPECT_EQ(3u, s.size());
+    EXPECT_EQ(0u, s.evictions());
+}
+
+TEST(ParsedSpecTreeCache, Kinds)
+{
+    TestEnvironment env;
+    auto cache(ParsedSpecTreeCache::get_instance());
+    cache->clear();
+    const EAPI & eapi(*EAPIData::get_instance()->eapi_from_string("paludis-1"));
+
+    auto l(cache->parse_license("GPL-2", &env, eapi, false));
+    auto p(cache->parse_plain_text("GPL-2", &env, eapi, false));
+    EXPECT_EQ("GPL-2", pretty(l));
+    EXPECT_EQ("GPL-2", pretty(p));
+    EXPECT_EQ(0u, cache->statistics().hits());
+    EXPECT_EQ(2u, cache->statistics().size());
+}
+
+TEST(ParsedSpecTreeCache, Eviction)
+{
+    TestEnvironment env;
+    auto cache(ParsedSpecTreeCache::get_instance());
+    cache->clear();
+    cache->set_capacity(2);
+    const EAPI & eapi(*EAPIData::get_instance()->eapi_from_string("paludis-1"));
+
+    auto a(cache->parse_depend("cat/a", &env, eapi, false));
+    auto b(cache->parse_depend("cat/b", &env, eapi, false));
+    EXPECT_EQ(a, cache->parse_depend("cat/a", &env, eapi, false));
+    auto c(cache->parse_depend("cat/c", &env, eapi, false));
+
+    /* b was the least recently used, so it has gone */
+    EXPECT_EQ(1u, cache->statistics().evictions());
+    EXPECT_EQ(a, cache->parse_depend("cat/a", &env, eapi, false));
+    EXPECT_EQ(c, cache->parse_depend("cat/c", &env, eapi, false));
+    EXPECT_NE(b, cache->parse_depend("cat/b", &env, eapi, false));
+
+    cache->set_capacity(0);
+    EXPECT_EQ(0u, cache->statistics().size());
+    EXPECT_NE(cache->parse_depend("cat/a", &env, eapi, false), cache->parse_depend("cat/a", &env, eapi, false));
+
+    cache->set_capacity(8192);
+    cache->clear();
+}
+
+TEST(ParsedSpecTreeCache, Errors)
+{
+    TestEnvironment env;
+    auto cache(ParsedSpecTreeCache::get_instance());
+    cache->clear();
+    const EAPI & eapi(*EAPIData::get_instance()->eapi_from_string("paludis-1"));
+
+    EXPECT_THROW(auto x(cache->parse_depend("( cat/a", &env, eapi, false)), EDepParseError);
+    EXPECT_THROW(auto x(cache->parse_depend("( cat/a", &env, eapi, false)), EDepParseError);
+    EXPECT_EQ(0u, cache->statistics().size());
+}
@@ -37,6 +37,7 @@
 #include <paludis/util/indirect_iterator-impl.hh>
 #include <paludis/util/hashes.hh>
 #include <paludis/util/fs_stat.hh>
+#include <paludis/util/fs_directory_reader.hh>
 #include <paludis/util/fs_iterator.hh>
 #include <paludis/util/active_object_ptr.hh>
 #include <paludis/util/deferred_construction_ptr.hh>
@@ -48,6 +49,7 @@
 #include <functional>
 #include <unordered_map>
 #include <algorithm>
+#include <vector>
 #include <list>
 
 using namespace paludis;
@@ -188,7 +190,7 @@ TraditionalLayout::need_category_names() const
     if (_imp->has_category_names)
         return;
 
-    Context context("When loading category names for " + stringify(_imp->repository->name()) + ":");
+    Context context([&] { return "When loading category names for " + stringify(_imp->repository->name()) + ":"; });
 
     Log::get_instance()->message("e.traditional_layout.need_category_names", ll_debug, lc_context) << "need_category_names";
 
@@ -228,16 +230,24 @@ TraditionalLayout::need_category_names() const
     {
         Log::get_instance()->message("e.traditional_layout.categories.no_file", ll_qa, lc_context)
             << "No categories file for repository at '" << _imp->tree_root << "', faking it";
-        for (FSIterator d(_imp->tree_root, { fsio_inode_sort, fsio_deref_symlinks_for_wants, fsio_want_directories }), d_end ; d != d_end ; ++d)
+        /* sorted by inode, so that later reads go roughly in disk order */
+        std::vector<std::pair<ino_t, std::string> > entries;
+        for (FSDirectoryReader d(_imp->tree_root) ; d.next() ; )
         {
-            std::string n(d->basename());
-            if (n == "CVS" || n == "distfiles" || n == "scripts" || n == "eclass" || n == "licenses"
-                    || n == "packages")
+            std::string_view n(d.name());
+            if ('.' == n[0] || n == "CVS" || n == "distfiles" || n == "scripts" || n == "eclass" || n == "licenses"
+                    || n == "packages" || ! d.is_directory_or_symlink_to_directory())
                 continue;
 
+            entries.emplace_back(d.inode(), n);
+        }
+        std::sort(entries.begin(), entries.end());
+
+        for (const auto & e : entries)
+        {
             try
             {
-                _imp->category_names.insert(std::make_pair(CategoryNamePart(n), false));
+                _imp->category_names.insert(std::make_pair(CategoryNamePart(e.second), false));
             }
             catch (const NameError &)
             {
@@ -258,8 +268,8 @@ TraditionalLayout::need_package_ids(const QualifiedPackageName & n) const
     if (_imp->package_names[n])
         return;
 
-    Context context("When loading versions for '" + stringify(n) + "' in "
-            + stringify(_imp->repository->name()) + ":");
+    Context context([&] { return "When loading versions for '" + stringify(n) + "' in "
+            + stringify(_imp->repository->name()) + ":"; });
 
     std::shared_ptr<PackageIDSequence> v(std::make_shared<PackageIDSequence>());
 
@@ -303,7 +313,7 @@ TraditionalLayout::has_category_named(const CategoryNamePart & c) const
 {
     std::unique_lock<std::recursive_mutex> lock(_imp->big_nasty_mutex);
 
-    Context context("When checking for category '" + stringify(c) + "' in '" + stringify(_imp->repository->name()) + "':");
+    Context context([&] { return "When checking for category '" + stringify(c) + "' in '" + stringify(_imp->repository->name()) + "':"; });
 
     need_category_names();
     return _imp->category_names.end() != _imp->category_names.find(c);
@@ -314,7 +324,7 @@ TraditionalLayout::has_package_named(const QualifiedPackageName & q) const
 {
     std::unique_lock<std::recursive_mutex> lock(_imp->big_nasty_mutex);
 
-    Context context("When checking for package '" + stringify(q) + "' in '" + stringify(_imp->repository->name()) + ":");
+    Context context([&] { return "When checking for package '" + stringify(q) + "' in '" + stringify(_imp->repository->name()) + ":"; });
 
     need_category_names();
 
@@ -365,7 +375,7 @@ TraditionalLayout::category_names() const
 {
     std::unique_lock<std::recursive_mutex> lock(_imp->big_nasty_mutex);
 
-    Context context("When fetching category names in " + stringify(stringify(_imp->repository->name())) + ":");
+    Context context([&] { return "When fetching category names in " + stringify(stringify(_imp->repository->name())) + ":"; });
 
     need_category_names_collection();
     return _imp->category_names_collection;
@@ -382,8 +392,8 @@ TraditionalLayout::package_names(const CategoryNamePart & c) const
      * changing the data structures used to make this faster at the expense of
      * slowing down single item queries. */
 
-    Context context("When fetching package names in category '" + stringify(c)
-            + "' in " + stringify(_imp->repository->name()) + ":");
+    Context context([&] { return "When fetching package names in category '" + stringify(c)
+            + "' in " + stringify(_imp->repository->name()) + ":"; });
 
     need_category_names();
 
@@ -391,22 +401,27 @@ TraditionalLayout::package_names(const CategoryNamePart & c) const
         return std::make_shared<QualifiedPackageNameSet>();
 
     if ((_imp->tree_root / stringify(c)).stat().is_directory_or_symlink_to_directory())
-        for (FSIterator d(_imp->tree_root / stringify(c), { fsio_inode_sort, fsio_deref_symlinks_for_wants, fsio_want_directories }), d_end ; d != d_end ; ++d)
+    {
+        std::vector<std::pair<ino_t, std::string> > entries;
+        for (FSDirectoryReader d(_imp->tree_root / stringify(c)) ; d.next() ; )
+            if ('.' != d.name()[0] && d.name() != "CVS" && d.is_directory_or_symlink_to_directory())
+                entries.emplace_back(d.inode(), d.name());
+        std::sort(entries.begin(), entries.end());
+
+        for (const auto & e : entries)
         {
             try
             {
-                if (d->basename() == "CVS")
-                   continue;
-
-                _imp->package_names.insert(std::make_pair(c + PackageNamePart(d->basename()), false));
+                _imp->package_names.insert(std::make_pair(c + PackageNamePart(e.second), false));
             }
-            catch (const NameError & e)
+            catch (const NameError & x)
             {
                 Log::get_instance()->message("e.traditional_layout.packages.failure", ll_warning, lc_context) << "Skipping entry '" <<
-                    d->basename() << "' in category '" << c << "' in repository '" <<
-                    stringify(_imp->repository->name()) << "' (" << e.message() << ")";
+                    e.second << "' in category '" << c << "' in repository '" <<
+                    stringify(_imp->repository->name()) << "' (" << x.message() << ")";
             }
         }
+    }
 
     _imp->category_names[c] = true;
 
@@ -424,7 +439,7 @@ TraditionalLayout::package_ids(const QualifiedPackageName & n) const
 {
     std::unique_lock<std::recursive_mutex> lock(_imp->big_nasty_mutex);
 
-    Context context("When fetching versions of '" + stringify(n) + "' in " + stringify(_imp->repository->name()) + ":");
+    Context context([&] { return "When fetching versions of '" + stringify(n) + "' in " + stringify(_imp->repository->name()) + ":"; });
 
     if (has_package_named(n))
     {
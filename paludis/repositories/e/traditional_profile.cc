@@ -43,10 +43,13 @@
 #include <paludis/util/fs_stat.hh>
 #include <paludis/util/fs_error.hh>
 #include <paludis/util/upper_lower.hh>
+#include <paludis/util/thread_pool.hh>
+#include <paludis/util/timestamp.hh>
 
 #include <paludis/choice.hh>
 #include <paludis/environment.hh>
 #include <paludis/match_package.hh>
+#include <paludis/package_dep_spec_index.hh>
 #include <paludis/distribution.hh>
 #include <paludis/package_id.hh>
 #include <paludis/metadata_key.hh>
@@ -69,10 +72,6 @@ typedef std::unordered_map<std::string, std::shared_ptr<Set<UnprefixedChoiceName
 namespace
 {
     typedef std::unordered_map<std::string, std::string, Hash<std::string> > EnvironmentVariablesMap;
-    typedef std::unordered_map<QualifiedPackageName,
-            std::list<std::pair<std::shared_ptr<const PackageDepSpec>, std::shared_ptr<const MaskInfo> > >,
-            Hash<QualifiedPackageName> > PackageMaskMap;
-
     typedef std::unordered_map<ChoiceNameWithPrefix, bool, Hash<ChoiceNameWithPrefix> > FlagStatusMap;
     typedef std::list<std::pair<std::shared_ptr<const PackageDepSpec>, FlagStatusMap> > PackageFlagStatusMapList;
 
@@ -97,6 +96,59 @@ namespace
     };
 
     typedef std::list<StackedValues> StackedValuesList;
+
+    /* Everything read from one profile directory, before it is stacked on top
+     * of its parents. Nothing here depends upon any other directory, so these
+     * can be loaded in parallel, and can be shared by every repository whose
+     * profile stack uses the directory. */
+    struct ProfileDirectory
+    {
+        const std::string fingerprint;
+        std::shared_ptr<const KeyValueConfigFile> make_defaults;
+        StackedValues stacked_values;
+
+        ProfileDirectory(const FSPath & dir, const std::string & f) :
+            fingerprint(f),
+            stacked_values(stringify(dir))
+        {
+        }
+    };
+
+    /* One entry for every time a directory is visited, in the order in which
+     * it gets stacked, so a directory inherited twice is here twice. */
+    struct ProfileStackEntry
+    {
+        FSPath dir;
+        std::shared_ptr<const EAPI> eapi;
+        std::shared_ptr<const ProfileDirectory> files;
+    };
+
+    typedef std::vector<ProfileStackEntry> ProfileStack;
+
+    struct ProfileDirectoryCache
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<const ProfileDirectory> > directories;
+    };
+
+    ProfileDirectoryCache & profile_directory_cache()
+    {
+        static ProfileDirectoryCache cache;
+        return cache;
+    }
+
+    const char * const profile_directory_file_names[] = {
+        "make.defaults",
+        "use.mask",
+        "use.force",
+        "package.use",
+        "package.use.mask",
+        "package.use.force",
+        "use.stable.mask",
+        "use.stable.force",
+        "package.use.stable.mask",
+        "package.use.stable.force"
+    };
 }
 
 namespace paludis
@@ -130,7 +182,8 @@ namespace paludis
         mutable std::unordered_map<char, KnownMap> known_choice_value_names_for_separator;
         StackedValuesList stacked_values_list;
 
-        PackageMaskMap package_mask;
+        PackageDepSpecIndex package_mask;
+        std::vector<std::shared_ptr<const MaskInfo> > package_mask_infos;
 
         Imp(const Environment * const e,
                 const EAPIForFileFunction & p,
@@ -148,7 +201,8 @@ namespace paludis
             use_expand_hidden(std::make_shared<Set<std::string>>()),
             use_expand_unprefixed(std::make_shared<Set<std::string>>()),
             use_expand_implicit(std::make_shared<Set<std::string>>()),
-            iuse_implicit(std::make_shared<Set<std::string>>())
+            iuse_implicit(std::make_shared<Set<std::string>>()),
+            package_mask(e)
         {
         }
     };
@@ -158,13 +212,22 @@ namespace
 {
     void load_environment(Pimp<TraditionalProfile> & _imp);
 
-    void load_profile_directory_recursively(
-            Pimp<TraditionalProfile> & _imp,
-            const FSPath & dir);
+    void find_profile_directories_recursively(
+            const EAPIForFileFunction & eapi_for_file,
+            const FSPath & dir,
+            ProfileStack & stack);
+
+    void find_profile_parents(
+            const EAPIForFileFunction & eapi_for_file,
+            const FSPath & dir,
+            ProfileStack & stack);
+
+    void load_profile_directories(
+            ProfileStack & stack);
 
-    void load_profile_parent(
+    void stack_profile_directory(
             Pimp<TraditionalProfile> & _imp,
-            const FSPath & dir);
+            const ProfileStackEntry & entry);
 
     void make_vars_from_file_vars(
             Pimp<TraditionalProfile> & _imp);
@@ -181,7 +244,9 @@ namespace
 
     void load_profile_make_defaults(
             Pimp<TraditionalProfile> & _imp,
-            const FSPath & dir);
+            const FSPath & dir,
+            const EAPI & eapi,
+            const KeyValueConfigFile & file);
 
     void load_basic_use_file(
             const FSPath & file,
@@ -201,9 +266,10 @@ namespace
         _imp->environment_variables["CONFIG_PROTECT_MASK"] = getenv_with_default("CONFIG_PROTECT_MASK", "");
     }
 
-    void load_profile_directory_recursively(
-            Pimp<TraditionalProfile> & _imp,
-            const FSPath & dir)
+    void find_profile_directories_recursively(
+            const EAPIForFileFunction & eapi_for_file,
+            const FSPath & dir,
+            ProfileStack & stack)
     {
         Context context("When adding profile directory '" + stringify(dir) + ":");
 
@@ -214,37 +280,20 @@ namespace
             return;
         }
 
-        auto eapi(EAPIData::get_instance()->eapi_from_string(_imp->eapi_for_file(dir / "use.mask")));
+        auto eapi(EAPIData::get_instance()->eapi_from_string(eapi_for_file(dir / "use.mask")));
         if (! eapi->supported())
             throw ERepositoryConfigurationError("Can't use profile directory '" + stringify(dir) +
                     "' because it uses an unsupported EAPI");
 
-        load_profile_parent(_imp, dir);
-        load_profile_make_defaults(_imp, dir);
+        find_profile_parents(eapi_for_file, dir, stack);
 
-        _imp->stacked_values_list.push_back(StackedValues(stringify(dir)));
-        load_basic_use_file(dir / "use.mask", _imp->stacked_values_list.back().use_mask);
-        load_basic_use_file(dir / "use.force", _imp->stacked_values_list.back().use_force);
-        load_spec_use_file(*eapi, dir / "package.use", _imp->stacked_values_list.back().package_use);
-        load_spec_use_file(*eapi, dir / "package.use.mask", _imp->stacked_values_list.back().package_use_mask);
-        load_spec_use_file(*eapi, dir / "package.use.force", _imp->stacked_values_list.back().package_use_force);
-        if (eapi->supported()->profile_options()->use_stable_mask_force())
-        {
-            load_basic_use_file(dir / "use.stable.mask", _imp->stacked_values_list.back().use_stable_mask);
-            load_basic_use_file(dir / "use.stable.force", _imp->stacked_values_list.back().use_stable_force);
-            load_spec_use_file(*eapi, dir / "package.use.stable.mask", _imp->stacked_values_list.back().package_use_stable_mask);
-            load_spec_use_file(*eapi, dir / "package.use.stable.force", _imp->stacked_values_list.back().package_use_stable_force);
-        }
-
-        _imp->packages_file.add_file(dir / "packages");
-        _imp->package_mask_file.add_file(dir / "package.mask");
-
-        _imp->profiles_with_parents->push_back(dir);
+        stack.push_back(ProfileStackEntry{ dir, eapi, nullptr });
     }
 
-    void load_profile_parent(
-            Pimp<TraditionalProfile> & _imp,
-            const FSPath & dir)
+    void find_profile_parents(
+            const EAPIForFileFunction & eapi_for_file,
+            const FSPath & dir,
+            ProfileStack & stack)
     {
         Context context("When handling parent file for profile directory '" + stringify(dir) + ":");
 
@@ -284,12 +333,133 @@ namespace
                         continue;
                     }
 
-                    load_profile_directory_recursively(_imp, parent_dir);
+                    find_profile_directories_recursively(eapi_for_file, parent_dir, stack);
 
                 } while (false);
             }
     }
 
+    /* Good enough to tell whether a cached ProfileDirectory is still usable,
+     * and no more expensive than the existence checks we'd make anyway. */
+    std::string profile_directory_fingerprint(
+            const FSPath & dir)
+    {
+        std::string result;
+        for (const auto & name : profile_directory_file_names)
+        {
+            FSStat s(dir / name);
+            if (s.exists())
+                result.append(stringify(s.mtim().seconds()) + "." + stringify(s.mtim().nanoseconds()) + "."
+                        + (s.is_regular_file() ? stringify(s.file_size()) : "") + " ");
+            else
+                result.append("- ");
+        }
+        return result;
+    }
+
+    std::shared_ptr<const ProfileDirectory> load_profile_directory(
+            const FSPath & dir,
+            const EAPI & eapi,
+            const std::string & fingerprint)
+    {
+        Context context("When loading profile directory '" + stringify(dir) + "':");
+
+        auto result(std::make_shared<ProfileDirectory>(dir, fingerprint));
+
+        if ((dir / "make.defaults").stat().exists())
+            result->make_defaults = std::make_shared<KeyValueConfigFile>(dir / "make.defaults", KeyValueConfigFileOptions{
+                    kvcfo_disallow_source, kvcfo_disallow_space_inside_unquoted_values, kvcfo_allow_inline_comments,
+                    kvcfo_allow_multiple_assigns_per_line },
+                    &KeyValueConfigFile::no_defaults, &KeyValueConfigFile::no_transformation);
+
+        StackedValues & values(result->stacked_values);
+        load_basic_use_file(dir / "use.mask", values.use_mask);
+        load_basic_use_file(dir / "use.force", values.use_force);
+        load_spec_use_file(eapi, dir / "package.use", values.package_use);
+        load_spec_use_file(eapi, dir / "package.use.mask", values.package_use_mask);
+        load_spec_use_file(eapi, dir / "package.use.force", values.package_use_force);
+        if (eapi.supported()->profile_options()->use_stable_mask_force())
+        {
+            load_basic_use_file(dir / "use.stable.mask", values.use_stable_mask);
+            load_basic_use_file(dir / "use.stable.force", values.use_stable_force);
+            load_spec_use_file(eapi, dir / "package.use.stable.mask", values.package_use_stable_mask);
+            load_spec_use_file(eapi, dir / "package.use.stable.force", values.package_use_stable_force);
+        }
+
+        return result;
+    }
+
+    /* Fill in the files for every entry in the stack, reusing anything an
+     * earlier profile (for this or another repository) loaded if it hasn't
+     * changed since, and reading everything else in parallel. */
+    void load_profile_directories(
+            ProfileStack & stack)
+    {
+        struct Job
+        {
+            FSPath dir;
+            std::shared_ptr<const EAPI> eapi;
+            std::string key;
+            std::string fingerprint;
+            std::shared_ptr<const ProfileDirectory> files;
+        };
+
+        std::vector<Job> jobs;
+        std::unordered_map<std::string, std::size_t> jobs_by_key;
+        for (const auto & entry : stack)
+        {
+            std::string key(stringify(entry.dir) + " " + entry.eapi->name());
+            if (jobs_by_key.insert(std::make_pair(key, jobs.size())).second)
+                jobs.push_back(Job{ entry.dir, entry.eapi, key, profile_directory_fingerprint(entry.dir), nullptr });
+        }
+
+        std::vector<Job *> to_load;
+        {
+            ProfileDirectoryCache & cache(profile_directory_cache());
+            std::unique_lock<std::mutex> lock(cache.mutex);
+            for (auto & job : jobs)
+            {
+                auto c(cache.directories.find(job.key));
+                if (cache.directories.end() != c && c->second->fingerprint == job.fingerprint)
+                    job.files = c->second;
+                else
+                    to_load.push_back(&job);
+            }
+        }
+
+        parallel_for_each(to_load.size(), [&] (std::size_t n) {
+                to_load[n]->files = load_profile_directory(to_load[n]->dir, *to_load[n]->eapi, to_load[n]->fingerprint);
+                });
+
+        if (! to_load.empty())
+        {
+            ProfileDirectoryCache & cache(profile_directory_cache());
+            std::unique_lock<std::mutex> lock(cache.mutex);
+            for (const auto & job : to_load)
+                cache.directories[job->key] = job->files;
+        }
+
+        for (auto & entry : stack)
+            entry.files = jobs[jobs_by_key.find(stringify(entry.dir) + " " + entry.eapi->name())->second].files;
+    }
+
+    void stack_profile_directory(
+            Pimp<TraditionalProfile> & _imp,
+            const ProfileStackEntry & entry)
+    {
+        Context context("When adding profile directory '" + stringify(entry.dir) + ":");
+
+        if (entry.files->make_defaults)
+            load_profile_make_defaults(_imp, entry.dir, *entry.eapi, *entry.files->make_defaults);
+
+        _imp->stacked_values_list.push_back(entry.files->stacked_values);
+
+        _imp->packages_file.add_file(entry.dir / "packages");
+        _imp->package_mask_file.add_file(entry.dir / "package.mask");
+
+        _imp->profiles_with_parents->push_back(entry.dir);
+    }
+
     void make_vars_from_file_vars(
             Pimp<TraditionalProfile> & _imp)
     {
@@ -327,13 +497,15 @@ namespace
 
             try
             {
-                std::shared_ptr<const PackageDepSpec> a(std::make_shared<PackageDepSpec>(
-                            parse_elike_package_dep_spec(line.second.first,
-                                line.first->supported()->package_dep_spec_parse_options(),
-                                line.first->supported()->version_spec_options())));
+                auto a(parse_elike_package_dep_spec(line.second.first,
+                            line.first->supported()->package_dep_spec_parse_options(),
+                            line.first->supported()->version_spec_options()));
 
-                if (a->package_ptr())
-                    _imp->package_mask[*a->package_ptr()].push_back(std::make_pair(a, line.second.second));
+                if (a.package_ptr())
+                {
+                    _imp->package_mask.insert(a);
+                    _imp->package_mask_infos.push_back(line.second.second);
+                }
                 else
                     Log::get_instance()->message("e.profile.package_mask.bad_spec", ll_warning, lc_context)
                         << "Loading package.mask spec '" << line.second.first << "' failed because specification does not restrict to a "
@@ -501,24 +673,15 @@ namespace
 
     void load_profile_make_defaults(
             Pimp<TraditionalProfile> & _imp,
-            const FSPath & dir)
+            const FSPath & dir,
+            const EAPI & eapi,
+            const KeyValueConfigFile & file)
     {
         Context context("When handling make.defaults file for profile directory '" + stringify(dir) + ":");
 
-        if (! (dir / "make.defaults").stat().exists())
-            return;
-
-        auto eapi(EAPIData::get_instance()->eapi_from_string(_imp->eapi_for_file(dir / "make.defaults")));
-        if (! eapi->supported())
-            throw ERepositoryConfigurationError("Can't use profile directory '" + stringify(dir) +
-                    "' because it uses an unsupported EAPI");
-
-        KeyValueConfigFile file(dir / "make.defaults", { kvcfo_disallow_source, kvcfo_disallow_space_inside_unquoted_values, kvcfo_allow_inline_comments, kvcfo_allow_multiple_assigns_per_line },
-                &KeyValueConfigFile::no_defaults, &KeyValueConfigFile::no_transformation);
-
         for (const auto & kv : file)
         {
-            if (is_incremental(*eapi, kv.first))
+            if (is_incremental(eapi, kv.first))
             {
                 std::list<std::string> val;
                 std::list<std::string> val_add;
@@ -543,7 +706,7 @@ namespace
                 _imp->environment_variables[kv.first] = kv.second;
         }
 
-        std::string use_expand_var(eapi->supported()->ebuild_environment_variables()->env_use_expand());
+        std::string use_expand_var(eapi.supported()->ebuild_environment_variables()->env_use_expand());
         try
         {
             _imp->use_expand->clear();
@@ -560,7 +723,7 @@ namespace
                 << "Loading '" << use_expand_var << "' failed due to exception: " << e.message() << " (" << e.what() << ")";
         }
 
-        std::string use_expand_unprefixed_var(eapi->supported()->ebuild_environment_variables()->env_use_expand_unprefixed());
+        std::string use_expand_unprefixed_var(eapi.supported()->ebuild_environment_variables()->env_use_expand_unprefixed());
         try
         {
             _imp->use_expand_unprefixed->clear();
@@ -577,7 +740,7 @@ namespace
                 << "Loading '" << use_expand_unprefixed_var << "' failed due to exception: " << e.message() << " (" << e.what() << ")";
         }
 
-        std::string use_expand_implicit_var(eapi->supported()->ebuild_environment_variables()->env_use_expand_implicit());
+        std::string use_expand_implicit_var(eapi.supported()->ebuild_environment_variables()->env_use_expand_implicit());
         try
         {
             _imp->use_expand_implicit->clear();
@@ -594,7 +757,7 @@ namespace
                 << "Loading '" << use_expand_implicit_var << "' failed due to exception: " << e.message() << " (" << e.what() << ")";
         }
 
-        std::string iuse_implicit_var(eapi->supported()->ebuild_environment_variables()->env_iuse_implicit());
+        std::string iuse_implicit_var(eapi.supported()->ebuild_environment_variables()->env_iuse_implicit());
         try
         {
             _imp->iuse_implicit->clear();
@@ -611,7 +774,7 @@ namespace
                 << "Loading '" << iuse_implicit_var << "' failed due to exception: " << e.message() << " (" << e.what() << ")";
         }
 
-        std::string use_expand_values_part_var(eapi->supported()->ebuild_environment_variables()->env_use_expand_values_part());
+        std::string use_expand_values_part_var(eapi.supported()->ebuild_environment_variables()->env_use_expand_values_part());
         try
         {
             _imp->use_expand_values.clear();
@@ -757,6 +920,7 @@ TraditionalProfile::TraditionalProfile(
 
     load_environment(_imp);
 
+    ProfileStack stack;
     for (const auto & dir : dirs)
     {
         Context subcontext("When using directory '" + stringify(dir) + "':");
@@ -766,9 +930,13 @@ TraditionalProfile::TraditionalProfile(
                 Log::get_instance()->message("e.profile.deprecated", ll_warning, lc_context) << "Profile directory '" << dir
                     << "' is deprecated. See the file '" << (dir / "deprecated") << "' for details";
 
-        load_profile_directory_recursively(_imp, dir);
+        find_profile_directories_recursively(_imp->eapi_for_file, dir, stack);
     }
 
+    load_profile_directories(stack);
+    for (const auto & entry : stack)
+        stack_profile_directory(_imp, entry);
+
     make_vars_from_file_vars(_imp);
     load_special_make_defaults_vars(_imp, *dirs.begin());
     add_use_expand_to_use(_imp);
@@ -1000,13 +1168,8 @@ const std::shared_ptr<const MasksInfo>
 TraditionalProfile::profile_masks(const std::shared_ptr<const PackageID> & id) const
 {
     auto result(std::make_shared<MasksInfo>());
-    PackageMaskMap::const_iterator rr(_imp->package_mask.find(id->name()));
-    if (_imp->package_mask.end() != rr)
-    {
-        for (const auto & k : rr->second)
-            if (match_package(*_imp->env, *k.first, id, nullptr, { }))
-                result->push_back(*k.second);
-    }
+    for (const auto & p : *_imp->package_mask.matching_positions(id))
+        result->push_back(*_imp->package_mask_infos[p]);
 
     return result;
 }
@@ -0,0 +1,93 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/repositories/e/traditional_profile.hh>
+
+#include <paludis/environments/test/test_environment.hh>
+
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/sequence.hh>
+#include <paludis/util/join.hh>
+#include <paludis/util/safe_ofstream.hh>
+#include <paludis/util/wrapped_forward_iterator.hh>
+#include <paludis/util/indirect_iterator-impl.hh>
+
+#include <paludis/name.hh>
+#include <paludis/choice.hh>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+using namespace paludis::erepository;
+
+namespace
+{
+    std::shared_ptr<TraditionalProfile> make_profile(const Environment * const env, const std::string & dir)
+    {
+        FSPathSequence dirs;
+        dirs.push_back(FSPath::cwd() / "traditional_profile_TEST_dir" / "profiles" / dir);
+
+        return std::make_shared<TraditionalProfile>(env, RepositoryName("repo"),
+                [] (const FSPath &) { return "0"; },
+                [] (const UnprefixedChoiceName &) { return false; },
+                dirs, "", false, false, false);
+    }
+
+    std::string profile_names(const TraditionalProfile & profile)
+    {
+        std::string result;
+        for (const auto & dir : *profile.profiles_with_parents())
+            result.append((result.empty() ? "" : " ") + dir.basename());
+        return result;
+    }
+}
+
+TEST(TraditionalProfile, Stacking)
+{
+    TestEnvironment env;
+    auto profile(make_profile(&env, "child"));
+
+    /* base is inherited twice, and so is stacked twice */
+    EXPECT_EQ("base base extra child", profile_names(*profile));
+    EXPECT_EQ("b b e c", profile->environment_variable("USE"));
+    EXPECT_EQ("y", profile->environment_variable("FOO"));
+    EXPECT_EQ("FOO", join(profile->use_expand()->begin(), profile->use_expand()->end(), " "));
+}
+
+TEST(TraditionalProfile, Reload)
+{
+    TestEnvironment env;
+
+    auto first(make_profile(&env, "extra"));
+    EXPECT_EQ("a b e", first->environment_variable("USE"));
+
+    auto second(make_profile(&env, "extra"));
+    EXPECT_EQ("a b e", second->environment_variable("USE"));
+
+    {
+        SafeOFStream f(FSPath::cwd() / "traditional_profile_TEST_dir" / "profiles" / "extra" / "make.defaults", -1, true);
+        f << "USE=\"-b e f\"" << std::endl;
+    }
+
+    auto third(make_profile(&env, "extra"));
+    EXPECT_EQ("a e f", third->environment_variable("USE"));
+    EXPECT_EQ("x", third->environment_variable("FOO"));
+    EXPECT_EQ("a b e", first->environment_variable("USE"));
+}
@@ -0,0 +1,29 @@
+#!/usr/bin/env bash
+# vim: set ft=sh sw=4 sts=4 et :
+
+mkdir traditional_profile_TEST_dir || exit 1
+cd traditional_profile_TEST_dir || exit 1
+
+mkdir -p profiles/{base,extra,child} || exit 1
+
+cat <<END > profiles/base/make.defaults
+USE="a b"
+USE_EXPAND="FOO"
+FOO="x"
+END
+
+cat <<END > profiles/extra/parent
+../base
+END
+cat <<END > profiles/extra/make.defaults
+USE="e"
+FOO="y"
+END
+
+cat <<END > profiles/child/parent
+../base
+../extra
+END
+cat <<END > profiles/child/make.defaults
+USE="-a c"
+END
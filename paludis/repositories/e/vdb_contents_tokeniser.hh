@@ -32,47 +32,52 @@ namespace paludis
                 VDBContentsTokeniser();
 
             public:
-                template <typename Iter_>
-                static bool tokenise(const std::string &, Iter_);
+                /**
+                 * Works on a std::string or a std::string_view, giving
+                 * tokens of the same type.
+                 */
+                template <typename String_, typename Iter_>
+                static bool tokenise(const String_ &, Iter_);
         };
 
-        template <typename Iter_>
+        template <typename String_, typename Iter_>
         bool
-        VDBContentsTokeniser::tokenise(const std::string & s, Iter_ iter)
+        VDBContentsTokeniser::tokenise(const String_ & s, Iter_ iter)
         {
-            static const std::string space(" \t\r\n");
+            typedef typename String_::size_type size_type;
+            static const char * const space(" \t\r\n");
 
-            std::string::size_type type_begin(s.find_first_not_of(space));
-            if (std::string::npos == type_begin)
+            size_type type_begin(s.find_first_not_of(space));
+            if (String_::npos == type_begin)
                 return false;
 
-            std::string::size_type type_end(s.find_first_of(space, type_begin + 1));
+            size_type type_end(s.find_first_of(space, type_begin + 1));
             // need at least one character for the filename after the
             // whitespace
-            if (std::string::npos == type_end || s.length() <= type_end + 1)
+            if (String_::npos == type_end || s.length() <= type_end + 1)
                 return false;
             // skip the whitespace
-            std::string::size_type filename_begin(type_end + 1);
+            size_type filename_begin(type_end + 1);
 
-            std::string type(s.substr(type_begin, type_end - type_begin));
+            const String_ type(s.substr(type_begin, type_end - type_begin));
             int extra_fields(0);
             if ("obj" == type)
                 extra_fields = 2;
             else if ("sym" == type)
                 extra_fields = 1;
 
-            std::string::size_type filename_end(s.length());
+            size_type filename_end(s.length());
             for (int x(0); x < extra_fields; ++x)
             {
                 // filename_end is exclusive, but the second argument
                 // to find_last_not_of is inclusive
-                std::string::size_type extra_end(s.find_last_not_of(space, filename_end - 1));
-                if (std::string::npos == extra_end || extra_end <= filename_begin)
+                size_type extra_end(s.find_last_not_of(space, filename_end - 1));
+                if (String_::npos == extra_end || extra_end <= filename_begin)
                     return false;
                 // filename_end will point /at/ the delimeter space,
                 // which is fine because it's exclusive
                 filename_end = s.find_last_of(space, extra_end);
-                if (std::string::npos == filename_end || filename_end <= filename_begin)
+                if (String_::npos == filename_end || filename_end <= filename_begin)
                     return false;
             }
 
@@ -80,8 +85,8 @@ namespace paludis
             {
                 // need at least one character each for the symlink
                 // name itself and the target
-                std::string::size_type arrow_begin(s.find(" -> ", filename_begin + 1));
-                if (std::string::npos == arrow_begin || arrow_begin >= filename_end - 4)
+                size_type arrow_begin(s.find(" -> ", filename_begin + 1));
+                if (String_::npos == arrow_begin || arrow_begin >= filename_end - 4)
                     return false;
 
                 *iter++ = type;
@@ -96,11 +101,11 @@ namespace paludis
 
             // none of these finds should fail because we already
             // counted the extra fields above
-            std::string::size_type pos(filename_end + 1);
+            size_type pos(filename_end + 1);
             for (int x(0); x < extra_fields; ++x)
             {
-                std::string::size_type extra_begin(s.find_first_not_of(space, pos));
-                std::string::size_type extra_end(s.find_first_of(space, extra_begin + 1));
+                size_type extra_begin(s.find_first_not_of(space, pos));
+                size_type extra_end(s.find_first_of(space, extra_begin + 1));
                 *iter++ = s.substr(extra_begin, extra_end - extra_begin);
                 pos = extra_end + 1;
             }
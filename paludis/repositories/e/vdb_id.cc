@@ -24,17 +24,94 @@
 #include <paludis/util/fs_stat.hh>
 #include <paludis/util/stringify.hh>
 #include <paludis/util/log.hh>
-#include <paludis/util/safe_ifstream.hh>
-#include <paludis/util/destringify.hh>
+#include <paludis/util/mapped_file.hh>
+#include <paludis/util/make_named_values.hh>
 #include <paludis/util/timestamp.hh>
 #include <paludis/contents.hh>
 #include <paludis/literal_metadata_key.hh>
 
+#include <functional>
 #include <vector>
 
 using namespace paludis;
 using namespace paludis::erepository;
 
+namespace
+{
+    bool check_contents_line(const std::string_view & line, const unsigned line_number)
+    {
+        std::string_view tokens[4];
+        if (! VDBContentsTokeniser::tokenise(line, tokens))
+        {
+            Log::get_instance()->message("e.contents.broken", ll_warning, lc_context) << "CONTENTS has broken line '" <<
+                line_number << "', skipping";
+            return false;
+        }
+
+        if ("obj" == tokens[0] || "sym" == tokens[0])
+            parse_contents_mtime(tokens[3]);
+        else if (! ("dir" == tokens[0] || "misc" == tokens[0] || "fif" == tokens[0] || "dev" == tokens[0]))
+        {
+            Log::get_instance()->message("e.contents.unknown", ll_warning, lc_context) << "CONTENTS has unsupported entry type '" <<
+                tokens[0] << "', skipping";
+            return false;
+        }
+
+        return true;
+    }
+
+    /* only called for lines check_contents_line accepted */
+    std::shared_ptr<const ContentsEntry> decode_contents_line(const std::string & context_text, const std::string_view & line)
+    {
+        // NOTE(compnerd) VDB does not support parts
+        static const std::string kNoPart = "";
+
+        Context context([&context_text] () { return context_text; });
+
+        std::string_view tokens[4];
+        VDBContentsTokeniser::tokenise(line, tokens);
+
+        if ("obj" == tokens[0])
+        {
+            auto e(std::make_shared<ContentsFileEntry>(FSPath(std::string(tokens[1])),
+                                                       kNoPart));
+            e->add_metadata_key(std::make_shared<LiteralMetadataTimeKey>("mtime", "mtime", mkt_normal,
+                            Timestamp(parse_contents_mtime(tokens[3]), 0)));
+            e->add_metadata_key(std::make_shared<LiteralMetadataValueKey<std::string>>("md5", "md5", mkt_normal, std::string(tokens[2])));
+            return e;
+        }
+        else if ("dir" == tokens[0])
+            return std::make_shared<ContentsDirEntry>(FSPath(std::string(tokens[1])));
+        else if ("sym" == tokens[0])
+        {
+            auto e(std::make_shared<ContentsSymEntry>(FSPath(std::string(tokens[1])),
+                                                      std::string(tokens[2]), kNoPart));
+            e->add_metadata_key(std::make_shared<LiteralMetadataTimeKey>("mtime", "mtime", mkt_normal,
+                            Timestamp(parse_contents_mtime(tokens[3]), 0)));
+            return e;
+        }
+        else
+            return std::make_shared<ContentsOtherEntry>(FSPath(std::string(tokens[1])));
+    }
+
+    /* only called for lines check_contents_line accepted */
+    ContentsEntryView view_contents_line(const std::string_view & line)
+    {
+        std::string_view tokens[4];
+        VDBContentsTokeniser::tokenise(line, tokens);
+
+        const bool obj("obj" == tokens[0]), sym("sym" == tokens[0]);
+        return make_named_values<ContentsEntryView>(
+                n::is_volatile() = false,
+                n::md5() = obj ? tokens[2] : std::string_view(),
+                n::mtime() = (obj || sym) ? tokens[3] : std::string_view(),
+                n::path() = tokens[1],
+                n::target() = sym ? tokens[2] : std::string_view(),
+                n::type() = obj ? et_file : sym ? et_sym : "dir" == tokens[0] ? et_dir : et_misc
+                );
+    }
+}
+
 VDBID::VDBID(const QualifiedPackageName & q, const VersionSpec & v,
         const Environment * const e,
         const RepositoryName & r,
@@ -64,66 +141,17 @@ VDBID::contents_filename() const
 const std::shared_ptr<const Contents>
 VDBID::contents() const
 {
-    // NOTE(compnerd) VDB does not support parts
-    static const std::string kNoPart = "";
-
     FSPath contents_location(fs_location_key()->parse_value() / "CONTENTS");
     Context context("When creating contents from '" + stringify(contents_location) + "':");
 
-    auto value(std::make_shared<Contents>());
-
     if (! contents_location.stat().is_regular_file_or_symlink_to_regular_file())
     {
         Log::get_instance()->message("e.contents.not_a_file", ll_warning, lc_context) << "Could not read CONTENTS file '" <<
             contents_location << "'";
-        return value;
+        return std::make_shared<Contents>();
     }
 
-    SafeIFStream ff(contents_location);
-
-    std::string line;
-    unsigned line_number(0);
-    while (std::getline(ff, line))
-    {
-        ++line_number;
-
-        std::vector<std::string> tokens;
-        if (! VDBContentsTokeniser::tokenise(line, std::back_inserter(tokens)))
-        {
-            Log::get_instance()->message("e.contents.broken", ll_warning, lc_context) << "CONTENTS has broken line '" <<
-                line_number << "', skipping";
-            continue;
-        }
-
-        if ("obj" == tokens.at(0))
-        {
-            auto e(std::make_shared<ContentsFileEntry>(FSPath(tokens.at(1)),
-                                                       kNoPart));
-            e->add_metadata_key(std::make_shared<LiteralMetadataTimeKey>("mtime", "mtime", mkt_normal,
-                            Timestamp(destringify<time_t>(tokens.at(3)), 0)));
-            e->add_metadata_key(std::make_shared<LiteralMetadataValueKey<std::string>>("md5", "md5", mkt_normal, tokens.at(2)));
-            value->add(e);
-        }
-        else if ("dir" == tokens.at(0))
-        {
-            std::shared_ptr<ContentsEntry> e(std::make_shared<ContentsDirEntry>(FSPath(tokens.at(1))));
-            value->add(e);
-        }
-        else if ("sym" == tokens.at(0))
-        {
-            auto e(std::make_shared<ContentsSymEntry>(FSPath(tokens.at(1)),
-                                                      tokens.at(2), kNoPart));
-            e->add_metadata_key(std::make_shared<LiteralMetadataTimeKey>("mtime", "mtime", mkt_normal,
-                            Timestamp(destringify<time_t>(tokens.at(3)), 0)));
-            value->add(e);
-        }
-        else if ("misc" == tokens.at(0) || "fif" == tokens.at(0) || "dev" == tokens.at(0))
-            value->add(std::make_shared<ContentsOtherEntry>(FSPath(tokens.at(1))));
-        else
-            Log::get_instance()->message("e.contents.unknown", ll_warning, lc_context) << "CONTENTS has unsupported entry type '" <<
-                tokens.at(0) << "', skipping";
-    }
-
-    return value;
+    return std::make_shared<Contents>(std::make_shared<MappedFile>(contents_location), &check_contents_line,
+            std::bind(&decode_contents_line, "When decoding contents from '" + stringify(contents_location) + "':",
+                std::placeholders::_1), &view_contents_line);
 }
-
@@ -59,13 +59,15 @@ namespace paludis
         VDBMergerParams params;
         FSPath realroot;
         std::shared_ptr<SafeOFStream> contents_file;
+        unsigned long installed_size;
 
         std::list<std::string> config_protect;
         std::list<std::string> config_protect_mask;
 
         Imp(const VDBMergerParams & p) :
             params(p),
-            realroot(params.root().realpath())
+            realroot(params.root().realpath()),
+            installed_size(0)
         {
             tokenise_whitespace(params.config_protect(), std::back_inserter(config_protect));
             tokenise_whitespace(params.config_protect_mask(), std::back_inserter(config_protect_mask));
@@ -152,7 +154,8 @@ VDBMerger::record_install_file(const FSPath & src, const FSPath & dst_dir, const
 
     const std::string tidy(stringify(renamed_file.strip_leading(_imp->realroot)));
     const std::string tidy_real(stringify(file.strip_leading(_imp->realroot)));
-    const Timestamp timestamp(renamed_file.stat().mtim());
+    const FSStat renamed_file_stat(renamed_file.stat());
+    const Timestamp timestamp(renamed_file_stat.mtim());
 
     SafeIFStream infile(renamed_file);
     if (! infile)
@@ -164,6 +167,7 @@ VDBMerger::record_install_file(const FSPath & src, const FSPath & dst_dir, const
                   src.basename() == dst_name ? "" : dst_name);
 
     *_imp->contents_file << "obj " << tidy_real << " " << md5.hexsum() << " " << timestamp.seconds() << std::endl;
+    _imp->installed_size += renamed_file_stat.file_size();
 }
 
 void
@@ -288,7 +292,11 @@ VDBMerger::merge()
 {
     display_override(">>> Merging to " + stringify(_imp->params.root()));
     _imp->contents_file = std::make_shared<SafeOFStream>(_imp->params.contents_file(), -1, false);
+    _imp->installed_size = 0;
     FSMerger::merge();
+
+    SafeOFStream size_file(_imp->params.size_file(), -1, false);
+    size_file << _imp->installed_size << std::endl;
 }
 
 bool
@@ -42,6 +42,7 @@ namespace paludis
         typedef Name<struct name_package_id> package_id;
         typedef Name<struct name_permit_destination> permit_destination;
         typedef Name<struct name_root> root;
+        typedef Name<struct name_size_file> size_file;
     }
 
     /**
@@ -68,6 +69,7 @@ namespace paludis
         NamedValue<n::package_id, std::shared_ptr<const PackageID> > package_id;
         NamedValue<n::permit_destination, PermitDestinationFn> permit_destination;
         NamedValue<n::root, FSPath> root;
+        NamedValue<n::size_file, FSPath> size_file;
     };
 
     /**
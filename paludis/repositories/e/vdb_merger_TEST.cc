@@ -114,7 +114,8 @@ namespace
                         n::output_manager() = std::make_shared<StandardOutputManager>(),
                         n::package_id() = nullptr,
                         n::permit_destination() = std::bind(return_literal_function(true)),
-                        n::root() = root_dir
+                        n::root() = root_dir,
+                        n::size_file() = FSPath::cwd() / "vdb_merger_TEST_dir" / (target + "_size")
                         ));
         }
 
@@ -194,6 +195,8 @@ TEST_P(VDBMergerTestConfigProtect, ConfigProtect)
 
     EXPECT_EQ("foo", file_contents(root_dir / "protected_dir_not_really/unprotected_file"));
     EXPECT_TRUE(! (root_dir / "protected_dir_not_really/._cfg0000_unprotected_file").stat().exists());
+
+    EXPECT_EQ("48", file_contents(FSPath::cwd() / "vdb_merger_TEST_dir" / (target + "_size")));
 }
 
 INSTANTIATE_TEST_SUITE_P(ConfigProtect, VDBMergerTestConfigProtect, testing::Values(std::string("config_protect")));
@@ -74,6 +74,7 @@
 #include <paludis/util/timestamp.hh>
 #include <paludis/util/destringify.hh>
 #include <paludis/util/fs_stat.hh>
+#include <paludis/util/fs_directory_reader.hh>
 #include <paludis/util/fs_iterator.hh>
 #include <paludis/util/join.hh>
 #include <paludis/util/return_literal_function.hh>
@@ -706,7 +707,8 @@ VDBRepository::merge(const MergeParams & m)
                 n::output_manager() = m.output_manager(),
                 n::package_id() = m.package_id(),
                 n::permit_destination() = m.permit_destination(),
-                n::root() = installed_root_key()->parse_value()
+                n::root() = installed_root_key()->parse_value(),
+                n::size_file() = vdb_dir / "SIZE"
             ));
 
     (m.used_this_for_config_protect())(config_protect);
@@ -813,20 +815,29 @@ VDBRepository::need_category_names() const
 
     Context context("When loading category names from '" + stringify(_imp->params.location()) + "':");
 
-    for (FSIterator d(_imp->params.location(), { fsio_inode_sort, fsio_want_directories, fsio_deref_symlinks_for_wants }), d_end ; d != d_end ; ++d)
+    /* visit in inode order, which is usually the order things are on disk */
+    std::vector<std::pair<ino_t, std::string> > entries;
+    for (FSDirectoryReader d(_imp->params.location()) ; d.next() ; )
+        if ('.' != d.name()[0] && d.is_directory_or_symlink_to_directory())
+            entries.emplace_back(d.inode(), d.name());
+    std::sort(entries.begin(), entries.end());
+
+    for (const auto & e : entries)
+    {
         try
         {
-            _imp->categories.insert(std::make_pair(CategoryNamePart(d->basename()), nullptr));
+            _imp->categories.insert(std::make_pair(CategoryNamePart(e.second), nullptr));
         }
         catch (const InternalError &)
         {
             throw;
         }
-        catch (const Exception & e)
+        catch (const Exception & x)
         {
             Log::get_instance()->message("e.vdb.categories.failure", ll_warning, lc_context) << "Skipping VDB category dir '"
-                << *d << "' due to exception '" << e.message() << "' (" << e.what() << ")";
+                << (_imp->params.location() / e.second) << "' due to exception '" << x.message() << "' (" << x.what() << ")";
         }
+    }
 
     _imp->has_category_names = true;
 }
@@ -844,31 +855,36 @@ VDBRepository::need_package_ids(const CategoryNamePart & c) const
 
     std::shared_ptr<QualifiedPackageNameSet> q(std::make_shared<QualifiedPackageNameSet>());
 
-    for (FSIterator d(_imp->params.location() / stringify(c), { fsio_inode_sort, fsio_want_directories, fsio_deref_symlinks_for_wants }), d_end ;
-            d != d_end ; ++d)
+    std::vector<std::pair<ino_t, std::string> > entries;
+    for (FSDirectoryReader d(_imp->params.location() / stringify(c)) ; d.next() ; )
+        if ('.' != d.name()[0] && std::string_view::npos != d.name().rfind('-') && d.is_directory_or_symlink_to_directory())
+            entries.emplace_back(d.inode(), d.name());
+    std::sort(entries.begin(), entries.end());
+
+    for (const auto & e : entries)
+    {
+        FSPath dir(_imp->params.location() / stringify(c) / e.second);
+
         try
         {
-            std::string s(d->basename());
-            if (std::string::npos == s.rfind('-'))
-                continue;
-
-            PackageDepSpec p(parse_user_package_dep_spec("=" + stringify(c) + "/" + s,
+            PackageDepSpec p(parse_user_package_dep_spec("=" + stringify(c) + "/" + e.second,
                         _imp->params.environment(), { }));
             q->insert(*p.package_ptr());
             IDMap::iterator i(_imp->ids.find(*p.package_ptr()));
             if (_imp->ids.end() == i)
                 i = _imp->ids.insert(std::make_pair(*p.package_ptr(), std::make_shared<PackageIDSequence>())).first;
-            i->second->push_back(make_id(*p.package_ptr(), p.version_requirements_ptr()->begin()->version_spec(), *d));
+            i->second->push_back(make_id(*p.package_ptr(), p.version_requirements_ptr()->begin()->version_spec(), dir));
         }
         catch (const InternalError &)
         {
             throw;
         }
-        catch (const Exception & e)
+        catch (const Exception & x)
         {
             Log::get_instance()->message("e.vdb.packages.failure", ll_warning, lc_context) << "Skipping VDB package dir '"
-                << *d << "' due to exception '" << e.message() << "' (" << e.what() << ")";
+                << dir << "' due to exception '" << x.message() << "' (" << x.what() << ")";
         }
+    }
 
     _imp->categories[c] = q;
 }
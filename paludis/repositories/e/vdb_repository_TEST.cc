@@ -30,6 +30,7 @@
 #include <paludis/util/fs_iterator.hh>
 #include <paludis/util/fs_stat.hh>
 #include <paludis/util/join.hh>
+#include <paludis/util/destringify.hh>
 
 #include <paludis/metadata_key.hh>
 #include <paludis/standard_output_manager.hh>
@@ -118,6 +119,12 @@ namespace
         }
     };
 
+    std::string describe(const ContentsEntryView & e)
+    {
+        return stringify(e.type()) + "|" + std::string(e.path()) + "|" + std::string(e.md5()) + "|" +
+            std::string(e.mtime()) + "|" + std::string(e.target()) + "\n";
+    }
+
     void install(const Environment & env,
             const std::shared_ptr<Repository> & vdb_repo,
             const std::string & chosen_one,
@@ -246,6 +253,72 @@ TEST(VDBRepository, Contents)
             "other\n/miscellaneous with spaces\n"
             "other\n/miscellaneous  with  consecutive  spaces\n",
         gatherer._str);
+
+    ContentsGatherer again;
+    std::for_each(indirect_iterator(contents->begin()),
+                  indirect_iterator(contents->end()),
+                  accept_visitor(again));
+    EXPECT_EQ(gatherer._str, again._str);
+    EXPECT_EQ(*contents->begin(), *contents->begin());
+}
+
+TEST(VDBRepository, ContentsViews)
+{
+    TestEnvironment env;
+    std::shared_ptr<Map<std::string, std::string> > keys(std::make_shared<Map<std::string, std::string>>());
+    keys->insert("format", "vdb");
+    keys->insert("names_cache", "/var/empty");
+    keys->insert("location", stringify(FSPath::cwd() / "vdb_repository_TEST_dir" / "repo1"));
+    keys->insert("builddir", stringify(FSPath::cwd() / "vdb_repository_TEST_dir" / "build"));
+    keys->insert("world", stringify(FSPath::cwd() / "vdb_repository_TEST_dir" / "world-no-match-no-eol"));
+    std::shared_ptr<Repository> repo(VDBRepository::VDBRepository::repository_factory_create(&env,
+                std::bind(from_keys, keys, std::placeholders::_1)));
+    env.add_repository(1, repo);
+
+    std::shared_ptr<const PackageID> e1(*env[selection::RequireExactlyOne(generator::Matches(
+                    PackageDepSpec(parse_user_package_dep_spec("=cat-one/pkg-one-1",
+                            &env, { })), nullptr, { }))]->begin());
+    auto contents(e1->contents());
+
+    std::string viewed;
+    unsigned count(0);
+    contents->for_each_view([&] (const ContentsEntryView & e) {
+            viewed += describe(e);
+            ++count;
+            return true;
+            });
+    EXPECT_EQ(25u, count);
+
+    std::string decoded;
+    for (const auto & e : *contents)
+        view_contents_entry(*e, [&] (const ContentsEntryView & v) { decoded += describe(v); });
+    EXPECT_EQ(decoded, viewed);
+
+    unsigned stopped_after(0);
+    contents->for_each_view([&] (const ContentsEntryView & e) {
+            ++stopped_after;
+            return e.type() != et_sym;
+            });
+    EXPECT_EQ(3u, stopped_after);
+}
+
+TEST(VDBRepository, ContentsErrorsOnLoad)
+{
+    TestEnvironment env;
+    std::shared_ptr<Map<std::string, std::string> > keys(std::make_shared<Map<std::string, std::string>>());
+    keys->insert("format", "vdb");
+    keys->insert("names_cache", "/var/empty");
+    keys->insert("location", stringify(FSPath::cwd() / "vdb_repository_TEST_dir" / "repo-bad-contents"));
+    keys->insert("builddir", stringify(FSPath::cwd() / "vdb_repository_TEST_dir" / "build"));
+    keys->insert("world", stringify(FSPath::cwd() / "vdb_repository_TEST_dir" / "world-no-match-no-eol"));
+    std::shared_ptr<Repository> repo(VDBRepository::VDBRepository::repository_factory_create(&env,
+                std::bind(from_keys, keys, std::placeholders::_1)));
+    env.add_repository(1, repo);
+
+    std::shared_ptr<const PackageID> e1(*env[selection::RequireExactlyOne(generator::Matches(
+                    PackageDepSpec(parse_user_package_dep_spec("=cat-one/pkg-one-1",
+                            &env, { })), nullptr, { }))]->begin());
+    EXPECT_THROW(e1->contents(), DestringifyError);
 }
 
 TEST(VDBRepository, Reinstall)
@@ -60,6 +60,14 @@ sym -> bar 2
 sym foo -> 2
 END
 
+mkdir -p repo-bad-contents/cat-one/pkg-one-1 || exit 1
+echo "0" >repo-bad-contents/cat-one/pkg-one-1/SLOT
+echo "0" >repo-bad-contents/cat-one/pkg-one-1/EAPI
+cat <<END >repo-bad-contents/cat-one/pkg-one-1/CONTENTS
+dir /directory
+obj /directory/file 4 not-a-time
+END
+
 touch "world-empty"
 cat <<END > world-no-match
 cat-one/foo
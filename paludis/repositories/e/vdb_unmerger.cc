@@ -156,61 +156,33 @@ VDBUnmerger::make_tidy(const FSPath & f) const
     return f_str.substr(root_str.length());
 }
 
-namespace
-{
-    EntryType get_et(const ContentsEntry & e)
-    {
-        return e.make_accept_returning(
-            [&] (const ContentsFileEntry &)  { return et_file; },
-            [&] (const ContentsDirEntry &)   { return et_dir; },
-            [&] (const ContentsSymEntry &)   { return et_sym; },
-            [&] (const ContentsOtherEntry &) { return et_misc; }
-            );
-    }
-}
-
 void
 VDBUnmerger::populate_unmerge_set()
 {
-    for (const auto & entry : *_imp->options.contents())
-        add_unmerge_entry(get_et(*entry), entry);
-}
-
-namespace
-{
-    template <typename T_>
-    const T_ & require_key(const MetadataKeyHolder & h, const std::string & r)
-    {
-        MetadataKeyHolder::MetadataConstIterator m(h.find_metadata(r));
-        if (m == h.end_metadata())
-            throw InternalError(PALUDIS_HERE, "Expected key '" + r + "' not found");
-
-        const T_ * const c(visitor_cast<const T_>(**m));
-        if (! c)
-            throw InternalError(PALUDIS_HERE, "Key '" + r + "' is of wrong type");
-
-        return *c;
-    }
+    _imp->options.contents()->for_each_view([&] (const ContentsEntryView & e) {
+            add_unmerge_entry(e);
+            return true;
+            });
 }
 
 bool
-VDBUnmerger::check_file(const std::shared_ptr<const ContentsEntry> & e) const
+VDBUnmerger::check_file(const ContentsEntryView & e) const
 {
-    const FSPath f(e->location_key()->parse_value());
+    const FSPath f(std::string(e.path()));
     const FSPath root_f(_imp->options.root() / f);
     const FSStat root_f_stat(root_f);
     if (! root_f_stat.exists())
         display("--- [gone ] " + stringify(f));
     else if (! root_f_stat.is_regular_file())
         display("--- [!type] " + stringify(f));
-    else if (root_f_stat.mtim().seconds() != require_key<MetadataTimeKey>(*e, "mtime").parse_value().seconds())
+    else if (root_f_stat.mtim().seconds() != parse_contents_mtime(e.mtime()))
         display("--- [!time] " + stringify(f));
     else
     {
         try
         {
             SafeIFStream md5_file(_imp->options.root() / f);
-            if (MD5(md5_file).hexsum() != require_key<MetadataValueKey<std::string> >(*e, "md5").parse_value())
+            if (MD5(md5_file).hexsum() != e.md5())
                 display("--- [!md5 ] " + stringify(f));
             else if (config_protected(_imp->options.root() / f))
                 display("--- [cfgpr] " + stringify(f));
@@ -229,9 +201,9 @@ VDBUnmerger::check_file(const std::shared_ptr<const ContentsEntry> & e) const
 }
 
 bool
-VDBUnmerger::check_sym(const std::shared_ptr<const ContentsEntry> & e) const
+VDBUnmerger::check_sym(const ContentsEntryView & e) const
 {
-    const FSPath f(e->location_key()->parse_value());
+    const FSPath f(std::string(e.path()));
     const FSPath root_f(_imp->options.root() / f);
     const FSStat root_f_stat(root_f);
 
@@ -239,9 +211,9 @@ VDBUnmerger::check_sym(const std::shared_ptr<const ContentsEntry> & e) const
         display("--- [gone ] " + stringify(f));
     else if (! root_f_stat.is_symlink())
         display("--- [!type] " + stringify(f));
-    else if (root_f_stat.mtim().seconds() != require_key<MetadataTimeKey>(*e, "mtime").parse_value().seconds())
+    else if (root_f_stat.mtim().seconds() != parse_contents_mtime(e.mtime()))
         display("--- [!time] " + stringify(f));
-    else if (root_f.readlink() != require_key<MetadataValueKey<std::string> >(*e, "target").parse_value())
+    else if (root_f.readlink() != e.target())
         display("--- [!dest] " + stringify(f));
     else
         return true;
@@ -250,9 +222,9 @@ VDBUnmerger::check_sym(const std::shared_ptr<const ContentsEntry> & e) const
 }
 
 bool
-VDBUnmerger::check_misc(const std::shared_ptr<const ContentsEntry> & e) const
+VDBUnmerger::check_misc(const ContentsEntryView & e) const
 {
-    const FSPath f(e->location_key()->parse_value());
+    const FSPath f(std::string(e.path()));
     const FSPath root_f(_imp->options.root() / f);
     const FSStat root_f_stat(root_f);
 
@@ -262,9 +234,9 @@ VDBUnmerger::check_misc(const std::shared_ptr<const ContentsEntry> & e) const
 }
 
 bool
-VDBUnmerger::check_dir(const std::shared_ptr<const ContentsEntry> & e) const
+VDBUnmerger::check_dir(const ContentsEntryView & e) const
 {
-    const FSPath f(e->location_key()->parse_value());
+    const FSPath f(std::string(e.path()));
     const FSPath root_f(_imp->options.root() / f);
     const FSStat root_f_stat(root_f);
 
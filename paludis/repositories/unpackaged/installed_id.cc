@@ -34,6 +34,8 @@
 #include <paludis/util/fs_iterator.hh>
 #include <paludis/util/fs_stat.hh>
 #include <paludis/util/join.hh>
+#include <paludis/util/destringify.hh>
+#include <paludis/util/log.hh>
 
 #include <paludis/ndbam.hh>
 #include <paludis/ndbam_unmerger.hh>
@@ -54,6 +56,7 @@
 #include <paludis/slot.hh>
 
 #include <functional>
+#include <iterator>
 
 using namespace paludis;
 using namespace paludis::unpackaged_repositories;
@@ -355,6 +358,7 @@ namespace paludis
         std::shared_ptr<InstalledUnpackagedStringKey> description_key;
         std::shared_ptr<InstalledUnpackagedDependencyKey> build_dependencies_key;
         std::shared_ptr<InstalledUnpackagedDependencyKey> run_dependencies_key;
+        std::shared_ptr<LiteralMetadataValueKey<long> > size_key;
         std::shared_ptr<LiteralMetadataStringSetKey> behaviours_key;
 
         Imp(
@@ -402,6 +406,23 @@ namespace paludis
                 run_dependencies_key = std::make_shared<InstalledUnpackagedDependencyKey>(env,
                             "run_dependencies", "Run dependencies", l / "run_dependencies",
                             InstalledUnpackagedIDData::get_instance()->run_dependencies_labels, mkt_dependencies);
+
+            if ((l / "size").stat().exists())
+            {
+                try
+                {
+                    /* read the same way as SIZE for E installed IDs */
+                    SafeIFStream f(l / "size");
+                    std::string size_text((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+                    size_key = std::make_shared<LiteralMetadataValueKey<long> >("size", "Installed size", mkt_internal,
+                            destringify<long>(strip_trailing(size_text, "\r\n")));
+                }
+                catch (const DestringifyError &)
+                {
+                    Log::get_instance()->message("unpackaged.installed.size.invalid", ll_warning, lc_context)
+                        << "Ignoring invalid size in '" << l << "'";
+                }
+            }
         }
     };
 }
@@ -423,6 +444,8 @@ InstalledUnpackagedID::InstalledUnpackagedID(const Environment * const e, const
         add_metadata_key(_imp->build_dependencies_key);
     if (_imp->run_dependencies_key)
         add_metadata_key(_imp->run_dependencies_key);
+    if (_imp->size_key)
+        add_metadata_key(_imp->size_key);
     add_metadata_key(_imp->behaviours_key);
 }
 
@@ -548,14 +571,7 @@ InstalledUnpackagedID::long_description_key() const
 const std::shared_ptr<const Contents>
 InstalledUnpackagedID::contents() const
 {
-    using namespace std::placeholders;
-    auto v(std::make_shared<Contents>());
-    _imp->ndbam->parse_contents(*this,
-            std::bind(&Contents::add, v.get(), std::placeholders::_1),
-            std::bind(&Contents::add, v.get(), std::placeholders::_1),
-            std::bind(&Contents::add, v.get(), std::placeholders::_1)
-            );
-    return v;
+    return _imp->ndbam->contents(*this);
 }
 
 const std::shared_ptr<const MetadataTimeKey>
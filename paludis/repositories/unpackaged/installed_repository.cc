@@ -350,7 +350,8 @@ InstalledUnpackagedRepository::merge(const MergeParams & m)
                 n::parts() = m.parts(),
                 n::permit_destination() = m.permit_destination(),
                 n::root() = installed_root_key()->parse_value().realpath(),
-                n::should_merge() = nullptr
+                n::should_merge() = nullptr,
+                n::size_file() = target_ver_dir / "size"
             ));
 
     if (m.check())
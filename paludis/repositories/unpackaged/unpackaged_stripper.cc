@@ -46,6 +46,7 @@ UnpackagedStripper::UnpackagedStripper(const UnpackagedStripperOptions & options
                 n::debug_dir() = options.debug_dir(),
                 n::dwarf_compression() = options.dwarf_compression(),
                 n::image_dir() = options.image_dir(),
+                n::max_threads() = 0,
                 n::split() = options.split(),
                 n::strip() = options.strip(),
                 n::tool_prefix() = options.tool_prefix()
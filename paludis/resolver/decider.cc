@@ -44,6 +44,7 @@
 #include <paludis/resolver/destination_utils.hh>
 #include <paludis/util/exception.hh>
 #include <paludis/util/stringify.hh>
+#include <paludis/util/instrumentation.hh>
 #include <paludis/util/make_named_values.hh>
 #include <paludis/util/make_shared_copy.hh>
 #include <paludis/util/wrapped_forward_iterator.hh>
@@ -927,6 +928,9 @@ Decider::_suggest_restart_with(
         const std::shared_ptr<const Constraint> & constraint,
         const std::shared_ptr<const Decision> & decision) const
 {
+    static InstrumentationPoint point("resolver.decider.restart");
+    point.count();
+
     throw SuggestRestart(resolution->resolvent(), resolution->decision(), constraint, decision,
             _make_constraint_for_preloading(decision, constraint));
 }
@@ -977,6 +981,9 @@ Decider::_make_spec_for_preloading(const PackageDepSpec & spec,
 void
 Decider::_decide(const std::shared_ptr<Resolution> & resolution)
 {
+    static InstrumentationPoint point("resolver.decider.decide");
+    ScopedInstrumentationTimer timer(point);
+
     Context context("When deciding upon an origin ID to use for '" + stringify(resolution->resolvent()) + "':");
 
     _copy_other_destination_constraints(resolution);
@@ -40,6 +40,7 @@
 
 #include <paludis/util/pimp-impl.hh>
 #include <paludis/util/exception.hh>
+#include <paludis/util/instrumentation.hh>
 #include <paludis/util/stringify.hh>
 #include <paludis/util/hashes.hh>
 #include <paludis/util/join.hh>
@@ -523,6 +524,9 @@ Orderer::_order_early(const NAGIndex & i) const
 void
 Orderer::resolve()
 {
+    static InstrumentationPoint point("resolver.orderer.resolve");
+    ScopedInstrumentationTimer timer(point);
+
     Context context("When resolving ordering:");
 
     _imp->env->trigger_notifier_callback(NotifierCallbackResolverStageEvent("Nodifying Decisions"));
@@ -21,6 +21,7 @@
 #include <paludis/selection_handler.hh>
 #include <paludis/util/pimp-impl.hh>
 #include <paludis/util/sequence-impl.hh>
+#include <paludis/util/instrumentation.hh>
 #include <paludis/util/set-impl.hh>
 #include <paludis/util/wrapped_forward_iterator.hh>
 #include <paludis/util/wrapped_output_iterator.hh>
@@ -87,6 +88,9 @@ Selection::operator= (const Selection & other)
 std::shared_ptr<PackageIDSequence>
 Selection::perform_select(const Environment * const env) const
 {
+    static InstrumentationPoint point("selection.perform_select");
+    ScopedInstrumentationTimer timer(point);
+
     Context context("When finding " + _imp->handler->as_string() + ":");
     return _imp->handler->perform_select(env);
 }
@@ -22,6 +22,7 @@
 #include <paludis/util/sequence-impl.hh>
 #include <paludis/util/wrapped_forward_iterator-impl.hh>
 #include <paludis/util/indirect_iterator-impl.hh>
+#include <paludis/util/arena.hh>
 #include <algorithm>
 
 using namespace paludis;
@@ -48,30 +49,61 @@ LeafNode<Tree_, Item_>::spec() const
 }
 
 template <typename Tree_>
-BasicInnerNode<Tree_>::BasicInnerNode() :
-    _child_list(std::make_shared<ChildList>())
+BasicInnerNode<Tree_>::BasicInnerNode(const std::shared_ptr<Arena> & a) :
+    _arena(a)
 {
 }
 
+template <typename Tree_>
+const std::shared_ptr<Arena> &
+BasicInnerNode<Tree_>::arena() const
+{
+    return _arena;
+}
+
 template <typename Tree_>
 typename BasicInnerNode<Tree_>::ConstIterator
 BasicInnerNode<Tree_>::begin() const
 {
-    return ConstIterator(_child_list->begin());
+    return ConstIterator(_child_list.begin());
 }
 
 template <typename Tree_>
 typename BasicInnerNode<Tree_>::ConstIterator
 BasicInnerNode<Tree_>::end() const
 {
-    return ConstIterator(_child_list->end());
+    return ConstIterator(_child_list.end());
 }
 
 template <typename Tree_>
 void
 BasicInnerNode<Tree_>::append_node(const std::shared_ptr<const BasicNode<Tree_> > & t)
 {
-    _child_list->push_back(t);
+    _child_list.push_back(t);
+}
+
+namespace
+{
+    template <typename Node_>
+    struct MakeNode;
+
+    template <typename Tree_, typename Item_>
+    struct MakeNode<LeafNode<Tree_, Item_> >
+    {
+        static std::shared_ptr<LeafNode<Tree_, Item_> > make(const std::shared_ptr<const Item_> & i, const std::shared_ptr<Arena> & a)
+        {
+            return make_shared_in<LeafNode<Tree_, Item_> >(a, i);
+        }
+    };
+
+    template <typename Tree_, typename Item_>
+    struct MakeNode<InnerNode<Tree_, Item_> >
+    {
+        static std::shared_ptr<InnerNode<Tree_, Item_> > make(const std::shared_ptr<const Item_> & i, const std::shared_ptr<Arena> & a)
+        {
+            return make_shared_in<InnerNode<Tree_, Item_> >(a, i, a);
+        }
+    };
 }
 
 template <typename Tree_>
@@ -80,7 +112,7 @@ const std::shared_ptr<typename Tree_::template NodeType<T_>::Type>
 BasicInnerNode<Tree_>::append(const std::shared_ptr<const T_> & t)
 {
     const std::shared_ptr<typename Tree_::template NodeType<T_>::Type> tt(
-            std::make_shared<typename Tree_::template NodeType<T_>::Type>(t));
+            MakeNode<typename Tree_::template NodeType<T_>::Type>::make(t, _arena));
     append_node(tt);
     return tt;
 }
@@ -94,7 +126,8 @@ BasicInnerNode<Tree_>::append(const std::shared_ptr<T_> & t)
 }
 
 template <typename Tree_, typename Item_>
-InnerNode<Tree_, Item_>::InnerNode(const std::shared_ptr<const Item_> & i) :
+InnerNode<Tree_, Item_>::InnerNode(const std::shared_ptr<const Item_> & i, const std::shared_ptr<Arena> & a) :
+    BasicInnerNode<Tree_>(a),
     _spec(i)
 {
 }
@@ -118,6 +151,18 @@ SpecTree<NodeList_, RootNode_>::SpecTree(const std::shared_ptr<const RootNode_>
 {
 }
 
+template <typename NodeList_, typename RootNode_>
+SpecTree<NodeList_, RootNode_>::SpecTree(const std::shared_ptr<RootNode_> & spec, const std::shared_ptr<Arena> & arena) :
+    _top(make_shared_in<typename InnerNodeType<RootNode_>::Type>(arena, spec, arena))
+{
+}
+
+template <typename NodeList_, typename RootNode_>
+SpecTree<NodeList_, RootNode_>::SpecTree(const std::shared_ptr<const RootNode_> & spec, const std::shared_ptr<Arena> & arena) :
+    _top(make_shared_in<typename InnerNodeType<RootNode_>::Type>(arena, spec, arena))
+{
+}
+
 template <typename NodeList_, typename RootNode_>
 const std::shared_ptr<typename SpecTree<NodeList_, RootNode_>::template InnerNodeType<RootNode_>::Type>
 SpecTree<NodeList_, RootNode_>::top()
@@ -172,7 +217,7 @@ namespace paludis
     template <typename T_>
     struct WrappedForwardIteratorTraits<BasicInnerNodeConstIteratorTag<T_> >
     {
-        typedef typename Sequence<std::shared_ptr<const BasicNode<T_> > >::ConstIterator UnderlyingIterator;
+        typedef typename std::vector<std::shared_ptr<const BasicNode<T_> > >::const_iterator UnderlyingIterator;
     };
 }
 
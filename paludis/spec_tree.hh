@@ -24,6 +24,9 @@
 #include <paludis/util/wrapped_forward_iterator.hh>
 #include <paludis/util/visitor.hh>
 #include <paludis/util/sequence.hh>
+#include <paludis/util/arena-fwd.hh>
+#include <memory>
+#include <vector>
 #include <type_traits>
 
 namespace paludis
@@ -63,11 +66,19 @@ namespace paludis
             public BasicNode<Tree_>
         {
             private:
-                typedef Sequence<std::shared_ptr<const BasicNode<Tree_> > > ChildList;
-                std::shared_ptr<ChildList> _child_list;
+                typedef std::vector<std::shared_ptr<const BasicNode<Tree_> > > ChildList;
+                ChildList _child_list;
+                const std::shared_ptr<Arena> _arena;
 
             public:
-                BasicInnerNode();
+                explicit BasicInnerNode(const std::shared_ptr<Arena> & = nullptr);
+
+                /**
+                 * If set, the Arena from which nodes appended to us are
+                 * allocated. Specs to be appended can be allocated from here
+                 * too.
+                 */
+                const std::shared_ptr<Arena> & arena() const PALUDIS_ATTRIBUTE((warn_unused_result));
 
                 typedef BasicInnerNodeConstIteratorTag<Tree_> ConstIteratorTag;
                 typedef WrappedForwardIterator<ConstIteratorTag,
@@ -97,7 +108,7 @@ namespace paludis
                 const std::shared_ptr<const Item_> _spec;
 
             public:
-                explicit InnerNode(const std::shared_ptr<const Item_> & i);
+                explicit InnerNode(const std::shared_ptr<const Item_> & i, const std::shared_ptr<Arena> & = nullptr);
 
                 template <typename OtherTree_>
                 operator InnerNode<OtherTree_, Item_> () const;
@@ -171,6 +182,15 @@ namespace paludis
 
             explicit SpecTree(const std::shared_ptr<const RootNode_> & spec);
 
+            /**
+             * Every node added to a tree constructed this way is allocated
+             * from the given Arena, which is then freed as a unit once
+             * neither the tree nor anything taken from it is in use.
+             */
+            SpecTree(const std::shared_ptr<RootNode_> & spec, const std::shared_ptr<Arena> & arena);
+
+            SpecTree(const std::shared_ptr<const RootNode_> & spec, const std::shared_ptr<Arena> & arena);
+
             const std::shared_ptr<typename InnerNodeType<RootNode_>::Type> top();
 
             const std::shared_ptr<const typename InnerNodeType<RootNode_>::Type> top() const;
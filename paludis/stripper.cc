@@ -29,10 +29,12 @@
 #include <paludis/util/fs_stat.hh>
 #include <paludis/util/options.hh>
 #include <paludis/util/singleton-impl.hh>
+#include <paludis/util/thread_pool.hh>
 #include <functional>
 #include <sstream>
 #include <list>
 #include <set>
+#include <vector>
 #include <algorithm>
 #include <sys/stat.h>
 
@@ -47,6 +49,18 @@ using namespace paludis;
 
 typedef std::set<std::pair<dev_t, ino_t> > StrippedSet;
 
+namespace
+{
+    struct StripJob
+    {
+        FSPath file;
+        std::string strip_options;
+        bool dwarf_compress;
+        bool split;
+        FSPath split_target;
+    };
+}
+
 StripperError::StripperError(const std::string & s) noexcept :
     Exception(s)
 {
@@ -123,6 +137,7 @@ namespace paludis
     {
         StripperOptions options;
         StrippedSet stripped_ids;
+        std::vector<StripJob> jobs;
         PaludisStripperExtras * stripper_extras;
 
         Imp(const StripperOptions & o) :
@@ -166,6 +181,20 @@ Stripper::strip()
         return;
 
     do_dir_recursive(_imp->options.image_dir());
+
+    /* Every job is a separate file, so once the walk has worked out what to
+     * do and announced it in order, the external tools can run in parallel. */
+    std::vector<StripJob> jobs;
+    std::swap(jobs, _imp->jobs);
+    parallel_for_each(jobs.size(), [&] (std::size_t n) {
+            Context job_context("When stripping '" + stringify(jobs[n].file) + "':");
+
+            if (jobs[n].dwarf_compress)
+                do_dwarf_compress(jobs[n].file);
+            if (jobs[n].split)
+                do_split(jobs[n].file, jobs[n].split_target);
+            do_strip(jobs[n].file, jobs[n].strip_options);
+            }, _imp->options.max_threads());
 }
 
 void
@@ -200,19 +229,26 @@ Stripper::do_dir_recursive(const FSPath & f)
                 if (std::string::npos != t.find("SB executable") || std::string::npos != t.find("SB shared object") ||
                                 std::string::npos != t.find("SB pie executable"))
                 {
-                    if (_imp->options.dwarf_compression())
-                        do_dwarf_compress(*d);
-                    if (_imp->options.split())
+                    StripJob job{ *d, "", _imp->options.dwarf_compression(), _imp->options.split(), *d };
+
+                    if (job.dwarf_compress)
+                        on_dwarf_compress(job.file);
+                    if (job.split)
                     {
                         FSPath target(_imp->options.debug_dir() / d->strip_leading(_imp->options.image_dir()));
-                        target = target.dirname() / (target.basename() + ".debug");
-                        do_split(*d, target);
+                        job.split_target = target.dirname() / (target.basename() + ".debug");
+                        on_split(job.file, job.split_target);
                     }
-                    do_strip(*d, "");
+                    on_strip(job.file);
+
+                    _imp->jobs.push_back(job);
+                    _imp->stripped_ids.insert(d_stat.lowlevel_id());
                 }
                 else if (std::string::npos != t.find("current ar archive"))
                 {
-                    do_strip(*d, "-g");
+                    on_strip(*d);
+                    _imp->jobs.push_back(StripJob{ *d, "-g", false, false, *d });
+                    _imp->stripped_ids.insert(d_stat.lowlevel_id());
                 }
                 else
                     on_unknown(*d);
@@ -244,14 +280,12 @@ Stripper::do_strip(const FSPath & f, const std::string & options)
 {
     const std::string strip_tool(_imp->options.tool_prefix() + "strip");
     Context context("When stripping '" + stringify(f) + "':");
-    on_strip(f);
 
     Process strip_process(options.empty()
                             ? ProcessCommand({ strip_tool, stringify(f) })
                             : ProcessCommand({ strip_tool, options, stringify(f) }));
     if (0 != strip_process.run().wait())
         Log::get_instance()->message("strip.failure", ll_warning, lc_context) << "Couldn't strip '" << f << "'";
-    _imp->stripped_ids.insert(f.stat().lowlevel_id());
 }
 
 void
@@ -259,7 +293,6 @@ Stripper::do_split(const FSPath & f, const FSPath & g)
 {
     const std::string objcopy_tool(_imp->options.tool_prefix() + "objcopy");
     Context context("When splitting '" + stringify(f) + "' to '" + stringify(g) + "':");
-    on_split(f, g);
 
     {
         std::list<FSPath> to_make;
@@ -290,8 +323,6 @@ Stripper::do_dwarf_compress(const FSPath & f)
 {
     Context context("When compressing DWARF information for '" + stringify(f) + "'");
 
-    on_dwarf_compress(f);
-
     Process dwz_process(ProcessCommand({ "dwz", /* quiet => */ "-q", stringify(f) }));
     if (dwz_process.run().wait() != 0)
         Log::get_instance()->message("strip.failure", ll_warning, lc_context)
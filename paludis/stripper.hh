@@ -36,6 +36,7 @@ namespace paludis
         typedef Name<struct name_debug_dir> debug_dir;
         typedef Name<struct name_dwarf_compression> dwarf_compression;
         typedef Name<struct name_image_dir> image_dir;
+        typedef Name<struct name_max_threads> max_threads;
         typedef Name<struct name_split> split;
         typedef Name<struct name_strip> strip;
         typedef Name<struct name_tool_prefix> tool_prefix;
@@ -47,6 +48,10 @@ namespace paludis
         NamedValue<n::debug_dir, FSPath> debug_dir;
         NamedValue<n::dwarf_compression, bool> dwarf_compression;
         NamedValue<n::image_dir, FSPath> image_dir;
+
+        /// How many files to work on at once, or 0 for one per processor.
+        NamedValue<n::max_threads, unsigned> max_threads;
+
         NamedValue<n::split, bool> split;
         NamedValue<n::strip, bool> strip;
         NamedValue<n::tool_prefix, std::string> tool_prefix;
@@ -73,6 +78,12 @@ namespace paludis
             virtual void on_dwarf_compress(const FSPath &) = 0;
             virtual void on_unknown(const FSPath &) = 0;
 
+            /**
+             * Walk the image, calling the on_ functions in order and queueing
+             * up the work to be done. The queued work is carried out in
+             * parallel by strip() once the walk has finished, so the do_
+             * functions may be called from several threads at once.
+             */
             virtual void do_dir_recursive(const FSPath &);
 
             virtual std::string file_type(const FSPath &);
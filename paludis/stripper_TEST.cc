@@ -24,6 +24,13 @@
 #include <paludis/util/fs_stat.hh>
 #include <paludis/util/make_named_values.hh>
 
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 using namespace paludis;
@@ -63,6 +70,79 @@ namespace
         {
         }
     };
+
+    struct RecordingStripper :
+        Stripper
+    {
+        const std::thread::id calling_thread;
+        std::mutex mutex;
+        std::vector<std::string> events;
+        std::map<std::string, std::pair<dev_t, ino_t> > inodes;
+        bool callback_from_other_thread;
+
+        void record(const std::string & s, const FSPath & f)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            events.push_back(s + " " + f.basename());
+        }
+
+        void callback(const std::string & s, const FSPath & f)
+        {
+            if (std::this_thread::get_id() != calling_thread)
+                callback_from_other_thread = true;
+            record(s, f);
+        }
+
+        void on_enter_dir(const FSPath & f) override
+        {
+            callback("enter", f);
+        }
+
+        void on_leave_dir(const FSPath & f) override
+        {
+            callback("leave", f);
+        }
+
+        void on_strip(const FSPath & f) override
+        {
+            inodes.insert(std::make_pair(f.basename(), f.stat().lowlevel_id()));
+            callback("on_strip", f);
+        }
+
+        void on_split(const FSPath & f, const FSPath &) override
+        {
+            callback("on_split", f);
+        }
+
+        void on_dwarf_compress(const FSPath & f) override
+        {
+            callback("on_dwarf_compress", f);
+        }
+
+        void on_unknown(const FSPath & f) override
+        {
+            callback("on_unknown", f);
+        }
+
+        void do_split(const FSPath & f, const FSPath & g) override
+        {
+            record("do_split", f);
+            Stripper::do_split(f, g);
+        }
+
+        void do_strip(const FSPath & f, const std::string & o) override
+        {
+            record("do_strip", f);
+            Stripper::do_strip(f, o);
+        }
+
+        RecordingStripper(const StripperOptions & o) :
+            Stripper(o),
+            calling_thread(std::this_thread::get_id()),
+            callback_from_other_thread(false)
+        {
+        }
+    };
 }
 
 TEST(Stripper, Works)
@@ -72,6 +152,7 @@ TEST(Stripper, Works)
                 n::debug_dir() = FSPath("stripper_TEST_dir/image").realpath() / "usr" / "lib" / "debug",
                 n::dwarf_compression() = false,
                 n::image_dir() = FSPath("stripper_TEST_dir/image").realpath(),
+                n::max_threads() = 0,
                 n::split() = true,
                 n::strip() = true,
                 n::tool_prefix() = PALUDIS_BUILD_STRIP_TOOL_PREFIX
@@ -81,3 +162,67 @@ TEST(Stripper, Works)
     ASSERT_TRUE(FSPath("stripper_TEST_dir/image/usr/lib/debug/usr/bin/stripper_TEST_binary.debug").stat().is_regular_file());
 }
 
+
+TEST(Stripper, HardLinks)
+{
+    RecordingStripper s(make_named_values<StripperOptions>(
+                n::compress_splits() = false,
+                n::debug_dir() = FSPath("stripper_TEST_dir/hardlinks").realpath() / "debug",
+                n::dwarf_compression() = false,
+                n::image_dir() = FSPath("stripper_TEST_dir/hardlinks").realpath(),
+                n::max_threads() = 4,
+                n::split() = true,
+                n::strip() = true,
+                n::tool_prefix() = PALUDIS_BUILD_STRIP_TOOL_PREFIX
+            ));
+    s.strip();
+
+    EXPECT_FALSE(s.callback_from_other_thread);
+
+    /* two inodes, so two files, whichever of their names the walk sees first */
+    ASSERT_EQ(2u, s.inodes.size());
+    EXPECT_NE(s.inodes.begin()->second, s.inodes.rbegin()->second);
+
+    /* every callback comes from the walk, properly nested, and before any
+     * work starts; the work for each file is a split and then a strip */
+    std::vector<std::string> dirs;
+    std::multiset<std::string> announced, split, stripped;
+    bool working(false);
+    for (const auto & e : s.events)
+    {
+        const std::string kind(e.substr(0, e.find(' '))), name(e.substr(e.find(' ') + 1));
+        if ("do_split" == kind || "do_strip" == kind)
+            working = true;
+        else
+            EXPECT_FALSE(working) << e;
+
+        if ("enter" == kind)
+            dirs.push_back(name);
+        else if ("leave" == kind)
+        {
+            ASSERT_FALSE(dirs.empty());
+            EXPECT_EQ(dirs.back(), name);
+            dirs.pop_back();
+        }
+        else if ("on_split" == kind)
+            announced.insert(name);
+        else if ("on_strip" == kind)
+            EXPECT_EQ(1u, announced.count(name)) << e;
+        else if ("do_split" == kind)
+            split.insert(name);
+        else if ("do_strip" == kind)
+            EXPECT_EQ(1u, split.count(name)) << e;
+        else
+            ADD_FAILURE() << e;
+
+        if ("do_strip" == kind)
+            stripped.insert(name);
+    }
+
+    EXPECT_TRUE(dirs.empty());
+    EXPECT_EQ(announced, split);
+    EXPECT_EQ(announced, stripped);
+    EXPECT_EQ(2u, stripped.size());
+    for (const auto & i : s.inodes)
+        EXPECT_EQ(1u, stripped.count(i.first)) << i.first;
+}
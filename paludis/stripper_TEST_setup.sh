@@ -7,3 +7,10 @@ cd stripper_TEST_dir || exit 3
 mkdir -p image/usr/bin || exit 5
 cp ../stripper_TEST_binary image/usr/bin || exit 6
 
+
+mkdir -p hardlinks/bin hardlinks/lib || exit 7
+cp ../stripper_TEST_binary hardlinks/bin/first || exit 8
+ln hardlinks/bin/first hardlinks/bin/first_again || exit 9
+ln hardlinks/bin/first hardlinks/lib/first_elsewhere || exit 10
+cp ../stripper_TEST_binary hardlinks/bin/second || exit 11
+ln hardlinks/bin/second hardlinks/lib/second_elsewhere || exit 12
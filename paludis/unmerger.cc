@@ -23,6 +23,7 @@
 #include <paludis/hook.hh>
 #include <paludis/util/pimp-impl.hh>
 #include <paludis/util/fs_stat.hh>
+#include <paludis/util/make_named_values.hh>
 #include <paludis/contents.hh>
 #include <paludis/metadata_key.hh>
 #include <sys/types.h>
@@ -35,7 +36,18 @@ using namespace paludis;
 
 namespace paludis
 {
-    typedef std::multimap<std::string, std::pair<EntryType, std::shared_ptr<const ContentsEntry> > > UnmergeEntries;
+    /* what a ContentsEntryView points to, kept until we're ready to
+     * unmerge, keyed by path */
+    struct UnmergeEntry
+    {
+        EntryType type;
+        std::string md5;
+        std::string mtime;
+        std::string target;
+        bool is_volatile;
+    };
+
+    typedef std::multimap<std::string, UnmergeEntry> UnmergeEntries;
     typedef UnmergeEntries::reverse_iterator UnmergeEntriesIterator;
 
     template<>
@@ -67,7 +79,18 @@ Unmerger::~Unmerger() = default;
 void
 Unmerger::add_unmerge_entry(const EntryType et, const std::shared_ptr<const ContentsEntry> & e)
 {
-    _imp->unmerge_entries.insert(std::make_pair(stringify(e->location_key()->parse_value()), std::make_pair(et, e)));
+    view_contents_entry(*e, [&] (const ContentsEntryView & v) {
+            ContentsEntryView w(v);
+            w.type() = et;
+            add_unmerge_entry(w);
+            });
+}
+
+void
+Unmerger::add_unmerge_entry(const ContentsEntryView & v)
+{
+    _imp->unmerge_entries.insert(std::make_pair(stringify(FSPath(std::string(v.path()))),
+                UnmergeEntry{v.type(), std::string(v.md5()), std::string(v.mtime()), std::string(v.target()), v.is_volatile()}));
 }
 
 void
@@ -83,23 +106,31 @@ Unmerger::unmerge()
 
     for (UnmergeEntriesIterator  i(_imp->unmerge_entries.rbegin()), i_end(_imp->unmerge_entries.rend()) ; i != i_end ; ++i)
     {
-        FSPath f(i->first);
-        switch (i->second.first)
+        const ContentsEntryView e(make_named_values<ContentsEntryView>(
+                    n::is_volatile() = i->second.is_volatile,
+                    n::md5() = std::string_view(i->second.md5),
+                    n::mtime() = std::string_view(i->second.mtime),
+                    n::path() = std::string_view(i->first),
+                    n::target() = std::string_view(i->second.target),
+                    n::type() = i->second.type
+                    ));
+
+        switch (i->second.type)
         {
             case et_dir:
-                unmerge_dir(i->second.second);
+                unmerge_dir(e);
                 continue;
 
             case et_file:
-                unmerge_file(i->second.second);
+                unmerge_file(e);
                 continue;
 
             case et_sym:
-                unmerge_sym(i->second.second);
+                unmerge_sym(e);
                 continue;
 
             case et_misc:
-                unmerge_misc(i->second.second);
+                unmerge_misc(e);
                 continue;
 
             case et_nothing:
@@ -107,7 +138,7 @@ Unmerger::unmerge()
                 ;
         }
 
-        throw InternalError(PALUDIS_HERE, "Unexpected entry_type '" + stringify((*i).second.first) + "'");
+        throw InternalError(PALUDIS_HERE, "Unexpected entry_type '" + stringify(i->second.type) + "'");
     }
 
     if (0 != _imp->options.environment()->perform_hook(extend_hook(
@@ -118,9 +149,10 @@ Unmerger::unmerge()
 }
 
 void
-Unmerger::unmerge_file(const std::shared_ptr<const ContentsEntry> & e) const
+Unmerger::unmerge_file(const ContentsEntryView & e) const
 {
-    FSPath f_real(_imp->options.root() / e->location_key()->parse_value());
+    const std::string path(e.path());
+    FSPath f_real(_imp->options.root() / path);
 
     HookResult hr(_imp->options.environment()->perform_hook(extend_hook(
                     Hook("unmerger_unlink_file_override")
@@ -129,27 +161,28 @@ Unmerger::unmerge_file(const std::shared_ptr<const ContentsEntry> & e) const
                 _imp->options.maybe_output_manager()));
 
     if (hr.max_exit_status() != 0)
-        throw UnmergerError("Unmerge of '" + stringify(e->location_key()->parse_value()) + "' aborted by hook");
+        throw UnmergerError("Unmerge of '" + path + "' aborted by hook");
     else if (hr.output() == "skip")
-        display("--- [skip ] " + stringify(e->location_key()->parse_value()));
+        display("--- [skip ] " + path);
     else if (hr.output() == "force")
     {
-        display("<<< [force] " + stringify(e->location_key()->parse_value()));
+        display("<<< [force] " + path);
         unlink_file(f_real, e);
     }
     else if (_imp->options.ignore()(FSPath(stringify(f_real))))
-        display("--- [ignor] " + stringify(e->location_key()->parse_value()));
+        display("--- [ignor] " + path);
     else if (check_file(e))
     {
-        display("<<<         " + stringify(e->location_key()->parse_value()));
+        display("<<<         " + path);
         unlink_file(f_real, e);
     }
 }
 
 void
-Unmerger::unmerge_sym(const std::shared_ptr<const ContentsEntry> & e) const
+Unmerger::unmerge_sym(const ContentsEntryView & e) const
 {
-    FSPath f_real(_imp->options.root() / e->location_key()->parse_value());
+    const std::string path(e.path());
+    FSPath f_real(_imp->options.root() / path);
 
     HookResult hr(_imp->options.environment()->perform_hook(extend_hook(
                     Hook("unmerger_unlink_sym_override")
@@ -158,27 +191,28 @@ Unmerger::unmerge_sym(const std::shared_ptr<const ContentsEntry> & e) const
                 _imp->options.maybe_output_manager()));
 
     if (hr.max_exit_status() != 0)
-        throw UnmergerError("Unmerge of '" + stringify(e->location_key()->parse_value()) + "' aborted by hook");
+        throw UnmergerError("Unmerge of '" + path + "' aborted by hook");
     else if (hr.output() == "skip")
-        display("--- [skip ] " + stringify(e->location_key()->parse_value()));
+        display("--- [skip ] " + path);
     else if (hr.output() == "force")
     {
-        display("<<< [force] " + stringify(e->location_key()->parse_value()));
+        display("<<< [force] " + path);
         unlink_sym(f_real, e);
     }
     else if (_imp->options.ignore()(FSPath(stringify(f_real))))
-        display("--- [ignor] " + stringify(e->location_key()->parse_value()));
+        display("--- [ignor] " + path);
     else if (check_sym(e))
     {
-        display("<<<         " + stringify(e->location_key()->parse_value()));
+        display("<<<         " + path);
         unlink_sym(f_real, e);
     }
 }
 
 void
-Unmerger::unmerge_dir(const std::shared_ptr<const ContentsEntry> & e) const
+Unmerger::unmerge_dir(const ContentsEntryView & e) const
 {
-    FSPath f_real(_imp->options.root() / e->location_key()->parse_value());
+    const std::string path(e.path());
+    FSPath f_real(_imp->options.root() / path);
 
     HookResult hr(_imp->options.environment()->perform_hook(extend_hook(
                     Hook("unmerger_unlink_dir_override")
@@ -187,22 +221,23 @@ Unmerger::unmerge_dir(const std::shared_ptr<const ContentsEntry> & e) const
                 _imp->options.maybe_output_manager()));
 
     if (hr.max_exit_status() != 0)
-        throw UnmergerError("Unmerge of '" + stringify(e->location_key()->parse_value()) + "' aborted by hook");
+        throw UnmergerError("Unmerge of '" + path + "' aborted by hook");
     else if (hr.output() == "skip")
-        display("--- [skip ] " + stringify(e->location_key()->parse_value()));
+        display("--- [skip ] " + path);
     else if (_imp->options.ignore()(FSPath(stringify(f_real))))
-        display("--- [ignor] " + stringify(e->location_key()->parse_value()));
+        display("--- [ignor] " + path);
     else if (check_dir(e))
     {
-        display("<<<         " + stringify(e->location_key()->parse_value()));
+        display("<<<         " + path);
         unlink_dir(f_real, e);
     }
 }
 
 void
-Unmerger::unmerge_misc(const std::shared_ptr<const ContentsEntry> & e) const
+Unmerger::unmerge_misc(const ContentsEntryView & e) const
 {
-    FSPath f_real(_imp->options.root() / e->location_key()->parse_value());
+    const std::string path(e.path());
+    FSPath f_real(_imp->options.root() / path);
 
     HookResult hr(_imp->options.environment()->perform_hook(extend_hook(
                     Hook("unmerger_unlink_misc_override")
@@ -211,31 +246,31 @@ Unmerger::unmerge_misc(const std::shared_ptr<const ContentsEntry> & e) const
                 _imp->options.maybe_output_manager()));
 
     if (hr.max_exit_status() != 0)
-        throw UnmergerError("Unmerge of '" + stringify(e->location_key()->parse_value()) + "' aborted by hook");
+        throw UnmergerError("Unmerge of '" + path + "' aborted by hook");
     else if (hr.output() == "skip")
-        display("--- [skip ] " + stringify(e->location_key()->parse_value()));
+        display("--- [skip ] " + path);
     else if (hr.output() == "force")
     {
-        display("<<< [force] " + stringify(e->location_key()->parse_value()));
+        display("<<< [force] " + path);
         unlink_misc(f_real, e);
     }
     else if (_imp->options.ignore()(FSPath(stringify(f_real))))
-        display("--- [ignor] " + stringify(e->location_key()->parse_value()));
+        display("--- [ignor] " + path);
     else if (check_misc(e))
     {
-        display("<<<         " + stringify(e->location_key()->parse_value()));
+        display("<<<         " + path);
         unlink_misc(f_real, e);
     }
 }
 
 void
-Unmerger::unlink_file(FSPath f, const std::shared_ptr<const ContentsEntry> & e) const
+Unmerger::unlink_file(FSPath f, const ContentsEntryView & e) const
 {
     if (0 != _imp->options.environment()->perform_hook(extend_hook(
                          Hook("unmerger_unlink_file_pre")
-                         ("UNLINK_TARGET", stringify(e->location_key()->parse_value()))),
+                         ("UNLINK_TARGET", std::string(e.path()))),
                 _imp->options.maybe_output_manager()).max_exit_status())
-        throw UnmergerError("Unmerge of '" + stringify(e->location_key()->parse_value()) + "' aborted by hook");
+        throw UnmergerError("Unmerge of '" + std::string(e.path()) + "' aborted by hook");
 
     FSStat f_stat(f);
     if (f_stat.is_regular_file())
@@ -252,63 +287,63 @@ Unmerger::unlink_file(FSPath f, const std::shared_ptr<const ContentsEntry> & e)
 
     if (0 != _imp->options.environment()->perform_hook(extend_hook(
                          Hook("unmerger_unlink_file_post")
-                         ("UNLINK_TARGET", stringify(e->location_key()->parse_value()))),
+                         ("UNLINK_TARGET", std::string(e.path()))),
                 _imp->options.maybe_output_manager()).max_exit_status())
-        throw UnmergerError("Unmerge of '" + stringify(e->location_key()->parse_value()) + "' aborted by hook");
+        throw UnmergerError("Unmerge of '" + std::string(e.path()) + "' aborted by hook");
 }
 
 void
-Unmerger::unlink_sym(FSPath f, const std::shared_ptr<const ContentsEntry> & e) const
+Unmerger::unlink_sym(FSPath f, const ContentsEntryView & e) const
 {
     if (0 != _imp->options.environment()->perform_hook(extend_hook(
                          Hook("unmerger_unlink_sym_pre")
-                         ("UNLINK_TARGET", stringify(e->location_key()->parse_value()))),
+                         ("UNLINK_TARGET", std::string(e.path()))),
                 _imp->options.maybe_output_manager()).max_exit_status())
-        throw UnmergerError("Unmerge of '" + stringify(e->location_key()->parse_value()) + "' aborted by hook");
+        throw UnmergerError("Unmerge of '" + std::string(e.path()) + "' aborted by hook");
 
     f.unlink();
 
     if (0 != _imp->options.environment()->perform_hook(extend_hook(
                          Hook("unmerger_unlink_sym_post")
-                         ("UNLINK_TARGET", stringify(e->location_key()->parse_value()))),
+                         ("UNLINK_TARGET", std::string(e.path()))),
                 _imp->options.maybe_output_manager()).max_exit_status())
-        throw UnmergerError("Unmerge of '" + stringify(e->location_key()->parse_value()) + "' aborted by hook");
+        throw UnmergerError("Unmerge of '" + std::string(e.path()) + "' aborted by hook");
 }
 
 void
-Unmerger::unlink_dir(FSPath f, const std::shared_ptr<const ContentsEntry> & e) const
+Unmerger::unlink_dir(FSPath f, const ContentsEntryView & e) const
 {
     if (0 != _imp->options.environment()->perform_hook(extend_hook(
                          Hook("unmerger_unlink_dir_pre")
-                         ("UNLINK_TARGET", stringify(e->location_key()->parse_value()))),
+                         ("UNLINK_TARGET", std::string(e.path()))),
                 _imp->options.maybe_output_manager()).max_exit_status())
-        throw UnmergerError("Unmerge of '" + stringify(e->location_key()->parse_value()) + "' aborted by hook");
+        throw UnmergerError("Unmerge of '" + std::string(e.path()) + "' aborted by hook");
 
     f.rmdir();
 
     if (0 != _imp->options.environment()->perform_hook(extend_hook(
                          Hook("unmerger_unlink_dir_post")
-                         ("UNLINK_TARGET", stringify(e->location_key()->parse_value()))),
+                         ("UNLINK_TARGET", std::string(e.path()))),
                 _imp->options.maybe_output_manager()).max_exit_status())
-        throw UnmergerError("Unmerge of '" + stringify(e->location_key()->parse_value()) + "' aborted by hook");
+        throw UnmergerError("Unmerge of '" + std::string(e.path()) + "' aborted by hook");
 }
 
 void
-Unmerger::unlink_misc(FSPath f, const std::shared_ptr<const ContentsEntry> & e) const
+Unmerger::unlink_misc(FSPath f, const ContentsEntryView & e) const
 {
     if (0 != _imp->options.environment()->perform_hook(extend_hook(
                          Hook("unmerger_unlink_misc_pre")
-                         ("UNLINK_TARGET", stringify(e->location_key()->parse_value()))),
+                         ("UNLINK_TARGET", std::string(e.path()))),
                 _imp->options.maybe_output_manager()).max_exit_status())
-        throw UnmergerError("Unmerge of '" + stringify(e->location_key()->parse_value()) + "' aborted by hook");
+        throw UnmergerError("Unmerge of '" + std::string(e.path()) + "' aborted by hook");
 
     f.unlink();
 
     if (0 != _imp->options.environment()->perform_hook(extend_hook(
                          Hook("unmerger_unlink_misc_post")
-                         ("UNLINK_TARGET", stringify(e->location_key()->parse_value()))),
+                         ("UNLINK_TARGET", std::string(e.path()))),
                 _imp->options.maybe_output_manager()).max_exit_status())
-        throw UnmergerError("Unmerge of '" + stringify(e->location_key()->parse_value()) + "' aborted by hook");
+        throw UnmergerError("Unmerge of '" + std::string(e.path()) + "' aborted by hook");
 }
 
 Hook
@@ -319,25 +354,25 @@ Unmerger::extend_hook(const Hook & h) const
 }
 
 bool
-Unmerger::check_file(const std::shared_ptr<const ContentsEntry> &) const
+Unmerger::check_file(const ContentsEntryView &) const
 {
     return true;
 }
 
 bool
-Unmerger::check_dir(const std::shared_ptr<const ContentsEntry> &) const
+Unmerger::check_dir(const ContentsEntryView &) const
 {
     return true;
 }
 
 bool
-Unmerger::check_sym(const std::shared_ptr<const ContentsEntry> &) const
+Unmerger::check_sym(const ContentsEntryView &) const
 {
     return true;
 }
 
 bool
-Unmerger::check_misc(const std::shared_ptr<const ContentsEntry> &) const
+Unmerger::check_misc(const ContentsEntryView &) const
 {
     return true;
 }
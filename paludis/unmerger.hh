@@ -112,6 +112,11 @@ namespace paludis
              */
             void add_unmerge_entry(const EntryType, const std::shared_ptr<const ContentsEntry> &);
 
+            /**
+             * Add entry to the unmerge set, keeping only what the view holds.
+             */
+            void add_unmerge_entry(const ContentsEntryView &);
+
             /**
              * Populate the unmerge set.
              */
@@ -125,30 +130,30 @@ namespace paludis
             ///\name Unmerge operations
             ///\{
 
-            virtual void unmerge_file(const std::shared_ptr<const ContentsEntry> &) const;
-            virtual void unmerge_dir(const std::shared_ptr<const ContentsEntry> &) const;
-            virtual void unmerge_sym(const std::shared_ptr<const ContentsEntry> &) const;
-            virtual void unmerge_misc(const std::shared_ptr<const ContentsEntry> &) const;
+            virtual void unmerge_file(const ContentsEntryView &) const;
+            virtual void unmerge_dir(const ContentsEntryView &) const;
+            virtual void unmerge_sym(const ContentsEntryView &) const;
+            virtual void unmerge_misc(const ContentsEntryView &) const;
 
             ///\}
 
             ///\name Check operations
             ///\{
 
-            virtual bool check_file(const std::shared_ptr<const ContentsEntry> &) const;
-            virtual bool check_dir(const std::shared_ptr<const ContentsEntry> &) const;
-            virtual bool check_sym(const std::shared_ptr<const ContentsEntry> &) const;
-            virtual bool check_misc(const std::shared_ptr<const ContentsEntry> &) const;
+            virtual bool check_file(const ContentsEntryView &) const;
+            virtual bool check_dir(const ContentsEntryView &) const;
+            virtual bool check_sym(const ContentsEntryView &) const;
+            virtual bool check_misc(const ContentsEntryView &) const;
 
             ///\}
 
             ///\name Unlink operations
             ///\{
 
-            virtual void unlink_file(FSPath, const std::shared_ptr<const ContentsEntry> &) const;
-            virtual void unlink_dir(FSPath, const std::shared_ptr<const ContentsEntry> &) const;
-            virtual void unlink_sym(FSPath, const std::shared_ptr<const ContentsEntry> &) const;
-            virtual void unlink_misc(FSPath, const std::shared_ptr<const ContentsEntry> &) const;
+            virtual void unlink_file(FSPath, const ContentsEntryView &) const;
+            virtual void unlink_dir(FSPath, const ContentsEntryView &) const;
+            virtual void unlink_sym(FSPath, const ContentsEntryView &) const;
+            virtual void unlink_misc(FSPath, const ContentsEntryView &) const;
 
             ///\}
 
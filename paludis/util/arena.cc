@@ -0,0 +1,130 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/util/arena.hh>
+#include <paludis/util/pimp-impl.hh>
+#include <paludis/util/exception.hh>
+#include <paludis/util/stringify.hh>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace paludis;
+
+namespace
+{
+    /* small trees are common, so start small and grow */
+    const std::size_t first_block_size(512);
+    const std::size_t max_block_size(64 * 1024);
+}
+
+namespace paludis
+{
+    template <>
+    struct Imp<Arena>
+    {
+        std::vector<void *> blocks;
+        char * current;
+        std::size_t remaining;
+        std::size_t next_block_size;
+        std::size_t bytes_allocated;
+
+        Imp() :
+            current(nullptr),
+            remaining(0),
+            next_block_size(first_block_size),
+            bytes_allocated(0)
+        {
+        }
+
+        ~Imp()
+        {
+            for (auto & b : blocks)
+                std::free(b);
+        }
+
+        void * new_block(const std::size_t size)
+        {
+            blocks.reserve(blocks.size() + 1);
+            void * result(std::malloc(size));
+            if (! result)
+                throw std::bad_alloc();
+            blocks.push_back(result);
+            return result;
+        }
+    };
+}
+
+Arena::Arena() :
+    _imp()
+{
+}
+
+Arena::~Arena() = default;
+
+void *
+Arena::allocate(const std::size_t size, const std::size_t alignment)
+{
+    if (0 == alignment || 0 != (alignment & (alignment - 1)) || alignment > alignof(std::max_align_t))
+        throw InternalError(PALUDIS_HERE, "Bad alignment " + stringify(alignment));
+
+    std::size_t padding((alignment - (reinterpret_cast<std::uintptr_t>(_imp->current) & (alignment - 1))) & (alignment - 1));
+
+    if (_imp->current && padding + size <= _imp->remaining)
+    {
+        void * result(_imp->current + padding);
+        _imp->current += padding + size;
+        _imp->remaining -= padding + size;
+        _imp->bytes_allocated += size;
+        return result;
+    }
+
+    /* anything too big to share a block gets one of its own, and doesn't
+     * waste what is left of the current block */
+    if (size > max_block_size / 4)
+    {
+        _imp->bytes_allocated += size;
+        return _imp->new_block(size);
+    }
+
+    std::size_t block_size(std::max(_imp->next_block_size, size));
+    _imp->next_block_size = std::min(_imp->next_block_size * 2, max_block_size);
+
+    /* malloc gives us suitable alignment for anything we accept */
+    char * block(static_cast<char *>(_imp->new_block(block_size)));
+    _imp->current = block + size;
+    _imp->remaining = block_size - size;
+    _imp->bytes_allocated += size;
+    return block;
+}
+
+std::size_t
+Arena::bytes_allocated() const
+{
+    return _imp->bytes_allocated;
+}
+
+namespace paludis
+{
+    template class Pimp<Arena>;
+}
+
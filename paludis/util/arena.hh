@@ -0,0 +1,156 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef PALUDIS_GUARD_PALUDIS_UTIL_ARENA_HH
+#define PALUDIS_GUARD_PALUDIS_UTIL_ARENA_HH 1
+
+#include <paludis/util/arena-fwd.hh>
+#include <paludis/util/attributes.hh>
+#include <paludis/util/pimp.hh>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/** \file
+ * Declarations for Arena and ArenaAllocator.
+ *
+ * \ingroup g_utils
+ *
+ * \section Examples
+ *
+ * - None at this time.
+ */
+
+namespace paludis
+{
+    /**
+     * A bump allocator. Memory is handed out from a few large blocks, and is
+     * only given back, all at once, when the Arena is destroyed.
+     *
+     * An Arena is not safe for concurrent allocation. Usually it is held via
+     * ArenaAllocator, which keeps it alive until the last object allocated
+     * from it has gone away.
+     *
+     * \ingroup g_utils
+     * \nosubgrouping
+     */
+    class PALUDIS_VISIBLE Arena
+    {
+        private:
+            Pimp<Arena> _imp;
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            Arena();
+            ~Arena();
+
+            Arena(const Arena &) = delete;
+            Arena & operator= (const Arena &) = delete;
+
+            ///\}
+
+            /**
+             * Allocate size bytes, aligned to alignment, which must be a power
+             * of two.
+             */
+            void * allocate(const std::size_t size, const std::size_t alignment) PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * How many bytes have been handed out so far, for statistics.
+             */
+            std::size_t bytes_allocated() const PALUDIS_ATTRIBUTE((warn_unused_result));
+    };
+
+    /**
+     * A standard allocator which allocates from an Arena, and keeps that
+     * Arena alive for as long as any copy of it exists.
+     *
+     * Deallocation does nothing, so this is only suitable for objects which
+     * are allocated once, such as those made by std::allocate_shared, and not
+     * for containers which grow.
+     *
+     * \ingroup g_utils
+     */
+    template <typename T_>
+    class ArenaAllocator
+    {
+        template <typename U_>
+        friend class ArenaAllocator;
+
+        private:
+            std::shared_ptr<Arena> _arena;
+
+        public:
+            typedef T_ value_type;
+
+            explicit ArenaAllocator(const std::shared_ptr<Arena> & a) :
+                _arena(a)
+            {
+            }
+
+            template <typename U_>
+            ArenaAllocator(const ArenaAllocator<U_> & other) :
+                _arena(other._arena)
+            {
+            }
+
+            T_ * allocate(const std::size_t n)
+            {
+                return static_cast<T_ *>(_arena->allocate(n * sizeof(T_), alignof(T_)));
+            }
+
+            void deallocate(T_ *, const std::size_t)
+            {
+            }
+
+            template <typename U_>
+            bool operator== (const ArenaAllocator<U_> & other) const
+            {
+                return _arena == other._arena;
+            }
+
+            template <typename U_>
+            bool operator!= (const ArenaAllocator<U_> & other) const
+            {
+                return _arena != other._arena;
+            }
+    };
+
+    /**
+     * Like std::make_shared, but with the object and its reference count
+     * allocated from an Arena if one is given.
+     *
+     * \ingroup g_utils
+     */
+    template <typename T_, typename... Args_>
+    std::shared_ptr<T_> make_shared_in(const std::shared_ptr<Arena> & arena, Args_ && ... args)
+    {
+        if (arena)
+            return std::allocate_shared<T_>(ArenaAllocator<T_>(arena), std::forward<Args_>(args)...);
+        else
+            return std::make_shared<T_>(std::forward<Args_>(args)...);
+    }
+
+    extern template class Pimp<Arena>;
+}
+
+#endif
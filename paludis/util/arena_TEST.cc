@@ -0,0 +1,95 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/util/arena.hh>
+
+#include <cstdint>
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+namespace
+{
+    struct Counted
+    {
+        static int count;
+
+        std::string value;
+
+        Counted(const std::string & v) :
+            value(v)
+        {
+            ++count;
+        }
+
+        ~Counted()
+        {
+            --count;
+        }
+    };
+
+    int Counted::count(0);
+}
+
+TEST(Arena, Alignment)
+{
+    Arena arena;
+    for (std::size_t align(1) ; align <= alignof(std::max_align_t) ; align *= 2)
+    {
+        void * p(arena.allocate(3, align));
+        EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(p) % align);
+    }
+}
+
+TEST(Arena, Large)
+{
+    Arena arena;
+    char * small(static_cast<char *>(arena.allocate(10, 1)));
+    char * large(static_cast<char *>(arena.allocate(1024 * 1024, 16)));
+    char * small_again(static_cast<char *>(arena.allocate(10, 1)));
+    large[1024 * 1024 - 1] = 'x';
+    EXPECT_EQ(small + 10, small_again);
+    EXPECT_EQ(1024u * 1024u + 20u, arena.bytes_allocated());
+}
+
+TEST(Arena, SharedObjects)
+{
+    std::shared_ptr<Counted> a, b;
+    {
+        auto arena(std::make_shared<Arena>());
+        a = make_shared_in<Counted>(arena, "first");
+        b = make_shared_in<Counted>(arena, "second");
+        EXPECT_LT(0u, arena->bytes_allocated());
+    }
+
+    EXPECT_EQ(2, Counted::count);
+    EXPECT_EQ("first", a->value);
+    a.reset();
+    EXPECT_EQ(1, Counted::count);
+    EXPECT_EQ("second", b->value);
+    b.reset();
+    EXPECT_EQ(0, Counted::count);
+
+    auto c(make_shared_in<Counted>(nullptr, "third"));
+    EXPECT_EQ("third", c->value);
+}
+
@@ -0,0 +1,306 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/util/character_class.hh>
+#include <atomic>
+
+#if defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#  define PALUDIS_CHARACTER_CLASS_SSE2 1
+#  include <emmintrin.h>
+#  if defined(__GNUC__)
+#    define PALUDIS_CHARACTER_CLASS_AVX2 1
+#    include <immintrin.h>
+#  endif
+#endif
+
+using namespace paludis;
+
+typedef CharacterClass::Range Range;
+
+namespace
+{
+    /* below this, setting up the vectors costs more than it saves */
+    const std::string::size_type vector_threshold(16);
+
+    std::atomic<bool> vectorised_enabled(true);
+
+#ifdef PALUDIS_CHARACTER_CLASS_SSE2
+    /*
+     * Each of these returns the position of the first (or, going backwards,
+     * one past the last) byte whose membership of ranges is want, or else
+     * the position where a scalar scan should take over for the leftover
+     * partial block.
+     */
+
+    typedef std::string::size_type (* ScanFunction) (const char * const, std::string::size_type, std::string::size_type,
+            const Range * const, const unsigned, const bool);
+
+    inline __m128i in_ranges_sse2(const __m128i x, const Range * const ranges, const unsigned n_ranges)
+    {
+        __m128i result(_mm_setzero_si128());
+        for (unsigned r(0) ; r < n_ranges ; ++r)
+        {
+            /* x is in [first, last] exactly when clamping it to that range
+             * leaves it unchanged, and SSE2 has unsigned byte min and max */
+            __m128i clamped(_mm_max_epu8(_mm_min_epu8(x, _mm_set1_epi8(char(ranges[r].last))),
+                        _mm_set1_epi8(char(ranges[r].first))));
+            result = _mm_or_si128(result, _mm_cmpeq_epi8(clamped, x));
+        }
+        return result;
+    }
+
+    std::string::size_type forward_sse2(const char * const p, std::string::size_type i, const std::string::size_type n,
+            const Range * const ranges, const unsigned n_ranges, const bool want)
+    {
+        for ( ; i + 16 <= n ; i += 16)
+        {
+            unsigned mask(_mm_movemask_epi8(in_ranges_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i)), ranges, n_ranges)));
+            if (! want)
+                mask = ~mask & 0xffffu;
+            if (0 != mask)
+                return i + __builtin_ctz(mask);
+        }
+        return i;
+    }
+
+    std::string::size_type backward_sse2(const char * const p, const std::string::size_type, std::string::size_type n,
+            const Range * const ranges, const unsigned n_ranges, const bool want)
+    {
+        for ( ; n >= 16 ; n -= 16)
+        {
+            unsigned mask(_mm_movemask_epi8(in_ranges_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + n - 16)), ranges, n_ranges)));
+            if (! want)
+                mask = ~mask & 0xffffu;
+            if (0 != mask)
+                return n - 16 + (32 - __builtin_clz(mask));
+        }
+        return n;
+    }
+
+#  ifdef PALUDIS_CHARACTER_CLASS_AVX2
+    __attribute__((target("avx2")))
+    inline __m256i in_ranges_avx2(const __m256i x, const Range * const ranges, const unsigned n_ranges)
+    {
+        __m256i result(_mm256_setzero_si256());
+        for (unsigned r(0) ; r < n_ranges ; ++r)
+        {
+            __m256i clamped(_mm256_max_epu8(_mm256_min_epu8(x, _mm256_set1_epi8(char(ranges[r].last))),
+                        _mm256_set1_epi8(char(ranges[r].first))));
+            result = _mm256_or_si256(result, _mm256_cmpeq_epi8(clamped, x));
+        }
+        return result;
+    }
+
+    __attribute__((target("avx2")))
+    std::string::size_type forward_avx2(const char * const p, std::string::size_type i, const std::string::size_type n,
+            const Range * const ranges, const unsigned n_ranges, const bool want)
+    {
+        for ( ; i + 32 <= n ; i += 32)
+        {
+            unsigned mask(_mm256_movemask_epi8(in_ranges_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i)), ranges, n_ranges)));
+            if (! want)
+                mask = ~mask;
+            if (0 != mask)
+                return i + __builtin_ctz(mask);
+        }
+        return forward_sse2(p, i, n, ranges, n_ranges, want);
+    }
+
+    __attribute__((target("avx2")))
+    std::string::size_type backward_avx2(const char * const p, const std::string::size_type i, std::string::size_type n,
+            const Range * const ranges, const unsigned n_ranges, const bool want)
+    {
+        for ( ; n >= 32 ; n -= 32)
+        {
+            unsigned mask(_mm256_movemask_epi8(in_ranges_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + n - 32)), ranges, n_ranges)));
+            if (! want)
+                mask = ~mask;
+            if (0 != mask)
+                return n - 32 + (32 - __builtin_clz(mask));
+        }
+        return backward_sse2(p, i, n, ranges, n_ranges, want);
+    }
+#  endif
+
+    bool have_avx2()
+    {
+#  ifdef PALUDIS_CHARACTER_CLASS_AVX2
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#  else
+        return false;
+#  endif
+    }
+
+    ScanFunction forward_function()
+    {
+#  ifdef PALUDIS_CHARACTER_CLASS_AVX2
+        static const ScanFunction result(have_avx2() ? &forward_avx2 : &forward_sse2);
+        return result;
+#  else
+        return &forward_sse2;
+#  endif
+    }
+
+    ScanFunction backward_function()
+    {
+#  ifdef PALUDIS_CHARACTER_CLASS_AVX2
+        static const ScanFunction result(have_avx2() ? &backward_avx2 : &backward_sse2);
+        return result;
+#  else
+        return &backward_sse2;
+#  endif
+    }
+#endif
+}
+
+CharacterClass::CharacterClass(const std::string_view & members) :
+    _bits{{0, 0, 0, 0}},
+    _n_ranges(0),
+    _too_many_ranges(false),
+    _complemented(false)
+{
+    for (const char c : members)
+    {
+        const unsigned char u(c);
+        _bits[u >> 6] |= std::uint64_t(1) << (u & 63);
+    }
+
+    _calculate_ranges();
+}
+
+void
+CharacterClass::_calculate_ranges()
+{
+    _n_ranges = 0;
+    _too_many_ranges = false;
+
+    /* walk runs of set bits a word at a time, since classes are built
+     * often enough (by simple_parser, for example) for this to matter */
+    for (unsigned w(0) ; w < 4 ; ++w)
+    {
+        std::uint64_t bits(_bits[w]);
+        while (0 != bits)
+        {
+            unsigned shift(__builtin_ctzll(bits));
+            std::uint64_t clear(~(bits >> shift));
+            unsigned run(0 == clear ? 64 : __builtin_ctzll(clear));
+            unsigned first(w * 64 + shift), last(first + run - 1);
+
+            if (0 != _n_ranges && _ranges[_n_ranges - 1].last + 1u == first)
+                _ranges[_n_ranges - 1].last = last;
+            else if (_n_ranges == max_ranges)
+            {
+                _too_many_ranges = true;
+                return;
+            }
+            else
+                _ranges[_n_ranges++] = Range{ static_cast<unsigned char>(first), static_cast<unsigned char>(last) };
+
+            bits = (64 == shift + run) ? 0 : bits & (~std::uint64_t(0) << (shift + run));
+        }
+    }
+}
+
+CharacterClass
+CharacterClass::complement() const
+{
+    CharacterClass result(*this);
+    result._complemented = ! _complemented;
+    return result;
+}
+
+std::string::size_type
+CharacterClass::find_first_in(const std::string_view & s, std::string::size_type pos) const
+{
+#ifdef PALUDIS_CHARACTER_CLASS_SSE2
+    /* the answer is often the very first byte, and checking that alone is
+     * cheaper than setting up the vectors */
+    if ((! _too_many_ranges) && vectorised_enabled.load(std::memory_order_relaxed) && pos < s.length() && s.length() - pos >= vector_threshold)
+    {
+        if (contains(s[pos]))
+            return pos;
+        pos = forward_function()(s.data(), pos, s.length(), _ranges.data(), _n_ranges, ! _complemented);
+    }
+#endif
+
+    for ( ; pos < s.length() ; ++pos)
+        if (contains(s[pos]))
+            return pos;
+
+    return std::string::npos;
+}
+
+std::string::size_type
+CharacterClass::find_first_not_in(const std::string_view & s, std::string::size_type pos) const
+{
+#ifdef PALUDIS_CHARACTER_CLASS_SSE2
+    if ((! _too_many_ranges) && vectorised_enabled.load(std::memory_order_relaxed) && pos < s.length() && s.length() - pos >= vector_threshold)
+    {
+        if (! contains(s[pos]))
+            return pos;
+        pos = forward_function()(s.data(), pos, s.length(), _ranges.data(), _n_ranges, _complemented);
+    }
+#endif
+
+    for ( ; pos < s.length() ; ++pos)
+        if (! contains(s[pos]))
+            return pos;
+
+    return std::string::npos;
+}
+
+std::string::size_type
+CharacterClass::find_last_not_in(const std::string_view & s) const
+{
+    std::string::size_type n(s.length());
+
+#ifdef PALUDIS_CHARACTER_CLASS_SSE2
+    if ((! _too_many_ranges) && vectorised_enabled.load(std::memory_order_relaxed) && n >= vector_threshold)
+    {
+        if (! contains(s[n - 1]))
+            return n - 1;
+        n = backward_function()(s.data(), 0, n, _ranges.data(), _n_ranges, _complemented);
+    }
+#endif
+
+    for ( ; n > 0 ; --n)
+        if (! contains(s[n - 1]))
+            return n - 1;
+
+    return std::string::npos;
+}
+
+
+void
+CharacterClass::set_vectorised(const bool v)
+{
+    vectorised_enabled.store(v, std::memory_order_relaxed);
+}
+
+bool
+CharacterClass::vectorised()
+{
+#ifdef PALUDIS_CHARACTER_CLASS_SSE2
+    return vectorised_enabled.load(std::memory_order_relaxed);
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,138 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef PALUDIS_GUARD_PALUDIS_UTIL_CHARACTER_CLASS_HH
+#define PALUDIS_GUARD_PALUDIS_UTIL_CHARACTER_CLASS_HH 1
+
+#include <paludis/util/character_class-fwd.hh>
+#include <paludis/util/attributes.hh>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/** \file
+ * Declarations for CharacterClass.
+ *
+ * \ingroup g_strings
+ *
+ * \section Examples
+ *
+ * - None at this time.
+ */
+
+namespace paludis
+{
+    /**
+     * A set of bytes, for fast scanning of strings.
+     *
+     * Scanning is vectorised where the processor allows it, so long as the
+     * set can be described by a handful of ranges, as is the case for
+     * whitespace and for the characters allowed in names. Otherwise, and for
+     * short strings, a lookup table is used. Vectorising can be turned off,
+     * so that benchmarks and tests can compare the two.
+     *
+     * \ingroup g_strings
+     */
+    class PALUDIS_VISIBLE CharacterClass
+    {
+        public:
+            ///\name Internal use
+            ///\{
+
+            static const unsigned max_ranges = 8;
+
+            struct Range
+            {
+                unsigned char first;
+                unsigned char last;
+            };
+
+            ///\}
+
+        private:
+            std::array<std::uint64_t, 4> _bits;
+            std::array<Range, max_ranges> _ranges;
+            unsigned _n_ranges;
+            bool _too_many_ranges;
+            bool _complemented;
+
+            void _calculate_ranges();
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            /**
+             * A class containing exactly the characters in members.
+             */
+            explicit CharacterClass(const std::string_view & members);
+
+            ///\}
+
+            /**
+             * A class containing every character we don't.
+             */
+            CharacterClass complement() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            bool contains(const char c) const PALUDIS_ATTRIBUTE((warn_unused_result))
+            {
+                const unsigned char u(c);
+                return _complemented != bool(_bits[u >> 6] & (std::uint64_t(1) << (u & 63)));
+            }
+
+            ///\name Scanning
+            ///\{
+
+            /**
+             * Like std::string::find_first_of.
+             */
+            std::string::size_type find_first_in(const std::string_view &, const std::string::size_type pos = 0) const
+                PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * Like std::string::find_first_not_of.
+             */
+            std::string::size_type find_first_not_in(const std::string_view &, const std::string::size_type pos = 0) const
+                PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * Like std::string::find_last_not_of.
+             */
+            std::string::size_type find_last_not_in(const std::string_view &) const
+                PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            ///\}
+
+            ///\name Vectorisation
+            ///\{
+
+            /**
+             * Whether scanning may be vectorised. Defaults to true.
+             */
+            static void set_vectorised(const bool);
+
+            static bool vectorised() PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            ///\}
+    };
+}
+
+#endif
@@ -0,0 +1,204 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/*
+ * Times the scans built on CharacterClass, using both its lookup table and
+ * its vectorised path, over every line of the given files. Directories are
+ * read recursively, so pass a metadata/md5-cache directory or /var/db/pkg.
+ *
+ * Usage: character_class_BENCHMARK [--runs n] path ...
+ *
+ * This is built but not installed, and is not run as a test.
+ */
+
+#include <paludis/util/character_class.hh>
+#include <paludis/util/tokeniser.hh>
+#include <paludis/util/strip.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/fs_stat.hh>
+#include <paludis/util/fs_iterator.hh>
+#include <paludis/util/options.hh>
+#include <paludis/util/safe_ifstream.hh>
+#include <paludis/util/destringify.hh>
+#include <paludis/util/exception.hh>
+#include <paludis/util/stringify.hh>
+#include <paludis/name.hh>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace paludis;
+
+namespace
+{
+    void read_lines(const FSPath & path, std::vector<std::string> & lines)
+    {
+        FSStat stat(path.stat());
+        if (stat.is_directory())
+        {
+            for (FSIterator d(path, { fsio_include_dotfiles }), d_end ; d != d_end ; ++d)
+                read_lines(*d, lines);
+        }
+        else if (stat.is_regular_file())
+        {
+            SafeIFStream file(path);
+            std::string line;
+            while (std::getline(file, line))
+                lines.push_back(line);
+        }
+    }
+
+    /* the category and package parts of anything that looks like a
+     * package dep spec, so that we validate names as they appear in
+     * dependencies and in the VDB */
+    void find_names(const std::vector<std::string> & lines,
+            std::vector<std::string> & categories, std::vector<std::string> & packages)
+    {
+        std::vector<std::string> tokens;
+        for (const auto & line : lines)
+        {
+            tokens.clear();
+            tokenise_whitespace(line.substr(line.find('=') + 1), std::back_inserter(tokens));
+            for (const auto & token : tokens)
+            {
+                std::string::size_type slash(token.find('/'));
+                if (std::string::npos == slash)
+                    continue;
+
+                std::string category(token.substr(0, slash)), package(token.substr(slash + 1));
+                category.erase(0, category.find_first_not_of("<>=~!"));
+                package.erase(std::min(package.find_first_of(":["), package.length()));
+
+                if (WrappedValueTraits<CategoryNamePartTag>::validate(category))
+                    categories.push_back(category);
+                if (WrappedValueTraits<PackageNamePartTag>::validate(package))
+                    packages.push_back(package);
+            }
+        }
+    }
+
+    double nanoseconds(const int runs, const std::size_t items, const std::function<void ()> & f)
+    {
+        auto start(std::chrono::steady_clock::now());
+        for (int n(0) ; n < runs ; ++n)
+            f();
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / runs / items;
+    }
+
+    /* nanoseconds per item, best of five rounds, alternating between the two
+     * paths so that both see the same noise */
+    void report(const std::string & what, const int runs, const std::size_t items, const std::function<void ()> & f)
+    {
+        if (0 == items)
+            return;
+
+        double scalar(0), vectorised(0);
+        for (int round(0) ; round < 5 ; ++round)
+        {
+            CharacterClass::set_vectorised(false);
+            double s(nanoseconds(runs, items, f));
+            CharacterClass::set_vectorised(true);
+            double v(nanoseconds(runs, items, f));
+
+            if (0 == round || s < scalar)
+                scalar = s;
+            if (0 == round || v < vectorised)
+                vectorised = v;
+        }
+
+        std::printf("%-24s %10zu %12.1f %12.1f %8.2f\n", what.c_str(), items, scalar, vectorised, scalar / vectorised);
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    try
+    {
+        std::vector<std::string> args(argv + 1, argv + argc);
+        int runs(20);
+        if (args.size() >= 2 && "--runs" == args.front())
+        {
+            runs = destringify<int>(args.at(1));
+            args.erase(args.begin(), args.begin() + 2);
+        }
+
+        if (args.empty())
+        {
+            std::cerr << "Usage: " << argv[0] << " [--runs n] path ..." << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::vector<std::string> lines;
+        for (const auto & a : args)
+            read_lines(FSPath(a), lines);
+
+        std::size_t bytes(0);
+        for (const auto & line : lines)
+            bytes += line.length() + 1;
+
+        std::vector<std::string> categories, packages;
+        find_names(lines, categories, packages);
+
+        if (! CharacterClass::vectorised())
+            std::cout << "No vectorised path was built, so both columns use the lookup table" << std::endl;
+        std::cout << lines.size() << " lines, " << bytes << " bytes" << std::endl;
+        std::printf("%-24s %10s %12s %12s %8s\n", "ns per item", "items", "scalar", "vectorised", "ratio");
+
+        volatile std::size_t sink(0);
+        std::vector<std::string> tokens;
+
+        report("tokenise_whitespace", runs, lines.size(), [&] () {
+                for (const auto & line : lines)
+                {
+                    tokens.clear();
+                    tokenise_whitespace(line, std::back_inserter(tokens));
+                    sink = sink + tokens.size();
+                }
+                });
+
+        report("strip_leading/trailing", runs, lines.size(), [&] () {
+                for (const auto & line : lines)
+                    sink = sink + strip_trailing(strip_leading(line, " \t\r\n"), " \t\r\n").length();
+                });
+
+        report("category validate()", runs, categories.size(), [&] () {
+                for (const auto & c : categories)
+                    sink = sink + WrappedValueTraits<CategoryNamePartTag>::validate(c);
+                });
+
+        report("package validate()", runs, packages.size(), [&] () {
+                for (const auto & p : packages)
+                    sink = sink + WrappedValueTraits<PackageNamePartTag>::validate(p);
+                });
+
+        return EXIT_SUCCESS;
+    }
+    catch (const Exception & e)
+    {
+        std::cerr << argv[0] << ": " << e.message() << " (" << e.what() << ")" << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,134 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/util/character_class.hh>
+
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+namespace
+{
+    const std::string classes[] = {
+        "",
+        " \t\r\n",
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-+_.",
+        "aceg",
+        "acegikmoqsuwy",
+        "\x80\xff",
+        "<=>?@AB",
+        "\n"
+    };
+
+    std::string all_except(const std::string & s)
+    {
+        std::string result;
+        for (unsigned c(0) ; c < 256 ; ++c)
+            if (std::string::npos == s.find(char(c)))
+                result.append(1, char(c));
+        return result;
+    }
+}
+
+TEST(CharacterClass, Contains)
+{
+    CharacterClass c("abc");
+    EXPECT_TRUE(c.contains('a'));
+    EXPECT_TRUE(c.contains('c'));
+    EXPECT_FALSE(c.contains('d'));
+    EXPECT_FALSE(c.contains('\0'));
+    EXPECT_TRUE(c.complement().contains('d'));
+    EXPECT_FALSE(c.complement().contains('b'));
+}
+
+TEST(CharacterClass, Simple)
+{
+    CharacterClass ws(" \t\r\n");
+    EXPECT_EQ(3u, ws.find_first_not_in("  \tfoo  "));
+    EXPECT_EQ(5u, ws.find_last_not_in("  \tfoo  "));
+    EXPECT_EQ(std::string::npos, ws.find_first_not_in("  \t  "));
+    EXPECT_EQ(std::string::npos, ws.find_last_not_in(""));
+    EXPECT_EQ(6u, ws.find_first_in("foobar baz", 2));
+}
+
+TEST(CharacterClass, Everything)
+{
+    const std::string everything(all_except(""));
+    CharacterClass c(everything);
+    EXPECT_EQ(std::string::npos, c.find_first_not_in(everything));
+    EXPECT_EQ(std::string::npos, c.find_last_not_in(everything));
+    EXPECT_EQ(0u, c.complement().find_first_not_in(everything));
+    EXPECT_EQ(std::string::npos, c.complement().find_first_in(everything));
+}
+
+namespace
+{
+    void check_random()
+    {
+        std::mt19937 rng(12345);
+        std::uniform_int_distribution<int> length_dist(0, 100), alphabet_dist(0, 3), byte_dist(0, 255);
+
+        for (const auto & members : classes)
+        {
+            const std::string complement_members(all_except(members));
+            const CharacterClass c(members), not_c(c.complement());
+
+            for (int iteration(0) ; iteration < 2000 ; ++iteration)
+            {
+                std::string s;
+                int length(length_dist(rng)), alphabet(alphabet_dist(rng));
+                for (int i(0) ; i < length ; ++i)
+                {
+                    if (0 == alphabet)
+                        s.append(1, char(byte_dist(rng)));
+                    else if (members.empty() || 1 == alphabet)
+                        s.append(1, " aZ9-\n\t"[byte_dist(rng) % 7]);
+                    else
+                        s.append(1, members[byte_dist(rng) % members.length()]);
+                }
+
+                std::string::size_type pos(s.empty() ? 0 : byte_dist(rng) % (s.length() + 1) / 4);
+
+                ASSERT_EQ(s.find_first_of(members, pos), c.find_first_in(s, pos)) << "'" << members << "' '" << s << "'";
+                ASSERT_EQ(s.find_first_not_of(members, pos), c.find_first_not_in(s, pos)) << "'" << members << "' '" << s << "'";
+                ASSERT_EQ(s.find_last_not_of(members), c.find_last_not_in(s)) << "'" << members << "' '" << s << "'";
+
+                ASSERT_EQ(s.find_first_of(complement_members, pos), not_c.find_first_in(s, pos));
+                ASSERT_EQ(s.find_first_not_of(complement_members, pos), not_c.find_first_not_in(s, pos));
+                ASSERT_EQ(s.find_last_not_of(complement_members), not_c.find_last_not_in(s));
+            }
+        }
+    }
+}
+
+TEST(CharacterClass, Random)
+{
+    check_random();
+}
+
+TEST(CharacterClass, RandomScalar)
+{
+    CharacterClass::set_vectorised(false);
+    check_random();
+    CharacterClass::set_vectorised(true);
+}
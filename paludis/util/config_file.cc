@@ -189,17 +189,32 @@ LineConfigFile::LineConfigFile(const Source & sr, const LineConfigFileOptions &
 {
     Context context("When parsing line-based configuration file '" + (sr.filename().empty() ? "?" : sr.filename()) + "':");
 
+    /* building an expression costs more than matching it against a typical
+     * line, so build each one once, rather than once per line */
+    std::string word;
+    std::string space;
+    const simple_parser::SimpleParserExpression
+        comment(*simple_parser::any_of(" \t") & simple_parser::exact("#") & *simple_parser::any_except("\n")),
+        newline(simple_parser::exact("\n")),
+        optional_whitespace(*simple_parser::any_of(" \t")),
+        whitespace(+simple_parser::any_of(" \t") >> space),
+        end_of_line(simple_parser::exact("\n") >> space),
+        continuation(simple_parser::exact("\\\n")),
+        backslash(simple_parser::exact("\\") >> word),
+        inline_comment(simple_parser::exact("#") & *simple_parser::any_except("\n")),
+        hash(simple_parser::exact("#") >> word),
+        text(+simple_parser::any_except(" \t\n\\#") >> word);
+
     SimpleParser parser(sr.text());
     while (! parser.eof())
     {
         /* is it a comment? */
         if (! _imp->options[lcfo_disallow_comments])
         {
-            if (parser.consume(*simple_parser::any_of(" \t") & simple_parser::exact("#") &
-                        *simple_parser::any_except("\n")))
+            if (parser.consume(comment))
             {
                 /* expect newline, but handle eof without final newline */
-                if (! parser.consume(simple_parser::exact("\n")))
+                if (! parser.consume(newline))
                 {
                     if (parser.eof())
                     {
@@ -216,7 +231,7 @@ LineConfigFile::LineConfigFile(const Source & sr, const LineConfigFileOptions &
         }
 
         if (! _imp->options[lcfo_preserve_whitespace])
-            if (! parser.consume(*simple_parser::any_of(" \t")))
+            if (! parser.consume(optional_whitespace))
                 throw InternalError(PALUDIS_HERE, "failed to consume a zero width match");
 
         if (parser.eof())
@@ -229,14 +244,12 @@ LineConfigFile::LineConfigFile(const Source & sr, const LineConfigFileOptions &
         /* is it a blank line? */
         if (! _imp->options[lcfo_no_skip_blank_lines])
         {
-            if (parser.consume(simple_parser::exact("\n")))
+            if (parser.consume(newline))
                 continue;
         }
 
         /* normal line, or lines with continuation */
         std::string line;
-        std::string word;
-        std::string space;
         bool need_single_space_unless_eol(false);
         while (true)
         {
@@ -246,20 +259,20 @@ LineConfigFile::LineConfigFile(const Source & sr, const LineConfigFileOptions &
                     << "No newline at end of file";
                 break;
             }
-            else if (parser.consume(+simple_parser::any_of(" \t") >> space))
+            else if (parser.consume(whitespace))
             {
                 if (_imp->options[lcfo_preserve_whitespace])
                     line.append(space);
                 else if (! line.empty())
                     need_single_space_unless_eol = true;
             }
-            else if (parser.consume(simple_parser::exact("\n") >> space))
+            else if (parser.consume(end_of_line))
                 break;
-            else if ((! _imp->options[lcfo_disallow_continuations]) && parser.consume(simple_parser::exact("\\\n")))
+            else if ((! _imp->options[lcfo_disallow_continuations]) && parser.consume(continuation))
             {
                 parse_after_continuation(sr, parser, ! _imp->options[lcfo_disallow_comments]);
             }
-            else if (parser.consume(simple_parser::exact("\\") >> word))
+            else if (parser.consume(backslash))
             {
                 if (need_single_space_unless_eol)
                 {
@@ -268,16 +281,15 @@ LineConfigFile::LineConfigFile(const Source & sr, const LineConfigFileOptions &
                 }
                 line.append(word);
             }
-            else if ((! line.empty()) && (_imp->options[lcfo_allow_inline_comments]) && parser.consume(simple_parser::exact("#") &
-                        *simple_parser::any_except("\n")))
+            else if ((! line.empty()) && (_imp->options[lcfo_allow_inline_comments]) && parser.consume(inline_comment))
             {
-                if (! parser.consume(simple_parser::exact("\n")))
+                if (! parser.consume(newline))
                     if (! parser.eof())
                         throw ConfigFileError(sr.filename(),
                                 "Something is very strange at line '" + stringify(parser.current_line_number()) + "'");
                 break;
             }
-            else if (parser.consume(simple_parser::exact("#") >> word))
+            else if (parser.consume(hash))
             {
                 if (need_single_space_unless_eol)
                 {
@@ -286,7 +298,7 @@ LineConfigFile::LineConfigFile(const Source & sr, const LineConfigFileOptions &
                 }
                 line.append(word);
             }
-            else if (parser.consume(+simple_parser::any_except(" \t\n\\#") >> word))
+            else if (parser.consume(text))
             {
                 if (need_single_space_unless_eol)
                 {
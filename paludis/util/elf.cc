@@ -27,6 +27,7 @@
 #include <paludis/util/elf_types.hh>
 
 #include <paludis/util/byte_swap.hh>
+#include <paludis/util/mapped_file.hh>
 #include <paludis/util/pimp-impl.hh>
 #include <paludis/util/wrapped_forward_iterator-impl.hh>
 #include <paludis/util/iterator_funcs.hh>
@@ -36,7 +37,6 @@
 #include <string>
 #include <exception>
 #include <stdexcept>
-#include <istream>
 #include <vector>
 #include <algorithm>
 
@@ -111,32 +111,6 @@ namespace
         shdr.sh_entsize   = byte_swap(shdr.sh_entsize);
     }
 
-    class StreamExceptions
-    {
-        private:
-            std::istream & _stream;
-            std::ios_base::iostate _old;
-
-        public:
-            StreamExceptions(std::istream & stream, std::ios_base::iostate flags) :
-                _stream(stream),
-                _old(stream.exceptions())
-            {
-                stream.exceptions(flags);
-            }
-
-            ~StreamExceptions()
-            {
-                try
-                {
-                    _stream.exceptions(_old);
-                }
-                catch (const std::ios_base::failure &)
-                {
-                }
-            }
-    };
-
     template <typename ElfType_>
     class StringResolvingVisitor
     {
@@ -222,138 +196,119 @@ InvalidElfFileError::InvalidElfFileError(const std::string & s) noexcept:
 
 template <typename ElfType_>
 bool
-ElfObject<ElfType_>::is_valid_elf(std::istream & stream)
+ElfObject<ElfType_>::is_valid_elf(const MappedFile & file)
 {
-    try
-    {
-        StreamExceptions exns(stream, std::ios::eofbit | std::ios::failbit | std::ios::badbit);
-
-        stream.seekg(0, std::ios::beg);
-
-        std::vector<char> ident(EI_NIDENT,0);
-        stream.read(&ident.front(), EI_NIDENT);
+    if (file.size() < EI_NIDENT)
+        return false;
 
-        // Check the magic \177ELF bytes
-        if ( ! (    (   ident[EI_MAG0] == ELFMAG0)
-                    && (ident[EI_MAG1] == ELFMAG1)
-                    && (ident[EI_MAG2] == ELFMAG2)
-                    && (ident[EI_MAG3] == ELFMAG3)
-                    ) )
-            return false;
+    const char * const ident(file.data());
 
-        // Check the ELF file version
-        if (ident[EI_VERSION] != EV_CURRENT)
-            return false;
+    // Check the magic \177ELF bytes
+    if ( ! (    (   ident[EI_MAG0] == ELFMAG0)
+                && (ident[EI_MAG1] == ELFMAG1)
+                && (ident[EI_MAG2] == ELFMAG2)
+                && (ident[EI_MAG3] == ELFMAG3)
+                ) )
+        return false;
 
-        // Check whether the endianness is valid
-        if ((ident[EI_DATA] != ELFDATA2LSB) && (ident[EI_DATA] != ELFDATA2MSB))
-            return false;
+    // Check the ELF file version
+    if (ident[EI_VERSION] != EV_CURRENT)
+        return false;
 
-        return (ident[EI_CLASS] == ElfType_::elf_class);
-    }
-    catch (const std::ios_base::failure &)
-    {
-        stream.clear();
+    // Check whether the endianness is valid
+    if ((ident[EI_DATA] != ELFDATA2LSB) && (ident[EI_DATA] != ELFDATA2MSB))
         return false;
-    }
+
+    return (ident[EI_CLASS] == ElfType_::elf_class);
 }
 
 template <typename ElfType_>
-ElfObject<ElfType_>::ElfObject(std::istream & stream) :
+ElfObject<ElfType_>::ElfObject(const MappedFile & file) :
     _imp()
 {
-    try
-    {
-        StreamExceptions exns(stream, std::ios::eofbit | std::ios::failbit | std::ios::badbit);
+    const std::string_view data(file.view());
 
-        stream.seekg(0, std::ios::beg);
-        stream.read(reinterpret_cast<char *>(&_hdr), sizeof(typename ElfType_::Header));
-        bool need_byte_swap(_hdr.e_ident[EI_DATA] != native_byte_order);
-        if (need_byte_swap)
-            ByteSwapElfHeader<ElfType_>::swap_in_place(_hdr);
+    if (data.size() < sizeof(typename ElfType_::Header))
+        throw InvalidElfFileError("file is too short to contain an ELF header");
 
-        std::vector<typename ElfType_::SectionHeader> shdrs;
-        if (_hdr.e_shoff)
-        {
-            if (sizeof(typename ElfType_::SectionHeader) != _hdr.e_shentsize)
-                throw InvalidElfFileError(
-                    "bad e_shentsize: got " + stringify(_hdr.e_shentsize) + ", expected " +
-                    stringify(sizeof(typename ElfType_::SectionHeader)));
+    _hdr = littlelf_internals::read_entry<typename ElfType_::Header>(data, 0);
+    bool need_byte_swap(_hdr.e_ident[EI_DATA] != native_byte_order);
+    if (need_byte_swap)
+        ByteSwapElfHeader<ElfType_>::swap_in_place(_hdr);
 
-            stream.seekg(0, std::ios::end);
-            typename ElfType_::Word max_shdrs(
-                (typename ElfType_::Word(stream.tellg()) - _hdr.e_shoff) / sizeof(typename ElfType_::SectionHeader));
-            stream.seekg(_hdr.e_shoff, std::ios::beg);
+    std::vector<typename ElfType_::SectionHeader> shdrs;
+    if (_hdr.e_shoff)
+    {
+        if (sizeof(typename ElfType_::SectionHeader) != _hdr.e_shentsize)
+            throw InvalidElfFileError(
+                "bad e_shentsize: got " + stringify(_hdr.e_shentsize) + ", expected " +
+                stringify(sizeof(typename ElfType_::SectionHeader)));
 
-            if (_hdr.e_shnum)
-            {
-                if (_hdr.e_shnum > max_shdrs)
-                    throw InvalidElfFileError(
-                        "file claims to contain " + stringify(_hdr.e_shnum) +
-                        " section headers, but is only big enough to contain " + stringify(max_shdrs));
-                std::vector<typename ElfType_::SectionHeader> my_shdrs(_hdr.e_shnum);
-
-                stream.read(reinterpret_cast<char *>(&my_shdrs.front()), sizeof(typename ElfType_::SectionHeader) * _hdr.e_shnum);
-                if (need_byte_swap)
-                    std::for_each(my_shdrs.begin(), my_shdrs.end(),
-                                  &ByteSwapSectionHeader<ElfType_>::swap_in_place);
-                shdrs.swap(my_shdrs);
-            }
-            else
-            {
-                typename ElfType_::SectionHeader first_shdr;
-                stream.read(reinterpret_cast<char *>(&first_shdr), sizeof(typename ElfType_::SectionHeader));
-                if (need_byte_swap)
-                    ByteSwapSectionHeader<ElfType_>::swap_in_place(first_shdr);
-                if (0 == first_shdr.sh_size)
-                    throw InvalidElfFileError("got non-zero e_shoff and zero e_shnum, but sh_size of the first section is zero");
-
-                if (first_shdr.sh_size > max_shdrs)
-                    throw InvalidElfFileError(
-                        "file claims to contain " + stringify(first_shdr.sh_size) +
-                        " section headers, but is only big enough to contain " + stringify(max_shdrs));
-                std::vector<typename ElfType_::SectionHeader> my_shdrs(first_shdr.sh_size);
-
-                my_shdrs[0] = first_shdr;
-                stream.read(reinterpret_cast<char *>(&my_shdrs[1]), sizeof(typename ElfType_::SectionHeader) * (first_shdr.sh_size - 1));
-                if (need_byte_swap)
-                    std::for_each(next(my_shdrs.begin()), my_shdrs.end(),
-                                  &ByteSwapSectionHeader<ElfType_>::swap_in_place);
-                shdrs.swap(my_shdrs);
-            }
-        }
+        if (_hdr.e_shoff > data.size())
+            throw InvalidElfFileError(
+                "section headers claim to start at offset " + stringify(_hdr.e_shoff) +
+                ", but the file is only " + stringify(data.size()) + " bytes long");
+
+        const std::string_view shdr_data(data.substr(_hdr.e_shoff));
+        std::size_t max_shdrs(shdr_data.size() / sizeof(typename ElfType_::SectionHeader));
+        if (0 == max_shdrs)
+            throw InvalidElfFileError("file is truncated, or an offset points past the end of the file");
+
+        typename ElfType_::SectionHeader first_shdr(
+                littlelf_internals::read_entry<typename ElfType_::SectionHeader>(shdr_data, 0));
+        if (need_byte_swap)
+            ByteSwapSectionHeader<ElfType_>::swap_in_place(first_shdr);
 
-        for (typename std::vector<typename ElfType_::SectionHeader>::iterator i = shdrs.begin(); i != shdrs.end(); ++i)
+        std::size_t shnum(_hdr.e_shnum);
+        if (0 == shnum)
         {
-            if (i->sh_type == SHT_STRTAB)
-                _imp->sections.push_back(std::make_shared<StringSection<ElfType_> >(_imp->sections.size(), *i, stream, need_byte_swap));
-            else if ( (i->sh_type == SHT_SYMTAB) || (i->sh_type == SHT_DYNSYM) )
-                _imp->sections.push_back(std::make_shared<SymbolSection<ElfType_> >(_imp->sections.size(), *i, stream, need_byte_swap));
-            else if (i->sh_type == SHT_DYNAMIC)
-                _imp->sections.push_back(std::make_shared<DynamicSection<ElfType_> >(_imp->sections.size(), *i, stream, need_byte_swap));
-            else if (i->sh_type == SHT_REL)
-                _imp->sections.push_back(std::make_shared<RelocationSection<ElfType_, Relocation<ElfType_> > >(_imp->sections.size(), *i, stream, need_byte_swap));
-            else if (i->sh_type == SHT_RELA)
-                _imp->sections.push_back(std::make_shared<RelocationSection<ElfType_, RelocationA<ElfType_> > >(_imp->sections.size(), *i, stream, need_byte_swap));
-            else
-                _imp->sections.push_back(std::make_shared<GenericSection<ElfType_> >(_imp->sections.size(), *i));
+            if (0 == first_shdr.sh_size)
+                throw InvalidElfFileError("got non-zero e_shoff and zero e_shnum, but sh_size of the first section is zero");
+            shnum = first_shdr.sh_size;
         }
 
-        if (! _hdr.e_shstrndx)
-            return;
-        typename ElfType_::Half shstrndx(SHN_XINDEX == _hdr.e_shstrndx ? shdrs[0].sh_link : _hdr.e_shstrndx);
-        if (_imp->sections.size() <= shstrndx)
+        if (shnum > max_shdrs)
             throw InvalidElfFileError(
-                "section name table has index " + stringify(shstrndx) +
-                ", but only found " + stringify(_imp->sections.size()) + " sections");
+                "file claims to contain " + stringify(shnum) +
+                " section headers, but is only big enough to contain " + stringify(max_shdrs));
 
-        littlelf_internals::SectionNameResolvingVisitor<ElfType_> res(section_begin(), section_end());
-        _imp->sections[shstrndx]->accept(res);
+        shdrs.reserve(shnum);
+        shdrs.push_back(first_shdr);
+        for (std::size_t i(1) ; i != shnum ; ++i)
+        {
+            shdrs.push_back(littlelf_internals::read_entry<typename ElfType_::SectionHeader>(shdr_data, i));
+            if (need_byte_swap)
+                ByteSwapSectionHeader<ElfType_>::swap_in_place(shdrs.back());
+        }
     }
-    catch (const std::ios_base::failure &)
+
+    _imp->sections.reserve(shdrs.size());
+    for (typename std::vector<typename ElfType_::SectionHeader>::iterator i = shdrs.begin(); i != shdrs.end(); ++i)
     {
-        throw InvalidElfFileError("file is truncated, or an offset points past the end of the file");
+        if (i->sh_type == SHT_STRTAB)
+            _imp->sections.push_back(std::make_shared<StringSection<ElfType_> >(_imp->sections.size(), *i, data, need_byte_swap));
+        else if ( (i->sh_type == SHT_SYMTAB) || (i->sh_type == SHT_DYNSYM) )
+            _imp->sections.push_back(std::make_shared<SymbolSection<ElfType_> >(_imp->sections.size(), *i, data, need_byte_swap));
+        else if (i->sh_type == SHT_DYNAMIC)
+            _imp->sections.push_back(std::make_shared<DynamicSection<ElfType_> >(_imp->sections.size(), *i, data, need_byte_swap));
+        else if (i->sh_type == SHT_REL)
+            _imp->sections.push_back(std::make_shared<RelocationSection<ElfType_, Relocation<ElfType_> > >(_imp->sections.size(), *i, data, need_byte_swap));
+        else if (i->sh_type == SHT_RELA)
+            _imp->sections.push_back(std::make_shared<RelocationSection<ElfType_, RelocationA<ElfType_> > >(_imp->sections.size(), *i, data, need_byte_swap));
+        else
+            _imp->sections.push_back(std::make_shared<GenericSection<ElfType_> >(_imp->sections.size(), *i));
     }
+
+    if (! _hdr.e_shstrndx)
+        return;
+    typename ElfType_::Half shstrndx(SHN_XINDEX == _hdr.e_shstrndx && ! shdrs.empty() ? shdrs[0].sh_link : _hdr.e_shstrndx);
+    if (_imp->sections.size() <= shstrndx)
+        throw InvalidElfFileError(
+            "section name table has index " + stringify(shstrndx) +
+            ", but only found " + stringify(_imp->sections.size()) + " sections");
+
+    littlelf_internals::SectionNameResolvingVisitor<ElfType_> res(section_begin(), section_end());
+    _imp->sections[shstrndx]->accept(res);
 }
 
 template <typename ElfType_>
@@ -24,9 +24,9 @@
 #include <paludis/util/elf_sections.hh>
 #include <paludis/util/exception.hh>
 #include <paludis/util/iterator_range.hh>
+#include <paludis/util/mapped_file-fwd.hh>
 #include <paludis/util/pimp.hh>
 #include <paludis/util/wrapped_forward_iterator-fwd.hh>
-#include <iosfwd>
 
 #include <elf.h>
 
@@ -43,6 +43,14 @@ namespace paludis
     template <typename ElfType_>
     struct ElfObjectSectionIteratorTag;
 
+    /**
+     * An ELF object, read from a MappedFile.
+     *
+     * Nothing is copied out of the mapping beyond the headers: strings are
+     * handed out as views into the string tables, and symbol and relocation
+     * tables are only decoded if they are iterated over. The MappedFile must
+     * therefore outlive the ElfObject and anything obtained from it.
+     */
     template <typename ElfType_>
     class PALUDIS_VISIBLE ElfObject
     {
@@ -52,8 +60,8 @@ namespace paludis
             typename ElfType_::Header _hdr;
 
         public:
-            static bool is_valid_elf(std::istream & stream);
-            ElfObject(std::istream & stream);
+            static bool is_valid_elf(const MappedFile & file);
+            ElfObject(const MappedFile & file);
             ~ElfObject();
 
             /**
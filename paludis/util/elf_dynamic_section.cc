@@ -32,7 +32,6 @@
 #include <paludis/util/wrapped_forward_iterator-impl.hh>
 #include <paludis/util/indirect_iterator-impl.hh>
 
-#include <istream>
 #include <map>
 #include <vector>
 #include <stdexcept>
@@ -231,8 +230,7 @@ DynamicEntryPointer<ElfType_>::initialize(typename ElfType_::Word index, const t
 
 template <typename ElfType_>
 DynamicEntryString<ElfType_>::DynamicEntryString(const std::string & name) :
-    DynamicEntry<ElfType_>(name),
-    _str("")
+    DynamicEntry<ElfType_>(name)
 {
 }
 
@@ -293,7 +291,7 @@ DynamicEntries<ElfType_>::has_entry(typename ElfType_::DynamicTag identifier) co
 }
 
 template <typename ElfType_>
-DynamicSection<ElfType_>::DynamicSection(typename ElfType_::Word index, const typename ElfType_::SectionHeader & shdr, std::istream & stream, bool need_byte_swap) :
+DynamicSection<ElfType_>::DynamicSection(typename ElfType_::Word index, const typename ElfType_::SectionHeader & shdr, std::string_view file, bool need_byte_swap) :
     Section<ElfType_>(index, shdr),
     _imp()
 {
@@ -302,17 +300,18 @@ DynamicSection<ElfType_>::DynamicSection(typename ElfType_::Word index, const ty
             "bad sh_entsize for " + this->description() + ": got " + stringify(shdr.sh_entsize) + ", expected " +
             stringify(sizeof(typename ElfType_::DynamicEntry)));
 
-    stream.seekg(shdr.sh_offset, std::ios::beg);
-    std::vector<typename ElfType_::DynamicEntry> tmp_entries(shdr.sh_size / sizeof(typename ElfType_::DynamicEntry));
-    stream.read( reinterpret_cast<char *>(&tmp_entries.front()), shdr.sh_size );
-    if (need_byte_swap)
-        std::for_each(tmp_entries.begin(), tmp_entries.end(),
-                      &ByteSwapDynamicEntry<ElfType_>::swap_in_place);
+    std::string_view data(this->get_data(file));
+    std::size_t count(data.size() / sizeof(typename ElfType_::DynamicEntry));
+    _imp->dynamic_entries.reserve(count);
 
-    for (typename std::vector<typename ElfType_::DynamicEntry>::iterator i = tmp_entries.begin(); i != tmp_entries.end(); ++i)
+    for (std::size_t i(0) ; i != count ; ++i)
     {
-        std::shared_ptr<DynamicEntry<ElfType_> > instance(DynamicEntries<ElfType_>::get_instance()->get_entry(i->d_tag));
-        instance->initialize(_imp->dynamic_entries.size(), *i);
+        auto entry(littlelf_internals::read_entry<typename ElfType_::DynamicEntry>(data, i));
+        if (need_byte_swap)
+            ByteSwapDynamicEntry<ElfType_>::swap_in_place(entry);
+
+        std::shared_ptr<DynamicEntry<ElfType_> > instance(DynamicEntries<ElfType_>::get_instance()->get_entry(entry.d_tag));
+        instance->initialize(_imp->dynamic_entries.size(), entry);
         _imp->dynamic_entries.push_back(instance);
     }
 }
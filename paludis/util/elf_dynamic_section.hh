@@ -31,7 +31,7 @@
 #include <paludis/util/type_list.hh>
 #include <memory>
 #include <string>
-#include <iosfwd>
+#include <string_view>
 
 namespace paludis
 {
@@ -147,20 +147,24 @@ namespace paludis
 
         private:
             typename ElfType_::DynamicValue _value;
-            std::string _str;
+            std::string_view _str;
 
         public:
             DynamicEntryString(const std::string &);
             ~DynamicEntryString() override;
             void initialize(typename ElfType_::Word, const typename ElfType_::DynamicEntry &) override;
 
-            std::string operator() () const
+            /**
+             * A view into the associated string table, valid for as long as
+             * the underlying MappedFile.
+             */
+            std::string_view operator() () const
             {
                 return _str;
             }
 
         private:
-            void resolve_string(std::string str)
+            void resolve_string(std::string_view str)
             {
                 _str = str;
             }
@@ -203,7 +207,7 @@ namespace paludis
             Pimp<DynamicSection> _imp;
 
         public:
-            DynamicSection(typename ElfType_::Word, const typename ElfType_::SectionHeader &, std::istream &, bool);
+            DynamicSection(typename ElfType_::Word, const typename ElfType_::SectionHeader &, std::string_view, bool);
             ~DynamicSection() override;
 
             std::string get_type() const override;
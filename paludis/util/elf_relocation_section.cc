@@ -25,8 +25,6 @@
 #include <paludis/util/pimp-impl.hh>
 #include <paludis/util/wrapped_forward_iterator-impl.hh>
 #include <paludis/util/stringify.hh>
-#include <algorithm>
-#include <istream>
 #include <vector>
 
 using namespace paludis;
@@ -36,7 +34,17 @@ namespace paludis
     template <typename ElfType_, typename Relocation_>
     struct Imp<RelocationSection<ElfType_, Relocation_> >
     {
-        std::vector<typename Relocation_::Entry> relocations;
+        std::string_view data;
+        bool need_byte_swap;
+
+        mutable bool relocations_done;
+        mutable std::vector<typename Relocation_::Entry> relocations;
+
+        Imp(bool s) :
+            need_byte_swap(s),
+            relocations_done(false)
+        {
+        }
     };
 
     template <typename ElfType_, typename Relocation_>
@@ -99,24 +107,16 @@ template <typename ElfType_> const std::string RelocationA<ElfType_>::type_name
 
 template <typename ElfType_, typename Relocation_>
 RelocationSection<ElfType_, Relocation_>::RelocationSection(
-    typename ElfType_::Word index, const typename ElfType_::SectionHeader & shdr, std::istream & stream, bool need_byte_swap) :
+    typename ElfType_::Word index, const typename ElfType_::SectionHeader & shdr, std::string_view file, bool need_byte_swap) :
     Section<ElfType_>(index, shdr),
-    _imp()
+    _imp(need_byte_swap)
 {
     if (sizeof(typename Relocation_::Type) != shdr.sh_entsize)
         throw InvalidElfFileError(
             "bad sh_entsize for " + this->description() + ": got " + stringify(shdr.sh_entsize) + ", expected " +
             stringify(sizeof(typename Relocation_::Type)));
 
-    std::vector<typename Relocation_::Type> relocations(shdr.sh_size / sizeof(typename Relocation_::Type));
-    stream.seekg(shdr.sh_offset, std::ios::beg);
-    stream.read(reinterpret_cast<char *>(&relocations.front()), shdr.sh_size);
-    if (need_byte_swap)
-        std::for_each(relocations.begin(), relocations.end(),
-                      &ByteSwapRelocation<ElfType_, Relocation_>::swap_in_place);
-
-    for (typename std::vector<typename Relocation_::Type>::iterator i = relocations.begin(); i != relocations.end(); ++i)
-        _imp->relocations.push_back(typename Relocation_::Entry(*i));
+    _imp->data = this->get_data(file);
 }
 
 template <typename ElfType_, typename Relocation_>
@@ -124,18 +124,41 @@ RelocationSection<ElfType_, Relocation_>::~RelocationSection()
 {
 }
 
+template <typename ElfType_, typename Relocation_>
+void
+RelocationSection<ElfType_, Relocation_>::_need_relocations() const
+{
+    if (_imp->relocations_done)
+        return;
+
+    std::size_t count(_imp->data.size() / sizeof(typename Relocation_::Type));
+    _imp->relocations.reserve(count);
+
+    for (std::size_t i(0) ; i != count ; ++i)
+    {
+        auto rel(littlelf_internals::read_entry<typename Relocation_::Type>(_imp->data, i));
+        if (_imp->need_byte_swap)
+            ByteSwapRelocation<ElfType_, Relocation_>::swap_in_place(rel);
+        _imp->relocations.push_back(typename Relocation_::Entry(rel));
+    }
+
+    _imp->relocations_done = true;
+}
+
 template <typename ElfType_, typename Relocation_>
 typename RelocationSection<ElfType_, Relocation_>::RelocationIterator
 RelocationSection<ElfType_, Relocation_>::relocation_begin() const
 {
-    return RelocationIterator(_imp->relocations.begin());
+    _need_relocations();
+    return RelocationIterator(_imp->relocations.cbegin());
 }
 
 template <typename ElfType_, typename Relocation_>
 typename RelocationSection<ElfType_, Relocation_>::RelocationIterator
 RelocationSection<ElfType_, Relocation_>::relocation_end() const
 {
-    return RelocationIterator(_imp->relocations.end());
+    _need_relocations();
+    return RelocationIterator(_imp->relocations.cend());
 }
 
 namespace paludis
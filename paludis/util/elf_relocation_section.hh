@@ -25,7 +25,7 @@
 #include <paludis/util/pimp.hh>
 #include <paludis/util/wrapped_forward_iterator-fwd.hh>
 
-#include <iosfwd>
+#include <string_view>
 
 namespace paludis
 {
@@ -95,6 +95,12 @@ namespace paludis
     template <typename ElfType_, typename Relocation_>
     struct RelocationSectionRelocationIteratorTag;
 
+    /**
+     * A relocation table.
+     *
+     * As with SymbolSection, entries are only decoded from the mapped file
+     * the first time they are iterated over.
+     */
     template <typename ElfType_, typename Relocation_>
     class RelocationSection :
         public Section<ElfType_>,
@@ -103,8 +109,10 @@ namespace paludis
         private:
             Pimp<RelocationSection> _imp;
 
+            void _need_relocations() const;
+
         public:
-            RelocationSection(typename ElfType_::Word, const typename ElfType_::SectionHeader &, std::istream &, bool);
+            RelocationSection(typename ElfType_::Word, const typename ElfType_::SectionHeader &, std::string_view, bool);
             ~RelocationSection() override;
 
             std::string get_type() const override
@@ -20,18 +20,15 @@
 
 #include <paludis/util/elf_sections.hh>
 #include <paludis/util/elf_types.hh>
+#include <paludis/util/elf.hh>
 #include <paludis/util/stringify.hh>
 
-#include <istream>
-#include <algorithm>
-
 using namespace paludis;
 
 template <typename ElfType_>
 Section<ElfType_>::Section(typename ElfType_::Word index, const typename ElfType_::SectionHeader & shdr) :
     _index(index),
-    _shdr(shdr),
-    _name("")
+    _shdr(shdr)
 {
 }
 
@@ -40,6 +37,18 @@ Section<ElfType_>::~Section()
 {
 }
 
+template <typename ElfType_>
+std::string_view
+Section<ElfType_>::get_data(std::string_view file) const
+{
+    if (_shdr.sh_offset > file.size() || _shdr.sh_size > file.size() - _shdr.sh_offset)
+        throw InvalidElfFileError(
+            description() + " claims to occupy " + stringify(_shdr.sh_size) + " bytes at offset " +
+            stringify(_shdr.sh_offset) + ", but the file is only " + stringify(file.size()) + " bytes long");
+
+    return file.substr(_shdr.sh_offset, _shdr.sh_size);
+}
+
 template <typename ElfType_>
 std::string
 Section<ElfType_>::description() const
@@ -68,14 +77,10 @@ GenericSection<ElfType_>::get_type() const
 }
 
 template <typename ElfType_>
-StringSection<ElfType_>::StringSection(typename ElfType_::Word index, const typename ElfType_::SectionHeader & shdr, std::istream & stream, bool) :
-    Section<ElfType_>(index, shdr),
-    _stringTable(shdr.sh_size, ' ')
+StringSection<ElfType_>::StringSection(typename ElfType_::Word index, const typename ElfType_::SectionHeader & shdr, std::string_view file, bool) :
+    Section<ElfType_>(index, shdr)
 {
-    std::string tmp_table(shdr.sh_size, '\0');
-    stream.seekg(shdr.sh_offset, std::ios::beg);
-    stream.read(&tmp_table[0], shdr.sh_size);
-    std::copy(tmp_table.begin(), tmp_table.end(), _stringTable.begin());
+    _stringTable = this->get_data(file);
 }
 
 template <typename ElfType_>
@@ -84,11 +89,12 @@ StringSection<ElfType_>::~StringSection()
 }
 
 template <typename ElfType_>
-std::string
+std::string_view
 StringSection<ElfType_>::get_string(typename ElfType_::Word index) const
 {
-    typename ElfType_::Word end(_stringTable.find_first_of('\0', index));
-    return _stringTable.substr(index, end-index);
+    /* substr throws std::out_of_range for us if index is past the end, and
+     * an unterminated final string runs to the end of the table */
+    return _stringTable.substr(index, _stringTable.find('\0', index) - index);
 }
 
 template <typename ElfType_>
@@ -22,7 +22,8 @@
 #define PALUDIS_GUARD_PALUDIS_UTIL_ELF_SECTIONS_HH 1
 
 #include <string>
-#include <iosfwd>
+#include <string_view>
+#include <cstring>
 #include <paludis/util/visitor.hh>
 #include <paludis/util/type_list.hh>
 
@@ -42,6 +43,18 @@ namespace paludis
     namespace littlelf_internals
     {
         template <typename ElfType_> class SectionNameResolvingVisitor;
+
+        /**
+         * Copy the n'th entry of type T_ out of a mapped table. The mapping
+         * makes no alignment promises for the table, so we never cast.
+         */
+        template <typename T_>
+        T_ read_entry(std::string_view table, std::size_t n)
+        {
+            T_ result;
+            std::memcpy(&result, table.data() + n * sizeof(T_), sizeof(T_));
+            return result;
+        }
     }
 
     template <typename ElfType_>
@@ -60,10 +73,10 @@ namespace paludis
         private:
             typename ElfType_::Word _index;
             typename ElfType_::SectionHeader _shdr;
-            std::string _name;
+            std::string_view _name;
 
         protected:
-            void resolve_section_name(std::string name)
+            void resolve_section_name(std::string_view name)
             {
                 _name = name;
             }
@@ -73,6 +86,14 @@ namespace paludis
                 return _shdr.sh_name;
             }
 
+            /**
+             * The part of the mapped file holding our contents.
+             *
+             * \exception InvalidElfFileError if our offset or size points
+             * past the end of the file.
+             */
+            std::string_view get_data(std::string_view file) const;
+
         public:
             Section(typename ElfType_::Word, const typename ElfType_::SectionHeader &);
             virtual ~Section();
@@ -84,7 +105,7 @@ namespace paludis
 
             virtual std::string get_name() const
             {
-                return _name;
+                return std::string(_name);
             }
             virtual std::string get_type() const = 0;
             typename ElfType_::Word get_index() const
@@ -128,13 +149,17 @@ namespace paludis
         public paludis::ImplementAcceptMethods<Section<ElfType_>, StringSection<ElfType_> >
     {
         private:
-            std::string _stringTable;
+            std::string_view _stringTable;
 
         public:
-            StringSection(typename ElfType_::Word, const typename ElfType_::SectionHeader &, std::istream &, bool);
+            StringSection(typename ElfType_::Word, const typename ElfType_::SectionHeader &, std::string_view, bool);
             ~StringSection() override;
 
-            std::string get_string(typename ElfType_::Word) const;
+            /**
+             * A view of the string starting at the given index, valid for
+             * as long as the underlying MappedFile.
+             */
+            std::string_view get_string(typename ElfType_::Word) const;
             typename ElfType_::Word get_max_string() const
             {
                 return _stringTable.length();
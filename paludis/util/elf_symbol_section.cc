@@ -30,10 +30,8 @@
 #include <paludis/util/wrapped_forward_iterator-impl.hh>
 #include <paludis/util/stringify.hh>
 
-#include <istream>
 #include <vector>
 #include <stdexcept>
-#include <algorithm>
 
 using namespace paludis;
 
@@ -42,7 +40,20 @@ namespace paludis
     template <typename ElfType_>
     struct Imp<SymbolSection<ElfType_> >
     {
-        std::vector<Symbol<ElfType_> > symbols;
+        std::string_view data;
+        bool need_byte_swap;
+        const StringSection<ElfType_> * string_section;
+
+        mutable bool symbols_done;
+        mutable std::vector<Symbol<ElfType_> > symbols;
+
+        Imp(std::string_view d, bool s) :
+            data(d),
+            need_byte_swap(s),
+            string_section(nullptr),
+            symbols_done(false)
+        {
+        }
     };
 
     template <typename ElfType_>
@@ -67,104 +78,89 @@ namespace
             sym.st_shndx = byte_swap(sym.st_shndx);
         }
     };
-}
 
-template <typename ElfType_>
-class littlelf_internals::SymbolStringResolvingVisitor
-{
-    private:
-        const SymbolSection<ElfType_> & _sym_section;
-        typename std::vector<Symbol<ElfType_> >::iterator _begin, _end;
-
-    public:
-        SymbolStringResolvingVisitor(const SymbolSection<ElfType_> & sym_section,
-            typename std::vector<Symbol<ElfType_> >::iterator begin,
-            typename std::vector<Symbol<ElfType_> >::iterator end) :
-            _sym_section(sym_section),
-            _begin(begin),
-            _end(end)
-        {
-        }
+    template <typename ElfType_>
+    class StringSectionFindingVisitor
+    {
+        public:
+            const StringSection<ElfType_> * result;
 
-        void visit(Section<ElfType_> &)
-        {
-        }
+            StringSectionFindingVisitor() :
+                result(nullptr)
+            {
+            }
 
-        void visit(StringSection<ElfType_> & string_section)
-        {
-            for (typename std::vector<Symbol<ElfType_> >::iterator i = _begin; i != _end; ++i)
-                try
-                {
-                    i->resolve_symbol(string_section.get_string(i->get_symbol_index()));
-                }
-                catch (std::out_of_range &)
-                {
-                    throw InvalidElfFileError(
-                        "symbol " + stringify(i - _begin) + " in " + _sym_section.description() + " has out-of-range string index " +
-                        stringify(i->get_symbol_index()) + " for " + string_section.description() +
-                        " (max " + stringify(string_section.get_max_string()) + ")");
-                }
-        }
-};
+            void visit(const Section<ElfType_> &)
+            {
+            }
+
+            void visit(const StringSection<ElfType_> & section)
+            {
+                result = &section;
+            }
+    };
+}
 
 template <typename ElfType_>
 Symbol<ElfType_>::Symbol(const typename ElfType_::Symbol & my_symbol) :
     _my_symbol(my_symbol),
-    _symbol_name("(unresolved)"),
-    _binding("invalid"),
-    _visibility("invalid")
+    _symbol_name("(unresolved)")
+{
+}
+
+template <typename ElfType_>
+Symbol<ElfType_>::~Symbol()
+{
+}
+
+template <typename ElfType_>
+std::string_view
+Symbol<ElfType_>::binding() const
 {
-    switch (ELF64_ST_BIND(my_symbol.st_info))
+    switch (ELF64_ST_BIND(_my_symbol.st_info))
     {
         case STB_LOCAL:
-            _binding = "local";
-            break;
+            return "local";
         case STB_GLOBAL:
-            _binding = "global";
-            break;
+            return "global";
         case STB_WEAK:
-            _binding = "weak";
-            break;
+            return "weak";
         case STB_LOOS:
-            _binding = "loos";
-            break;
+            return "loos";
         case STB_HIOS:
-            _binding = "hios";
-            break;
+            return "hios";
         case STB_LOPROC:
-            _binding = "loproc";
-            break;
+            return "loproc";
         case STB_HIPROC:
-            _binding = "hiproc";
-            break;
+            return "hiproc";
     }
 
-    switch (ELF64_ST_VISIBILITY(my_symbol.st_other))
+    return "invalid";
+}
+
+template <typename ElfType_>
+std::string_view
+Symbol<ElfType_>::visibility() const
+{
+    switch (ELF64_ST_VISIBILITY(_my_symbol.st_other))
     {
         case STV_DEFAULT:
-            _visibility = "default";
-            break;
+            return "default";
         case STV_INTERNAL:
-            _visibility = "internal";
-            break;
+            return "internal";
         case STV_HIDDEN:
-            _visibility = "hidden";
-            break;
+            return "hidden";
         case STV_PROTECTED:
-            _visibility = "protected";
-            break;
+            return "protected";
     }
-}
 
-template <typename ElfType_>
-Symbol<ElfType_>::~Symbol()
-{
+    return "invalid";
 }
 
 template <typename ElfType_>
-SymbolSection<ElfType_>::SymbolSection(typename ElfType_::Word index, const typename ElfType_::SectionHeader & shdr, std::istream & stream, bool need_byte_swap) :
+SymbolSection<ElfType_>::SymbolSection(typename ElfType_::Word index, const typename ElfType_::SectionHeader & shdr, std::string_view file, bool need_byte_swap) :
     Section<ElfType_>(index, shdr),
-    _imp(),
+    _imp(std::string_view(), need_byte_swap),
     _type("invalid")
 {
     if (shdr.sh_type == SHT_DYNSYM)
@@ -177,15 +173,7 @@ SymbolSection<ElfType_>::SymbolSection(typename ElfType_::Word index, const type
             "bad sh_entsize for " + this->description() + ": got " + stringify(shdr.sh_entsize) + ", expected " +
             stringify(sizeof(typename ElfType_::Symbol)));
 
-    std::vector<typename ElfType_::Symbol> symbols(shdr.sh_size / sizeof(typename ElfType_::Symbol));
-    stream.seekg(shdr.sh_offset, std::ios::beg);
-    stream.read( reinterpret_cast<char *>(&symbols.front()), shdr.sh_size );
-    if (need_byte_swap)
-        std::for_each(symbols.begin(), symbols.end(),
-                      &ByteSwapSymbol<ElfType_>::swap_in_place);
-
-    for (typename std::vector<typename ElfType_::Symbol>::iterator i = symbols.begin(); i != symbols.end(); ++i)
-        _imp->symbols.push_back(Symbol<ElfType_>(*i));
+    _imp->data = this->get_data(file);
 }
 
 template <typename ElfType_>
@@ -197,27 +185,68 @@ template <typename ElfType_>
 void
 SymbolSection<ElfType_>::resolve_symbols(Section<ElfType_> & string_section)
 {
-    littlelf_internals::SymbolStringResolvingVisitor<ElfType_> v(
-        *this, _imp->symbols.begin(), _imp->symbols.end());
+    StringSectionFindingVisitor<ElfType_> v;
     string_section.accept(v);
+    _imp->string_section = v.result;
+}
+
+template <typename ElfType_>
+void
+SymbolSection<ElfType_>::_need_symbols() const
+{
+    if (_imp->symbols_done)
+        return;
+
+    std::size_t count(_imp->data.size() / sizeof(typename ElfType_::Symbol));
+    std::vector<Symbol<ElfType_> > symbols;
+    symbols.reserve(count);
+
+    for (std::size_t i(0) ; i != count ; ++i)
+    {
+        auto sym(littlelf_internals::read_entry<typename ElfType_::Symbol>(_imp->data, i));
+        if (_imp->need_byte_swap)
+            ByteSwapSymbol<ElfType_>::swap_in_place(sym);
+        symbols.push_back(Symbol<ElfType_>(sym));
+
+        if (_imp->string_section)
+            try
+            {
+                symbols.back().resolve_symbol(_imp->string_section->get_string(sym.st_name));
+            }
+            catch (const std::out_of_range &)
+            {
+                throw InvalidElfFileError(
+                    "symbol " + stringify(i) + " in " + this->description() + " has out-of-range string index " +
+                    stringify(sym.st_name) + " for " + _imp->string_section->description() +
+                    " (max " + stringify(_imp->string_section->get_max_string()) + ")");
+            }
+    }
+
+    _imp->symbols.swap(symbols);
+    _imp->symbols_done = true;
 }
 
 template <typename ElfType_>
 typename SymbolSection<ElfType_>::SymbolIterator
 SymbolSection<ElfType_>::symbol_begin() const
 {
-    return SymbolIterator(_imp->symbols.begin());
+    _need_symbols();
+    return SymbolIterator(_imp->symbols.cbegin());
 }
 
 template <typename ElfType_>
 typename SymbolSection<ElfType_>::SymbolIterator
 SymbolSection<ElfType_>::symbol_end() const
 {
-    return SymbolIterator(_imp->symbols.end());
+    _need_symbols();
+    return SymbolIterator(_imp->symbols.cend());
 }
 
 namespace paludis
 {
+    template class PALUDIS_VISIBLE Symbol<Elf32Type>;
+    template class PALUDIS_VISIBLE Symbol<Elf64Type>;
+
     template class PALUDIS_VISIBLE SymbolSection<Elf32Type>;
     template class PALUDIS_VISIBLE SymbolSection<Elf64Type>;
 
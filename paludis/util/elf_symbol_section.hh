@@ -25,27 +25,21 @@
 #include <paludis/util/pimp.hh>
 #include <paludis/util/wrapped_forward_iterator-fwd.hh>
 
-#include <iosfwd>
+#include <string_view>
 
 namespace paludis
 {
-    namespace littlelf_internals
-    {
-        template <typename ElfType_> class SymbolStringResolvingVisitor;
-    }
-
     template <typename ElfType_>
     class Symbol
     {
-        friend class littlelf_internals::SymbolStringResolvingVisitor<ElfType_>;
+        friend class SymbolSection<ElfType_>;
 
         private:
             typename ElfType_::Symbol _my_symbol;
-            std::string _symbol_name;
-            std::string _binding, _visibility;
+            std::string_view _symbol_name;
 
         protected:
-            void resolve_symbol(std::string symbol_name)
+            void resolve_symbol(std::string_view symbol_name)
             {
                 _symbol_name = symbol_name;
             }
@@ -59,25 +53,30 @@ namespace paludis
             Symbol(const typename ElfType_::Symbol &);
             ~Symbol();
 
-            std::string name() const
+            /**
+             * A view into the associated string table, valid for as long as
+             * the underlying MappedFile.
+             */
+            std::string_view name() const
             {
                 return _symbol_name;
             }
 
-            std::string binding() const
-            {
-                return _binding;
-            }
+            std::string_view binding() const;
 
-            std::string visibility() const
-            {
-                return _visibility;
-            }
+            std::string_view visibility() const;
     };
 
     template <typename ElfType_>
     struct SymbolSectionSymbolIteratorTag;
 
+    /**
+     * A symbol table.
+     *
+     * Symbols are only decoded from the mapped file, and have their names
+     * looked up, the first time they are iterated over, so objects whose
+     * symbols are never inspected cost nothing beyond the section header.
+     */
     template <typename ElfType_>
     class SymbolSection :
         public Section<ElfType_>,
@@ -87,8 +86,10 @@ namespace paludis
             Pimp<SymbolSection> _imp;
             std::string _type;
 
+            void _need_symbols() const;
+
         public:
-            SymbolSection(typename ElfType_::Word, const typename ElfType_::SectionHeader &, std::istream &, bool);
+            SymbolSection(typename ElfType_::Word, const typename ElfType_::SectionHeader &, std::string_view, bool);
             ~SymbolSection() override;
 
             std::string get_type() const override
@@ -100,6 +101,11 @@ namespace paludis
 
             typedef SymbolSectionSymbolIteratorTag<ElfType_> SymbolIteratorTag;
             typedef paludis::WrappedForwardIterator<SymbolIteratorTag, const Symbol<ElfType_ > > SymbolIterator;
+
+            /**
+             * \exception InvalidElfFileError if a symbol has an out of range
+             * name index.
+             */
             SymbolIterator symbol_begin() const;
             SymbolIterator symbol_end() const;
     };
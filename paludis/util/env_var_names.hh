@@ -28,6 +28,7 @@ namespace paludis
     namespace env_vars
     {
         const std::string bypass_userpriv_checks("PALUDIS_BYPASS_USERPRIV_CHECKS");
+        const std::string config_snapshot("PALUDIS_CONFIG_SNAPSHOT");
         const std::string default_output_conf("PALUDIS_DEFAULT_OUTPUT_CONF");
         const std::string distribution("PALUDIS_DISTRIBUTION");
         const std::string distributions_dir("PALUDIS_DISTRIBUTIONS_DIR");
@@ -43,6 +44,7 @@ namespace paludis
         const std::string no_global_hooks("PALUDIS_NO_GLOBAL_HOOKS");
         const std::string no_global_sets("PALUDIS_NO_GLOBAL_SETS");
         const std::string no_global_syncers("PALUDIS_NO_GLOBAL_SYNCERS");
+        const std::string no_spawn("PALUDIS_NO_SPAWN");
         const std::string no_xml("PALUDIS_NO_XML");
         const std::string portage_bashrc("PALUDIS_PORTAGE_BASHRC");
         const std::string python_dir("PALUDIS_PYTHON_DIR");
@@ -35,28 +35,55 @@ using namespace paludis;
 
 namespace
 {
-    static thread_local std::list<std::string> context;
+    static thread_local const Context * current_context(nullptr);
 }
 
-Context::Context(const std::string & s)
+Context::Context(const std::string & s) :
+    _text(s),
+    _format(nullptr),
+    _previous(_push(this))
+{
+}
+
+Context::Context(std::string && s) :
+    _text(std::move(s)),
+    _format(nullptr),
+    _previous(_push(this))
 {
-    context.push_back(s);
 }
 
 Context::~Context() noexcept(false)
 {
-    if (context.empty())
-        throw InternalError(PALUDIS_HERE, "no context");
-    context.pop_back();
+    if (current_context != this)
+        throw InternalError(PALUDIS_HERE, "context stack mismatch");
+    current_context = _previous;
+}
+
+const Context *
+Context::_push(const Context * const c)
+{
+    const Context * const result(current_context);
+    current_context = c;
+    return result;
+}
+
+std::string
+Context::_describe() const
+{
+    return _format ? _format(_callable) : _text;
 }
 
 std::string
 Context::backtrace(const std::string & delim)
 {
-    if (context.empty())
+    if (! current_context)
         return "";
 
-    return join(context.begin(), context.end(), delim) + delim;
+    std::list<std::string> texts;
+    for (const Context * c(current_context) ; c ; c = c->_previous)
+        texts.push_front(c->_describe());
+
+    return join(texts.begin(), texts.end(), delim) + delim;
 }
 
 namespace paludis
@@ -67,7 +94,8 @@ namespace paludis
 
         ContextData()
         {
-            local_context.assign(context.begin(), context.end());
+            for (const Context * c(current_context) ; c ; c = c->_previous)
+                local_context.push_front(c->_describe());
         }
 
         ContextData(const ContextData & other) = default;
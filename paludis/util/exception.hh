@@ -23,7 +23,9 @@
 #include <paludis/util/attributes.hh>
 #include <exception>
 #include <memory>
+#include <new>
 #include <string>
+#include <type_traits>
 
 /** \file
  * Declaration for the Exception base class, the InternalError exception
@@ -41,6 +43,17 @@ namespace paludis
     /**
      * Backtrace context class.
      *
+     * A Context lives on the stack for the duration of a scope, and describes
+     * what is being done there. Contexts on a thread are chained together
+     * without any allocation, and their text is only used if a backtrace is
+     * made, for example when an Exception is created.
+     *
+     * Where building the description would be expensive, a callable returning
+     * the text can be passed instead, and will only be called if it is
+     * needed. The callable must be small and trivially copyable, such as a
+     * lambda capturing only by reference, and anything it references must
+     * outlive the Context.
+     *
      * \ingroup g_exceptions
      * \nosubgrouping
      */
@@ -50,11 +63,42 @@ namespace paludis
             Context(const Context &);
             const Context & operator= (const Context &);
 
+            const std::string _text;
+            std::string (* const _format)(const void * const);
+            alignas(void *) unsigned char _callable[4 * sizeof(void *)];
+            const Context * const _previous;
+
+            template <typename F_>
+            static std::string _call(const void * const f)
+            {
+                return (*static_cast<const F_ *>(f))();
+            }
+
+            static const Context * _push(const Context * const);
+
+            std::string _describe() const;
+
+            friend class Exception;
+
         public:
             ///\name Basic operations
             ///\{
 
             Context(const std::string &);
+            Context(std::string &&);
+
+            template <typename F_, typename = typename std::enable_if<
+                ! std::is_convertible<const F_ &, std::string>::value>::type>
+            explicit Context(const F_ & f) :
+                _format(&_call<F_>),
+                _previous(_push(this))
+            {
+                static_assert(sizeof(F_) <= sizeof(_callable) && alignof(F_) <= alignof(void *),
+                        "Context callable is too big to be stored inline");
+                static_assert(std::is_trivially_copyable<F_>::value && std::is_trivially_destructible<F_>::value,
+                        "Context callable must be trivially copyable");
+                new (_callable) F_(f);
+            }
 
             ~Context() noexcept(false);
 
@@ -0,0 +1,82 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/util/exception.hh>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+namespace
+{
+    struct TestError :
+        Exception
+    {
+        TestError() :
+            Exception("test")
+        {
+        }
+    };
+}
+
+TEST(Context, Backtrace)
+{
+    EXPECT_EQ("", Context::backtrace("|"));
+
+    Context c1("one");
+    {
+        Context c2(std::string("two"));
+        EXPECT_EQ("one|two|", Context::backtrace("|"));
+    }
+
+    EXPECT_EQ("one|", Context::backtrace("|"));
+}
+
+TEST(Context, Lazy)
+{
+    int calls(0);
+    std::string name("three");
+
+    Context c([&] { ++calls; return "When doing '" + name + "':"; });
+    EXPECT_EQ(0, calls);
+
+    EXPECT_EQ("When doing 'three':/", Context::backtrace("/"));
+    EXPECT_EQ(1, calls);
+
+    name = "four";
+    EXPECT_EQ("When doing 'four':/", Context::backtrace("/"));
+}
+
+TEST(Context, Exception)
+{
+    try
+    {
+        Context c1("one");
+        Context c2([] { return std::string("two"); });
+        throw TestError();
+    }
+    catch (const Exception & e)
+    {
+        EXPECT_FALSE(e.empty());
+        EXPECT_EQ("one|two|", e.backtrace("|"));
+    }
+
+    EXPECT_EQ("", Context::backtrace("|"));
+}
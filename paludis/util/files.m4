@@ -9,10 +9,12 @@ dnl `gtest', `impl', `testscript'. Note that there isn't much error checking don
 dnl on this file at present...
 
 add(`active_object_ptr',                 `hh', `cc', `fwd', `gtest')
+add(`arena',                             `hh', `cc', `fwd', `gtest')
 add(`attributes',                        `hh')
 add(`buffer_output_stream',              `hh', `cc', `fwd', `gtest')
 add(`byte_swap',                         `hh', `gtest')
 add(`channel',                           `hh', `cc')
+add(`character_class',                   `hh', `cc', `fwd', `gtest')
 add(`checked_delete',                    `hh')
 add(`clone',                             `hh', `impl')
 add(`config_file',                       `hh', `cc', `fwd', `se', `gtest', `testscript')
@@ -31,25 +33,29 @@ add(`elf_symbol_section',                `hh', `cc')
 add(`elf_types',                         `hh')
 add(`enum_iterator',                     `hh', `cc', `fwd', `gtest')
 add(`env_var_names',                     `hh', `cc')
-add(`exception',                         `hh', `cc')
+add(`exception',                         `hh', `cc', `gtest')
 add(`executor',                          `hh', `cc', `fwd')
 add(`extract_host_from_url',             `hh', `cc', `fwd', `gtest')
 add(`fd_holder',                         `hh')
+add(`fs_directory_reader',               `hh', `cc', `fwd', `gtest', `testscript')
 add(`fs_iterator',                       `hh', `cc', `fwd', `se', `gtest', `testscript')
 add(`fs_error',                          `hh', `cc')
 add(`fs_path',                           `hh', `cc', `fwd', `se', `gtest', `testscript')
 add(`fs_stat',                           `hh', `cc', `fwd', `gtest', `testscript')
 add(`graph',                             `hh', `cc', `fwd', `impl', `gtest')
 add(`hashes',                            `hh', `cc', `gtest')
+add(`instrumentation',                   `hh', `cc', `fwd', `gtest', `testscript')
 add(`iterator_funcs',                    `hh', `gtest')
 add(`iterator_range',                    `hh')
 add(`indirect_iterator',                 `hh', `fwd', `impl', `gtest')
 add(`is_file_with_extension',            `hh', `cc', `se', `gtest', `testscript')
 add(`join',                              `hh', `gtest')
+add(`json',                              `hh', `cc', `gtest')
 add(`log',                               `hh', `cc', `se', `gtest')
 add(`make_named_values',                 `hh', `cc')
 add(`make_shared_copy',                  `hh', `fwd')
 add(`map',                               `hh', `fwd', `impl', `cc')
+add(`mapped_file',                       `hh', `cc', `fwd', `gtest', `testscript')
 add(`member_iterator',                   `hh', `fwd', `impl', `gtest')
 add(`md5',                               `hh', `cc', `gtest')
 add(`named_value',                       `hh', `cc', `fwd')
@@ -0,0 +1,281 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/util/fs_directory_reader.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/fs_error.hh>
+#include <paludis/util/stringify.hh>
+#include <paludis/util/pimp-impl.hh>
+
+#include <vector>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#  include <sys/syscall.h>
+#endif
+
+#include "config.h"
+
+using namespace paludis;
+
+namespace
+{
+#ifdef __linux__
+    struct LinuxDirent64
+    {
+        ino64_t d_ino;
+        off64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+#endif
+
+    mode_t mode_from_dirent_type(unsigned char t)
+    {
+#ifdef HAVE_DIRENT_DTYPE
+        if (DT_UNKNOWN != t)
+            return DTTOIF(t);
+#endif
+        return 0;
+    }
+}
+
+namespace paludis
+{
+    template <>
+    struct Imp<FSDirectoryReader>
+    {
+        const FSPath dir;
+        int fd;
+
+#ifdef __linux__
+        std::vector<char> buffer;
+        long buffer_used;
+        long buffer_pos;
+#else
+        DIR * d;
+#endif
+
+        const char * name;
+        std::size_t name_length;
+        ino_t inode;
+
+        /* 0 if we don't know yet */
+        mutable mode_t type;
+        mutable mode_t deref_type;
+        mutable bool have_deref_type;
+
+        Imp(const FSPath & p) :
+            dir(p),
+            fd(::open(stringify(p).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)),
+#ifdef __linux__
+            buffer(32 * 1024),
+            buffer_used(0),
+            buffer_pos(0),
+#else
+            d(nullptr),
+#endif
+            name(nullptr),
+            name_length(0),
+            inode(0),
+            type(0),
+            deref_type(0),
+            have_deref_type(false)
+        {
+            if (-1 == fd)
+                throw FSError(errno, "Error opening directory '" + stringify(p) + "'");
+
+#ifndef __linux__
+            d = ::fdopendir(fd);
+            if (! d)
+            {
+                int e(errno);
+                ::close(fd);
+                throw FSError(e, "Error opening directory '" + stringify(p) + "'");
+            }
+#endif
+        }
+
+        ~Imp()
+        {
+#ifdef __linux__
+            ::close(fd);
+#else
+            ::closedir(d);
+#endif
+        }
+
+        bool read_one(unsigned char & t)
+        {
+#ifdef __linux__
+            if (buffer_pos >= buffer_used)
+            {
+                long n(::syscall(SYS_getdents64, fd, buffer.data(), buffer.size()));
+                if (-1 == n)
+                    throw FSError(errno, "Error reading directory '" + stringify(dir) + "'");
+                if (0 == n)
+                    return false;
+
+                buffer_used = n;
+                buffer_pos = 0;
+            }
+
+            const LinuxDirent64 * const de(reinterpret_cast<const LinuxDirent64 *>(buffer.data() + buffer_pos));
+            buffer_pos += de->d_reclen;
+
+            name = de->d_name;
+            inode = de->d_ino;
+            t = de->d_type;
+#else
+            errno = 0;
+            struct dirent * de(::readdir(d));
+            if (! de)
+            {
+                if (0 != errno)
+                    throw FSError(errno, "Error reading directory '" + stringify(dir) + "'");
+                return false;
+            }
+
+            name = de->d_name;
+            inode = de->d_ino;
+#  ifdef HAVE_DIRENT_DTYPE
+            t = de->d_type;
+#  else
+            t = 0;
+#  endif
+#endif
+            return true;
+        }
+
+        mode_t stat_type(const bool deref) const
+        {
+            struct stat st;
+            if (0 != ::fstatat(fd, name, &st, deref ? 0 : AT_SYMLINK_NOFOLLOW))
+                return 0;
+            return st.st_mode & S_IFMT;
+        }
+    };
+}
+
+FSDirectoryReader::FSDirectoryReader(const FSPath & p) :
+    _imp(p)
+{
+}
+
+FSDirectoryReader::~FSDirectoryReader() = default;
+
+bool
+FSDirectoryReader::next()
+{
+    unsigned char t;
+    do
+    {
+        if (! _imp->read_one(t))
+        {
+            _imp->name = nullptr;
+            return false;
+        }
+    } while ('.' == _imp->name[0] && ('\0' == _imp->name[1] || ('.' == _imp->name[1] && '\0' == _imp->name[2])));
+
+    _imp->name_length = std::strlen(_imp->name);
+    _imp->type = mode_from_dirent_type(t);
+    _imp->deref_type = 0;
+    _imp->have_deref_type = false;
+    return true;
+}
+
+std::string_view
+FSDirectoryReader::name() const
+{
+    return std::string_view(_imp->name, _imp->name_length);
+}
+
+ino_t
+FSDirectoryReader::inode() const
+{
+    return _imp->inode;
+}
+
+FSPath
+FSDirectoryReader::path() const
+{
+    return _imp->dir / std::string(name());
+}
+
+mode_t
+FSDirectoryReader::_type(const bool deref) const
+{
+    if (0 == _imp->type)
+        _imp->type = _imp->stat_type(false);
+
+    if ((! deref) || (! S_ISLNK(_imp->type)))
+        return _imp->type;
+
+    if (! _imp->have_deref_type)
+    {
+        _imp->deref_type = _imp->stat_type(true);
+        _imp->have_deref_type = true;
+    }
+
+    return _imp->deref_type;
+}
+
+bool
+FSDirectoryReader::is_directory() const
+{
+    return S_ISDIR(_type(false));
+}
+
+bool
+FSDirectoryReader::is_regular_file() const
+{
+    return S_ISREG(_type(false));
+}
+
+bool
+FSDirectoryReader::is_symlink() const
+{
+    return S_ISLNK(_type(false));
+}
+
+bool
+FSDirectoryReader::is_directory_or_symlink_to_directory() const
+{
+    return S_ISDIR(_type(true));
+}
+
+bool
+FSDirectoryReader::is_regular_file_or_symlink_to_regular_file() const
+{
+    return S_ISREG(_type(true));
+}
+
+namespace paludis
+{
+    template class Pimp<FSDirectoryReader>;
+}
@@ -0,0 +1,104 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef PALUDIS_GUARD_PALUDIS_UTIL_FS_DIRECTORY_READER_HH
+#define PALUDIS_GUARD_PALUDIS_UTIL_FS_DIRECTORY_READER_HH 1
+
+#include <paludis/util/fs_directory_reader-fwd.hh>
+#include <paludis/util/fs_path-fwd.hh>
+#include <paludis/util/attributes.hh>
+#include <paludis/util/pimp.hh>
+#include <string_view>
+#include <sys/types.h>
+
+namespace paludis
+{
+    /**
+     * Reads the entries in a directory one at a time, in whatever order the
+     * filesystem returns them.
+     *
+     * Unlike FSIterator, nothing is allocated per entry: names are views into
+     * a buffer that is reused as we go, and the entry type comes from the
+     * directory itself where the filesystem provides it, with a stat relative
+     * to the directory only when it doesn't.
+     *
+     * \ingroup g_fs
+     */
+    class PALUDIS_VISIBLE FSDirectoryReader
+    {
+        private:
+            Pimp<FSDirectoryReader> _imp;
+
+            mode_t _type(const bool deref) const;
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            /**
+             * \exception FSError if the directory cannot be opened.
+             */
+            explicit FSDirectoryReader(const FSPath &);
+
+            ~FSDirectoryReader();
+
+            FSDirectoryReader(const FSDirectoryReader &) = delete;
+            FSDirectoryReader & operator= (const FSDirectoryReader &) = delete;
+
+            ///\}
+
+            /**
+             * Move on to the next entry, skipping '.' and '..'. Must be called
+             * before the first entry can be used.
+             *
+             * \return false if there are no more entries.
+             * \exception FSError if reading the directory fails.
+             */
+            bool next() PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            ///\name The current entry
+            ///\{
+
+            /**
+             * Our name, which is only valid until next() is called.
+             */
+            std::string_view name() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            ino_t inode() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * Our full path. This allocates, so avoid it for entries that are
+             * going to be skipped.
+             */
+            FSPath path() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            bool is_directory() const PALUDIS_ATTRIBUTE((warn_unused_result));
+            bool is_regular_file() const PALUDIS_ATTRIBUTE((warn_unused_result));
+            bool is_symlink() const PALUDIS_ATTRIBUTE((warn_unused_result));
+            bool is_directory_or_symlink_to_directory() const PALUDIS_ATTRIBUTE((warn_unused_result));
+            bool is_regular_file_or_symlink_to_regular_file() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            ///\}
+    };
+
+    extern template class Pimp<FSDirectoryReader>;
+}
+
+#endif
@@ -0,0 +1,82 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/util/fs_directory_reader.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/fs_error.hh>
+#include <paludis/util/fs_stat.hh>
+
+#include <map>
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+TEST(FSDirectoryReader, Empty)
+{
+    FSDirectoryReader r(FSPath::cwd() / "fs_directory_reader_TEST_dir" / "empty");
+    EXPECT_FALSE(r.next());
+}
+
+TEST(FSDirectoryReader, NoEnt)
+{
+    EXPECT_THROW(FSDirectoryReader(FSPath::cwd() / "fs_directory_reader_TEST_dir" / "noent"), FSError);
+}
+
+TEST(FSDirectoryReader, Entries)
+{
+    const FSPath dir(FSPath::cwd() / "fs_directory_reader_TEST_dir" / "entries");
+
+    std::map<std::string, std::string> types;
+    FSDirectoryReader r(dir);
+    while (r.next())
+    {
+        EXPECT_EQ(dir / std::string(r.name()), r.path());
+        EXPECT_EQ(FSStat(r.path()).lowlevel_id().second, r.inode());
+
+        std::string t;
+        if (r.is_directory())
+            t.append("d");
+        if (r.is_regular_file())
+            t.append("f");
+        if (r.is_symlink())
+            t.append("l");
+        if (r.is_directory_or_symlink_to_directory())
+            t.append("D");
+        if (r.is_regular_file_or_symlink_to_regular_file())
+            t.append("F");
+
+        EXPECT_TRUE(types.insert(std::make_pair(std::string(r.name()), t)).second);
+    }
+
+    EXPECT_FALSE(r.next());
+
+    std::map<std::string, std::string> expected{
+        { ".dotdir", "dD" },
+        { ".dotfile", "fF" },
+        { "broken_symlink", "l" },
+        { "dir", "dD" },
+        { "file", "fF" },
+        { "symlink_to_dir", "lD" },
+        { "symlink_to_file", "lF" }
+    };
+    EXPECT_EQ(expected, types);
+}
@@ -0,0 +1,16 @@
+#!/usr/bin/env bash
+# vim: set ft=sh sw=4 sts=4 et :
+
+mkdir fs_directory_reader_TEST_dir || exit 2
+cd fs_directory_reader_TEST_dir || exit 3
+
+mkdir empty || exit 4
+
+mkdir entries || exit 4
+cd entries || exit 4
+mkdir dir .dotdir || exit 5
+touch file .dotfile || exit 5
+ln -s file symlink_to_file || exit 6
+ln -s dir symlink_to_dir || exit 6
+ln -s nothing broken_symlink || exit 6
+cd ..
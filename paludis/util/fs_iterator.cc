@@ -19,177 +19,105 @@
  */
 
 #include <paludis/util/fs_iterator.hh>
+#include <paludis/util/fs_directory_reader.hh>
 #include <paludis/util/fs_path.hh>
-#include <paludis/util/fs_error.hh>
-#include <paludis/util/fs_stat.hh>
 #include <paludis/util/stringify.hh>
 #include <paludis/util/exception.hh>
 #include <paludis/util/pimp-impl.hh>
 #include <paludis/util/options.hh>
-#include <paludis/util/tribool.hh>
 
-#include <dirent.h>
-#include <sys/types.h>
-#include <functional>
-#include <set>
-#include <cstring>
-#include <cerrno>
-
-#include "config.h"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
 
 using namespace paludis;
 
 #include <paludis/util/fs_iterator-se.cc>
 
-typedef std::multiset<std::pair<ino_t, FSPath>, std::function<bool (std::pair<ino_t, FSPath>, std::pair<ino_t, FSPath>)> > EntrySet;
-
-namespace paludis
+namespace
 {
-    template<>
-    struct Imp<FSIterator>
+    struct Entry
     {
-        std::shared_ptr<EntrySet> items;
-        EntrySet::iterator iter;
+        ino_t inode;
+        std::string name;
 
-        Imp(const std::shared_ptr<EntrySet> & ii) :
-            items(ii)
-        {
-        }
+        /* only built when someone dereferences us */
+        mutable std::unique_ptr<FSPath> path;
     };
 
-    bool compare_inode(const std::pair<ino_t, FSPath> & a, const std::pair<ino_t, FSPath> & b)
-    {
-        return a.first < b.first;
-    }
-
-    bool compare_name(const std::pair<ino_t, FSPath> & a, const std::pair<ino_t, FSPath> & b)
+    struct Entries
     {
-        return FSPathComparator()(a.second, b.second);
-    }
-}
+        std::shared_ptr<const FSPath> base;
+        std::vector<Entry> entries;
+    };
 
-namespace
-{
-#ifdef HAVE_DIRENT_DTYPE
-    Tribool determine_wants_using_dirent(struct dirent * de, const FSIteratorOptions & options)
+    bool want_entry(const FSDirectoryReader & r, const FSIteratorOptions & options)
     {
-        if (DT_UNKNOWN == de->d_type)
-            return indeterminate;
-
-        int s(DTTOIF(de->d_type));
+        if (! (options[fsio_want_directories] || options[fsio_want_regular_files]))
+            return true;
 
-        if (S_ISREG(s))
+        if (r.is_regular_file())
             return options[fsio_want_regular_files];
 
-        if (S_ISDIR(s))
+        if (r.is_directory())
             return options[fsio_want_directories];
 
-        if (S_ISLNK(s))
+        if (r.is_symlink() && options[fsio_deref_symlinks_for_wants])
         {
-            if (! options[fsio_deref_symlinks_for_wants])
-                return false;
+            if (r.is_regular_file_or_symlink_to_regular_file())
+                return options[fsio_want_regular_files];
 
-            return indeterminate;
+            if (r.is_directory_or_symlink_to_directory())
+                return options[fsio_want_directories];
         }
 
         return false;
     }
-#else
-    Tribool determine_wants_using_dirent(struct dirent *, const FSIteratorOptions &)
-    {
-        return indeterminate;
-    }
-#endif
+}
 
-    Tribool determine_wants_using_stat(const FSPath & f, const FSIteratorOptions & options)
+namespace paludis
+{
+    template<>
+    struct Imp<FSIterator>
     {
-        FSStat f_stat(f);
+        std::shared_ptr<Entries> items;
+        std::vector<Entry>::const_iterator iter;
 
-        if (f_stat.is_regular_file())
-            return options[fsio_want_regular_files];
-
-        if (f_stat.is_directory())
-            return options[fsio_want_directories];
-
-        if (f_stat.is_symlink())
+        Imp(const std::shared_ptr<Entries> & ii) :
+            items(ii)
         {
-            if (options[fsio_deref_symlinks_for_wants])
-            {
-                if (f_stat.is_regular_file_or_symlink_to_regular_file())
-                    return options[fsio_want_regular_files];
-
-                if (f_stat.is_directory_or_symlink_to_directory())
-                    return options[fsio_want_directories];
-            }
-
-            return false;
         }
-
-        return false;
-    }
+    };
 }
 
 FSIterator::FSIterator(const FSPath & base, const FSIteratorOptions & options) :
-    _imp(nullptr)
+    _imp(std::make_shared<Entries>())
 {
-    if (options[fsio_inode_sort])
-        _imp->items = std::make_shared<EntrySet>(&compare_inode);
-    else
-        _imp->items = std::make_shared<EntrySet>(&compare_name);
-
-    DIR * d(opendir(stringify(base).c_str()));
-    if (nullptr == d)
-        throw FSError(errno, "Error opening directory '" + stringify(base) + "'");
-
-    bool have_any_special_wants(options[fsio_want_directories] || options[fsio_want_regular_files]);
+    _imp->items->base = std::make_shared<FSPath>(base);
 
-    struct dirent * de;
-    bool done(false);
-    while (nullptr != ((de = readdir(d))))
+    FSDirectoryReader reader(base);
+    while (reader.next())
     {
-        if (done)
-            break;
-
-        bool want(false);
+        if ((! options[fsio_include_dotfiles]) && '.' == reader.name()[0])
+            continue;
 
-        if (! options[fsio_include_dotfiles])
-        {
-            if ('.' != de->d_name[0])
-                want = true;
-        }
-        else if (! (de->d_name[0] == '.' &&
-                    (de->d_name[1] == '\0' || (de->d_name[1] == '.' && de->d_name[2] == '\0'))))
-            want = true;
+        if (! want_entry(reader, options))
+            continue;
 
-        if (want)
-        {
-            FSPath f(stringify(base / std::string(de->d_name)));
-
-            if (have_any_special_wants)
-            {
-                // Determine if we want the file (regular file, directory, symlink to either)
-                // using the dirent type entry if it's available. If it can't be used to make
-                // the decision (we don't get the information if a symlink points to a regular
-                // file or directory), we use FSStat to figure it out
-                Tribool still_want = determine_wants_using_dirent(de, options);
-                if (still_want.is_indeterminate())
-                    still_want = determine_wants_using_stat(f, options);
-
-                want = still_want.is_true();
-            }
-
-            if (want)
-            {
-                _imp->items->insert(std::make_pair(de->d_ino, f));
-                if (options[fsio_first_only])
-                    done = true;
-            }
-        }
+        _imp->items->entries.push_back(Entry{ reader.inode(), std::string(reader.name()), nullptr });
+        if (options[fsio_first_only])
+            break;
     }
 
-    _imp->iter = _imp->items->begin();
+    if (options[fsio_inode_sort])
+        std::stable_sort(_imp->items->entries.begin(), _imp->items->entries.end(),
+                [] (const Entry & a, const Entry & b) { return a.inode < b.inode; });
+    else
+        std::sort(_imp->items->entries.begin(), _imp->items->entries.end(),
+                [] (const Entry & a, const Entry & b) { return a.name < b.name; });
 
-    closedir(d);
+    _imp->iter = _imp->items->entries.cbegin();
 }
 
 FSIterator::FSIterator(const FSIterator & other) :
@@ -199,9 +127,9 @@ FSIterator::FSIterator(const FSIterator & other) :
 }
 
 FSIterator::FSIterator() :
-    _imp(std::make_shared<EntrySet>(&compare_name))
+    _imp(std::make_shared<Entries>())
 {
-    _imp->iter = _imp->items->end();
+    _imp->iter = _imp->items->entries.cend();
 }
 
 FSIterator::~FSIterator() = default;
@@ -220,13 +148,15 @@ FSIterator::operator= (const FSIterator & other)
 const FSPath &
 FSIterator::operator* () const
 {
-    return _imp->iter->second;
+    if (! _imp->iter->path)
+        _imp->iter->path = std::make_unique<FSPath>(*_imp->items->base / _imp->iter->name);
+    return *_imp->iter->path;
 }
 
 const FSPath *
 FSIterator::operator-> () const
 {
-    return &_imp->iter->second;
+    return &operator* ();
 }
 
 FSIterator &
@@ -247,11 +177,11 @@ FSIterator::operator++ (int)
 bool
 paludis::operator== (const FSIterator & me, const FSIterator & other)
 {
-    if (other._imp->iter == other._imp->items->end())
-        return me._imp->iter == me._imp->items->end();
+    if (other._imp->iter == other._imp->items->entries.cend())
+        return me._imp->iter == me._imp->items->entries.cend();
 
-    if (me._imp->iter == me._imp->items->end())
-        return other._imp->iter == other._imp->items->end();
+    if (me._imp->iter == me._imp->items->entries.cend())
+        return other._imp->iter == other._imp->items->entries.cend();
 
     if (other._imp->items != me._imp->items)
         throw InternalError(PALUDIS_HERE, "comparing two different FSIterators.");
@@ -21,7 +21,6 @@
 #define PALUDIS_GUARD_PALUDIS_UTIL_HASHES_HH 1
 
 #include <paludis/util/attributes.hh>
-#include <paludis/util/wrapped_value-fwd.hh>
 #include <paludis/util/fs_path-fwd.hh>
 #include <cstddef>
 #include <tuple>
@@ -121,15 +120,6 @@ namespace paludis
         }
     };
 
-    template <typename Tag_>
-    struct Hash<WrappedValue<Tag_> >
-    {
-        std::size_t operator() (const WrappedValue<Tag_> & v) const
-        {
-            return Hash<typename WrappedValueTraits<Tag_>::UnderlyingType>()(v.value());
-        }
-    };
-
     template <typename T_>
     struct Hash<const T_>
     {
@@ -0,0 +1,340 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/util/instrumentation.hh>
+#include <paludis/util/pimp-impl.hh>
+#include <paludis/util/singleton-impl.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/fs_error.hh>
+#include <paludis/util/fd_holder.hh>
+#include <paludis/util/stringify.hh>
+#include <paludis/util/system.hh>
+#include <paludis/util/json.hh>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <vector>
+#include <cerrno>
+
+#include <unistd.h>
+#include <fcntl.h>
+
+using namespace paludis;
+
+namespace
+{
+    std::atomic<bool> instrumentation_enabled(false);
+    std::atomic<bool> instrumentation_records_events(false);
+
+    struct Event
+    {
+        /* exactly one of these is set */
+        const InstrumentationPoint * point;
+        std::string name;
+
+        std::string category;
+        unsigned long long start;
+        unsigned long long end;
+        long thread;
+    };
+
+    /* Each thread records its own events, so that threads don't contend
+     * with one another. The lock is only shared with whoever is writing a
+     * trace. */
+    struct ThreadEvents
+    {
+        std::mutex mutex;
+        std::vector<Event> events;
+    };
+
+    void write_microseconds(std::ostream & s, const unsigned long long ns)
+    {
+        s << (ns / 1000) << "." << std::setw(3) << std::setfill('0') << (ns % 1000) << std::setfill(' ');
+    }
+
+    void write_event(std::ostream & s, const Event & e, const pid_t pid)
+    {
+        s << "{\"name\":" << json_string(e.point ? e.point->name() : e.name)
+            << ",\"cat\":" << json_string(e.point ? "paludis" : e.category)
+            << ",\"ph\":\"X\",\"ts\":";
+        write_microseconds(s, e.start);
+        s << ",\"dur\":";
+        write_microseconds(s, e.end - e.start);
+        s << ",\"pid\":" << pid << ",\"tid\":" << e.thread << "}";
+    }
+}
+
+namespace paludis
+{
+    template <>
+    struct Imp<Instrumentation>
+    {
+        mutable std::mutex mutex;
+        std::vector<InstrumentationPoint *> points;
+        std::vector<std::shared_ptr<ThreadEvents> > threads;
+
+        ThreadEvents & events_for_this_thread()
+        {
+            static thread_local std::shared_ptr<ThreadEvents> events;
+            if (! events)
+            {
+                events = std::make_shared<ThreadEvents>();
+                std::unique_lock<std::mutex> lock(mutex);
+                threads.push_back(events);
+            }
+
+            return *events;
+        }
+    };
+}
+
+InstrumentationPoint::InstrumentationPoint(const std::string & n) :
+    _name(n),
+    _count(0),
+    _total(0),
+    _max(0)
+{
+    Instrumentation::get_instance()->_register(this);
+}
+
+const std::string &
+InstrumentationPoint::name() const
+{
+    return _name;
+}
+
+void
+InstrumentationPoint::count()
+{
+    if (Instrumentation::enabled())
+        _count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+InstrumentationPoint::add(const unsigned long long start, const unsigned long long end)
+{
+    const unsigned long long t(end - start);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _total.fetch_add(t, std::memory_order_relaxed);
+
+    unsigned long long m(_max.load(std::memory_order_relaxed));
+    while (t > m && ! _max.compare_exchange_weak(m, t, std::memory_order_relaxed))
+        ;
+
+    if (! Instrumentation::records_events())
+        return;
+
+    ThreadEvents & e(Instrumentation::get_instance()->_imp->events_for_this_thread());
+    std::unique_lock<std::mutex> lock(e.mutex);
+    e.events.push_back(Event{ this, "", "", start, end, current_thread_id() });
+}
+
+unsigned long long
+InstrumentationPoint::calls() const
+{
+    return _count.load();
+}
+
+unsigned long long
+InstrumentationPoint::total_time() const
+{
+    return _total.load();
+}
+
+unsigned long long
+InstrumentationPoint::max_time() const
+{
+    return _max.load();
+}
+
+Instrumentation::Instrumentation() :
+    _imp()
+{
+}
+
+Instrumentation::~Instrumentation() = default;
+
+void
+Instrumentation::_register(InstrumentationPoint * const p)
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->points.push_back(p);
+}
+
+bool
+Instrumentation::enabled()
+{
+    return instrumentation_enabled.load(std::memory_order_relaxed);
+}
+
+void
+Instrumentation::set_enabled(const bool b)
+{
+    instrumentation_enabled.store(b);
+}
+
+bool
+Instrumentation::records_events()
+{
+    return instrumentation_records_events.load(std::memory_order_relaxed);
+}
+
+void
+Instrumentation::set_records_events(const bool b)
+{
+    instrumentation_records_events.store(b);
+}
+
+unsigned long long
+Instrumentation::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void
+Instrumentation::add_event(const std::string & name, const std::string & category,
+        const unsigned long long start, const unsigned long long end)
+{
+    if (! (enabled() && records_events()))
+        return;
+
+    ThreadEvents & e(_imp->events_for_this_thread());
+    std::unique_lock<std::mutex> lock(e.mutex);
+    e.events.push_back(Event{ nullptr, name, category, start, end, current_thread_id() });
+}
+
+void
+Instrumentation::write_report(std::ostream & s) const
+{
+    std::vector<const InstrumentationPoint *> points;
+    {
+        std::unique_lock<std::mutex> lock(_imp->mutex);
+        std::copy_if(_imp->points.begin(), _imp->points.end(), std::back_inserter(points),
+                [] (const InstrumentationPoint * const p) { return 0 != p->calls(); });
+    }
+
+    std::sort(points.begin(), points.end(), [] (const InstrumentationPoint * const a, const InstrumentationPoint * const b) {
+            if (a->total_time() != b->total_time())
+                return a->total_time() > b->total_time();
+            if (a->calls() != b->calls())
+                return a->calls() > b->calls();
+            return a->name() < b->name();
+            });
+
+    s << std::left << std::setw(40) << "Point" << std::right
+        << std::setw(12) << "Calls" << std::setw(14) << "Total (ms)" << std::setw(14) << "Mean (us)"
+        << std::setw(14) << "Max (ms)" << std::endl;
+
+    for (const auto & p : points)
+    {
+        s << std::left << std::setw(40) << p->name() << std::right << std::setw(12) << p->calls();
+        if (0 == p->total_time())
+            s << std::setw(14) << "-" << std::setw(14) << "-" << std::setw(14) << "-";
+        else
+            s << std::fixed << std::setprecision(3)
+                << std::setw(14) << (p->total_time() / 1e6)
+                << std::setw(14) << (p->total_time() / 1e3 / p->calls())
+                << std::setw(14) << (p->max_time() / 1e6);
+        s << std::endl;
+    }
+
+    s << "Times include time spent in nested points." << std::endl;
+}
+
+void
+Instrumentation::write_chrome_trace(std::ostream & s) const
+{
+    std::vector<std::shared_ptr<ThreadEvents> > threads;
+    {
+        std::unique_lock<std::mutex> lock(_imp->mutex);
+        threads = _imp->threads;
+    }
+
+    const pid_t pid(::getpid());
+    bool first(true);
+
+    s << "{\"traceEvents\":[" << std::endl;
+    for (const auto & t : threads)
+    {
+        std::unique_lock<std::mutex> lock(t->mutex);
+        for (const auto & e : t->events)
+        {
+            if (! first)
+                s << "," << std::endl;
+            first = false;
+            write_event(s, e, pid);
+        }
+    }
+    s << std::endl << "],\"displayTimeUnit\":\"ms\"}" << std::endl;
+}
+
+void
+Instrumentation::append_chrome_trace_events(const FSPath & f) const
+{
+    std::vector<std::shared_ptr<ThreadEvents> > threads;
+    {
+        std::unique_lock<std::mutex> lock(_imp->mutex);
+        threads = _imp->threads;
+    }
+
+    const pid_t pid(::getpid());
+    std::stringstream s;
+    for (const auto & t : threads)
+    {
+        std::unique_lock<std::mutex> lock(t->mutex);
+        for (const auto & e : t->events)
+        {
+            write_event(s, e, pid);
+            s << ",\n";
+        }
+    }
+
+    /* whoever creates the file starts the array. nobody ends it, which trace
+     * viewers accept, so that any number of processes can append to it. */
+    std::string text(s.str());
+    int fd(::open(stringify(f).c_str(), O_WRONLY | O_APPEND | O_CREAT | O_EXCL | O_CLOEXEC, 0644));
+    if (-1 != fd)
+        text = "[\n" + text;
+    else if (EEXIST == errno)
+        fd = ::open(stringify(f).c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+
+    if (-1 == fd)
+        throw FSError(errno, "Couldn't open '" + stringify(f) + "' to append trace events");
+
+    FDHolder holder(fd, false);
+    if (text.empty())
+        return;
+
+    /* a single write, so that we don't interleave with anyone else */
+    ssize_t n(::write(fd, text.data(), text.length()));
+    if (n != static_cast<ssize_t>(text.length()))
+        throw FSError(-1 == n ? errno : EIO, "Couldn't append trace events to '" + stringify(f) + "'");
+}
+
+namespace paludis
+{
+    template class Pimp<Instrumentation>;
+    template class Singleton<Instrumentation>;
+}
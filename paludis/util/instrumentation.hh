@@ -0,0 +1,219 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef PALUDIS_GUARD_PALUDIS_UTIL_INSTRUMENTATION_HH
+#define PALUDIS_GUARD_PALUDIS_UTIL_INSTRUMENTATION_HH 1
+
+#include <paludis/util/instrumentation-fwd.hh>
+#include <paludis/util/fs_path-fwd.hh>
+#include <paludis/util/attributes.hh>
+#include <paludis/util/pimp.hh>
+#include <paludis/util/singleton.hh>
+#include <atomic>
+#include <iosfwd>
+#include <string>
+
+/** \file
+ * Declarations for Instrumentation and related classes.
+ *
+ * \ingroup g_log
+ *
+ * \section Examples
+ *
+ * - None at this time.
+ */
+
+namespace paludis
+{
+    /**
+     * A named place in the code whose calls are counted, and possibly timed,
+     * when instrumentation is enabled.
+     *
+     * These are intended to be function-local statics:
+     *
+     * \code
+     * static InstrumentationPoint point("selection.perform_select");
+     * ScopedInstrumentationTimer timer(point);
+     * \endcode
+     *
+     * \ingroup g_log
+     */
+    class PALUDIS_VISIBLE InstrumentationPoint
+    {
+        private:
+            const std::string _name;
+            std::atomic<unsigned long long> _count;
+            std::atomic<unsigned long long> _total;
+            std::atomic<unsigned long long> _max;
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            explicit InstrumentationPoint(const std::string &);
+
+            InstrumentationPoint(const InstrumentationPoint &) = delete;
+            InstrumentationPoint & operator= (const InstrumentationPoint &) = delete;
+
+            ///\}
+
+            const std::string & name() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * Count a call, without timing it. Does nothing if instrumentation
+             * is disabled.
+             */
+            void count();
+
+            /**
+             * Record a timed call, with times from Instrumentation::now(),
+             * keeping it for a trace if Instrumentation::records_events().
+             */
+            void add(const unsigned long long start, const unsigned long long end);
+
+            ///\name Totals so far
+            ///\{
+
+            unsigned long long calls() const PALUDIS_ATTRIBUTE((warn_unused_result));
+            unsigned long long total_time() const PALUDIS_ATTRIBUTE((warn_unused_result));
+            unsigned long long max_time() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            ///\}
+    };
+
+    /**
+     * Collects timings from InstrumentationPoint instances, and reports on
+     * them.
+     *
+     * Instrumentation is compiled in everywhere, but is disabled by default,
+     * in which case a ScopedInstrumentationTimer or
+     * InstrumentationPoint::count() costs one relaxed atomic load.
+     *
+     * \ingroup g_log
+     */
+    class PALUDIS_VISIBLE Instrumentation :
+        public Singleton<Instrumentation>
+    {
+        friend class Singleton<Instrumentation>;
+        friend class InstrumentationPoint;
+
+        private:
+            Pimp<Instrumentation> _imp;
+
+            Instrumentation();
+            ~Instrumentation();
+
+            void _register(InstrumentationPoint * const);
+
+        public:
+            /**
+             * Are we collecting anything? Cheap enough to call on hot paths.
+             */
+            static bool enabled() PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            void set_enabled(const bool);
+
+            /**
+             * Are we keeping every timed call and event for a trace, as well
+             * as the totals used by write_report()?
+             */
+            static bool records_events() PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * Keep every timed call and event for write_chrome_trace() and
+             * append_chrome_trace_events(). Off by default, because a report
+             * only needs the totals, and a long run can time millions of
+             * calls.
+             */
+            void set_records_events(const bool);
+
+            /**
+             * A monotonic time, in nanoseconds.
+             */
+            static unsigned long long now() PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * Record an event on the timeline used by write_chrome_trace(),
+             * with times from now(), if records_events(). Used for things
+             * that aren't naturally scoped, or whose names aren't known in
+             * advance.
+             */
+            void add_event(const std::string & name, const std::string & category,
+                    const unsigned long long start, const unsigned long long end);
+
+            /**
+             * Write a summary of every point that has been reached, most
+             * expensive first.
+             */
+            void write_report(std::ostream &) const;
+
+            /**
+             * Write every timed call and event in the Chrome trace event
+             * format, for use with a trace viewer.
+             */
+            void write_chrome_trace(std::ostream &) const;
+
+            /**
+             * Append every timed call and event to a file using the JSON
+             * array form of the Chrome trace event format, creating it if
+             * necessary. Several processes may append to the same file.
+             *
+             * \exception FSError if the file cannot be written.
+             */
+            void append_chrome_trace_events(const FSPath &) const;
+    };
+
+    /**
+     * Times the scope it lives in against an InstrumentationPoint.
+     *
+     * \ingroup g_log
+     */
+    class PALUDIS_VISIBLE ScopedInstrumentationTimer
+    {
+        private:
+            InstrumentationPoint * const _point;
+            const unsigned long long _start;
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            explicit ScopedInstrumentationTimer(InstrumentationPoint & p) :
+                _point(Instrumentation::enabled() ? &p : nullptr),
+                _start(_point ? Instrumentation::now() : 0)
+            {
+            }
+
+            ~ScopedInstrumentationTimer()
+            {
+                if (_point)
+                    _point->add(_start, Instrumentation::now());
+            }
+
+            ScopedInstrumentationTimer(const ScopedInstrumentationTimer &) = delete;
+            ScopedInstrumentationTimer & operator= (const ScopedInstrumentationTimer &) = delete;
+
+            ///\}
+    };
+
+    extern template class Pimp<Instrumentation>;
+}
+
+#endif
@@ -0,0 +1,135 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/util/instrumentation.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/safe_ifstream.hh>
+
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+TEST(Instrumentation, Disabled)
+{
+    static InstrumentationPoint point("test.disabled");
+    Instrumentation::get_instance()->set_enabled(false);
+
+    {
+        ScopedInstrumentationTimer timer(point);
+    }
+    point.count();
+
+    EXPECT_EQ(0u, point.calls());
+
+    std::stringstream s;
+    Instrumentation::get_instance()->write_report(s);
+    EXPECT_EQ(std::string::npos, s.str().find("test.disabled"));
+}
+
+TEST(Instrumentation, Timers)
+{
+    static InstrumentationPoint timed("test.timed"), counted("test.counted");
+    Instrumentation::get_instance()->set_enabled(true);
+    Instrumentation::get_instance()->set_records_events(true);
+
+    for (int i(0) ; i < 3 ; ++i)
+    {
+        ScopedInstrumentationTimer timer(timed);
+        counted.count();
+        counted.count();
+    }
+
+    const unsigned long long now(Instrumentation::now());
+    Instrumentation::get_instance()->add_event("some \"event\"", "test", now, now + 1500);
+
+    Instrumentation::get_instance()->set_enabled(false);
+    Instrumentation::get_instance()->set_records_events(false);
+
+    EXPECT_EQ(3u, timed.calls());
+    EXPECT_EQ(6u, counted.calls());
+    EXPECT_LE(timed.max_time(), timed.total_time());
+    EXPECT_EQ(0u, counted.total_time());
+
+    std::stringstream report;
+    Instrumentation::get_instance()->write_report(report);
+    EXPECT_NE(std::string::npos, report.str().find("test.timed"));
+    EXPECT_NE(std::string::npos, report.str().find("test.counted"));
+
+    std::stringstream trace;
+    Instrumentation::get_instance()->write_chrome_trace(trace);
+    EXPECT_EQ(0u, trace.str().find("{\"traceEvents\":["));
+    EXPECT_NE(std::string::npos, trace.str().find("{\"name\":\"test.timed\",\"cat\":\"paludis\",\"ph\":\"X\",\"ts\":"));
+    EXPECT_EQ(std::string::npos, trace.str().find("test.counted"));
+    EXPECT_NE(std::string::npos, trace.str().find("{\"name\":\"some \\\"event\\\"\",\"cat\":\"test\",\"ph\":\"X\",\"ts\":"));
+    EXPECT_NE(std::string::npos, trace.str().find(",\"dur\":1.500,"));
+}
+
+TEST(Instrumentation, ReportOnly)
+{
+    static InstrumentationPoint point("test.report_only");
+    Instrumentation::get_instance()->set_enabled(true);
+
+    {
+        ScopedInstrumentationTimer timer(point);
+    }
+    const unsigned long long now(Instrumentation::now());
+    Instrumentation::get_instance()->add_event("report only event", "test", now, now + 1000);
+
+    Instrumentation::get_instance()->set_enabled(false);
+
+    EXPECT_EQ(1u, point.calls());
+
+    std::stringstream report;
+    Instrumentation::get_instance()->write_report(report);
+    EXPECT_NE(std::string::npos, report.str().find("test.report_only"));
+
+    std::stringstream trace;
+    Instrumentation::get_instance()->write_chrome_trace(trace);
+    EXPECT_EQ(std::string::npos, trace.str().find("test.report_only"));
+    EXPECT_EQ(std::string::npos, trace.str().find("report only event"));
+}
+
+TEST(Instrumentation, Append)
+{
+    FSPath f(FSPath::cwd() / "instrumentation_TEST_dir" / "trace.json");
+
+    Instrumentation::get_instance()->set_enabled(true);
+    Instrumentation::get_instance()->set_records_events(true);
+    const unsigned long long now(Instrumentation::now());
+    Instrumentation::get_instance()->add_event("appended", "test", now, now + 2000);
+    Instrumentation::get_instance()->set_enabled(false);
+    Instrumentation::get_instance()->set_records_events(false);
+
+    Instrumentation::get_instance()->append_chrome_trace_events(f);
+    Instrumentation::get_instance()->append_chrome_trace_events(f);
+
+    SafeIFStream s(f);
+    std::string text((std::istreambuf_iterator<char>(s)), std::istreambuf_iterator<char>());
+
+    EXPECT_EQ(0u, text.find("[\n{"));
+    EXPECT_EQ(text.rfind("[\n"), 0u);
+    const std::string::size_type first(text.find("{\"name\":\"appended\""));
+    ASSERT_NE(std::string::npos, first);
+    EXPECT_NE(std::string::npos, text.find("{\"name\":\"appended\"", first + 1));
+    EXPECT_EQ(",\n", text.substr(text.length() - 2));
+}
@@ -0,0 +1,4 @@
+#!/usr/bin/env bash
+# vim: set ft=sh sw=4 sts=4 et :
+
+mkdir instrumentation_TEST_dir || exit 2
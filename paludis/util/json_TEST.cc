@@ -0,0 +1,39 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/util/json.hh>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+TEST(JSONString, Plain)
+{
+    EXPECT_EQ("\"\"", json_string(""));
+    EXPECT_EQ("\"cat/pkg-1:0::repo\"", json_string("cat/pkg-1:0::repo"));
+}
+
+TEST(JSONString, Escapes)
+{
+    EXPECT_EQ("\"a \\\"b\\\" c\\\\d\"", json_string("a \"b\" c\\d"));
+    EXPECT_EQ("\"\\n\\r\\t\"", json_string("\n\r\t"));
+    EXPECT_EQ("\"\\u0001\\u001f\"", json_string("\x01\x1f"));
+    EXPECT_EQ("\"\xc3\xa9\"", json_string("\xc3\xa9"));
+}
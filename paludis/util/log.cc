@@ -17,108 +17,394 @@
  * Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+
 #include <paludis/util/log.hh>
 #include <paludis/util/pimp-impl.hh>
 #include <paludis/util/singleton-impl.hh>
 #include <paludis/util/exception.hh>
+#include <paludis/util/system.hh>
+#include <paludis/util/json.hh>
 #include <iostream>
 #include <exception>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
+#include <ctime>
 
-#include "config.h"
+#include <pthread.h>
 
-#ifdef __linux__
-#  include <sys/time.h>
-#  include <sys/resource.h>
-#  include <unistd.h>
-#  include <sys/syscall.h>
-#endif
+#include "config.h"
 
 using namespace paludis;
 
 #include <paludis/util/log-se.cc>
 
+namespace
+{
+    struct LogRecord
+    {
+        unsigned long long sequence;
+        std::time_t time;
+        std::string id;
+        LogLevel level;
+        LogContext context;
+        long thread;
+
+        /* each Context's description, followed by a \0 */
+        std::string context_texts;
+
+        std::string message;
+    };
+
+    const std::size_t log_buffer_size(256);
+
+    /* One of these per thread that logs asynchronously. Only that thread
+     * adds records, and only the writer thread takes them, so neither side
+     * needs a lock. */
+    struct LogBuffer
+    {
+        LogRecord records[log_buffer_size];
+        std::atomic<std::size_t> head{0};
+        std::atomic<std::size_t> tail{0};
+        std::atomic<bool> abandoned{false};
+    };
+
+    struct ThreadLogBuffer
+    {
+        std::shared_ptr<LogBuffer> buffer;
+        unsigned long long generation = 0;
+
+        ~ThreadLogBuffer()
+        {
+            if (buffer)
+                buffer->abandoned.store(true);
+        }
+    };
+
+    std::atomic<unsigned long long> next_log_generation(1);
+
+    /* there's no writer thread in a child created by fork(), so anything the
+     * child logs has to be written directly */
+    std::atomic<bool> in_forked_child(false);
+
+    void mark_forked_child()
+    {
+        in_forked_child.store(true);
+    }
+}
+
 namespace paludis
 {
     template<>
     struct Imp<Log>
     {
+        std::atomic<LogLevel> log_level;
+        std::atomic<bool> asynchronous;
+        const unsigned long long generation;
+
+        /* protects everything to do with writing */
         std::mutex mutex;
-        LogLevel log_level;
         std::ostream * stream;
         std::string program_name;
+        LogFormat format;
         std::string previous_context;
 
+        /* protects everything to do with the writer thread */
+        std::mutex buffers_mutex;
+        std::vector<std::shared_ptr<LogBuffer> > buffers;
+        std::condition_variable writer_condition;
+        std::condition_variable written_condition;
+        std::condition_variable space_condition;
+        std::atomic<bool> writer_waiting;
+        std::atomic<unsigned long long> next_sequence;
+
+        /* every record with a lower sequence number has been written */
+        unsigned long long written;
+        bool stopping;
+        std::thread writer;
+
         Imp() :
             log_level(ll_qa),
+            asynchronous(false),
+            generation(next_log_generation++),
             stream(&std::cerr),
-            program_name("paludis")
+            program_name("paludis"),
+            format(lf_text),
+            writer_waiting(false),
+            next_sequence(0),
+            written(0),
+            stopping(false)
         {
+            static std::once_flag register_atfork;
+            std::call_once(register_atfork, [] { ::pthread_atfork(nullptr, nullptr, &mark_forked_child); });
+        }
+
+        ~Imp()
+        {
+            {
+                std::unique_lock<std::mutex> lock(buffers_mutex);
+                stopping = true;
+                writer_condition.notify_one();
+            }
+
+            if (writer.joinable())
+                writer.join();
         }
 
-        void message(const std::string id, const LogLevel l, const LogContext c, const std::string cs, const std::string s)
+        void write_text(const LogRecord & r)
         {
-            if (l >= log_level)
+            *stream << program_name << "@" << r.time << ": ";
+            do
             {
-                *stream << program_name << "@" << ::time(nullptr) << ": ";
-                do
+                switch (r.level)
                 {
-                    switch (l)
-                    {
-                        case ll_debug:
-                            *stream << "[DEBUG " << id << "] ";
-                            continue;
+                    case ll_debug:
+                        *stream << "[DEBUG " << r.id << "] ";
+                        continue;
 
-                        case ll_qa:
-                            *stream << "[QA " << id << "] ";
-                            continue;
+                    case ll_qa:
+                        *stream << "[QA " << r.id << "] ";
+                        continue;
 
-                        case ll_warning:
-                            *stream << "[WARNING " << id << "] ";
-                            continue;
+                    case ll_warning:
+                        *stream << "[WARNING " << r.id << "] ";
+                        continue;
 
-                        case ll_silent:
-                            throw InternalError(PALUDIS_HERE, "ll_silent used for a message");
+                    case ll_silent:
+                        throw InternalError(PALUDIS_HERE, "ll_silent used for a message");
 
-                        case last_ll:
-                            break;
-                    }
+                    case last_ll:
+                        break;
+                }
 
-                    throw InternalError(PALUDIS_HERE, "Bad value for log_level");
+                throw InternalError(PALUDIS_HERE, "Bad value for log_level");
 
-                } while (false);
+            } while (false);
 
-                if (lc_context == c)
-                {
-                    if (previous_context == cs)
-                        *stream << "(same context) " << s << std::endl;
+            if (lc_context == r.context)
+            {
+                std::string cs("In thread ID '" + stringify(r.thread) + "':\n  ... ");
+                for (const char c : r.context_texts)
+                    if ('\0' == c)
+                        cs.append("\n  ... ");
                     else
-                        *stream << cs << s << std::endl;
-                    previous_context = cs;
-                }
+                        cs.append(1, c);
+
+                if (previous_context == cs)
+                    *stream << "(same context) " << r.message << std::endl;
                 else
-                    *stream << s << std::endl;
+                    *stream << cs << r.message << std::endl;
+                previous_context = cs;
             }
+            else
+                *stream << r.message << std::endl;
         }
 
-        void set_log_level(const LogLevel l)
+        void write_json(const LogRecord & r)
         {
-            log_level = l;
+            if (ll_silent == r.level || last_ll == r.level)
+                throw InternalError(PALUDIS_HERE, "Bad value for log_level");
+
+            *stream << "{\"program\":" << json_string(program_name)
+                << ",\"time\":" << r.time << ",\"level\":\"" << r.level << "\",\"id\":" << json_string(r.id)
+                << ",\"thread\":" << r.thread;
+
+            if (lc_context == r.context)
+            {
+                *stream << ",\"context\":[";
+                std::string::size_type p(0), q;
+                while (std::string::npos != ((q = r.context_texts.find('\0', p))))
+                {
+                    if (0 != p)
+                        *stream << ",";
+                    *stream << json_string(r.context_texts.substr(p, q - p));
+                    p = q + 1;
+                }
+                *stream << "]";
+            }
+
+            *stream << ",\"message\":" << json_string(r.message) << "}" << std::endl;
         }
 
-        void get_log_level(LogLevel & l) const
+        /* with mutex held */
+        void write(const LogRecord & r)
         {
-            l = log_level;
+            if (r.level < log_level.load())
+                return;
+
+            switch (format)
+            {
+                case lf_text:
+                    write_text(r);
+                    return;
+
+                case lf_json:
+                    write_json(r);
+                    return;
+
+                case last_lf:
+                    break;
+            }
+
+            throw InternalError(PALUDIS_HERE, "Bad value for log_format");
         }
 
-        void set_program_name(const std::string & s)
+        void wake_writer()
         {
-            program_name = s;
+            if (writer_waiting.load())
+            {
+                std::unique_lock<std::mutex> lock(buffers_mutex);
+                writer_condition.notify_one();
+            }
         }
 
-        void set_log_stream(std::ostream * const s)
+        void enqueue(LogRecord && r)
         {
-            stream = s;
+            static thread_local ThreadLogBuffer thread_buffer;
+
+            if (thread_buffer.generation != generation)
+            {
+                if (thread_buffer.buffer)
+                    thread_buffer.buffer->abandoned.store(true);
+                thread_buffer.buffer = std::make_shared<LogBuffer>();
+                thread_buffer.generation = generation;
+
+                std::unique_lock<std::mutex> lock(buffers_mutex);
+                buffers.push_back(thread_buffer.buffer);
+                if (! writer.joinable())
+                    writer = std::thread(&Imp<Log>::run_writer, this);
+            }
+
+            LogBuffer & b(*thread_buffer.buffer);
+            std::size_t tail(b.tail.load(std::memory_order_relaxed));
+            if (tail - b.head.load(std::memory_order_acquire) >= log_buffer_size)
+            {
+                std::unique_lock<std::mutex> lock(buffers_mutex);
+                writer_condition.notify_one();
+                space_condition.wait(lock, [&] {
+                        return tail - b.head.load(std::memory_order_acquire) < log_buffer_size; });
+            }
+
+            /* the slot is ours, so take the sequence number and publish
+             * straight away. Another thread can still publish a later number
+             * in between, which is why the writer waits for gaps to fill. */
+            LogRecord & slot(b.records[tail % log_buffer_size]);
+            slot = std::move(r);
+            slot.sequence = next_sequence++;
+            b.tail.store(tail + 1);
+
+            wake_writer();
+        }
+
+        /* with buffers_mutex held */
+        void collect(std::vector<LogRecord> & into)
+        {
+            bool any(false);
+            for (auto i(buffers.begin()) ; i != buffers.end() ; )
+            {
+                LogBuffer & b(**i);
+                bool abandoned(b.abandoned.load());
+                std::size_t head(b.head.load(std::memory_order_relaxed)), tail(b.tail.load());
+                any = any || head != tail;
+                for ( ; head != tail ; ++head)
+                    into.push_back(std::move(b.records[head % log_buffer_size]));
+                b.head.store(head, std::memory_order_release);
+
+                if (abandoned)
+                    i = buffers.erase(i);
+                else
+                    ++i;
+            }
+
+            if (any)
+            {
+                std::sort(into.begin(), into.end(), [] (const LogRecord & a, const LogRecord & b) {
+                        return a.sequence < b.sequence; });
+                space_condition.notify_all();
+            }
+        }
+
+        /* with buffers_mutex held */
+        bool next_is_ready(const std::vector<LogRecord> & pending) const
+        {
+            return (! pending.empty()) && written == pending.front().sequence;
+        }
+
+        void run_writer()
+        {
+            std::vector<LogRecord> pending;
+            while (true)
+            {
+                bool stop;
+                unsigned long long first;
+                {
+                    std::unique_lock<std::mutex> lock(buffers_mutex);
+                    collect(pending);
+                    while (! (stopping || next_is_ready(pending)))
+                    {
+                        writer_waiting.store(true);
+                        collect(pending);
+                        if (! next_is_ready(pending))
+                            writer_condition.wait(lock);
+                        writer_waiting.store(false);
+                        collect(pending);
+                    }
+
+                    stop = stopping;
+                    first = written;
+                }
+
+                /* only write up to the first gap, unless we're stopping, in
+                 * which case nobody is left to fill it */
+                std::size_t count(0);
+                while (count != pending.size() && (stop || pending[count].sequence == first + count))
+                    ++count;
+
+                if (0 == count)
+                    return;
+
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    for (std::size_t n(0) ; n != count ; ++n)
+                    {
+                        try
+                        {
+                            write(pending[n]);
+                        }
+                        catch (const std::exception &)
+                        {
+                            /* nowhere to report it */
+                        }
+                    }
+                }
+
+                {
+                    std::unique_lock<std::mutex> lock(buffers_mutex);
+                    written = pending[count - 1].sequence + 1;
+                    written_condition.notify_all();
+                }
+
+                pending.erase(pending.begin(), pending.begin() + count);
+            }
+        }
+
+        void flush()
+        {
+            if (in_forked_child.load())
+                return;
+
+            unsigned long long target(next_sequence.load());
+
+            std::unique_lock<std::mutex> lock(buffers_mutex);
+            if (! writer.joinable() || std::this_thread::get_id() == writer.get_id())
+                return;
+
+            writer_condition.notify_one();
+            written_condition.wait(lock, [&] { return written >= target; });
         }
     };
 }
@@ -133,34 +419,41 @@ Log::~Log() = default;
 void
 Log::set_log_level(const LogLevel l)
 {
-    std::unique_lock<std::mutex> lock(_imp->mutex);
-    _imp->log_level = l;
+    _imp->log_level.store(l);
 }
 
 LogLevel
 Log::log_level() const
 {
-    return _imp->log_level;
+    return _imp->log_level.load();
 }
 
 void
 Log::_message(const std::string & id, const LogLevel l, const LogContext c, const std::string & s)
 {
-    std::unique_lock<std::mutex> lock(_imp->mutex);
+    if (l < _imp->log_level.load())
+        return;
 
+    LogRecord r{ 0, ::time(nullptr), id, l, c, current_thread_id(), "", s };
     if (lc_context == c)
-        _imp->message(id, l, c,
-#ifdef __linux__
-                "In thread ID '" + stringify(syscall(SYS_gettid)) + "':\n  ... " +
-#else
-#  warning "Don't know how to get a thread ID on your platform"
-#endif
-                Context::backtrace("\n  ... "), s);
+        r.context_texts = Context::backtrace(std::string(1, '\0'));
+
+    if (in_forked_child.load())
+    {
+        /* whoever held the lock when we forked isn't around to release it */
+        _imp->write(r);
+    }
+    else if (_imp->asynchronous.load())
+        _imp->enqueue(std::move(r));
     else
-        _imp->message(id, l, c, "", s);
+    {
+        std::unique_lock<std::mutex> lock(_imp->mutex);
+        _imp->write(r);
+    }
 }
 
 LogMessageHandler::LogMessageHandler(const LogMessageHandler & o) :
+    _log(o._log),
     _id(o._id),
     _message(o._message),
     _log_level(o._log_level),
@@ -171,16 +464,27 @@ LogMessageHandler::LogMessageHandler(const LogMessageHandler & o) :
 LogMessageHandler
 Log::message(const std::string & id, const LogLevel l, const LogContext c)
 {
-    return LogMessageHandler(this, id, l, c);
+    return LogMessageHandler(l >= _imp->log_level.load() ? this : nullptr, id, l, c);
 }
 
 void
 Log::set_log_stream(std::ostream * const s)
 {
+    flush();
+
     std::unique_lock<std::mutex> lock(_imp->mutex);
     _imp->stream = s;
 }
 
+void
+Log::set_log_format(const LogFormat f)
+{
+    flush();
+
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->format = f;
+}
+
 void
 Log::set_program_name(const std::string & s)
 {
@@ -188,6 +492,21 @@ Log::set_program_name(const std::string & s)
     _imp->program_name = s;
 }
 
+void
+Log::set_asynchronous(const bool b)
+{
+    _imp->asynchronous.store(b);
+
+    if (! b)
+        flush();
+}
+
+void
+Log::flush()
+{
+    _imp->flush();
+}
+
 LogMessageHandler::LogMessageHandler(Log * const ll, const std::string & id, const LogLevel l, const LogContext c) :
     _log(ll),
     _id(id),
@@ -204,7 +523,7 @@ LogMessageHandler::_append(const std::string & s)
 
 LogMessageHandler::~LogMessageHandler()
 {
-    if (0 == std::uncaught_exceptions() && ! _message.empty())
+    if (_log && 0 == std::uncaught_exceptions() && ! _message.empty())
         _log->_message(_id, _log_level, _log_context, _message);
 }
 
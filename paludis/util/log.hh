@@ -90,9 +90,31 @@ namespace paludis
 
             /**
              * Change the log stream.
+             *
+             * Any messages still waiting to be written go to the old stream.
              */
             void set_log_stream(std::ostream * const);
 
+            /**
+             * Change how messages are written.
+             */
+            void set_log_format(const LogFormat);
+
+            /**
+             * If true, messages are handed to a background thread to be
+             * written, rather than being written under a lock by the thread
+             * that logs them. Off by default.
+             *
+             * Anything which writes to the log stream itself, or which swaps
+             * its buffer, should call flush() first.
+             */
+            void set_asynchronous(const bool);
+
+            /**
+             * Wait until every message logged so far has been written.
+             */
+            void flush();
+
             /**
              * Set our program name.
              */
@@ -132,12 +154,15 @@ namespace paludis
 
             /**
              * Append some text to our message.
+             *
+             * Nothing is stringified if our level means we won't be shown.
              */
             template <typename T_>
             LogMessageHandler &
             operator<< (const T_ & t)
             {
-                _append(stringify(t));
+                if (_log)
+                    _append(stringify(t));
                 return *this;
             }
     };
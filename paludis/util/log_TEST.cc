@@ -18,8 +18,12 @@
  */
 
 #include <paludis/util/log.hh>
+#include <paludis/util/exception.hh>
 
+#include <atomic>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -104,3 +108,127 @@ TEST(Log, Exceptions)
     EXPECT_TRUE(s.str().empty());
 }
 
+
+TEST(Log, NotStringifiedWhenHidden)
+{
+    Log::destroy_instance();
+
+    std::stringstream s;
+    Log::get_instance()->set_log_stream(&s);
+    Log::get_instance()->set_log_level(ll_warning);
+
+    EXPECT_NO_THROW(Log::get_instance()->message("test.log", ll_debug, lc_no_context) << throws_a_monkey_when_stringified());
+    EXPECT_TRUE(s.str().empty());
+}
+
+TEST(Log, Asynchronous)
+{
+    Log::destroy_instance();
+
+    std::stringstream s;
+    Log::get_instance()->set_log_stream(&s);
+    Log::get_instance()->set_log_level(ll_debug);
+    Log::get_instance()->set_asynchronous(true);
+
+    std::vector<std::thread> threads;
+    for (int t(0) ; t < 4 ; ++t)
+        threads.emplace_back([t] {
+                for (int n(0) ; n < 1000 ; ++n)
+                    Log::get_instance()->message("test.log", ll_debug, lc_no_context) << "t" << t << " " << n;
+                });
+
+    for (auto & t : threads)
+        t.join();
+
+    Log::get_instance()->flush();
+
+    int next[4] = { 0, 0, 0, 0 }, lines(0);
+    std::string line;
+    while (std::getline(s, line))
+    {
+        ++lines;
+        std::string::size_type p(line.rfind(" t"));
+        ASSERT_TRUE(std::string::npos != p);
+        int t(std::stoi(line.substr(p + 2, 1))), n(std::stoi(line.substr(p + 4)));
+        EXPECT_EQ(next[t]++, n);
+    }
+
+    EXPECT_EQ(4000, lines);
+
+    Log::destroy_instance();
+}
+
+TEST(Log, AsynchronousOrderedAcrossThreads)
+{
+    Log::destroy_instance();
+
+    std::stringstream s;
+    Log::get_instance()->set_log_stream(&s);
+    Log::get_instance()->set_log_level(ll_debug);
+    Log::get_instance()->set_asynchronous(true);
+
+    /* the threads take turns, so each message happens after the one before
+     * it, even though they come from different threads */
+    const int n_threads(4), n_messages(2000);
+    std::atomic<int> turn(0);
+    std::vector<std::thread> threads;
+    for (int t(0) ; t < n_threads ; ++t)
+        threads.emplace_back([t, &turn] {
+                while (true)
+                {
+                    int n(turn.load());
+                    if (n >= n_messages)
+                        return;
+                    if (n % n_threads != t)
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+
+                    Log::get_instance()->message("test.log", ll_debug, lc_no_context) << "m " << n;
+                    turn.store(n + 1);
+                }
+                });
+
+    for (auto & t : threads)
+        t.join();
+
+    Log::get_instance()->flush();
+
+    int next(0);
+    std::string line;
+    while (std::getline(s, line))
+    {
+        std::string::size_type p(line.rfind(" m "));
+        ASSERT_TRUE(std::string::npos != p);
+        ASSERT_EQ(next++, std::stoi(line.substr(p + 3)));
+    }
+
+    EXPECT_EQ(n_messages, next);
+
+    Log::destroy_instance();
+}
+
+TEST(Log, JSON)
+{
+    Log::destroy_instance();
+
+    std::stringstream s;
+    Log::get_instance()->set_log_stream(&s);
+    Log::get_instance()->set_log_format(lf_json);
+    Log::get_instance()->set_program_name("monkey");
+
+    {
+        Context context("When testing:");
+        Log::get_instance()->message("test.log", ll_warning, lc_context) << "a \"quoted\"\nmessage";
+    }
+
+    std::string line;
+    ASSERT_TRUE(std::getline(s, line));
+    EXPECT_EQ(0u, line.find("{\"program\":\"monkey\",\"time\":"));
+    EXPECT_TRUE(std::string::npos != line.find(",\"level\":\"warning\",\"id\":\"test.log\",\"thread\":"));
+    EXPECT_TRUE(std::string::npos != line.find(",\"context\":[\"When testing:\"],\"message\":\"a \\\"quoted\\\"\\nmessage\"}"));
+    EXPECT_FALSE(std::getline(s, line));
+
+    Log::destroy_instance();
+}
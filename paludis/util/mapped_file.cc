@@ -0,0 +1,127 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/util/mapped_file.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/pimp-impl.hh>
+#include <paludis/util/stringify.hh>
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+using namespace paludis;
+
+namespace paludis
+{
+    template <>
+    struct Imp<MappedFile>
+    {
+        void * data;
+        std::size_t size;
+
+        Imp(const FSPath & f) :
+            data(nullptr),
+            size(0)
+        {
+            Context context("When mapping '" + stringify(f) + "':");
+
+            int fd(::open(stringify(f).c_str(), O_RDONLY | O_CLOEXEC));
+            if (-1 == fd)
+                throw MappedFileError("Could not open '" + stringify(f) + "': " + ::strerror(errno));
+
+            struct stat st;
+            if (0 != ::fstat(fd, &st))
+            {
+                int e(errno);
+                ::close(fd);
+                throw MappedFileError("Could not stat '" + stringify(f) + "': " + ::strerror(e));
+            }
+
+            if (! S_ISREG(st.st_mode))
+            {
+                ::close(fd);
+                throw MappedFileError("'" + stringify(f) + "' is not a regular file");
+            }
+
+            size = st.st_size;
+
+            /* mmap refuses zero length mappings, and there's nothing to map anyway */
+            if (0 != size)
+            {
+                data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (MAP_FAILED == data)
+                {
+                    int e(errno);
+                    ::close(fd);
+                    throw MappedFileError("Could not mmap '" + stringify(f) + "': " + ::strerror(e));
+                }
+            }
+
+            ::close(fd);
+        }
+
+        ~Imp()
+        {
+            if (data)
+                ::munmap(data, size);
+        }
+    };
+}
+
+MappedFile::MappedFile(const FSPath & f) :
+    _imp(f)
+{
+}
+
+MappedFile::~MappedFile() = default;
+
+const char *
+MappedFile::data() const
+{
+    return static_cast<const char *>(_imp->data);
+}
+
+std::size_t
+MappedFile::size() const
+{
+    return _imp->size;
+}
+
+std::string_view
+MappedFile::view() const
+{
+    return std::string_view(data(), size());
+}
+
+MappedFileError::MappedFileError(const std::string & s) noexcept :
+    FSError(s)
+{
+}
+
+namespace paludis
+{
+    template class Pimp<MappedFile>;
+}
+
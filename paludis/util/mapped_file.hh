@@ -0,0 +1,104 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PALUDIS_GUARD_PALUDIS_UTIL_MAPPED_FILE_HH
+#define PALUDIS_GUARD_PALUDIS_UTIL_MAPPED_FILE_HH 1
+
+#include <paludis/util/mapped_file-fwd.hh>
+#include <paludis/util/attributes.hh>
+#include <paludis/util/fs_error.hh>
+#include <paludis/util/fs_path-fwd.hh>
+#include <paludis/util/pimp.hh>
+#include <cstddef>
+#include <string_view>
+
+/** \file
+ * Declarations for MappedFile.
+ *
+ * \ingroup g_fs
+ *
+ * \section Examples
+ *
+ * - None at this time.
+ */
+
+namespace paludis
+{
+    /**
+     * A read-only view of the entire contents of a regular file, backed by a
+     * private memory mapping.
+     *
+     * Any views handed out by data() or view() are only valid for as long as
+     * the MappedFile itself is alive.
+     *
+     * \ingroup g_fs
+     * \nosubgrouping
+     */
+    class PALUDIS_VISIBLE MappedFile
+    {
+        private:
+            Pimp<MappedFile> _imp;
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            /**
+             * \exception MappedFileError if the file cannot be opened, is not
+             * a regular file, or cannot be mapped.
+             */
+            explicit MappedFile(const FSPath &);
+            ~MappedFile();
+
+            MappedFile(const MappedFile &) = delete;
+            MappedFile & operator= (const MappedFile &) = delete;
+
+            ///\}
+
+            /**
+             * The start of the mapping. May be null for an empty file.
+             */
+            const char * data() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * The size of the mapping, in bytes.
+             */
+            std::size_t size() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * The whole mapping as a string view.
+             */
+            std::string_view view() const PALUDIS_ATTRIBUTE((warn_unused_result));
+    };
+
+    /**
+     * Thrown by MappedFile if an error occurs.
+     *
+     * \ingroup g_fs
+     * \ingroup g_exceptions
+     */
+    class PALUDIS_VISIBLE MappedFileError :
+        public FSError
+    {
+        public:
+            MappedFileError(const std::string &) noexcept;
+    };
+}
+
+#endif
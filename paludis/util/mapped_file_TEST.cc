@@ -0,0 +1,178 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/util/mapped_file.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/elf.hh>
+#include <paludis/util/elf_types.hh>
+#include <paludis/util/elf_dynamic_section.hh>
+#include <paludis/util/elf_relocation_section.hh>
+#include <paludis/util/elf_symbol_section.hh>
+#include <paludis/util/visitor_cast.hh>
+#include <paludis/util/wrapped_forward_iterator.hh>
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+TEST(MappedFile, Existing)
+{
+    MappedFile f(FSPath::cwd() / "mapped_file_TEST_dir" / "ten_bytes");
+    EXPECT_EQ(10u, f.size());
+    EXPECT_EQ("0123456789", f.view());
+}
+
+TEST(MappedFile, Symlink)
+{
+    MappedFile f(FSPath::cwd() / "mapped_file_TEST_dir" / "symlink_to_ten_bytes");
+    EXPECT_EQ("0123456789", f.view());
+}
+
+TEST(MappedFile, Empty)
+{
+    MappedFile f(FSPath::cwd() / "mapped_file_TEST_dir" / "empty");
+    EXPECT_EQ(0u, f.size());
+    EXPECT_TRUE(f.view().empty());
+}
+
+TEST(MappedFile, Dir)
+{
+    EXPECT_THROW(MappedFile(FSPath::cwd() / "mapped_file_TEST_dir" / "dir"), MappedFileError);
+}
+
+TEST(MappedFile, NoEnt)
+{
+    EXPECT_THROW(MappedFile(FSPath::cwd() / "mapped_file_TEST_dir" / "noent"), MappedFileError);
+}
+
+TEST(MappedFile, Elf)
+{
+    typedef std::conditional<8 == sizeof(void *), Elf64Type, Elf32Type>::type NativeElfType;
+
+    MappedFile f(FSPath("/proc/self/exe"));
+    ASSERT_TRUE(ElfObject<NativeElfType>::is_valid_elf(f));
+
+    MappedFile not_elf(FSPath::cwd() / "mapped_file_TEST_dir" / "ten_bytes");
+    EXPECT_FALSE(ElfObject<NativeElfType>::is_valid_elf(not_elf));
+
+    ElfObject<NativeElfType> elf(f);
+    elf.resolve_all_strings();
+
+    bool found_dynamic(false), found_libpaludisutil(false);
+    for (const auto & section : elf.sections())
+        if (const auto * dyn_sec = visitor_cast<const DynamicSection<NativeElfType> >(section))
+        {
+            found_dynamic = true;
+            EXPECT_EQ(".dynamic", dyn_sec->get_name());
+
+            for (const auto & entry : dyn_sec->entries())
+                if (const auto * ent_str = visitor_cast<const DynamicEntryString<NativeElfType> >(entry))
+                    if ("NEEDED" == ent_str->tag_name() && 0 == (*ent_str)().compare(0, 14, "libpaludisutil"))
+                        found_libpaludisutil = true;
+        }
+
+    EXPECT_TRUE(found_dynamic);
+    EXPECT_TRUE(found_libpaludisutil);
+}
+
+
+namespace
+{
+    template <typename ElfType_, typename OtherElfType_>
+    void check_elf_fixture(const std::string & name, const bool big_endian, const unsigned machine,
+            const typename ElfType_::RelocationInfo rel_info, const typename ElfType_::RelocationInfo rela_info)
+    {
+        MappedFile f(FSPath::cwd() / "mapped_file_TEST_dir" / name);
+        ASSERT_TRUE(ElfObject<ElfType_>::is_valid_elf(f));
+        EXPECT_FALSE(ElfObject<OtherElfType_>::is_valid_elf(f));
+
+        ElfObject<ElfType_> elf(f);
+        EXPECT_EQ(unsigned(ET_DYN), elf.get_type());
+        EXPECT_EQ(machine, elf.get_arch());
+        EXPECT_EQ(big_endian, bool(elf.is_big_endian()));
+        EXPECT_EQ(7u, elf.get_number_of_sections());
+        elf.resolve_all_strings();
+
+        std::vector<std::string> section_names, dynamic_entries, symbols;
+        std::vector<typename ElfType_::RelocationInfo> rel_infos, rela_infos;
+        std::vector<typename ElfType_::RelocationAddend> rela_addends;
+
+        for (const auto & section : elf.sections())
+        {
+            section_names.push_back(section.get_name());
+
+            if (const auto * dyn_sec = visitor_cast<const DynamicSection<ElfType_> >(section))
+            {
+                for (const auto & entry : dyn_sec->entries())
+                    if (const auto * ent_str = visitor_cast<const DynamicEntryString<ElfType_> >(entry))
+                        dynamic_entries.push_back(ent_str->tag_name() + " " + std::string((*ent_str)()));
+                    else
+                        dynamic_entries.push_back(entry.tag_name());
+            }
+            else if (const auto * sym_sec = visitor_cast<const SymbolSection<ElfType_> >(section))
+            {
+                for (auto s(sym_sec->symbol_begin()), s_end(sym_sec->symbol_end()) ; s != s_end ; ++s)
+                    symbols.push_back(std::string(s->name()) + " " + std::string(s->binding()) + " " + std::string(s->visibility()));
+            }
+            else if (const auto * rel_sec = visitor_cast<const RelocationSection<ElfType_, Relocation<ElfType_> > >(section))
+            {
+                for (auto r(rel_sec->relocation_begin()), r_end(rel_sec->relocation_end()) ; r != r_end ; ++r)
+                {
+                    EXPECT_EQ(0x3000u, r->get_offset());
+                    rel_infos.push_back(r->get_info());
+                }
+            }
+            else if (const auto * rela_sec = visitor_cast<const RelocationSection<ElfType_, RelocationA<ElfType_> > >(section))
+            {
+                for (auto r(rela_sec->relocation_begin()), r_end(rela_sec->relocation_end()) ; r != r_end ; ++r)
+                {
+                    EXPECT_EQ(0x3008u, r->get_offset());
+                    rela_infos.push_back(r->get_info());
+                    rela_addends.push_back(r->get_addend());
+                }
+            }
+        }
+
+        EXPECT_EQ((std::vector<std::string>{ "", ".shstrtab", ".dynstr", ".dynsym", ".dynamic", ".rel.dyn", ".rela.dyn" }), section_names);
+        EXPECT_EQ((std::vector<std::string>{ "NEEDED libc.so.6", "SONAME libfixture.so.1", "NULL" }), dynamic_entries);
+        EXPECT_EQ((std::vector<std::string>{ " local default", "fixture_function global default", "fixture_data weak protected" }), symbols);
+        EXPECT_EQ((std::vector<typename ElfType_::RelocationInfo>{ rel_info }), rel_infos);
+        EXPECT_EQ((std::vector<typename ElfType_::RelocationInfo>{ rela_info }), rela_infos);
+        EXPECT_EQ((std::vector<typename ElfType_::RelocationAddend>{ -4 }), rela_addends);
+    }
+}
+
+TEST(MappedFile, Elf32LittleEndian)
+{
+    check_elf_fixture<Elf32Type, Elf64Type>("elf32_le", false, EM_ARM, ELF32_R_INFO(1, 1), ELF32_R_INFO(2, 2));
+}
+
+TEST(MappedFile, Elf32BigEndian)
+{
+    check_elf_fixture<Elf32Type, Elf64Type>("elf32_be", true, EM_PPC, ELF32_R_INFO(1, 1), ELF32_R_INFO(2, 2));
+}
+
+TEST(MappedFile, Elf64BigEndian)
+{
+    check_elf_fixture<Elf64Type, Elf32Type>("elf64_be", true, EM_PPC64, ELF64_R_INFO(1, 1), ELF64_R_INFO(2, 2));
+}
@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+# vim: set ft=sh sw=4 sts=4 et :
+
+mkdir mapped_file_TEST_dir || exit 2
+cd mapped_file_TEST_dir || exit 3
+
+echo -n '0123456789' > ten_bytes || exit 4
+touch empty || exit 5
+mkdir dir || exit 6
+ln -s ten_bytes symlink_to_ten_bytes || exit 7
+
+# Tiny shared objects, one per ELF class and byte order that we don't get
+# from the native binary. Each has .dynstr, .dynsym (fixture_function is
+# global, fixture_data is weak and protected), .dynamic (NEEDED libc.so.6,
+# SONAME libfixture.so.1), and one .rel.dyn and one .rela.dyn entry.
+base64 -d > elf32_le <<'END' || exit 8
+f0VMRgEBAQAAAAAAAAAAAAMAKAABAAAAAAAAAAAAAAAQAQAAAAAAADQAAAAAACgABwABAAAA
+AAAALnNoc3RydGFiAC5keW5zdHIALmR5bnN5bQAuZHluYW1pYwAucmVsLmR5bgAucmVsYS5k
+eW4AAABsaWJjLnNvLjYAbGliZml4dHVyZS5zby4xAGZpeHR1cmVfZnVuY3Rpb24AZml4dHVy
+ZV9kYXRhAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAGwAAAAAQAAAQAAAAEgDx/ywAAAAAIAAA
+BAAAACED8f8BAAAAAQAAAA4AAAALAAAAAAAAAAAAAAAAMAAAAQEAAAgwAAACAgAA/P///wAA
+AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAQAAAAMAAAAAAAAA
+AAAAADgAAAA3AAAAAAAAAAAAAAAEAAAAAAAAAAsAAAADAAAAAAAAAAAAAABwAAAAOQAAAAAA
+AAAAAAAABAAAAAAAAAATAAAACwAAAAAAAAAAAAAAsAAAADAAAAACAAAAAQAAAAQAAAAQAAAA
+GwAAAAYAAAAAAAAAAAAAAOAAAAAYAAAAAgAAAAAAAAAEAAAACAAAACQAAAAJAAAAAAAAAAAA
+AAD4AAAACAAAAAMAAAAAAAAABAAAAAgAAAAtAAAABAAAAAAAAAAAAAAAAAEAAAwAAAADAAAA
+AAAAAAQAAAAMAAAA
+END
+base64 -d > elf32_be <<'END' || exit 9
+f0VMRgECAQAAAAAAAAAAAAADABQAAAABAAAAAAAAAAAAAAEQAAAAAAA0AAAAAAAoAAcAAQAA
+AAAALnNoc3RydGFiAC5keW5zdHIALmR5bnN5bQAuZHluYW1pYwAucmVsLmR5bgAucmVsYS5k
+eW4AAABsaWJjLnNvLjYAbGliZml4dHVyZS5zby4xAGZpeHR1cmVfZnVuY3Rpb24AZml4dHVy
+ZV9kYXRhAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAGwAAEAAAAAAQEgD/8QAAACwAACAA
+AAAABCED//EAAAABAAAAAQAAAA4AAAALAAAAAAAAAAAAADAAAAABAQAAMAgAAAIC/////AAA
+AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAQAAAAMAAAAA
+AAAAAAAAADgAAAA3AAAAAAAAAAAAAAAEAAAAAAAAAAsAAAADAAAAAAAAAAAAAABwAAAAOQAA
+AAAAAAAAAAAABAAAAAAAAAATAAAACwAAAAAAAAAAAAAAsAAAADAAAAACAAAAAQAAAAQAAAAQ
+AAAAGwAAAAYAAAAAAAAAAAAAAOAAAAAYAAAAAgAAAAAAAAAEAAAACAAAACQAAAAJAAAAAAAA
+AAAAAAD4AAAACAAAAAMAAAAAAAAABAAAAAgAAAAtAAAABAAAAAAAAAAAAAABAAAAAAwAAAAD
+AAAAAAAAAAQAAAAM
+END
+base64 -d > elf64_be <<'END' || exit 10
+f0VMRgICAQAAAAAAAAAAAAADABUAAAABAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAFYAAAAAABA
+AAAAAABAAAcAAQAuc2hzdHJ0YWIALmR5bnN0cgAuZHluc3ltAC5keW5hbWljAC5yZWwuZHlu
+AC5yZWxhLmR5bgAAAGxpYmMuc28uNgBsaWJmaXh0dXJlLnNvLjEAZml4dHVyZV9mdW5jdGlv
+bgBmaXh0dXJlX2RhdGEAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAABsSAP/x
+AAAAAAAAEAAAAAAAAAAAEAAAACwhA//xAAAAAAAAIAAAAAAAAAAABAAAAAAAAAABAAAAAAAA
+AAEAAAAAAAAADgAAAAAAAAALAAAAAAAAAAAAAAAAAAAAAAAAAAAAADAAAAAAAQAAAAEAAAAA
+AAAwCAAAAAIAAAAC//////////wAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA
+AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAQAAAAMAAAAAAAAAAAAAAAAAAAAA
+AAAAAAAAAEAAAAAAAAAANwAAAAAAAAAAAAAAAAAAAAgAAAAAAAAAAAAAAAsAAAADAAAAAAAA
+AAAAAAAAAAAAAAAAAAAAAAB4AAAAAAAAADkAAAAAAAAAAAAAAAAAAAAIAAAAAAAAAAAAAAAT
+AAAACwAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAuAAAAAAAAABIAAAAAgAAAAEAAAAAAAAACAAA
+AAAAAAAYAAAAGwAAAAYAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAQAAAAAAAAAAMAAAAAIAAAAA
+AAAAAAAAAAgAAAAAAAAAEAAAACQAAAAJAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAEwAAAAAAAA
+ABAAAAADAAAAAAAAAAAAAAAIAAAAAAAAABAAAAAtAAAABAAAAAAAAAAAAAAAAAAAAAAAAAAA
+AAABQAAAAAAAAAAYAAAAAwAAAAAAAAAAAAAACAAAAAAAAAAY
+END
@@ -18,6 +18,7 @@
  */
 
 #include <paludis/util/env_var_names.hh>
+#include <paludis/util/fd_holder.hh>
 #include <paludis/util/fs_path.hh>
 #include <paludis/util/log.hh>
 #include <paludis/util/persona.hh>
@@ -46,12 +47,15 @@
 #include <limits.h>
 #include <pwd.h>
 #include <signal.h>
+#include <spawn.h>
 #include <sys/ioctl.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include "config.h"
+
 using namespace paludis;
 
 ProcessError::ProcessError(const std::string & s) noexcept :
@@ -483,6 +487,109 @@ ProcessCommand::exec(int err_fd)
     _exit(1);
 }
 
+namespace
+{
+    struct SpawnFileActions
+    {
+        posix_spawn_file_actions_t actions;
+
+        SpawnFileActions()
+        {
+            int r(posix_spawn_file_actions_init(&actions));
+            if (0 != r)
+                throw ProcessError(r, "posix_spawn_file_actions_init() failed");
+        }
+
+        ~SpawnFileActions()
+        {
+            posix_spawn_file_actions_destroy(&actions);
+        }
+
+        SpawnFileActions(const SpawnFileActions &) = delete;
+        SpawnFileActions & operator= (const SpawnFileActions &) = delete;
+    };
+
+    struct SpawnAttributes
+    {
+        posix_spawnattr_t attr;
+
+        SpawnAttributes()
+        {
+            int r(posix_spawnattr_init(&attr));
+            if (0 != r)
+                throw ProcessError(r, "posix_spawnattr_init() failed");
+        }
+
+        ~SpawnAttributes()
+        {
+            posix_spawnattr_destroy(&attr);
+        }
+
+        SpawnAttributes(const SpawnAttributes &) = delete;
+        SpawnAttributes & operator= (const SpawnAttributes &) = delete;
+    };
+}
+
+bool
+ProcessCommand::can_spawn() const
+{
+#ifdef HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCHDIR_NP
+    /* posix_spawn has no way of calling setgroups for us */
+    return _imp->setuid == getuid() && _imp->setgid == getgid();
+#else
+    return false;
+#endif
+}
+
+pid_t
+ProcessCommand::spawn(const std::vector<std::pair<int, int> > & fds, const sigset_t & sigmask)
+{
+#ifdef HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCHDIR_NP
+    exec_prepare();
+
+    SpawnFileActions actions;
+    for (const auto & fd : fds)
+    {
+        int r(posix_spawn_file_actions_adddup2(&actions.actions, fd.first, fd.second));
+        if (0 != r)
+            throw ProcessError(r, "posix_spawn_file_actions_adddup2() failed");
+    }
+
+    if (! _imp->chdir.empty())
+    {
+        int r(posix_spawn_file_actions_addchdir_np(&actions.actions, _imp->chdir.c_str()));
+        if (0 != r)
+            throw ProcessError(r, "posix_spawn_file_actions_addchdir_np() failed");
+    }
+
+    SpawnAttributes attributes;
+    sigset_t intandterm;
+    sigemptyset(&intandterm);
+    sigaddset(&intandterm, SIGINT);
+    sigaddset(&intandterm, SIGTERM);
+    if (0 != posix_spawnattr_setsigdefault(&attributes.attr, &intandterm) ||
+            0 != posix_spawnattr_setsigmask(&attributes.attr, &sigmask) ||
+            0 != posix_spawnattr_setflags(&attributes.attr, POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK))
+        throw ProcessError("posix_spawnattr_set*() failed");
+
+    pid_t child(-1);
+    int r;
+    if (! _imp->args_string.empty())
+        r = posix_spawn(&child, "/bin/sh", &actions.actions, &attributes.attr,
+                const_cast<char *const *>(_imp->argv_ptrs.data()), const_cast<char *const *>(_imp->env_ptrs.data()));
+    else
+        r = posix_spawnp(&child, _imp->argv_ptrs[0], &actions.actions, &attributes.attr,
+                const_cast<char *const *>(_imp->argv_ptrs.data()), const_cast<char *const *>(_imp->env_ptrs.data()));
+
+    if (0 != r)
+        throw ProcessError(r, "posix_spawn() failed for '" + std::string(_imp->argv_ptrs[0]) + "'");
+
+    return child;
+#else
+    throw ProcessError("posix_spawn() is not usable on this system");
+#endif
+}
+
 namespace paludis
 {
     struct RunningProcessThread
@@ -542,6 +649,52 @@ namespace paludis
     };
 }
 
+namespace
+{
+    void
+    set_nonblocking(const int fd)
+    {
+        int flags(::fcntl(fd, F_GETFL, NULL));
+        if (-1 == flags || -1 == ::fcntl(fd, F_SETFL, flags | O_NONBLOCK))
+            throw ProcessError(errno, "fcntl() O_NONBLOCK failed");
+    }
+
+    void
+    watch_fd(const int epoll_fd, const int fd, const uint32_t events)
+    {
+        struct epoll_event event;
+        event.events = events | EPOLLET;
+        event.data.fd = fd;
+        if (-1 == ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event))
+            throw ProcessError(errno, "epoll_ctl() failed");
+    }
+
+    /* Our fds are edge triggered, so once we're told an fd is ready we keep
+     * reading from it until it's drained, one buffer at a time so that we
+     * don't starve the others. */
+    ssize_t
+    read_ready_fd(const int fd, bool & ready, std::vector<char> & buf, const std::string & what)
+    {
+        ssize_t n(::read(fd, buf.data(), buf.size()));
+        if (-1 == n)
+        {
+            if (EINTR == errno)
+                return 0;
+            else if (EAGAIN == errno || EWOULDBLOCK == errno)
+            {
+                ready = false;
+                return 0;
+            }
+            else
+                throw ProcessError(errno, "read() " + what + " failed");
+        }
+        else if (0 == n)
+            ready = false;
+
+        return n;
+    }
+}
+
 void
 RunningProcessThread::thread_func()
 {
@@ -555,123 +708,154 @@ RunningProcessThread::thread_func()
     if (as_main_process && send_input_to_fd)
         want_to_finish = false;
 
-    bool done(false);
-    while (! done)
+    FDHolder epoll_fd(::epoll_create1(EPOLL_CLOEXEC), false);
+    if (-1 == epoll_fd)
+        throw ProcessError(errno, "epoll_create1() failed");
+
+    bool ctl_ready(false);
+    bool capture_stdout_ready(false);
+    bool capture_stderr_ready(false);
+    bool capture_output_to_fd_ready(false);
+    bool send_input_to_fd_ready(false);
+    bool pipe_command_handler_ready(false);
+
+    watch_fd(epoll_fd, ctl_pipe.read_fd(), EPOLLIN);
+
+    if (capture_stdout_pipe)
     {
-        fd_set read_fds;
-        fd_set write_fds;
-        int max_fd(0);
-        FD_ZERO(&read_fds);
-        FD_ZERO(&write_fds);
+        set_nonblocking(capture_stdout_pipe->read_fd());
+        watch_fd(epoll_fd, capture_stdout_pipe->read_fd(), EPOLLIN);
+    }
 
-        if (want_to_finish)
-        {
-            FD_SET(ctl_pipe.read_fd(), &read_fds);
-            max_fd = std::max(max_fd, ctl_pipe.read_fd());
-        }
+    if (capture_stderr_pipe)
+    {
+        set_nonblocking(capture_stderr_pipe->read_fd());
+        watch_fd(epoll_fd, capture_stderr_pipe->read_fd(), EPOLLIN);
+    }
 
-        if (capture_stdout_pipe)
-        {
-            FD_SET(capture_stdout_pipe->read_fd(), &read_fds);
-            max_fd = std::max(max_fd, capture_stdout_pipe->read_fd());
-        }
+    if (capture_output_to_fd)
+    {
+        set_nonblocking(capture_output_to_fd_pipe->read_fd());
+        watch_fd(epoll_fd, capture_output_to_fd_pipe->read_fd(), EPOLLIN);
+    }
 
-        if (capture_stderr_pipe)
-        {
-            FD_SET(capture_stderr_pipe->read_fd(), &read_fds);
-            max_fd = std::max(max_fd, capture_stderr_pipe->read_fd());
-        }
+    if (send_input_to_fd)
+        watch_fd(epoll_fd, send_input_to_fd_pipe->write_fd(), EPOLLOUT);
 
-        if (capture_output_to_fd)
-        {
-            FD_SET(capture_output_to_fd_pipe->read_fd(), &read_fds);
-            max_fd = std::max(max_fd, capture_output_to_fd_pipe->read_fd());
-        }
+    if (pipe_command_handler)
+    {
+        set_nonblocking(pipe_command_handler_command_pipe->read_fd());
+        watch_fd(epoll_fd, pipe_command_handler_command_pipe->read_fd(), EPOLLIN);
+    }
 
-        if (send_input_to_fd)
-        {
-            FD_SET(send_input_to_fd_pipe->write_fd(), &write_fds);
-            max_fd = std::max(max_fd, send_input_to_fd_pipe->write_fd());
-        }
+    /* one buffer, big enough to empty a pipe in one go, for everything */
+    std::vector<char> buf(64 * 1024);
 
-        if (pipe_command_handler)
+    bool done(false);
+    while (! done)
+    {
+        /* if we've still got something to read, just check for new events,
+         * rather than waiting for them */
+        const bool anything_ready((ctl_ready && want_to_finish) || capture_stdout_ready || capture_stderr_ready ||
+                capture_output_to_fd_ready || send_input_to_fd_ready || pipe_command_handler_ready);
+
+        struct epoll_event events[8];
+        int n_events(::epoll_wait(epoll_fd, events, sizeof(events) / sizeof(events[0]), anything_ready ? 0 : -1));
+        if (-1 == n_events)
         {
-            FD_SET(pipe_command_handler_command_pipe->read_fd(), &read_fds);
-            max_fd = std::max(max_fd, pipe_command_handler_command_pipe->read_fd());
+            if (EINTR == errno)
+                continue;
+            throw ProcessError(errno, "epoll_wait() failed");
         }
 
-        int retval(::pselect(max_fd + 1, &read_fds, &write_fds, nullptr, nullptr, nullptr));
-        if (-1 == retval)
-            throw ProcessError("pselect() failed");
-
         bool done_anything(false);
-        char buf[4096];
 
-        if (capture_stdout_pipe && FD_ISSET(capture_stdout_pipe->read_fd(), &read_fds))
+        for (int e(0) ; e < n_events ; ++e)
+        {
+            const int fd(events[e].data.fd);
+            if (fd == ctl_pipe.read_fd())
+                ctl_ready = true;
+            else
+            {
+                if (capture_stdout_pipe && fd == capture_stdout_pipe->read_fd())
+                    capture_stdout_ready = true;
+                else if (capture_stderr_pipe && fd == capture_stderr_pipe->read_fd())
+                    capture_stderr_ready = true;
+                else if (capture_output_to_fd_pipe && fd == capture_output_to_fd_pipe->read_fd())
+                    capture_output_to_fd_ready = true;
+                else if (send_input_to_fd && fd == send_input_to_fd_pipe->write_fd())
+                    send_input_to_fd_ready = true;
+                else if (pipe_command_handler && fd == pipe_command_handler_command_pipe->read_fd())
+                    pipe_command_handler_ready = true;
+                done_anything = true;
+            }
+        }
+
+        if (capture_stdout_ready)
         {
-            int n(::read(capture_stdout_pipe->read_fd(), &buf, sizeof(buf)));
-            if (-1 == n)
-                throw ProcessError("read() capture_stdout_pipe read_fd failed");
-            else if (0 != n)
+            ssize_t n(read_ready_fd(capture_stdout_pipe->read_fd(), capture_stdout_ready, buf, "capture_stdout_pipe read_fd"));
+            if (0 != n)
             {
                 if (prefix_stdout.empty())
-                    capture_stdout->write(buf, n);
+                    capture_stdout->write(buf.data(), n);
                 else
                 {
-                    std::string s(buf, n);
-                    prefix_stdout_buffer.append(s);
-                    if (std::string::npos != s.find('\n'))
+                    prefix_stdout_buffer.append(buf.data(), n);
+                    if (std::find(buf.begin(), buf.begin() + n, '\n') != buf.begin() + n)
                         prefix_stdout_buffer_has_newline = true;
                 }
+                done_anything = true;
             }
-            done_anything = true;
         }
 
-        if (capture_stderr_pipe && FD_ISSET(capture_stderr_pipe->read_fd(), &read_fds))
+        if (capture_stderr_ready)
         {
-            int n(::read(capture_stderr_pipe->read_fd(), &buf, sizeof(buf)));
-            if (-1 == n)
-                throw ProcessError("read() capture_stderr_pipe read_fd failed");
-            else if (0 != n)
+            ssize_t n(read_ready_fd(capture_stderr_pipe->read_fd(), capture_stderr_ready, buf, "capture_stderr_pipe read_fd"));
+            if (0 != n)
             {
                 if (prefix_stderr.empty())
-                    capture_stderr->write(buf, n);
+                    capture_stderr->write(buf.data(), n);
                 else
                 {
-                    std::string s(buf, n);
-                    prefix_stderr_buffer.append(s);
-                    if (std::string::npos != s.find('\n'))
+                    prefix_stderr_buffer.append(buf.data(), n);
+                    if (std::find(buf.begin(), buf.begin() + n, '\n') != buf.begin() + n)
                         prefix_stderr_buffer_has_newline = true;
                 }
+                done_anything = true;
             }
-            done_anything = true;
         }
 
-        if (capture_output_to_fd_pipe && FD_ISSET(capture_output_to_fd_pipe->read_fd(), &read_fds))
+        if (capture_output_to_fd_ready)
         {
-            int n(::read(capture_output_to_fd_pipe->read_fd(), &buf, sizeof(buf)));
-            if (-1 == n)
-                throw ProcessError("read() capture_output_to_fd_pipe read_fd failed");
-            else if (0 != n)
-                capture_output_to_fd->write(buf, n);
-            done_anything = true;
+            ssize_t n(read_ready_fd(capture_output_to_fd_pipe->read_fd(), capture_output_to_fd_ready, buf,
+                        "capture_output_to_fd_pipe read_fd"));
+            if (0 != n)
+            {
+                capture_output_to_fd->write(buf.data(), n);
+                done_anything = true;
+            }
         }
 
-        if (send_input_to_fd && FD_ISSET(send_input_to_fd_pipe->write_fd(), &write_fds))
+        if (send_input_to_fd_ready)
         {
             while ((! input_stream_pending.empty()) || send_input_to_fd->good())
             {
                 if (input_stream_pending.empty() && send_input_to_fd->good())
                 {
-                    send_input_to_fd->read(buf, sizeof(buf));
-                    input_stream_pending.assign(buf, send_input_to_fd->gcount());
+                    send_input_to_fd->read(buf.data(), buf.size());
+                    input_stream_pending.assign(buf.data(), send_input_to_fd->gcount());
                 }
 
                 int w(::write(send_input_to_fd_pipe->write_fd(), input_stream_pending.data(),
                             input_stream_pending.length()));
 
                 if (0 == w || (-1 == w && (errno == EAGAIN || errno == EWOULDBLOCK)))
+                {
+                    send_input_to_fd_ready = false;
                     break;
+                }
+                else if (-1 == w && errno == EINTR)
+                    continue;
                 else if (-1 == w)
                     throw ProcessError("write() send_input_to_fd_pipe write_fd failed");
                 else
@@ -680,24 +864,28 @@ RunningProcessThread::thread_func()
 
             if (input_stream_pending.empty() && ! send_input_to_fd->good())
             {
+                if (-1 == ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, send_input_to_fd_pipe->write_fd(), nullptr))
+                    throw ProcessError(errno, "epoll_ctl() failed");
                 if (0 != ::close(send_input_to_fd_pipe->write_fd()))
                     throw ProcessError("close() send_input_to_fd_pipe write_fd failed");
                 send_input_to_fd_pipe->clear_write_fd();
                 send_input_to_fd = nullptr;
+                send_input_to_fd_ready = false;
                 want_to_finish = true;
             }
 
             done_anything = true;
         }
 
-        if (pipe_command_handler && FD_ISSET(pipe_command_handler_command_pipe->read_fd(), &read_fds))
+        if (pipe_command_handler_ready)
         {
-            int n(::read(pipe_command_handler_command_pipe->read_fd(), &buf, sizeof(buf)));
-            if (-1 == n)
-                throw ProcessError("read() pipe_command_handler_command_pipe read_fd failed");
-            else if (0 != n)
-                pipe_command_handler_buffer.append(buf, n);
-            done_anything = true;
+            ssize_t n(read_ready_fd(pipe_command_handler_command_pipe->read_fd(), pipe_command_handler_ready, buf,
+                        "pipe_command_handler_command_pipe read_fd"));
+            if (0 != n)
+            {
+                pipe_command_handler_buffer.append(buf.data(), n);
+                done_anything = true;
+            }
         }
 
         while (! pipe_command_handler_buffer.empty())
@@ -777,7 +965,7 @@ RunningProcessThread::thread_func()
             continue;
 
         /* don't do this until nothing else has anything to do */
-        if (FD_ISSET(ctl_pipe.read_fd(), &read_fds))
+        if (ctl_ready && want_to_finish)
         {
             /* haxx: flush our buffers first */
             if (! prefix_stdout_buffer.empty())
@@ -1051,9 +1239,67 @@ Process::run()
         _imp->command.setenv("LINES", stringify(lines));
     }
 
+    /* Work out what the child's fds need to look like. A pair with the same
+     * fd twice means that fd must survive the exec. */
+    std::vector<std::pair<int, int> > child_fds;
+
+    if (thread && thread->capture_stdout_pipe)
+        child_fds.emplace_back(thread->capture_stdout_pipe->write_fd(), STDOUT_FILENO);
+
+    if (thread && thread->capture_stderr_pipe)
+        child_fds.emplace_back(thread->capture_stderr_pipe->write_fd(), STDERR_FILENO);
+
+    if (thread && thread->capture_output_to_fd_pipe)
+    {
+        const int src_fd(thread->capture_output_to_fd_pipe->write_fd());
+        const int tgt_fd(_imp->capture_output_to_fd_fd);
+        child_fds.emplace_back(src_fd, -1 == tgt_fd ? src_fd : tgt_fd);
+    }
+
+    if (thread && thread->send_input_to_fd_pipe)
+    {
+        const int src_fd(thread->send_input_to_fd_pipe->read_fd());
+        const int tgt_fd(_imp->send_input_to_fd_fd);
+        child_fds.emplace_back(src_fd, -1 == tgt_fd ? src_fd : tgt_fd);
+    }
+
+    if (thread && thread->pipe_command_handler)
+    {
+        child_fds.emplace_back(thread->pipe_command_handler_response_pipe->read_fd(),
+                thread->pipe_command_handler_response_pipe->read_fd());
+        child_fds.emplace_back(thread->pipe_command_handler_command_pipe->write_fd(),
+                thread->pipe_command_handler_command_pipe->write_fd());
+    }
+
+    if (-1 != _imp->set_stdin_fd)
+        child_fds.emplace_back(_imp->set_stdin_fd, STDIN_FILENO);
+
+    /* Anything we've logged should come out before anything the child
+     * writes, even if logging is asynchronous */
+    Log::get_instance()->flush();
+
     /* Prepare exec so we don't allocate after fork */
     _imp->command.exec_prepare();
 
+    /* Unless we need to do something in the child that posix_spawn can't,
+     * use it rather than fork, so we don't have to copy our page tables,
+     * which can be slow if we're big. */
+    if ((! _imp->as_main_process) && _imp->command.can_spawn() &&
+            getenv_with_default(env_vars::no_spawn, "").empty())
+    {
+        sigset_t sigmask;
+        if (0 != pthread_sigmask(SIG_BLOCK, nullptr, &sigmask))
+            throw ProcessError("pthread_sigmask failed");
+        sigdelset(&sigmask, SIGINT);
+        sigdelset(&sigmask, SIGTERM);
+
+        pid_t child(_imp->command.spawn(child_fds, sigmask));
+
+        if (thread)
+            thread->start();
+        return RunningProcessHandle(child, std::move(thread));
+    }
+
     /* This pipe is used for error handling. It will be open until the
      * child process either fails to exec, in which case the error is sent
      * to the parent through it, or the child succeeds to exec, in which
@@ -1099,94 +1345,18 @@ Process::run()
             _exit(1);
         }
 
-        if (thread && thread->capture_stdout_pipe)
-        {
-            if (-1 == ::dup2(thread->capture_stdout_pipe->write_fd(), STDOUT_FILENO))
-            {
-                ExecError(ExecError::DUP2_FAILED, errno).send(err_fd);
-                _exit(1);
-            }
-        }
-
-        if (thread && thread->capture_stderr_pipe)
-        {
-            if (-1 == ::dup2(thread->capture_stderr_pipe->write_fd(), STDERR_FILENO))
-            {
-                ExecError(ExecError::DUP2_FAILED, errno).send(err_fd);
-                _exit(1);
-            }
-        }
-
-        if (thread && thread->capture_output_to_fd_pipe)
+        for (const auto & fd : child_fds)
         {
-            const int src_fd(thread->capture_output_to_fd_pipe->write_fd());
-            const int tgt_fd(_imp->capture_output_to_fd_fd);
-
-            if (-1 == tgt_fd)
+            if (fd.first == fd.second)
             {
-                int flags = ::fcntl(src_fd, F_GETFD);
-                if (-1 == flags || -1 == ::fcntl(src_fd, F_SETFD, flags & ~FD_CLOEXEC))
+                int flags = ::fcntl(fd.first, F_GETFD);
+                if (-1 == flags || -1 == ::fcntl(fd.first, F_SETFD, flags & ~FD_CLOEXEC))
                 {
                     ExecError(ExecError::FCNTL_FAILED, errno).send(err_fd);
                     _exit(1);
                 }
             }
-            else
-            {
-                if (-1 == ::dup2(src_fd, tgt_fd))
-                {
-                    ExecError(ExecError::DUP2_FAILED, errno).send(err_fd);
-                    _exit(1);
-                }
-            }
-        }
-
-        if (thread && thread->send_input_to_fd_pipe)
-        {
-            const int src_fd(thread->send_input_to_fd_pipe->read_fd());
-            const int tgt_fd(_imp->send_input_to_fd_fd);
-
-            if (-1 == tgt_fd)
-            {
-                int flags = ::fcntl(src_fd, F_GETFD);
-                if (-1 == flags || -1 == ::fcntl(src_fd, F_SETFD, flags & ~FD_CLOEXEC))
-                {
-                    ExecError(ExecError::FCNTL_FAILED, errno).send(err_fd);
-                    _exit(1);
-                }
-            }
-            else
-            {
-                if (-1 == ::dup2(src_fd, tgt_fd))
-                {
-                    ExecError(ExecError::DUP2_FAILED, errno).send(err_fd);
-                    _exit(1);
-                }
-            }
-        }
-
-        if (thread && thread->pipe_command_handler)
-        {
-            int read_fd = thread->pipe_command_handler_response_pipe->read_fd();
-            int read_flags = ::fcntl(read_fd, F_GETFD);
-            if (-1 == read_flags || -1 == ::fcntl(read_fd, F_SETFD, read_flags & ~FD_CLOEXEC))
-            {
-                ExecError(ExecError::FCNTL_FAILED, errno).send(err_fd);
-                _exit(1);
-            }
-
-            int write_fd = thread->pipe_command_handler_command_pipe->write_fd();
-            int write_flags = ::fcntl(write_fd, F_GETFD);
-            if (-1 == write_flags || -1 == ::fcntl(write_fd, F_SETFD, write_flags & ~FD_CLOEXEC))
-            {
-                ExecError(ExecError::FCNTL_FAILED, errno).send(err_fd);
-                _exit(1);
-            }
-        }
-
-        if (-1 != _imp->set_stdin_fd)
-        {
-            if (-1 == ::dup2(_imp->set_stdin_fd, STDIN_FILENO))
+            else if (-1 == ::dup2(fd.first, fd.second))
             {
                 ExecError(ExecError::DUP2_FAILED, errno).send(err_fd);
                 _exit(1);
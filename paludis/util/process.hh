@@ -32,7 +32,9 @@
 #include <functional>
 #include <initializer_list>
 #include <vector>
+#include <utility>
 
+#include <signal.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -83,6 +85,23 @@ namespace paludis
             void exec_prepare();
             void exec(int err_fd = -1) PALUDIS_ATTRIBUTE((noreturn));
 
+            /**
+             * Can spawn() be used for this command, or must we fork() and
+             * exec() ourselves?
+             */
+            bool can_spawn() const;
+
+            /**
+             * Start the command in a new process using posix_spawn, which
+             * avoids copying our page tables.
+             *
+             * Each pair of fds is dup2ed in order in the child. A pair
+             * giving the same fd twice instead makes that fd survive the
+             * exec. The child starts with the given signal mask, and with
+             * default SIGINT and SIGTERM handling.
+             */
+            pid_t spawn(const std::vector<std::pair<int, int> > & fds, const sigset_t & sigmask);
+
             const std::vector<std::string>& get_args();
             const std::string& get_args_string();
     };
@@ -0,0 +1,136 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/*
+ * Times starting and waiting for a trivial child process using both of
+ * Process's paths, posix_spawn and fork, as the parent's resident set grows.
+ *
+ * Usage: process_BENCHMARK [--capture] [runs [MiB ...]]
+ *
+ * This is built but not installed, and is not run as a test.
+ */
+
+#include <paludis/util/process.hh>
+#include <paludis/util/env_var_names.hh>
+#include <paludis/util/destringify.hh>
+#include <paludis/util/exception.hh>
+#include <paludis/util/stringify.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace paludis;
+
+namespace
+{
+    double best_milliseconds_per_process(const int runs, const bool capture, const bool spawn)
+    {
+        if (spawn)
+            ::unsetenv(env_vars::no_spawn.c_str());
+        else
+            ::setenv(env_vars::no_spawn.c_str(), "yes", 1);
+
+        double best(0);
+        for (int round(0) ; round < 3 ; ++round)
+        {
+            auto start(std::chrono::steady_clock::now());
+            for (int n(0) ; n < runs ; ++n)
+            {
+                std::stringstream output;
+                Process process(ProcessCommand({ "/bin/true" }));
+                if (capture)
+                    process.capture_stdout(output);
+                if (0 != process.run().wait())
+                    throw InternalError(PALUDIS_HERE, "/bin/true failed");
+            }
+
+            double ms(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / runs);
+            if (0 == round || ms < best)
+                best = ms;
+        }
+
+        ::unsetenv(env_vars::no_spawn.c_str());
+        return best;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    try
+    {
+        std::vector<std::string> args(argv + 1, argv + argc);
+        bool capture(false);
+        if ((! args.empty()) && "--capture" == args.front())
+        {
+            capture = true;
+            args.erase(args.begin());
+        }
+
+        int runs(100);
+        if (! args.empty())
+        {
+            runs = destringify<int>(args.front());
+            args.erase(args.begin());
+        }
+
+        std::vector<std::size_t> sizes;
+        for (const auto & a : args)
+            sizes.push_back(destringify<std::size_t>(a));
+        if (sizes.empty())
+            sizes = { 16, 256, 1024 };
+        std::sort(sizes.begin(), sizes.end());
+
+        std::printf("%10s %14s %14s\n", "RSS (MiB)", "spawn (ms)", "fork (ms)");
+
+        /* grow the ballast a block at a time, touching every page, so that
+         * it really is resident */
+        std::vector<std::unique_ptr<char[]> > ballast;
+        std::size_t have(0);
+        volatile char sink(0);
+        for (const auto & size : sizes)
+        {
+            for ( ; have < size ; ++have)
+            {
+                ballast.emplace_back(new char[1 << 20]);
+                std::memset(ballast.back().get(), 1, 1 << 20);
+                sink = sink + ballast.back()[have % (1 << 20)];
+            }
+
+            std::printf("%10zu %14.2f %14.2f\n", size,
+                    best_milliseconds_per_process(runs, capture, true),
+                    best_milliseconds_per_process(runs, capture, false));
+        }
+
+        return EXIT_SUCCESS;
+    }
+    catch (const Exception & e)
+    {
+        std::cerr << argv[0] << ": " << e.message() << " (" << e.what() << ")" << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -19,10 +19,12 @@
 
 #include <paludis/util/process.hh>
 #include <paludis/util/fs_path.hh>
+#include <paludis/util/log.hh>
 #include <paludis/util/pipe.hh>
 #include <paludis/util/safe_ofstream.hh>
 #include <paludis/util/stringify.hh>
 
+#include <iostream>
 #include <sstream>
 #include <sys/types.h>
 #include <pwd.h>
@@ -85,6 +87,24 @@ TEST(Process, GrabStdout)
     EXPECT_EQ("monkey\n", stdout_stream.str());
 }
 
+TEST(Process, FlushesLog)
+{
+    std::stringstream s;
+    Log::get_instance()->set_log_stream(&s);
+    Log::get_instance()->set_asynchronous(true);
+
+    Log::get_instance()->message("test.process", ll_warning, lc_no_context) << "before";
+    Process echo_process(ProcessCommand({"echo", "after"}));
+    echo_process.capture_stdout(s);
+    EXPECT_EQ(0, echo_process.run().wait());
+
+    Log::get_instance()->set_asynchronous(false);
+    Log::get_instance()->set_log_stream(&std::cerr);
+
+    ASSERT_NE(std::string::npos, s.str().find("before"));
+    EXPECT_LT(s.str().find("before"), s.str().find("after"));
+}
+
 TEST(Process, GrabStdoutSingleCommand)
 {
     std::stringstream stdout_stream;
@@ -137,6 +157,31 @@ TEST(Process, GrabStdoutLong)
     ASSERT_TRUE(! std::getline(stdout_stream, s));
 }
 
+TEST(Process, GrabStdoutStderrLongPrefixed)
+{
+    std::stringstream stdout_stream;
+    std::stringstream stderr_stream;
+    Process seq_process(ProcessCommand({"bash", "-c", "seq 1 100000 ; seq 1 100000 1>&2"}));
+    seq_process.capture_stdout(stdout_stream);
+    seq_process.capture_stderr(stderr_stream);
+    seq_process.prefix_stdout("o: ");
+    seq_process.prefix_stderr("e: ");
+
+    EXPECT_EQ(0, seq_process.run().wait());
+
+    std::string s;
+    for (int x(1) ; x <= 100000 ; ++x)
+    {
+        ASSERT_TRUE(bool(std::getline(stdout_stream, s)));
+        ASSERT_EQ("o: " + stringify(x), s);
+        ASSERT_TRUE(bool(std::getline(stderr_stream, s)));
+        ASSERT_EQ("e: " + stringify(x), s);
+    }
+
+    ASSERT_TRUE(! std::getline(stdout_stream, s));
+    ASSERT_TRUE(! std::getline(stderr_stream, s));
+}
+
 TEST(Process, Setenv)
 {
     std::stringstream stdout_stream;
@@ -159,6 +204,33 @@ TEST(Process, Chdir)
     EXPECT_EQ("/\n", stdout_stream.str());
 }
 
+TEST(Process, ChdirError)
+{
+    Process pwd_process(ProcessCommand({"pwd"}));
+    pwd_process.chdir(FSPath("/paludis-nonexisting-dir"));
+
+    EXPECT_THROW({ auto ph = pwd_process.run(); }, ProcessError);
+}
+
+TEST(Process, NoSpawn)
+{
+    std::stringstream stdout_stream;
+    Process pwd_process(ProcessCommand({"bash", "-c", "pwd ; cat <&5"}));
+    pwd_process.capture_stdout(stdout_stream);
+    pwd_process.chdir(FSPath("/"));
+
+    std::stringstream in_stream;
+    in_stream << "monkey" << std::endl;
+    pwd_process.send_input_to_fd(in_stream, 5, "");
+
+    ::setenv("PALUDIS_NO_SPAWN", "yes", 1);
+    int status(pwd_process.run().wait());
+    ::unsetenv("PALUDIS_NO_SPAWN");
+
+    EXPECT_EQ(0, status);
+    EXPECT_EQ("/\nmonkey\n", stdout_stream.str());
+}
+
 TEST(Process, NoPty)
 {
     std::stringstream stdout_stream;
@@ -19,6 +19,7 @@
 
 #include <paludis/util/simple_parser.hh>
 #include <paludis/util/pimp-impl.hh>
+#include <paludis/util/character_class.hh>
 #include <strings.h>
 
 using namespace paludis;
@@ -30,12 +31,25 @@ SimpleParserExpression::SimpleParserExpression(const SimpleParserMatchFunction &
 {
 }
 
+SimpleParserExpression::SimpleParserExpression(const SimpleParserMatchFunction & f,
+        const std::shared_ptr<const CharacterClass> & c) :
+    _match(f),
+    _single_character_class(c)
+{
+}
+
 std::string::size_type
 SimpleParserExpression::match(const std::string & s, const std::string::size_type offset) const
 {
     return _match(s, offset);
 }
 
+const std::shared_ptr<const CharacterClass>
+SimpleParserExpression::single_character_class() const
+{
+    return _single_character_class;
+}
+
 namespace
 {
     std::string::size_type
@@ -81,6 +95,17 @@ namespace
         }
     }
 
+    std::string::size_type
+    m_star_class(const std::shared_ptr<const CharacterClass> & c, const std::string & text,
+            const std::string::size_type offset)
+    {
+        if (offset >= text.length())
+            return 0;
+
+        std::string::size_type end(c->find_first_not_in(text, offset));
+        return (std::string::npos == end ? text.length() : end) - offset;
+    }
+
     std::string::size_type
     m_plus(const SimpleParserExpression & e1, const std::string & text,
             const std::string::size_type offset)
@@ -101,6 +126,14 @@ namespace
         }
     }
 
+    std::string::size_type
+    m_plus_class(const std::shared_ptr<const CharacterClass> & c, const std::string & text,
+            const std::string::size_type offset)
+    {
+        std::string::size_type len(m_star_class(c, text, offset));
+        return 0 == len ? std::string::npos : len;
+    }
+
     std::string::size_type
     m_minus(const SimpleParserExpression & e1, const std::string & text,
             const std::string::size_type offset)
@@ -129,30 +162,17 @@ namespace
     }
 
     std::string::size_type
-    m_any_of(const std::string & allowed, const std::string & text,
+    m_any_of(const std::shared_ptr<const CharacterClass> & c, const std::string & text,
             const std::string::size_type offset)
     {
         if (offset >= text.length())
             return std::string::npos;
 
-        if (std::string::npos != allowed.find(text.at(offset)))
+        if (c->contains(text[offset]))
             return 1;
         else
             return std::string::npos;
     }
-
-    std::string::size_type
-    m_any_except(const std::string & not_allowed, const std::string & text,
-            const std::string::size_type offset)
-    {
-        if (offset >= text.length())
-            return std::string::npos;
-
-        if (std::string::npos != not_allowed.find(text.at(offset)))
-            return std::string::npos;
-        else
-            return 1;
-    }
 }
 
 SimpleParserExpression
@@ -173,6 +193,8 @@ SimpleParserExpression
 paludis::simple_parser::operator* (const SimpleParserExpression & e1)
 {
     using namespace std::placeholders;
+    if (e1.single_character_class())
+        return SimpleParserExpression(std::bind(m_star_class, e1.single_character_class(), _1, _2));
     return SimpleParserExpression(std::bind(m_star, e1, _1, _2));
 }
 
@@ -180,6 +202,8 @@ SimpleParserExpression
 paludis::simple_parser::operator+ (const SimpleParserExpression & e1)
 {
     using namespace std::placeholders;
+    if (e1.single_character_class())
+        return SimpleParserExpression(std::bind(m_plus_class, e1.single_character_class(), _1, _2));
     return SimpleParserExpression(std::bind(m_plus, e1, _1, _2));
 }
 
@@ -208,14 +232,16 @@ SimpleParserExpression
 paludis::simple_parser::any_of(const std::string & s)
 {
     using namespace std::placeholders;
-    return SimpleParserExpression(std::bind(m_any_of, s, _1, _2));
+    auto c(std::make_shared<const CharacterClass>(s));
+    return SimpleParserExpression(std::bind(m_any_of, c, _1, _2), c);
 }
 
 SimpleParserExpression
 paludis::simple_parser::any_except(const std::string & s)
 {
     using namespace std::placeholders;
-    return SimpleParserExpression(std::bind(m_any_except, s, _1, _2));
+    auto c(std::make_shared<const CharacterClass>(CharacterClass(s).complement()));
+    return SimpleParserExpression(std::bind(m_any_of, c, _1, _2), c);
 }
 
 namespace paludis
@@ -23,7 +23,9 @@
 #include <paludis/util/attributes.hh>
 #include <paludis/util/pimp.hh>
 #include <paludis/util/simple_parser-fwd.hh>
+#include <paludis/util/character_class-fwd.hh>
 #include <functional>
+#include <memory>
 #include <string>
 
 namespace paludis
@@ -36,12 +38,25 @@ namespace paludis
         {
             private:
                 const SimpleParserMatchFunction _match;
+                const std::shared_ptr<const CharacterClass> _single_character_class;
 
             public:
                 SimpleParserExpression(const SimpleParserMatchFunction &);
 
+                /**
+                 * For an expression which matches exactly one character from
+                 * a class, allowing repetitions to scan the class in one go.
+                 */
+                SimpleParserExpression(const SimpleParserMatchFunction &, const std::shared_ptr<const CharacterClass> &);
+
                 std::string::size_type match(const std::string &, const std::string::size_type) const
                     PALUDIS_ATTRIBUTE((warn_unused_result));
+
+                /**
+                 * The class of characters we match exactly one of, or null.
+                 */
+                const std::shared_ptr<const CharacterClass> single_character_class() const
+                    PALUDIS_ATTRIBUTE((warn_unused_result));
         };
 
         SimpleParserExpression operator& (const SimpleParserExpression &, const SimpleParserExpression &)
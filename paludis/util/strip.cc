@@ -20,6 +20,20 @@
 #include <paludis/util/exception.hh>
 #include <paludis/util/strip.hh>
 #include <paludis/util/stringify.hh>
+#include <paludis/util/character_class.hh>
+
+namespace
+{
+    /* most callers strip whitespace, and we'd rather not build a class
+     * for each call */
+    const paludis::CharacterClass * cached_class(const std::string & remove)
+    {
+        static const std::string whitespace(" \t\r\n");
+        static const paludis::CharacterClass whitespace_class(whitespace);
+
+        return remove == whitespace ? &whitespace_class : nullptr;
+    }
+}
 
 namespace paludis
 {
@@ -43,7 +57,8 @@ namespace paludis
     {
         try
         {
-            std::string::size_type p(s.find_first_not_of(remove));
+            const CharacterClass * const c(cached_class(remove));
+            std::string::size_type p(c ? c->find_first_not_in(s) : s.find_first_not_of(remove));
             if (std::string::npos == p)
                 return std::string();
             else
@@ -78,7 +93,8 @@ namespace paludis
     {
         try
         {
-            std::string::size_type p(s.find_last_not_of(remove));
+            const CharacterClass * const c(cached_class(remove));
+            std::string::size_type p(c ? c->find_last_not_in(s) : s.find_last_not_of(remove));
             if (std::string::npos == p)
                 return std::string();
             else
@@ -36,6 +36,10 @@
 #include <fcntl.h>
 #include "config.h"
 
+#ifdef __linux__
+#  include <sys/syscall.h>
+#endif
+
 using namespace paludis;
 
 namespace
@@ -134,3 +138,14 @@ paludis::get_group_name(const gid_t u)
     }
 }
 
+long
+paludis::current_thread_id()
+{
+#ifdef __linux__
+    static thread_local const long id(syscall(SYS_gettid));
+    return id;
+#else
+#  warning "Don't know how to get a thread ID on your platform"
+    return 0;
+#endif
+}
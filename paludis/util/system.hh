@@ -90,6 +90,14 @@ namespace paludis
      * \ingroup g_system
      */
     std::string get_group_name(const gid_t) PALUDIS_VISIBLE;
+
+    /**
+     * Fetch an identifier for the calling thread, as used in log messages
+     * and traces, or 0 if we don't know how to get one.
+     *
+     * \ingroup g_system
+     */
+    long current_thread_id() PALUDIS_VISIBLE;
 }
 
 #endif
@@ -24,6 +24,7 @@
 #include <functional>
 #include <cctype>
 #include <sched.h>
+#include <thread>
 
 #include <gtest/gtest.h>
 
@@ -57,3 +58,15 @@ TEST(KernelVersion, Works)
 #endif
 }
 
+TEST(CurrentThreadID, Works)
+{
+    long other(0);
+    std::thread t([&] { other = current_thread_id(); });
+    t.join();
+
+    EXPECT_EQ(current_thread_id(), current_thread_id());
+#ifdef __linux__
+    EXPECT_NE(0, current_thread_id());
+    EXPECT_NE(other, current_thread_id());
+#endif
+}
@@ -19,8 +19,11 @@
 
 #include <paludis/util/thread_pool.hh>
 #include <paludis/util/pimp-impl.hh>
+#include <algorithm>
 #include <memory>
 #include <deque>
+#include <exception>
+#include <mutex>
 #include <thread>
 
 using namespace paludis;
@@ -57,6 +60,52 @@ ThreadPool::number_of_threads() const
     return _imp->threads.size();
 }
 
+void
+paludis::parallel_for_each(const std::size_t count, const std::function<void (std::size_t)> & f, const unsigned max_threads)
+{
+    std::size_t n_threads(0 != max_threads ? max_threads : std::thread::hardware_concurrency());
+    n_threads = std::max<std::size_t>(1, std::min(n_threads, count));
+
+    std::mutex mutex;
+    std::size_t next(0);
+    std::exception_ptr failure;
+
+    auto worker([&] () {
+        while (true)
+        {
+            std::size_t n;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (failure || count == next)
+                    return;
+                n = next++;
+            }
+
+            try
+            {
+                f(n);
+            }
+            catch (...)
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (! failure)
+                    failure = std::current_exception();
+                return;
+            }
+        }
+    });
+
+    {
+        ThreadPool pool;
+        for (std::size_t t(1) ; t < n_threads ; ++t)
+            pool.create_thread(worker);
+        worker();
+    }
+
+    if (failure)
+        std::rethrow_exception(failure);
+}
+
 namespace paludis
 {
     template class Pimp<ThreadPool>;
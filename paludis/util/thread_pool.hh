@@ -23,9 +23,10 @@
 #include <paludis/util/attributes.hh>
 #include <paludis/util/pimp.hh>
 #include <functional>
+#include <cstddef>
 
 /** \file
- * Declarations for the ThreadPool class.
+ * Declarations for the ThreadPool class and parallel_for_each.
  *
  * \ingroup g_threads
  *
@@ -67,6 +68,19 @@ namespace paludis
             unsigned number_of_threads() const;
     };
 
+    /**
+     * Call f(n) for every n in [0, count), using up to max_threads threads
+     * (zero means one per processor), including the calling thread.
+     *
+     * If any call throws, no further calls are started, and the first
+     * exception is rethrown in the calling thread once every thread has
+     * finished.
+     *
+     * \ingroup g_threads
+     */
+    void parallel_for_each(const std::size_t count, const std::function<void (std::size_t)> & f,
+            const unsigned max_threads = 0) PALUDIS_VISIBLE;
+
     extern template class Pimp<ThreadPool>;
 }
 
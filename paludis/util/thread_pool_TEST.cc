@@ -18,6 +18,8 @@
  */
 
 #include <paludis/util/thread_pool.hh>
+#include <paludis/util/exception.hh>
+#include <paludis/util/stringify.hh>
 
 #include <vector>
 #include <algorithm>
@@ -46,3 +48,32 @@ TEST(ThreadPool, Works)
     ASSERT_TRUE(n_threads == std::count(t.begin(), t.end(), 1));
 }
 
+
+TEST(ParallelForEach, Works)
+{
+    for (unsigned n_threads(0) ; n_threads != 4 ; ++n_threads)
+    {
+        std::vector<int> t(100, 0);
+        parallel_for_each(t.size(), [&] (std::size_t n) { t[n] += n; }, n_threads);
+        for (std::size_t n(0) ; n != t.size() ; ++n)
+            ASSERT_EQ(int(n), t[n]);
+    }
+}
+
+TEST(ParallelForEach, Empty)
+{
+    parallel_for_each(0, [] (std::size_t) { throw InternalError(PALUDIS_HERE, "called"); });
+}
+
+TEST(ParallelForEach, Exceptions)
+{
+    auto f([] (std::size_t n) {
+            if (3 == n)
+                throw InternalError(PALUDIS_HERE, "three");
+            });
+    ASSERT_THROW(parallel_for_each(100, f, 4), InternalError);
+
+    unsigned calls(0);
+    ASSERT_THROW(parallel_for_each(100, [&] (std::size_t n) { ++calls; f(n); }, 1), InternalError);
+    ASSERT_EQ(4u, calls);
+}
@@ -26,3 +26,20 @@ TokeniserError::TokeniserError(const std::string & s, const std::string & msg) n
 {
 }
 
+
+const tokeniser_internals::LexerClasses *
+tokeniser_internals::cached_lexer_classes(const std::string & delims, const std::string & quotes)
+{
+    static const std::string whitespace(" \t\r\n");
+    static const LexerClasses whitespace_classes(whitespace, "");
+    static const LexerClasses whitespace_quoted_classes(whitespace, "'\"");
+
+    if (delims != whitespace)
+        return nullptr;
+    else if (quotes.empty())
+        return &whitespace_classes;
+    else if (quotes == "'\"")
+        return &whitespace_quoted_classes;
+    else
+        return nullptr;
+}
@@ -20,9 +20,12 @@
 #ifndef PALUDIS_GUARD_PALUDIS_TOKENISER_HH
 #define PALUDIS_GUARD_PALUDIS_TOKENISER_HH 1
 
-#include <iterator>
+#include <paludis/util/character_class.hh>
 #include <paludis/util/exception.hh>
 #include <paludis/util/stringify.hh>
+#include <algorithm>
+#include <iterator>
+#include <optional>
 #include <string>
 
 /** \file
@@ -140,21 +143,64 @@ namespace paludis
             }
         };
 
+        /**
+         * The character classes a Lexer scans with.
+         *
+         * \ingroup g_strings
+         */
+        struct LexerClasses
+        {
+            const CharacterClass delims;
+            const CharacterClass quotes;
+            const CharacterClass delims_or_quotes;
+
+            LexerClasses(const std::string & d, const std::string & q) :
+                delims(d),
+                quotes(q),
+                delims_or_quotes(d + q)
+            {
+            }
+        };
+
+        /**
+         * Prebuilt classes for the whitespace delimiters, with and without
+         * quotes, or null for any other set.
+         *
+         * \ingroup g_strings
+         */
+        const LexerClasses * cached_lexer_classes(const std::string & delims, const std::string & quotes)
+            PALUDIS_VISIBLE PALUDIS_ATTRIBUTE((warn_unused_result));
+
         struct Lexer
         {
-            const std::string text;
+            const std::string & text;
             std::string::size_type text_pos;
-            std::string delims;
-            const std::string quotes;
+            std::optional<LexerClasses> own_classes;
+            const LexerClasses & classes;
+            const CharacterClass & delims;
+            const CharacterClass & quotes;
+            const CharacterClass & delims_or_quotes;
+            bool use_delims;
 
             std::string value;
             enum { t_quote, t_delim, t_text } kind;
 
+            static const LexerClasses & classes_for(std::optional<LexerClasses> & own, const std::string & d, const std::string & q)
+            {
+                if (const LexerClasses * const cached = cached_lexer_classes(d, q))
+                    return *cached;
+                own.emplace(d, q);
+                return *own;
+            }
+
             Lexer(const std::string & t, const std::string & d, const std::string & q) :
                 text(t),
                 text_pos(0),
-                delims(d),
-                quotes(q)
+                classes(classes_for(own_classes, d, q)),
+                delims(classes.delims),
+                quotes(classes.quotes),
+                delims_or_quotes(classes.delims_or_quotes),
+                use_delims(true)
             {
             }
 
@@ -163,17 +209,14 @@ namespace paludis
                 if (text_pos >= text.length())
                     return false;
 
-                if (std::string::npos != delims.find(text[text_pos]))
+                if (use_delims && delims.contains(text[text_pos]))
                 {
                     std::string::size_type start_pos(text_pos);
-                    while (++text_pos < text.length())
-                        if (std::string::npos == delims.find(text[text_pos]))
-                            break;
-
+                    text_pos = std::min(delims.find_first_not_in(text, text_pos + 1), text.length());
                     value = text.substr(start_pos, text_pos - start_pos);
                     kind = t_delim;
                 }
-                else if (std::string::npos != quotes.find(text[text_pos]))
+                else if (quotes.contains(text[text_pos]))
                 {
                     value = std::string(1, text[text_pos]);
                     kind = t_quote;
@@ -182,11 +225,7 @@ namespace paludis
                 else
                 {
                     std::string::size_type start_pos(text_pos);
-                    while (++text_pos < text.length())
-                        if (std::string::npos != delims.find(text[text_pos]))
-                            break;
-                        else if (std::string::npos != quotes.find(text[text_pos]))
-                            break;
+                    text_pos = std::min((use_delims ? delims_or_quotes : quotes).find_first_in(text, text_pos + 1), text.length());
                     value = text.substr(start_pos, text_pos - start_pos);
                     kind = t_text;
                 }
@@ -254,7 +293,7 @@ namespace paludis
                     {
                         case Lexer::t_quote:
                             state = s_had_quote;
-                            l.delims = "";
+                            l.use_delims = false;
                             break;
 
                         case Lexer::t_delim:
@@ -274,7 +313,7 @@ namespace paludis
                     {
                         case Lexer::t_quote:
                             state = s_had_quote_text_quote;
-                            l.delims = delims;
+                            l.use_delims = true;
                             tokeniser_internals::Writer<DelimMode_, Iter_>::handle_token("", iter);
                             break;
 
@@ -302,7 +341,7 @@ namespace paludis
 
                         case Lexer::t_quote:
                             state = s_had_quote_text_quote;
-                            l.delims = delims;
+                            l.use_delims = true;
                             break;
                     }
                     break;
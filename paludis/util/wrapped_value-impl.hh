@@ -21,6 +21,7 @@
 #define PALUDIS_GUARD_PALUDIS_UTIL_WRAPPED_VALUE_IMPL_HH 1
 
 #include <paludis/util/wrapped_value.hh>
+#include <paludis/util/hashes.hh>
 #include <ostream>
 
 namespace paludis
@@ -42,15 +43,73 @@ namespace paludis
         }
     };
 
+    template <typename Tag_, bool interned_ = WrappedValueInterning<Tag_>::enabled>
+    struct WrappedValueStore
+    {
+        typedef typename WrappedValueTraits<Tag_>::UnderlyingType UnderlyingType;
+        typedef typename WrappedValueStorage<Tag_>::Type Type;
+
+        static Type make(
+                const UnderlyingType & v,
+                const typename WrappedValueDevoid<typename WrappedValueTraits<Tag_>::ValidationParamsType>::Type & p)
+        {
+            if (WrappedValueValidate<Tag_, typename WrappedValueTraits<Tag_>::ValidationParamsType>::Type::validate(v, p))
+                return std::make_shared<UnderlyingType>(v);
+            else
+                throw typename WrappedValueTraits<Tag_>::ExceptionType(v);
+        }
+
+        static const UnderlyingType & value(const Type & t)
+        {
+            return *t;
+        }
+
+        static std::size_t hash(const Type & t)
+        {
+            return Hash<UnderlyingType>()(*t);
+        }
+
+        static bool equal(const Type & a, const Type & b)
+        {
+            return *a == *b;
+        }
+    };
+
+    template <typename Tag_>
+    struct WrappedValueStore<Tag_, true>
+    {
+        typedef typename WrappedValueTraits<Tag_>::UnderlyingType UnderlyingType;
+        typedef typename WrappedValueStorage<Tag_>::Type Type;
+
+        static Type make(
+                const UnderlyingType & v,
+                const typename WrappedValueDevoid<typename WrappedValueTraits<Tag_>::ValidationParamsType>::Type &)
+        {
+            return WrappedValueInterning<Tag_>::intern(v);
+        }
+
+        static const UnderlyingType & value(const Type & t)
+        {
+            return t->first;
+        }
+
+        static std::size_t hash(const Type & t)
+        {
+            return t->second;
+        }
+
+        static bool equal(const Type & a, const Type & b)
+        {
+            return a == b;
+        }
+    };
+
     template <typename Tag_>
     WrappedValue<Tag_>::WrappedValue(
             const typename WrappedValueTraits<Tag_>::UnderlyingType & v,
-            const typename WrappedValueDevoid<typename WrappedValueTraits<Tag_>::ValidationParamsType>::Type & p)
+            const typename WrappedValueDevoid<typename WrappedValueTraits<Tag_>::ValidationParamsType>::Type & p) :
+        _value(WrappedValueStore<Tag_>::make(v, p))
     {
-        if (WrappedValueValidate<Tag_, typename WrappedValueTraits<Tag_>::ValidationParamsType>::Type::validate(v, p))
-            _value = std::make_shared<typename WrappedValueTraits<Tag_>::UnderlyingType>(v);
-        else
-            throw typename WrappedValueTraits<Tag_>::ExceptionType(v);
     }
 
     template <typename Tag_>
@@ -72,7 +131,14 @@ namespace paludis
     bool
     WrappedValue<Tag_>::WrappedValue::operator== (const WrappedValue & other) const
     {
-        return value() == other.value();
+        return WrappedValueStore<Tag_>::equal(_value, other._value);
+    }
+
+    template <typename Tag_>
+    std::size_t
+    WrappedValue<Tag_>::WrappedValue::hash() const
+    {
+        return WrappedValueStore<Tag_>::hash(_value);
     }
 
     template <typename Tag_>
@@ -88,7 +154,7 @@ namespace paludis
     const typename WrappedValueTraits<Tag_>::UnderlyingType &
     WrappedValue<Tag_>::value() const
     {
-        return *_value;
+        return WrappedValueStore<Tag_>::value(_value);
     }
 
     template <typename Tag_>
@@ -23,7 +23,9 @@
 #include <paludis/util/wrapped_value-fwd.hh>
 #include <paludis/util/no_type.hh>
 #include <paludis/util/operators.hh>
+#include <cstddef>
 #include <memory>
+#include <utility>
 
 namespace paludis
 {
@@ -39,12 +41,43 @@ namespace paludis
         typedef NoType<0u> * Type;
     };
 
+    /**
+     * Specialise this, with enabled set to true and a suitable intern()
+     * function, to have every distinct value of a WrappedValue stored exactly
+     * once.
+     *
+     * An interned value is validated only the first time it is seen, and
+     * afterwards is carried around as a single pointer, giving constant time
+     * copying, equality and hashing.
+     */
+    template <typename Tag_>
+    struct WrappedValueInterning
+    {
+        static const bool enabled = false;
+    };
+
+    template <typename Tag_, bool interned_ = WrappedValueInterning<Tag_>::enabled>
+    struct WrappedValueStorage
+    {
+        typedef std::shared_ptr<const typename WrappedValueTraits<Tag_>::UnderlyingType> Type;
+    };
+
+    template <typename Tag_>
+    struct WrappedValueStorage<Tag_, true>
+    {
+        /**
+         * The value, and its precomputed hash. Owned by the intern table, and
+         * never freed.
+         */
+        typedef const std::pair<const typename WrappedValueTraits<Tag_>::UnderlyingType, std::size_t> * Type;
+    };
+
     template <typename Tag_>
     class PALUDIS_VISIBLE WrappedValue :
         public relational_operators::HasRelationalOperators
     {
         private:
-            std::shared_ptr<const typename WrappedValueTraits<Tag_>::UnderlyingType> _value;
+            typename WrappedValueStorage<Tag_>::Type _value;
 
         public:
             explicit WrappedValue(
@@ -60,6 +93,8 @@ namespace paludis
 
             bool operator< (const WrappedValue &) const PALUDIS_ATTRIBUTE((warn_unused_result));
             bool operator== (const WrappedValue &) const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            std::size_t hash() const PALUDIS_ATTRIBUTE((warn_unused_result));
     };
 }
 
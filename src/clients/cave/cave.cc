@@ -21,6 +21,11 @@
 #include <paludis/util/join.hh>
 #include <paludis/util/wrapped_output_iterator.hh>
 #include <paludis/util/iterator_funcs.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/log.hh>
+#include <paludis/util/instrumentation.hh>
+#include <paludis/util/safe_ofstream.hh>
+#include <paludis/util/system.hh>
 #include <paludis/args/do_help.hh>
 #include <paludis/environment_factory.hh>
 #include <paludis/environment.hh>
@@ -33,6 +38,7 @@
 
 #include "command_factory.hh"
 #include "command_line.hh"
+#include "cmd_serve.hh"
 #include "format_user_config.hh"
 
 using namespace paludis;
@@ -40,6 +46,54 @@ using std::endl;
 using std::cout;
 using std::cerr;
 
+namespace
+{
+    /* write out whatever --profile and --profile-trace asked for when the
+     * command finishes, however it finishes. if we're part of an
+     * execute-resolution --timeline, add our events to that too. */
+    struct ProfileWriter
+    {
+        bool report;
+        std::string trace_file;
+
+        ~ProfileWriter()
+        {
+            std::string timeline(getenv_with_default("CAVE_TIMELINE", ""));
+            if (! timeline.empty())
+            {
+                try
+                {
+                    Instrumentation::get_instance()->append_chrome_trace_events(FSPath(timeline));
+                }
+                catch (const Exception & e)
+                {
+                    cerr << "Couldn't write timeline to '" << timeline << "': " << e.message() << endl;
+                }
+            }
+
+            if (report)
+            {
+                Log::get_instance()->flush();
+                cerr << endl;
+                Instrumentation::get_instance()->write_report(cerr);
+            }
+
+            if (! trace_file.empty())
+            {
+                try
+                {
+                    SafeOFStream stream(FSPath(trace_file), -1, true);
+                    Instrumentation::get_instance()->write_chrome_trace(stream);
+                }
+                catch (const Exception & e)
+                {
+                    cerr << "Couldn't write profile trace to '" << trace_file << "': " << e.message() << endl;
+                }
+            }
+        }
+    };
+}
+
 int main(int argc, char * argv[])
 {
     Context context(std::string("In program ") + argv[0] + " " + join(argv + 1, argv + argc, " ") + ":");
@@ -86,6 +140,8 @@ int main(int argc, char * argv[])
             cave_var = cave_var + " --" + cmdline.a_environment.long_name() + " " + cmdline.a_environment.argument();
         if (cmdline.a_log_level.specified())
             cave_var = cave_var + " --" + cmdline.a_log_level.long_name() + " " + cmdline.a_log_level.argument();
+        if (cmdline.a_log_format.specified())
+            cave_var = cave_var + " --" + cmdline.a_log_format.long_name() + " " + cmdline.a_log_format.argument();
         if (cmdline.a_colour.specified())
             cave_var = cave_var + " --" + cmdline.a_colour.long_name() + " " + cmdline.a_colour.argument();
         setenv("CAVE", cave_var.c_str(), 1);
@@ -97,6 +153,34 @@ int main(int argc, char * argv[])
 
         Log::get_instance()->set_program_name(argv[0]);
         Log::get_instance()->set_log_level(cmdline.a_log_level.option());
+        if (cmdline.a_log_format.argument() == "json")
+            Log::get_instance()->set_log_format(lf_json);
+        /* only debug logging says enough for a background writer to pay
+         * off, and otherwise we'd rather messages stayed in order with our
+         * own output */
+        if (ll_debug == cmdline.a_log_level.option())
+            Log::get_instance()->set_asynchronous(true);
+
+        /* the server's timings are no use to us if we're profiling */
+        if (cmdline.a_via_server.specified() && cave::can_run_via_server(*cmdline.begin_parameters())
+                && ! cmdline.a_profile.specified() && ! cmdline.a_profile_trace.specified())
+        {
+            std::shared_ptr<Sequence<std::string> > all(std::make_shared<Sequence<std::string>>());
+            std::copy(cmdline.begin_parameters(), cmdline.end_parameters(), all->back_inserter());
+
+            int status;
+            if (cave::run_via_server(FSPath(cmdline.a_via_server.argument()), cmdline, all, status))
+                return status;
+        }
+
+        ProfileWriter profile_writer{ cmdline.a_profile.specified(), cmdline.a_profile_trace.argument() };
+        /* a report only needs the totals, so only keep every call if
+         * something is going to write them out */
+        const bool want_events(cmdline.a_profile_trace.specified() || ! getenv_with_default("CAVE_TIMELINE", "").empty());
+        if (cmdline.a_profile.specified() || want_events)
+            Instrumentation::get_instance()->set_enabled(true);
+        Instrumentation::get_instance()->set_records_events(want_events);
+
         std::shared_ptr<Environment> env(EnvironmentFactory::get_instance()->create(cmdline.a_environment.argument()));
 
         std::shared_ptr<Sequence<std::string> > seq(std::make_shared<Sequence<std::string>>());
@@ -115,6 +199,7 @@ int main(int argc, char * argv[])
     }
     catch (const ActionAbortedError & e)
     {
+        Log::get_instance()->flush();
         cout << endl;
         cerr << "Action aborted:" << endl
             << "  * " << e.backtrace("\n  * ")
@@ -123,6 +208,7 @@ int main(int argc, char * argv[])
     }
     catch (const Exception & e)
     {
+        Log::get_instance()->flush();
         cerr << endl;
         cerr << "Error:" << endl;
         cerr << "  * " << e.backtrace("\n  * ") << e.message() << " (" << e.what() << ")" << endl;
@@ -46,6 +46,7 @@
 #include <paludis/util/executor.hh>
 #include <paludis/util/timestamp.hh>
 #include <paludis/util/process.hh>
+#include <paludis/util/instrumentation.hh>
 #include <paludis/resolver/resolutions_by_resolvent.hh>
 #include <paludis/resolver/reason.hh>
 #include <paludis/resolver/sanitised_dependencies.hh>
@@ -153,6 +154,32 @@ namespace
         return f(s);
     }
 
+    /* jobs are recorded for --timeline. the ebuild phases that they run are
+     * recorded by the cave perform processes that run them, which append to
+     * the same file. */
+    void add_timeline_event(
+            const std::string & what,
+            const PackageDepSpec & id_spec,
+            const bool success,
+            const unsigned long long start)
+    {
+        if (Instrumentation::enabled())
+            Instrumentation::get_instance()->add_event(what + " " + stringify(id_spec) + (success ? "" : " (failed)"),
+                    what, start, Instrumentation::now());
+    }
+
+    void start_timeline(const std::string & f)
+    {
+        FSPath timeline((f.empty() || '/' != f.at(0)) ? FSPath::cwd() / f : FSPath(f));
+        timeline.unlink();
+
+        /* every cave process from here down, including this one, appends its
+         * events to the timeline when it finishes */
+        ::setenv("CAVE_TIMELINE", stringify(timeline).c_str(), 1);
+        Instrumentation::get_instance()->set_enabled(true);
+        Instrumentation::get_instance()->set_records_events(true);
+    }
+
     std::string stringify_id_or_spec(
             const std::shared_ptr<Environment> & env,
             const PackageDepSpec & spec)
@@ -466,7 +493,9 @@ namespace
         process.pipe_command_handler("PALUDIS_IPC", std::bind(lock_pipe_command,
                     std::ref(executor_mutex), input_manager.pipe_command_handler(), std::placeholders::_1));
 
+        const unsigned long long start(Instrumentation::now());
         int retcode(process.run().wait());
+        add_timeline_event("fetch", id_spec, 0 == retcode, start);
         return 0 == retcode;
     }
 
@@ -527,7 +556,9 @@ namespace
         process.pipe_command_handler("PALUDIS_IPC", std::bind(lock_pipe_command,
                     std::ref(executor_mutex), input_manager.pipe_command_handler(), std::placeholders::_1));
 
+        const unsigned long long start(Instrumentation::now());
         int retcode(process.run().wait());
+        add_timeline_event("install", id_spec, 0 == retcode, start);
         const std::shared_ptr<OutputManager> output_manager(input_manager.underlying_output_manager_if_constructed());
         return 0 == retcode;
     }
@@ -584,7 +615,9 @@ namespace
         process.pipe_command_handler("PALUDIS_IPC", std::bind(lock_pipe_command,
                     std::ref(executor_mutex), input_manager.pipe_command_handler(), std::placeholders::_1));
 
+        const unsigned long long start(Instrumentation::now());
         int retcode(process.run().wait());
+        add_timeline_event("uninstall", id_spec, 0 == retcode, start);
         const std::shared_ptr<OutputManager> output_manager(input_manager.underlying_output_manager_if_constructed());
         if (output_manager)
             output_manager->succeeded();
@@ -1743,6 +1776,9 @@ ExecuteResolutionCommand::run(
     else
         n_fetch_jobs = 1;
 
+    if (cmdline.execution_options.a_timeline.specified())
+        start_timeline(cmdline.execution_options.a_timeline.argument());
+
     return execute_resolution(env, lists, cmdline, n_fetch_jobs);
 }
 
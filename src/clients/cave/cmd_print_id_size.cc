@@ -53,10 +53,16 @@ namespace
         args::SwitchArg a_all;
         args::SwitchArg a_best;
 
+        args::ArgsGroup g_size_options;
+        args::IntegerArg a_jobs;
+
         PrintIDSizeCommandLine() :
             g_spec_options(main_options_section(), "Spec Options", "Alter how the supplied spec is used."),
             a_all(&g_spec_options, "all", 'a', "If the spec matches multiple IDs, display all matches.", true),
-            a_best(&g_spec_options, "best", 'b', "If the spec matches multiple IDs, select the best ID rather than giving an error.", true)
+            a_best(&g_spec_options, "best", 'b', "If the spec matches multiple IDs, select the best ID rather than giving an error.", true),
+            g_size_options(main_options_section(), "Size Options", "Alter how sizes are calculated."),
+            a_jobs(&g_size_options, "jobs", 'j', "The number of packages to add up in parallel, for packages which did not have their size "
+                    "recorded when they were installed. Defaults to the number of processors.")
         {
             add_usage_line("spec");
         }
@@ -81,7 +87,8 @@ PrintIDSizeCommand::run(
     if (cmdline.parameters().size() != 1)
         throw args::DoHelp("print-id-size takes exactly one parameter");
 
-    return size_common(env, false, *cmdline.begin_parameters(), cmdline.a_all.specified(), cmdline.a_best.specified());
+    return size_common(env, false, *cmdline.begin_parameters(), cmdline.a_all.specified(), cmdline.a_best.specified(),
+            cmdline.a_jobs.specified() ? cmdline.a_jobs.argument() : 0);
 }
 
 std::shared_ptr<args::ArgsHandler>
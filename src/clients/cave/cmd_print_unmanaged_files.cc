@@ -31,15 +31,20 @@
 #include <paludis/metadata_key.hh>
 #include <paludis/filtered_generator.hh>
 
+#include <paludis/util/fs_directory_reader.hh>
+#include <paludis/util/fs_error.hh>
 #include <paludis/util/fs_path.hh>
 #include <paludis/util/fs_stat.hh>
-#include <paludis/util/fs_error.hh>
-#include <paludis/util/fs_iterator.hh>
+#include <paludis/util/stringify.hh>
+#include <paludis/util/thread_pool.hh>
 
-#include <set>
-#include <list>
-#include <iostream>
 #include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
 
 using namespace paludis;
 using namespace cave;
@@ -82,62 +87,216 @@ namespace
         }
     };
 
-    class CollectRecursiveDirectoryContents
+    /**
+     * The set of every path owned by an installed package, held as a single
+     * sorted, front coded string. Every block_size'th entry is stored in
+     * full so that we can binary search on those, and then decode forwards
+     * from there.
+     */
+    class ManagedPaths
     {
-        public:
-            explicit CollectRecursiveDirectoryContents(std::set<FSPath, FSPathComparator> * contents)
-                : _contents(contents)
+        private:
+            static const std::size_t block_size = 16;
+
+            std::string _data;
+            std::vector<std::size_t> _block_offsets;
+
+            static void _put_length(std::string & out, std::size_t n)
             {
+                while (n >= 0x80)
+                {
+                    out.push_back(char((n & 0x7f) | 0x80));
+                    n >>= 7;
+                }
+                out.push_back(char(n));
             }
 
-            ~CollectRecursiveDirectoryContents() = default;
+            std::size_t _get_length(std::size_t & pos) const
+            {
+                std::size_t result(0);
+                for (unsigned shift(0) ; ; shift += 7)
+                {
+                    unsigned char c(_data[pos++]);
+                    result |= std::size_t(c & 0x7f) << shift;
+                    if (! (c & 0x80))
+                        return result;
+                }
+            }
 
-            void operator()(const FSPath& path)
+            /* decode the entry at pos into current, which must hold the
+             * previous entry in the block */
+            void _decode(std::size_t & pos, std::string & current) const
             {
-                for (FSIterator entry(path, { fsio_include_dotfiles, fsio_want_regular_files, fsio_want_directories }), end;
-                        entry != end; ++entry)
+                std::size_t shared(_get_length(pos));
+                std::size_t suffix(_get_length(pos));
+                current.resize(shared);
+                current.append(_data, pos, suffix);
+                pos += suffix;
+            }
+
+            /* the first entry not less than s, if there is one */
+            bool _lower_bound(const std::string & s, std::string & result) const
+            {
+                if (_block_offsets.empty())
+                    return false;
+
+                /* find the last block whose head is not greater than s */
+                std::size_t lo(0), hi(_block_offsets.size());
+                while (hi - lo > 1)
                 {
-                    try
-                    {
-                        if (entry->stat().is_directory())
-                            (*this)(*entry);
-                        else
-                            _contents->insert(*entry);
-                    }
-                    catch (const FSError& error)
-                    {
-                        cerr << error.message() << endl;
-                    }
+                    std::size_t mid(lo + (hi - lo) / 2), pos(_block_offsets[mid]);
+                    std::string head;
+                    _decode(pos, head);
+                    if (s < head)
+                        hi = mid;
+                    else
+                        lo = mid;
+                }
+
+                std::size_t pos(_block_offsets[lo]);
+                std::size_t end(lo + 1 == _block_offsets.size() ? _data.size() : _block_offsets[lo + 1]);
+                result.clear();
+                while (pos != end)
+                {
+                    _decode(pos, result);
+                    if (! (result < s))
+                        return true;
                 }
+
+                if (lo + 1 == _block_offsets.size())
+                    return false;
+
+                /* everything in this block was smaller, so it's the next head */
+                pos = _block_offsets[lo + 1];
+                result.clear();
+                _decode(pos, result);
+                return true;
             }
 
-        private:
-            std::set<FSPath, FSPathComparator> * const _contents;
+        public:
+            explicit ManagedPaths(std::vector<std::string> && paths)
+            {
+                std::sort(paths.begin(), paths.end());
+                paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+                const std::string * previous(nullptr);
+                for (std::size_t i(0) ; i != paths.size() ; ++i)
+                {
+                    std::size_t shared(0);
+                    if (0 == i % block_size)
+                        _block_offsets.push_back(_data.size());
+                    else
+                        while (shared < previous->size() && shared < paths[i].size() && (*previous)[shared] == paths[i][shared])
+                            ++shared;
+
+                    _put_length(_data, shared);
+                    _put_length(_data, paths[i].size() - shared);
+                    _data.append(paths[i], shared, std::string::npos);
+                    previous = &paths[i];
+                }
+            }
+
+            bool contains(const std::string & s) const
+            {
+                std::string found;
+                return _lower_bound(s, found) && found == s;
+            }
+
+            bool has_any_under(const std::string & dir) const
+            {
+                std::string found;
+                return _lower_bound(dir + "/", found) && 0 == found.compare(0, dir.length() + 1, dir + "/");
+            }
+    };
+
+    struct PendingDirectory
+    {
+        std::string path;
+
+        /* if false, nothing at or below path is managed, so there's no need
+         * to look anything up */
+        bool any_managed;
     };
 
-    class CollectPackageContents
+    /**
+     * Walks a tree one level at a time, reading every directory on a level in
+     * parallel, using FSDirectoryReader so that we only stat() entries whose
+     * type the filesystem doesn't tell us.
+     */
+    class UnmanagedFilesFinder
     {
+        private:
+            const ManagedPaths & _managed;
+
+            std::vector<PendingDirectory> _pending;
+
+            void _visit(const PendingDirectory & dir, std::vector<PendingDirectory> & subdirs, std::vector<std::string> & unmanaged)
+            {
+                FSDirectoryReader reader{FSPath(dir.path)};
+                while (reader.next())
+                {
+                    /* symlinks are neither, so we never follow them */
+                    const bool is_directory(reader.is_directory());
+                    if ((! is_directory) && (! reader.is_regular_file()))
+                        continue;
+
+                    std::string path(("/" == dir.path ? "" : dir.path) + "/");
+                    path.append(reader.name());
+                    if (is_directory)
+                    {
+                        bool any_managed(dir.any_managed && _managed.has_any_under(path));
+                        subdirs.push_back(PendingDirectory{ std::move(path), any_managed });
+                    }
+                    else if (! (dir.any_managed && _managed.contains(path)))
+                        unmanaged.push_back(std::move(path));
+                }
+            }
+
         public:
-            CollectPackageContents(std::set<FSPath, FSPathComparator> * contents)
-                : _contents(contents)
+            explicit UnmanagedFilesFinder(const ManagedPaths & managed) :
+                _managed(managed)
             {
             }
 
-            ~CollectPackageContents() = default;
+            void add_root(const FSPath & root)
+            {
+                std::string path(stringify(root));
+                _pending.push_back(PendingDirectory{ path, "/" == path || _managed.has_any_under(path) });
+            }
 
-            void operator()(const std::shared_ptr<const PackageID>& package)
+            std::vector<std::string> run()
             {
-                const auto contents(package->contents());
+                std::vector<std::string> result;
+                std::mutex cerr_mutex;
 
-                if (! contents)
-                    return;
+                while (! _pending.empty())
+                {
+                    std::vector<std::vector<PendingDirectory> > subdirs(_pending.size());
+                    std::vector<std::vector<std::string> > unmanaged(_pending.size());
+
+                    parallel_for_each(_pending.size(), [&] (std::size_t n) {
+                            try
+                            {
+                                _visit(_pending[n], subdirs[n], unmanaged[n]);
+                            }
+                            catch (const FSError & error)
+                            {
+                                std::unique_lock<std::mutex> lock(cerr_mutex);
+                                cerr << error.message() << endl;
+                            }
+                            });
+
+                    _pending.clear();
+                    for (auto & s : subdirs)
+                        std::move(s.begin(), s.end(), std::back_inserter(_pending));
+                    for (auto & u : unmanaged)
+                        std::move(u.begin(), u.end(), std::back_inserter(result));
+                }
 
-                for (const auto & entry : *contents)
-                    _contents->insert(entry->location_key()->parse_value());
+                std::sort(result.begin(), result.end());
+                result.erase(std::unique(result.begin(), result.end()), result.end());
+                return result;
             }
-
-        private:
-            std::set<FSPath, FSPathComparator> * const _contents;
     };
 }
 
@@ -147,9 +306,6 @@ PrintUnmanagedFilesCommand::run(const std::shared_ptr<Environment> & env,
 {
     PrintUnmanagedFilesCommandLine cmdline;
     std::set<FSPath, FSPathComparator> roots;
-    std::set<FSPath, FSPathComparator> all_files;
-    std::set<FSPath, FSPathComparator> managed_files;
-    std::set<FSPath, FSPathComparator> unmanaged_files;
 
     cmdline.run(args, "CAVE", "CAVE_PRINT_UNMANAGED_FILES_OPTIONS",
                 "CAVE_PRINT_UNMANAGED_FILES_CMDLINE");
@@ -188,22 +344,26 @@ PrintUnmanagedFilesCommand::run(const std::shared_ptr<Environment> & env,
     if (roots.empty())
         roots.insert(sysroot);
 
-    std::for_each(roots.begin(), roots.end(),
-                  CollectRecursiveDirectoryContents(&all_files));
-
+    std::vector<std::string> managed_files;
     const auto selection(selection::AllVersionsUnsorted(generator::All() | filter::InstalledAtRoot(sysroot)));
     const auto packages((*env)[selection]);
+    for (const auto & package : *packages)
+    {
+        const auto contents(package->contents());
+        if (! contents)
+            continue;
 
-    std::for_each(packages->begin(), packages->end(),
-                  CollectPackageContents(&managed_files));
+        for (const auto & entry : *contents)
+            managed_files.push_back(stringify(entry->location_key()->parse_value()));
+    }
 
-    std::set_difference(all_files.begin(), all_files.end(),
-                        managed_files.begin(), managed_files.end(),
-                        std::inserter(unmanaged_files, unmanaged_files.begin()),
-                        FSPathComparator());
+    const ManagedPaths managed(std::move(managed_files));
+    UnmanagedFilesFinder finder(managed);
+    for (const auto & root : roots)
+        finder.add_root(root);
 
-    for (const auto & unmanaged_file : unmanaged_files)
-        cout << unmanaged_file << endl;
+    for (const auto & unmanaged_file : finder.run())
+        cout << unmanaged_file << '\n';
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,795 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "cmd_serve.hh"
+#include "command_factory.hh"
+#include "command_line.hh"
+#include "exceptions.hh"
+#include "format_user_config.hh"
+#include <paludis/args/args.hh>
+#include <paludis/args/do_help.hh>
+#include <paludis/environment.hh>
+#include <paludis/repository.hh>
+#include <paludis/metadata_key.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/fs_stat.hh>
+#include <paludis/util/fs_iterator.hh>
+#include <paludis/util/fs_error.hh>
+#include <paludis/util/timestamp.hh>
+#include <paludis/util/options.hh>
+#include <paludis/util/sequence.hh>
+#include <paludis/util/stringify.hh>
+#include <paludis/util/destringify.hh>
+#include <paludis/util/exception.hh>
+#include <paludis/util/join.hh>
+#include <paludis/util/iterator_funcs.hh>
+#include <paludis/util/wrapped_forward_iterator.hh>
+#include <paludis/util/wrapped_output_iterator.hh>
+#include <paludis/util/safe_ifstream.hh>
+#include <paludis/util/system.hh>
+#include <paludis/util/log.hh>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "command_command_line.hh"
+
+using namespace paludis;
+using namespace cave;
+using std::cout;
+using std::cerr;
+using std::endl;
+
+namespace
+{
+    const char * const served_commands[] = { "has-version", "match", "print-best-version", "print-ids" };
+
+    /* not a valid command name, so it can't clash with anything we serve */
+    const std::string reload_request(":reload");
+
+    /* sent instead of a status when a request's environment settings aren't
+     * the same as ours */
+    const std::string refused_response("refused\n");
+
+    /* used to hand our sockets to our replacement when we reload */
+    const std::string listen_fd_var("CAVE_SERVE_LISTEN_FD");
+    const std::string pending_fd_var("CAVE_SERVE_PENDING_FD");
+
+    const std::size_t max_request_size(1 << 20);
+
+    /* requests are answered one at a time, so a client that connects but
+     * doesn't send its request, or doesn't read its response, holds up
+     * everyone else until this runs out */
+    const int request_timeout_seconds(10);
+
+    struct ServeCommandLine :
+        CaveCommandCommandLine
+    {
+        std::string app_name() const override
+        {
+            return "cave serve";
+        }
+
+        std::string app_synopsis() const override
+        {
+            return "Answers queries from other cave processes using a long-running environment.";
+        }
+
+        std::string app_description() const override
+        {
+            return "Listens on a UNIX socket, and answers queries made using 'cave --via-server socket COMMAND', "
+                "keeping a single environment loaded between queries. Only has-version, match, "
+                "print-best-version and print-ids can be served; other commands, and any command run when "
+                "no server is listening, are run by the client as normal. The environment is reloaded when "
+                "anything in the configuration directory changes, or when the top level, metadata or .git "
+                "directory of a repository changes. Other changes, such as editing an individual ebuild, are "
+                "not noticed; use 'cave serve --reload socket' to force a reload after making them. "
+                "The client's --log-level, --log-format and --colour options are used for its query, but if "
+                "its --environment option, or any of the ROOT, HOME, PALUDIS_* or CAVE_* environment "
+                "variables which affect the environment or the served commands, differ from the server's, "
+                "the client runs the command itself. Queries are answered one at a time, and a client which "
+                "connects but does not send its query holds up other clients for up to ten seconds.";
+        }
+
+        args::ArgsGroup g_serve_options;
+        args::SwitchArg a_reload;
+
+        ServeCommandLine() :
+            g_serve_options(main_options_section(), "Serve Options", "Serve options."),
+            a_reload(&g_serve_options, "reload", 'r', "Tell the server already listening on the socket to "
+                    "reload its environment, rather than starting a new server.", false)
+        {
+            add_usage_line("socket");
+            add_usage_line("--reload socket");
+        }
+    };
+
+    struct FdCloser
+    {
+        int fd;
+
+        explicit FdCloser(int f) :
+            fd(f)
+        {
+        }
+
+        ~FdCloser()
+        {
+            if (-1 != fd)
+                ::close(fd);
+        }
+
+        FdCloser(const FdCloser &) = delete;
+        FdCloser & operator= (const FdCloser &) = delete;
+    };
+
+    struct sockaddr_un make_address(const FSPath & socket)
+    {
+        struct sockaddr_un result;
+        std::memset(&result, 0, sizeof(result));
+        result.sun_family = AF_UNIX;
+
+        std::string s(stringify(socket));
+        if (s.length() >= sizeof(result.sun_path))
+            throw ServeError("Socket path '" + s + "' is too long");
+        std::copy(s.begin(), s.end(), result.sun_path);
+
+        return result;
+    }
+
+    /* returns -1, with errno set, if nothing is listening */
+    int connect_to(const FSPath & socket)
+    {
+        struct sockaddr_un address(make_address(socket));
+
+        int fd(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        if (-1 == fd)
+            throw ServeError("socket() failed: " + stringify(::strerror(errno)));
+
+        if (0 != ::connect(fd, reinterpret_cast<const struct sockaddr *>(&address), sizeof(address)))
+        {
+            int e(errno);
+            ::close(fd);
+            errno = e;
+            return -1;
+        }
+
+        return fd;
+    }
+
+    int listen_on(const FSPath & socket)
+    {
+        struct sockaddr_un address(make_address(socket));
+
+        /* a socket left over from a server that went away is fine to replace,
+         * but don't steal the address from one that is still running */
+        if (FSStat(socket).exists())
+        {
+            int fd(connect_to(socket));
+            if (-1 != fd)
+            {
+                ::close(fd);
+                throw ServeError("Something is already listening on '" + stringify(socket) + "'");
+            }
+            else if (ECONNREFUSED != errno)
+                throw ServeError("Cannot use '" + stringify(socket) + "': " + ::strerror(errno));
+
+            socket.unlink();
+        }
+
+        int fd(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        if (-1 == fd)
+            throw ServeError("socket() failed: " + stringify(::strerror(errno)));
+
+        FdCloser closer(fd);
+        if (0 != ::bind(fd, reinterpret_cast<const struct sockaddr *>(&address), sizeof(address)))
+            throw ServeError("Cannot bind to '" + stringify(socket) + "': " + ::strerror(errno));
+        socket.chmod(S_IRUSR | S_IWUSR);
+        if (0 != ::listen(fd, 64))
+            throw ServeError("Cannot listen on '" + stringify(socket) + "': " + ::strerror(errno));
+
+        closer.fd = -1;
+        return fd;
+    }
+
+    void send_all(int fd, const std::string & s)
+    {
+        for (std::string::size_type done(0) ; done < s.length() ; )
+        {
+            ssize_t n(::send(fd, s.data() + done, s.length() - done, MSG_NOSIGNAL));
+            if (-1 == n)
+            {
+                if (EINTR == errno)
+                    continue;
+                throw ServeError("send() failed: " + stringify(::strerror(errno)));
+            }
+            done += n;
+        }
+    }
+
+    std::string receive_all(int fd, const std::size_t limit)
+    {
+        std::string result;
+        char buf[4096];
+        while (true)
+        {
+            ssize_t n(::recv(fd, buf, sizeof(buf), 0));
+            if (-1 == n)
+            {
+                if (EINTR == errno)
+                    continue;
+                throw ServeError("recv() failed: " + stringify(::strerror(errno)));
+            }
+            else if (0 == n)
+                return result;
+
+            if (result.length() + n > limit)
+                throw ServeError("Message too large");
+            result.append(buf, n);
+        }
+    }
+
+    /* requests and the command line are both sequences of NUL-terminated strings */
+    std::vector<std::string> split_on_nuls(const std::string & s)
+    {
+        std::vector<std::string> result;
+        for (std::string::size_type p(0), q ; p < s.length() ; p = q + 1)
+        {
+            q = s.find('\0', p);
+            if (std::string::npos == q)
+                throw ServeError("Unterminated string in request");
+            result.push_back(s.substr(p, q - p));
+        }
+        return result;
+    }
+
+    std::vector<std::string> own_command_line()
+    {
+        SafeIFStream cmdline_file(FSPath("/proc/self/cmdline"));
+        return split_on_nuls(std::string(
+                    (std::istreambuf_iterator<char>(cmdline_file)), std::istreambuf_iterator<char>()));
+    }
+
+    /* Environment variables that can change how an environment is created, or
+     * how a served command behaves. Those that cave exports from its own
+     * command lines or process ID, and those that only matter to the client or
+     * to 'cave serve' itself, don't count. */
+    bool affects_served_commands(const std::string & var)
+    {
+        if ("PALUDIS_PID" == var)
+            return false;
+
+        if ("ROOT" == var || "HOME" == var || 0 == var.compare(0, 8, "PALUDIS_"))
+            return true;
+
+        return 0 == var.compare(0, 5, "CAVE_")
+            && "CAVE_OPTIONS" != var
+            && 0 != var.compare(0, 11, "CAVE_SERVE_")
+            && std::string::npos == var.find("CMDLINE");
+    }
+
+    /* the things which were used to create an environment, and which so have
+     * to be the same for the client and the server */
+    std::vector<std::string> environment_settings(const std::string & environment_spec)
+    {
+        std::vector<std::string> result{ "environment=" + environment_spec };
+        for (const char * const * e(environ) ; nullptr != *e ; ++e)
+        {
+            std::string v(*e);
+            if (affects_served_commands(v.substr(0, v.find('='))))
+                result.push_back("env=" + v);
+        }
+        std::sort(result.begin(), result.end());
+
+        return result;
+    }
+
+    struct ServerSettings
+    {
+        std::vector<std::string> environment_settings;
+        LogLevel log_level;
+        LogFormat log_format;
+    };
+
+    /* parse our own global options in the same way main() did */
+    ServerSettings own_settings()
+    {
+        std::vector<std::string> args(own_command_line());
+        std::vector<const char *> argv;
+        for (const auto & a : args)
+            argv.push_back(a.c_str());
+
+        CaveCommandLine cmdline;
+        cmdline.run(argv.size(), &argv[0], "CAVE", "CAVE_OPTIONS", "CAVE_CMDLINE",
+                args::ArgsHandlerOptions() + args::aho_stop_on_first_parameter);
+
+        return ServerSettings{
+            environment_settings(cmdline.a_environment.argument()),
+            cmdline.a_log_level.option(),
+            destringify<LogFormat>(cmdline.a_log_format.argument())
+        };
+    }
+
+    /* A request is the client's environment settings, then its output
+     * settings, then an empty string, then the command and its arguments, all
+     * as NUL-terminated strings. The output settings only change what the
+     * output looks like, so we use them for the request rather than needing
+     * them to match ours. */
+    struct Request
+    {
+        std::vector<std::string> environment_settings;
+        LogLevel log_level;
+        LogFormat log_format;
+        bool colour;
+        std::vector<std::string> command_and_args;
+    };
+
+    Request parse_request(const std::vector<std::string> & strings, const ServerSettings & settings)
+    {
+        Request result{ { }, settings.log_level, settings.log_format, false, { } };
+
+        auto separator(std::find(strings.begin(), strings.end(), ""));
+        if (strings.end() == separator)
+            throw ServeError("No command in request");
+
+        try
+        {
+            for (auto s(strings.begin()) ; s != separator ; ++s)
+                if (0 == s->compare(0, 10, "log-level="))
+                    result.log_level = destringify<LogLevel>(s->substr(10));
+                else if (0 == s->compare(0, 11, "log-format="))
+                    result.log_format = destringify<LogFormat>(s->substr(11));
+                else if (0 == s->compare(0, 7, "colour="))
+                    result.colour = ("yes" == s->substr(7));
+                else
+                    result.environment_settings.push_back(*s);
+        }
+        catch (const Exception & e)
+        {
+            throw ServeError("Bad setting in request: " + e.message());
+        }
+
+        result.command_and_args.assign(next(separator), strings.end());
+        return result;
+    }
+
+    /* uses a request's output settings until the request is done */
+    struct RequestOutputSettings
+    {
+        const ServerSettings & settings;
+
+        RequestOutputSettings(const Request & request, const ServerSettings & s) :
+            settings(s)
+        {
+            Log::get_instance()->set_log_level(request.log_level);
+            Log::get_instance()->set_log_format(request.log_format);
+            set_want_colours(request.colour);
+        }
+
+        ~RequestOutputSettings()
+        {
+            Log::get_instance()->set_log_level(settings.log_level);
+            Log::get_instance()->set_log_format(settings.log_format);
+            set_want_colours(false);
+        }
+
+        RequestOutputSettings(const RequestOutputSettings &) = delete;
+        RequestOutputSettings & operator= (const RequestOutputSettings &) = delete;
+    };
+
+    void add_to_fingerprint(std::string & f, const FSPath & p, int depth)
+    {
+        try
+        {
+            FSStat s(p);
+            if (! s.exists())
+            {
+                f.append("-" + stringify(p) + "\n");
+                return;
+            }
+
+            f.append(stringify(p) + " " + stringify(s.mtim().seconds()) + "." + stringify(s.mtim().nanoseconds())
+                    + " " + (s.is_regular_file() ? stringify(s.file_size()) : "-") + "\n");
+
+            if (depth > 0 && s.is_directory())
+                for (FSIterator d(p, { fsio_include_dotfiles }), d_end ; d != d_end ; ++d)
+                    add_to_fingerprint(f, *d, depth - 1);
+        }
+        catch (const FSError &)
+        {
+            f.append("!" + stringify(p) + "\n");
+        }
+    }
+
+    /* cheap enough to do for every request, and covers config edits, syncs
+     * and (via the installed repositories' category directories) merges */
+    std::string fingerprint(const Environment & env)
+    {
+        std::string result;
+
+        if (env.config_location_key())
+            add_to_fingerprint(result, env.config_location_key()->parse_value(), 2);
+
+        for (const auto & repo : env.repositories())
+            if (repo->location_key())
+            {
+                FSPath location(repo->location_key()->parse_value());
+                add_to_fingerprint(result, location, 1);
+                add_to_fingerprint(result, location / "metadata", 1);
+                add_to_fingerprint(result, location / ".git", 1);
+            }
+
+        return result;
+    }
+
+    int fd_from_env(const std::string & var)
+    {
+        std::string v(getenv_with_default(var, ""));
+        ::unsetenv(var.c_str());
+        return v.empty() ? -1 : destringify<int>(v);
+    }
+
+    void keep_across_exec(int fd, const std::string & var)
+    {
+        if (-1 == fd)
+            return;
+
+        int flags(::fcntl(fd, F_GETFD));
+        if (-1 == flags || -1 == ::fcntl(fd, F_SETFD, flags & ~FD_CLOEXEC))
+            throw ServeError("fcntl() failed: " + stringify(::strerror(errno)));
+        ::setenv(var.c_str(), stringify(fd).c_str(), 1);
+    }
+
+    /* Start again from scratch, using the same command line, so that nothing
+     * from the old environment (including anything cached statically) is kept.
+     * We use the executable's path, rather than /proc/self/exe, so that we
+     * pick up a new cave if it has been upgraded. The listening socket, and the
+     * connection whose request prompted the reload (if any), are handed over
+     * rather than closed. */
+    void reexec(const FSPath & exe, int listen_fd, int pending_fd) PALUDIS_ATTRIBUTE((noreturn));
+
+    void reexec(const FSPath & exe, int listen_fd, int pending_fd)
+    {
+        std::vector<std::string> cmdline(own_command_line());
+
+        std::vector<char *> argv;
+        for (auto & a : cmdline)
+            argv.push_back(&a[0]);
+        argv.push_back(nullptr);
+
+        keep_across_exec(listen_fd, listen_fd_var);
+        keep_across_exec(pending_fd, pending_fd_var);
+
+        Log::get_instance()->message("cave.serve.reloading", ll_debug, lc_context) << "Reloading";
+        ::execv(stringify(exe).c_str(), &argv[0]);
+        throw ServeError("execv() failed: " + stringify(::strerror(errno)));
+    }
+
+    struct CapturedStream
+    {
+        std::ostream & stream;
+        std::streambuf * const old;
+
+        CapturedStream(std::ostream & s, std::stringstream & to) :
+            stream(s),
+            old(s.rdbuf(to.rdbuf()))
+        {
+        }
+
+        ~CapturedStream()
+        {
+            stream.rdbuf(old);
+            stream.clear();
+        }
+
+        CapturedStream(const CapturedStream &) = delete;
+        CapturedStream & operator= (const CapturedStream &) = delete;
+    };
+
+    /* mirrors what main() does, but with output going into strings */
+    int run_served_command(
+            const std::shared_ptr<Environment> & env,
+            const Request & request,
+            const ServerSettings & settings,
+            std::string & out,
+            std::string & err)
+    {
+        std::stringstream out_stream, err_stream;
+        int status(EXIT_FAILURE);
+
+        {
+            CapturedStream captured_out(cout, out_stream), captured_err(cerr, err_stream);
+            RequestOutputSettings output_settings(request, settings);
+
+            const std::vector<std::string> & command(request.command_and_args);
+            Context context("When serving request '" + join(command.begin(), command.end(), " ") + "':");
+
+            try
+            {
+                if (command.empty() || ! can_run_via_server(command.front()))
+                    throw ServeError("Command '" + (command.empty() ? std::string() : command.front())
+                            + "' cannot be run via a server");
+
+                auto args(std::make_shared<Sequence<std::string>>());
+                std::copy(next(command.begin()), command.end(), args->back_inserter());
+                status = CommandFactory::get_instance()->create(command.front())->run(env, args);
+            }
+            catch (const args::DoHelp & h)
+            {
+                if (h.message.empty())
+                    cout << "Usage: cave COMMAND [ARGS]" << endl;
+                else
+                    cerr << "Usage error: " << h.message << endl;
+            }
+            catch (const Exception & e)
+            {
+                cerr << endl;
+                cerr << "Error:" << endl;
+                cerr << "  * " << e.backtrace("\n  * ") << e.message() << " (" << e.what() << ")" << endl;
+                cerr << endl;
+            }
+            catch (const std::exception & e)
+            {
+                cerr << endl;
+                cerr << "Error:" << endl;
+                cerr << "  * " << e.what() << endl;
+                cerr << endl;
+            }
+        }
+
+        out = out_stream.str();
+        err = err_stream.str();
+        return status;
+    }
+
+    /* returns false if we need to reload before answering */
+    bool handle_connection(
+            const std::shared_ptr<Environment> & env,
+            const ServerSettings & settings,
+            int fd)
+    {
+        struct timeval timeout{ request_timeout_seconds, 0 };
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        std::vector<std::string> strings(split_on_nuls(receive_all(fd, max_request_size)));
+
+        if (1 == strings.size() && reload_request == strings.front())
+        {
+            send_all(fd, "0\n0\n");
+            return false;
+        }
+
+        Request request(parse_request(strings, settings));
+        if (request.environment_settings != settings.environment_settings)
+        {
+            std::vector<std::string> differences;
+            std::set_symmetric_difference(
+                    request.environment_settings.begin(), request.environment_settings.end(),
+                    settings.environment_settings.begin(), settings.environment_settings.end(),
+                    std::back_inserter(differences));
+            Log::get_instance()->message("cave.serve.refused", ll_debug, lc_context)
+                << "Refusing a request whose environment specification or variables differ from ours: '"
+                << join(differences.begin(), differences.end(), "', '") << "'";
+            send_all(fd, refused_response);
+            return true;
+        }
+
+        std::string out, err;
+        int status(run_served_command(env, request, settings, out, err));
+        send_all(fd, stringify(status) + "\n" + stringify(out.length()) + "\n" + out + err);
+        return true;
+    }
+
+    int serve(
+            const std::shared_ptr<Environment> & env,
+            const FSPath & socket)
+    {
+        /* nobody is looking at our output, and it isn't going to a terminal */
+        set_want_colours(false);
+
+        /* requests capture std::cerr, so log messages have to be written
+         * before a request finishes, by the thread that logged them */
+        Log::get_instance()->set_asynchronous(false);
+
+        FSPath exe(FSPath("/proc/self/exe").realpath());
+        int listen_fd(fd_from_env(listen_fd_var)), pending_fd(fd_from_env(pending_fd_var));
+        if (-1 == listen_fd)
+            listen_fd = listen_on(socket);
+
+        const ServerSettings settings(own_settings());
+        std::string initial_fingerprint(fingerprint(*env));
+
+        /* one request at a time: served commands write to cout and cerr, which
+         * we capture, so they can't run concurrently. request_timeout_seconds
+         * limits how long a misbehaving client can hold everyone else up. */
+        while (true)
+        {
+            int fd(pending_fd);
+            pending_fd = -1;
+
+            if (-1 == fd)
+            {
+                fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+                if (-1 == fd)
+                {
+                    if (EINTR == errno || ECONNABORTED == errno)
+                        continue;
+                    throw ServeError("accept() failed: " + stringify(::strerror(errno)));
+                }
+
+                /* the request is still sitting unread in the socket, so our
+                 * replacement can answer it */
+                if (fingerprint(*env) != initial_fingerprint)
+                    reexec(exe, listen_fd, fd);
+            }
+
+            FdCloser closer(fd);
+            try
+            {
+                if (! handle_connection(env, settings, fd))
+                {
+                    ::close(fd);
+                    closer.fd = -1;
+                    reexec(exe, listen_fd, -1);
+                }
+            }
+            catch (const ServeError & e)
+            {
+                Log::get_instance()->message("cave.serve.bad_connection", ll_warning, lc_context)
+                    << "Dropping connection: " << e.message();
+            }
+        }
+    }
+
+    int request_reload(const FSPath & socket)
+    {
+        int fd(connect_to(socket));
+        if (-1 == fd)
+            throw ServeError("Cannot connect to '" + stringify(socket) + "': " + ::strerror(errno));
+
+        FdCloser closer(fd);
+        send_all(fd, reload_request + '\0');
+        ::shutdown(fd, SHUT_WR);
+        if (receive_all(fd, max_request_size).empty())
+            throw ServeError("No response from '" + stringify(socket) + "'");
+
+        return EXIT_SUCCESS;
+    }
+}
+
+bool
+paludis::cave::can_run_via_server(const std::string & command)
+{
+    return std::end(served_commands) != std::find(std::begin(served_commands), std::end(served_commands), command);
+}
+
+bool
+paludis::cave::run_via_server(
+        const FSPath & socket,
+        const CaveCommandLine & global_options,
+        const std::shared_ptr<const Sequence<std::string> > & command_and_args,
+        int & status)
+{
+    int fd(connect_to(socket));
+    if (-1 == fd)
+    {
+        if (ENOENT == errno || ECONNREFUSED == errno)
+        {
+            Log::get_instance()->message("cave.via_server.not_listening", ll_debug, lc_no_context)
+                << "Nothing is listening on '" << socket << "', running locally";
+            return false;
+        }
+        throw ServeError("Cannot connect to '" + stringify(socket) + "': " + ::strerror(errno));
+    }
+
+    FdCloser closer(fd);
+
+    const std::string & colour(global_options.a_colour.argument());
+    bool want_colour("yes" == colour || ("auto" == colour && ::isatty(STDOUT_FILENO)));
+
+    std::string request;
+    for (const auto & s : environment_settings(global_options.a_environment.argument()))
+        request.append(s + '\0');
+    request.append("log-level=" + stringify(global_options.a_log_level.option()) + '\0');
+    request.append("log-format=" + global_options.a_log_format.argument() + '\0');
+    request.append("colour=" + std::string(want_colour ? "yes" : "no") + '\0');
+    request.append(1, '\0');
+    for (const auto & a : *command_and_args)
+        request.append(a + '\0');
+    send_all(fd, request);
+    ::shutdown(fd, SHUT_WR);
+
+    std::string response(receive_all(fd, std::string::npos));
+    if (refused_response == response)
+    {
+        Log::get_instance()->message("cave.via_server.refused", ll_debug, lc_no_context)
+            << "The server on '" << socket << "' is using a different environment specification or "
+            << "different environment variables, running locally";
+        return false;
+    }
+
+    std::string::size_type status_end(response.find('\n')), out_length_end(std::string::npos);
+    if (std::string::npos != status_end)
+        out_length_end = response.find('\n', status_end + 1);
+    if (std::string::npos == out_length_end)
+        throw ServeError("Bad response from '" + stringify(socket) + "'");
+
+    status = destringify<int>(response.substr(0, status_end));
+    std::string::size_type out_length(destringify<std::string::size_type>(
+                response.substr(status_end + 1, out_length_end - status_end - 1)));
+    if (out_length > response.length() - out_length_end - 1)
+        throw ServeError("Bad response from '" + stringify(socket) + "'");
+
+    cout << response.substr(out_length_end + 1, out_length) << std::flush;
+    cerr << response.substr(out_length_end + 1 + out_length) << std::flush;
+
+    return true;
+}
+
+int
+ServeCommand::run(
+        const std::shared_ptr<Environment> & env,
+        const std::shared_ptr<const Sequence<std::string > > & args
+        )
+{
+    ServeCommandLine cmdline;
+    cmdline.run(args, "CAVE", "CAVE_SERVE_OPTIONS", "CAVE_SERVE_CMDLINE");
+
+    if (cmdline.a_help.specified())
+    {
+        cout << cmdline;
+        return EXIT_SUCCESS;
+    }
+
+    if (cmdline.parameters().size() != 1)
+        throw args::DoHelp("serve takes exactly one parameter");
+
+    FSPath socket(*cmdline.begin_parameters());
+
+    if (cmdline.a_reload.specified())
+        return request_reload(socket);
+    else
+        return serve(env, socket);
+}
+
+std::shared_ptr<args::ArgsHandler>
+ServeCommand::make_doc_cmdline()
+{
+    return std::make_shared<ServeCommandLine>();
+}
+
+CommandImportance
+ServeCommand::importance() const
+{
+    return ci_scripting;
+}
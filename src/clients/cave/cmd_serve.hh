@@ -0,0 +1,72 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * Copyright (c) 2026 Paludis contributors
+ *
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef PALUDIS_GUARD_SRC_CLIENTS_CAVE_CMD_SERVE_HH
+#define PALUDIS_GUARD_SRC_CLIENTS_CAVE_CMD_SERVE_HH 1
+
+#include "command.hh"
+#include <paludis/util/fs_path-fwd.hh>
+
+namespace paludis
+{
+    namespace cave
+    {
+        struct CaveCommandLine;
+
+        class PALUDIS_VISIBLE ServeCommand :
+            public Command
+        {
+            public:
+                CommandImportance importance() const override PALUDIS_ATTRIBUTE((warn_unused_result));
+
+                int run(
+                        const std::shared_ptr<Environment> &,
+                        const std::shared_ptr<const Sequence<std::string > > & args
+                        ) override;
+
+                std::shared_ptr<args::ArgsHandler> make_doc_cmdline() override;
+        };
+
+        /**
+         * Can a 'cave serve' instance run the named command for us?
+         */
+        bool can_run_via_server(const std::string &) PALUDIS_VISIBLE PALUDIS_ATTRIBUTE((warn_unused_result));
+
+        /**
+         * Ask the 'cave serve' instance listening on the specified socket to run
+         * a command (the first item in the sequence, followed by its arguments),
+         * and copy its output to our stdout and stderr.
+         *
+         * The global options and the relevant environment variables are sent
+         * along with the command. Returns false, without running anything, if
+         * nothing is listening on the socket, or if the server's environment
+         * was created using a different environment specification or different
+         * environment variables, in which case the caller should run the
+         * command itself.
+         */
+        bool run_via_server(
+                const FSPath & socket,
+                const CaveCommandLine & global_options,
+                const std::shared_ptr<const Sequence<std::string> > & command_and_args,
+                int & status) PALUDIS_VISIBLE PALUDIS_ATTRIBUTE((warn_unused_result));
+    }
+}
+
+#endif
@@ -56,7 +56,13 @@ namespace
             return "Shows the size of files installed by a package.";
         }
 
-        SizeCommandLine()
+        args::ArgsGroup g_size_options;
+        args::IntegerArg a_jobs;
+
+        SizeCommandLine() :
+            g_size_options(main_options_section(), "Size Options", "Alter how sizes are calculated."),
+            a_jobs(&g_size_options, "jobs", 'j', "The number of packages to add up in parallel, for packages which did not have their size "
+                    "recorded when they were installed. Defaults to the number of processors.")
         {
             add_usage_line("spec");
         }
@@ -81,7 +87,8 @@ SizeCommand::run(
     if (cmdline.parameters().size() != 1)
         throw args::DoHelp("size takes exactly one parameter");
 
-    return size_common(env, true, *cmdline.begin_parameters(), true, false);
+    return size_common(env, true, *cmdline.begin_parameters(), true, false,
+            cmdline.a_jobs.specified() ? cmdline.a_jobs.argument() : 0);
 }
 
 std::shared_ptr<args::ArgsHandler>
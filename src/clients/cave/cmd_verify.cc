@@ -47,6 +47,7 @@
 #include <paludis/output_manager_from_environment.hh>
 #include <paludis/contents.hh>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <algorithm>
 #include <set>
@@ -114,91 +115,79 @@ namespace
             cout << fuc(fs_error(), fv<'t'>(text), fv<'p'>(stringify(path)));
         }
 
-        bool check_mtime(const ContentsEntry & e, const FSPath & p, const FSStat & f)
+        bool check_mtime(const ContentsEntryView & e, const FSPath & p, const FSStat & f)
         {
-            ContentsEntry::MetadataConstIterator k(e.find_metadata("mtime"));
-            if (e.end_metadata() != k)
+            if ((! e.mtime().empty()) && parse_contents_mtime(e.mtime()) != f.mtim().seconds())
             {
-                const MetadataTimeKey * kk(visitor_cast<const MetadataTimeKey>(**k));
-                if (kk && (kk->parse_value().seconds() != f.mtim().seconds()))
-                {
-                    message(p, "Modification time changed");
-                    return false;
-                }
+                message(p, "Modification time changed");
+                return false;
             }
 
             return true;
         }
 
-        bool check_md5(const ContentsEntry & e, const FSPath & f)
+        bool check_md5(const ContentsEntryView & e, const FSPath & f)
         {
-            ContentsEntry::MetadataConstIterator k(e.find_metadata("md5"));
-            if (e.end_metadata() != k)
+            if (! e.md5().empty())
             {
-                const MetadataValueKey<std::string> * kk(visitor_cast<const MetadataValueKey<std::string> >(**k));
-                if (kk)
+                SafeIFStream s(f);
+                MD5 md5(s);
+                if (e.md5() != md5.hexsum())
                 {
-                    SafeIFStream s(f);
-                    MD5 md5(s);
-                    if (kk->parse_value() != md5.hexsum())
-                    {
-                        message(f, "Contents (md5) changed");
-                        return false;
-                    }
+                    message(f, "Contents (md5) changed");
+                    return false;
                 }
             }
 
             return true;
         }
 
-        bool is_volatile(const ContentsEntry & e)
+        bool check(const ContentsEntryView & e)
         {
-            ContentsEntry::MetadataConstIterator k(e.find_metadata("volatile"));
-            if (e.end_metadata() != k)
+            FSPath f(std::string(e.path()));
+            switch (e.type())
             {
-                const MetadataValueKey<bool> * kk(visitor_cast<const MetadataValueKey<bool> >(**k));
-                if (kk)
-                    return kk->parse_value();
-            }
-            return false;
-        }
+                case et_file:
+                    {
+                        FSStat f_stat(f);
+                        if (! f_stat.exists())
+                            message(f, "Does not exist");
+                        else if (! f_stat.is_regular_file())
+                            message(f, "Not a regular file");
+                        else if (! e.is_volatile())
+                            check_mtime(e, f, f_stat) && check_md5(e, f);
+                    }
+                    break;
 
-        void visit(const ContentsFileEntry & e)
-        {
-            FSPath f(e.location_key()->parse_value());
-            FSStat f_stat(f);
-            if (! f_stat.exists())
-                message(f, "Does not exist");
-            else if (! f_stat.is_regular_file())
-                message(f, "Not a regular file");
-            else if (! is_volatile(e))
-                check_mtime(e, f, f_stat) && check_md5(e, f);
-        }
+                case et_sym:
+                    {
+                        FSStat f_stat(f);
+                        if (! f_stat.exists())
+                            message(f, "Does not exist");
+                        else if (! f_stat.is_symlink())
+                            message(f, "Not a symbolic link");
+                        else
+                            check_mtime(e, f, f_stat);
+                    }
+                    break;
 
-        void visit(const ContentsSymEntry & e)
-        {
-            FSPath f(e.location_key()->parse_value());
-            FSStat f_stat(f);
-            if (! f_stat.exists())
-                message(f, "Does not exist");
-            else if (! f_stat.is_symlink())
-                message(f, "Not a symbolic link");
-            else
-                check_mtime(e, f, f_stat);
-        }
+                case et_dir:
+                    {
+                        FSStat f_stat(f);
+                        if (! f_stat.exists())
+                            message(f, "Does not exist");
+                        else if (! f_stat.is_directory())
+                            message(f, "Not a directory");
+                    }
+                    break;
 
-        void visit(const ContentsDirEntry & e)
-        {
-            FSPath f(e.location_key()->parse_value());
-            FSStat f_stat(f);
-            if (! f_stat.exists())
-                message(f, "Does not exist");
-            else if (! f_stat.is_directory())
-                message(f, "Not a directory");
-        }
+                case et_misc:
+                case et_nothing:
+                case last_et:
+                    break;
+            }
 
-        void visit(const ContentsOtherEntry &)
-        {
+            return true;
         }
     };
 }
@@ -239,7 +228,7 @@ VerifyCommand::run(
             continue;
 
         Verifier v(id);
-        std::for_each(indirect_iterator(contents->begin()), indirect_iterator(contents->end()), accept_visitor(v));
+        contents->for_each_view(std::bind(&Verifier::check, &v, std::placeholders::_1));
         exit_status |= v.exit_status;
     }
 
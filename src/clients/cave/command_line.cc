@@ -29,6 +29,12 @@ CaveCommandLine::CaveCommandLine() :
     a_environment(&g_global_options, "environment", 'E',
             "Environment specification (class:suffix, both parts optional)"),
     a_log_level(&g_global_options, "log-level", 'L'),
+    a_log_format(&g_global_options, "log-format", '\0',
+            "Specify how log messages are written",
+            args::EnumArg::EnumArgOptions
+            ("text",       't', "Human readable text")
+            ("json",       'j', "One JSON object per line, with the message's id, level, thread and context"),
+            "text"),
     a_colour(&g_global_options, "colour", 'c',
             "Specify whether to use colour",
             args::EnumArg::EnumArgOptions
@@ -37,6 +43,15 @@ CaveCommandLine::CaveCommandLine() :
             ("no",         'n', "No"),
             "auto"),
     a_color(&a_colour, "color", true),
+    a_via_server(&g_global_options, "via-server", '\0',
+            "If a 'cave serve' instance is listening on the specified socket, have it run the command, "
+            "if it is one that can be served"),
+    a_profile(&g_global_options, "profile", '\0',
+            "When the command finishes, display how much time was spent in, and how many calls were made to, "
+            "various expensive operations", false),
+    a_profile_trace(&g_global_options, "profile-trace", '\0',
+            "When the command finishes, write the timings collected for --profile to the specified file "
+            "in the Chrome trace event format, for use with a trace viewer"),
     a_help(&g_global_options, "help", 'h', "display help message", false),
     a_version(&g_global_options, "version", 'v', "display version information", false)
 {
@@ -54,6 +69,9 @@ CaveCommandLine::CaveCommandLine() :
     add_description_line("Arguments specified after the COMMAND are handled by the individual "
             "commands. Arguments before the COMMAND are global arguments shared by all commands.");
 
+    add_description_line("The --via-server option may be set in CAVE_OPTIONS, so that scripts "
+            "making many queries use a running 'cave serve' without needing to be changed.");
+
     add_environment_variable("CAVE_COMMANDS_PATH", "Colon-separated paths in which to look for "
             "additional commands.");
 
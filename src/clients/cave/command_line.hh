@@ -48,8 +48,12 @@ namespace paludis
             args::ArgsGroup g_global_options;
             args::StringArg a_environment;
             args::LogLevelArg a_log_level;
+            args::EnumArg a_log_format;
             args::EnumArg a_colour;
             args::AliasArg a_color;
+            args::StringArg a_via_server;
+            args::SwitchArg a_profile;
+            args::StringArg a_profile_trace;
             args::SwitchArg a_help;
             args::SwitchArg a_version;
 
@@ -75,6 +75,11 @@ BadRepositoryForCommand::BadRepositoryForCommand(const RepositoryName & name, co
 {
 }
 
+ServeError::ServeError(const std::string & s) noexcept :
+    Exception(s)
+{
+}
+
 void
 paludis::cave::nothing_matching_error(
         const Environment * const env,
@@ -76,6 +76,13 @@ namespace paludis
                         const std::string & r) noexcept;
         };
 
+        class PALUDIS_VISIBLE ServeError :
+            public Exception
+        {
+            public:
+                ServeError(const std::string &) noexcept;
+        };
+
         void nothing_matching_error(
                 const Environment * const,
                 const std::string &,
@@ -41,19 +41,20 @@ using namespace paludis;
 
 namespace
 {
-    bool handle_full(const std::string & q, const std::shared_ptr<const ContentsEntry> & e)
+    bool handle_full(const std::string & q, const ContentsEntryView & e)
     {
-        return q == stringify(e->location_key()->parse_value());
+        return q == e.path();
     }
 
-    bool handle_basename(const std::string & q, const std::shared_ptr<const ContentsEntry> & e)
+    bool handle_basename(const std::string & q, const ContentsEntryView & e)
     {
-        return q == e->location_key()->parse_value().basename();
+        const std::string_view p(e.path());
+        return q == (p == "/" ? p : p.substr(p.rfind('/') + 1));
     }
 
-    bool handle_partial(const std::string & q, const std::shared_ptr<const ContentsEntry> & e)
+    bool handle_partial(const std::string & q, const ContentsEntryView & e)
     {
-        return std::string::npos != stringify(e->location_key()->parse_value()).find(q);
+        return std::string_view::npos != e.path().find(q);
     }
 }
 
@@ -67,7 +68,7 @@ paludis::cave::owner_common(
         const std::function<void (const std::shared_ptr<const PackageID> &)> & callback)
 {
     bool found(false);
-    std::function<bool (const std::string &, const std::shared_ptr<const ContentsEntry> &)> handler;
+    std::function<bool (const std::string &, const ContentsEntryView &)> handler;
     std::string query(q);
 
     if (dereference)
@@ -109,8 +110,9 @@ paludis::cave::owner_common(
         if (! contents)
             continue;
 
-        if (contents->end() != std::find_if(contents->begin(), contents->end(), std::bind(handler, query,
-                        std::placeholders::_1)))
+        bool owns(false);
+        contents->for_each_view([&] (const ContentsEntryView & e) { return ! (owns = handler(query, e)); });
+        if (owns)
         {
             callback(id);
             found = true;
@@ -0,0 +1,9 @@
+#!/usr/bin/env bash
+# vim: set ft=sh sw=4 sts=4 et :
+
+if [ -d print_unmanaged_files_TEST_dir ] ; then
+    chmod 755 print_unmanaged_files_TEST_dir/root/unreadable
+    rm -fr print_unmanaged_files_TEST_dir
+else
+    true
+fi
@@ -0,0 +1,51 @@
+#!/usr/bin/env bash
+# vim: set ft=sh sw=4 sts=4 et :
+
+mkdir print_unmanaged_files_TEST_dir || exit 1
+cd print_unmanaged_files_TEST_dir || exit 1
+mkdir -p build
+
+mkdir -p config/.paludis-print-unmanaged-files-test/repositories
+cat <<END > config/.paludis-print-unmanaged-files-test/specpath.conf
+config-suffix =
+END
+
+cat <<END > config/.paludis-print-unmanaged-files-test/general.conf
+world = `pwd`/world
+END
+
+cat <<END > config/.paludis-print-unmanaged-files-test/repositories/installed.conf
+location = `pwd`/vdb
+format = vdb
+names_cache = /var/empty
+builddir = `pwd`/build
+END
+
+mkdir -p vdb/cat/pkg-1 || exit 1
+for i in SLOT EAPI ; do
+    echo "0" > vdb/cat/pkg-1/${i}
+done
+for i in DEPEND RDEPEND LICENSE INHERITED IUSE PDEPEND ; do
+    touch vdb/cat/pkg-1/${i}
+done
+
+mkdir -p root/{managed/sub,mixed,unmanaged/sub,unreadable} || exit 1
+touch root/managed/file root/managed/sub/file || exit 1
+touch root/mixed/managed root/mixed/unmanaged || exit 1
+touch root/unmanaged/file root/unmanaged/sub/file || exit 1
+touch root/unreadable/file || exit 1
+ln -s ../unmanaged root/mixed/symlink_to_dir || exit 1
+ln -s managed root/mixed/symlink_to_file || exit 1
+ln -s nowhere root/mixed/dangling_symlink || exit 1
+
+cat <<END > vdb/cat/pkg-1/CONTENTS
+dir `pwd`/root/managed
+obj `pwd`/root/managed/file 0 0
+dir `pwd`/root/managed/sub
+obj `pwd`/root/managed/sub/file 0 0
+dir `pwd`/root/mixed
+obj `pwd`/root/mixed/managed 0 0
+sym `pwd`/root/mixed/symlink_to_file -> managed 0
+END
+
+chmod 000 root/unreadable || exit 1
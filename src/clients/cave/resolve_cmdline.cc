@@ -401,6 +401,9 @@ ResolveCommandLineExecutionOptions::ResolveCommandLineExecutionOptions(args::Arg
     a_fetch_jobs(&g_jobs_options, "fetch-jobs", 'J', "The number of parallel fetch jobs to launch. If set to 0, fetches "
             "will be carried out sequentially with other jobs. Values higher than 1 are currently treated "
             "as being 1. Defaults to 1, or if --fetch is specified, 0."),
+    a_timeline(&g_jobs_options, "timeline", '\0', "Write the start and end of every fetch, install and "
+            "uninstall job, and of every ebuild phase, to the specified file, in the Chrome trace event format, "
+            "for use with a trace viewer."),
 
     g_phase_options(this, "Phase Options", "Options controlling which phases to execute. No sanity checking "
             "is done, allowing you to shoot as many feet off as you desire. Phase names do not have the "
@@ -139,6 +139,7 @@ namespace paludis
             args::ArgsGroup g_jobs_options;
             args::SwitchArg a_fetch;
             args::IntegerArg a_fetch_jobs;
+            args::StringArg a_timeline;
 
             args::ArgsGroup g_phase_options;
             args::StringSetArg a_skip_phase;
@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+# vim: set ft=sh sw=4 sts=4 et :
+
+mkdir serve_TEST_dir || exit 1
+cd serve_TEST_dir || exit 1
+mkdir -p build root/var/db/pkg
+
+for env in serve-test:repo1 serve-other:repo2 ; do
+    name=${env%%:*}
+    repo=${env##*:}
+
+    mkdir -p config/.paludis-${name}/repositories
+    cat <<END > config/.paludis-${name}/specpath.conf
+config-suffix =
+END
+
+    cat <<END > config/.paludis-${name}/general.conf
+world = `pwd`/root/world
+END
+
+    cat <<END > config/.paludis-${name}/repositories/${repo}.conf
+location = `pwd`/${repo}
+cache = /var/empty
+format = e
+names_cache = /var/empty
+profiles = \${location}/profiles/testprofile
+builddir = `pwd`/build
+END
+
+    cat <<END > config/.paludis-${name}/repositories/installed.conf
+location = `pwd`/root/var/db/pkg
+format = vdb
+names_cache = /var/empty
+builddir = `pwd`/build
+END
+
+    mkdir -p ${repo}/{eclass,distfiles,profiles/testprofile} || exit 1
+    echo "${repo}" > ${repo}/profiles/repo_name || exit 1
+    echo "cat" > ${repo}/profiles/categories || exit 1
+    cat <<END > ${repo}/profiles/testprofile/make.defaults
+ARCH=test
+USERLAND=test
+KERNEL=test
+END
+done
+
+for ebuild in repo1/cat/a/a-1.ebuild repo1/cat/b/b-1.ebuild repo2/cat/c/c-1.ebuild ; do
+    mkdir -p ${ebuild%/*} || exit 1
+    cat <<"END" > ${ebuild} || exit 1
+DESCRIPTION="Test"
+SLOT="0"
+KEYWORDS="test"
+END
+done
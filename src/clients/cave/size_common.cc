@@ -39,9 +39,12 @@
 #include <paludis/util/fs_path.hh>
 #include <paludis/util/fs_stat.hh>
 #include <paludis/util/iterator_funcs.hh>
+#include <paludis/util/thread_pool.hh>
+#include <paludis/util/visitor_cast.hh>
 #include <algorithm>
 #include <functional>
 #include <iostream>
+#include <vector>
 
 using namespace paludis;
 
@@ -82,6 +85,32 @@ namespace
             }
         }
     };
+
+    bool get_recorded_size(const PackageID & id, unsigned long & size)
+    {
+        for (const auto & raw_name : { "SIZE", "size" })
+        {
+            auto m(id.find_metadata(raw_name));
+            if (m == id.end_metadata())
+                continue;
+
+            if (auto k = visitor_cast<const MetadataValueKey<long> >(**m))
+            {
+                size = k->parse_value();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    unsigned long get_size_from_contents(const Contents & contents)
+    {
+        unsigned long size(0);
+        for (const auto & entry : contents)
+            size += entry->accept_returning<unsigned long>(GetSize());
+        return size;
+    }
 }
 
 int
@@ -90,7 +119,8 @@ paludis::cave::size_common(
         const bool purdy,
         const std::string & q,
         const bool all,
-        const bool best)
+        const bool best,
+        const int jobs)
 {
     PackageDepSpec spec(parse_spec_with_nice_error(q, env.get(), { }, filter::All()));
     std::shared_ptr<const PackageIDSequence> entries((*env)[selection::AllVersionsSorted(generator::Matches(spec, nullptr, { }) |
@@ -101,17 +131,30 @@ paludis::cave::size_common(
     else if ((! best) && (! all) && (next(entries->begin()) != entries->end()))
         throw BeMoreSpecific(spec, entries);
 
-    for (auto i(best ? entries->last() : entries->begin()), i_end(entries->end()) ;
-            i != i_end ; ++i)
+    /* anything installed by an older Paludis won't have its size recorded,
+     * so fall back to adding up its contents, doing several at once */
+    std::vector<std::shared_ptr<const PackageID> > ids(best ? entries->last() : entries->begin(), entries->end());
+    std::vector<unsigned long> sizes(ids.size(), 0);
+    std::vector<std::pair<std::size_t, std::shared_ptr<const Contents> > > unrecorded;
+
+    for (std::size_t n(0) ; n != ids.size() ; ++n)
     {
-        auto contents((*i)->contents());
+        if (get_recorded_size(*ids[n], sizes[n]))
+            continue;
+
+        auto contents(ids[n]->contents());
         if (! contents)
-            throw BadIDForCommand(spec, (*i), "does not support listing contents");
+            throw BadIDForCommand(spec, ids[n], "does not support listing contents");
 
-        unsigned long size(0);
-        for (const auto & entry : *contents)
-            size += entry->accept_returning<unsigned long>(GetSize());
+        unrecorded.push_back(std::make_pair(n, contents));
+    }
 
+    parallel_for_each(unrecorded.size(), [&] (std::size_t n) {
+            sizes[unrecorded[n].first] = get_size_from_contents(*unrecorded[n].second);
+            }, jobs > 0 ? jobs : 0);
+
+    for (const auto & size : sizes)
+    {
         if (purdy)
             cout << pretty_print_bytes(size) << endl;
         else
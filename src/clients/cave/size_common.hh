@@ -36,7 +36,8 @@ namespace paludis
                 const bool purdy,
                 const std::string & query,
                 const bool all,
-                const bool best);
+                const bool best,
+                const int jobs);
     }
 }
 